@@ -19,12 +19,24 @@
 
 # include "dgd.h"
 
+/*
+ * The size field of a chunk holds a magic number and the size.  When
+ * compiled with MEMSTATS, it also holds the allocation category, which
+ * limits chunks to 128 MB with a 32 bit size_t.
+ */
 # define SIZE_SHIFT	(8 * (sizeof(size_t) - 1))
 # define MAGIC_MASK	((size_t) 0xc0 << SIZE_SHIFT)	/* magic number mask */
-# define SIZE_MASK	(~MAGIC_MASK)			/* size mask */
+# ifdef MEMSTATS
+# define CAT_MASK	((size_t) 0x38 << SIZE_SHIFT)	/* category mask */
+# define CAT_SHIFT	(SIZE_SHIFT + 3)
+# else
+# define CAT_MASK	((size_t) 0)
+# endif
+# define SIZE_MASK	(~(MAGIC_MASK | CAT_MASK))	/* size mask */
 
 # define SM_MAGIC	((size_t) 0x80 << SIZE_SHIFT)	/* static mem */
 # define DM_MAGIC	((size_t) 0xc0 << SIZE_SHIFT)	/* dynamic mem */
+# define SL_MAGIC	((size_t) 0x40 << SIZE_SHIFT)	/* dynamic slab mem */
 
 # define SIZETSIZE	ALGN(sizeof(size_t), STRUCT_AL)
 
@@ -51,6 +63,8 @@ struct header {
 
 
 static allocinfo mstat;		/* memory statistics */
+static allocstat scat[MCATEGORIES];	/* static memory per category */
+static allocstat dcat[MCATEGORIES];	/* dynamic memory per category */
 
 /*
  * NAME:	newmem()
@@ -144,6 +158,10 @@ static chunk *salloc(size_t size)
 {
     chunk *c;
 
+    if (size > SIZE_MASK) {
+	fatal("static memory chunk too large");
+    }
+
     /* try lists of free chunks */
     if (size >= SLIMIT) {
 	chunk **lc;
@@ -516,14 +534,81 @@ static void del(chunk *c)
     }
 }
 
-# define DSMALL		64
+# define DSMALL		512
 # define DLIMIT		(DSMALL + MOFFSET)
-# define DCHUNKS	(DSMALL / STRUCT_AL - 1)
-# define DCHUNKSZ	32768
+# define DCLASSES	32
+# define DSLABSZ	16384
+# define SL_SHIFT	8
+# define SL_CLASS	((1 << SL_SHIFT) - 1)
+# define SL_ARENA	SL_CLASS	/* size class of task arena chunks */
+# define DTINY		64
+# define DTLIMIT	(DTINY + MOFFSET)
+# define DTCHUNKSZ	32768
+
+/*
+ * Small dynamic chunks are allocated from slabs of DSLABSZ bytes.  Each slab
+ * holds chunks of a single size class.  The size field of a chunk in a slab
+ * holds the offset of the chunk in the slab, and the size class.  Chunks
+ * smaller than DTLIMIT are kept in a free list per size class instead, and
+ * have offset 0.
+ */
+struct slab {
+    slab *prev;			/* previous slab with free chunks */
+    slab *next;			/* next slab with free chunks */
+    slab *lprev;		/* previous in list of all slabs */
+    slab *lnext;		/* next in list of all slabs */
+    chunk *flist;		/* list of free chunks */
+    unsigned short top;		/* offset of unused space */
+    unsigned short nused;	/* # chunks in use */
+    unsigned short sclass;	/* size class */
+};
+
+# define SLABOFFSET	ALGN(sizeof(slab), STRUCT_AL)
+
+static size_t dclsize[DCLASSES];	/* chunk size per class */
+static unsigned char dclass[DLIMIT / STRUCT_AL];	/* size to class */
+static slab *dslabs[DCLASSES];		/* slabs with free chunks per class */
+static slab *slabs;			/* list of all slabs */
+static allocstat dclstat[DCLASSES];	/* chunks in use per class */
+static unsigned int ndclasses;		/* # classes */
+static unsigned int ntclasses;		/* # classes with free lists */
+static chunk *dtchunks[DCLASSES];	/* free tiny chunks per class */
+static char *dtchunk;			/* chunk of tiny chunks */
+static size_t dtchunksz;		/* unused space in chunk of tiny chunks */
+
+/*
+ * NAME:	dclasses()
+ * DESCRIPTION:	initialize the size classes of small dynamic chunks
+ */
+static void dclasses()
+{
+    size_t size, step;
+    unsigned int i, n;
+
+    i = n = 0;
+    for (size = ALGN(sizeof(chunk), STRUCT_AL); ; size += step) {
+	if (size > DLIMIT - STRUCT_AL) {
+	    size = DLIMIT - STRUCT_AL;
+	}
+	dclsize[n] = size;
+	while (i <= (size - 1) / STRUCT_AL) {
+	    dclass[i++] = n;
+	}
+	if (size < DTLIMIT) {
+	    ntclasses = n + 1;
+	}
+	n++;
+	if (size == DLIMIT - STRUCT_AL) {
+	    ndclasses = n;
+	    break;
+	}
+
+	/* 4 size classes per doubling in size */
+	for (step = STRUCT_AL; (step << 3) <= size; step <<= 1) ;
+    }
+}
 
 static char *dlist;		/* list of dynamic memory chunks */
-static chunk *dchunks[DCHUNKS];	/* list of free small chunks */
-static chunk *dchunk;		/* chunk of small chunks */
 
 /*
  * NAME:	dalloc()
@@ -535,6 +620,9 @@ static chunk *dalloc(size_t size)
     char *p;
     size_t sz;
 
+    if (size > SIZE_MASK - SIZETSIZE) {
+	fatal("dynamic memory chunk too large");
+    }
     if (dchunksz == 0) {
 	/*
 	 * memory manager hasn't been initialized yet
@@ -545,37 +633,6 @@ static chunk *dalloc(size_t size)
     }
     dmem = TRUE;
 
-    if (size < DLIMIT) {
-	/*
-	 * small chunk
-	 */
-	if ((c=dchunks[(size - MOFFSET) / STRUCT_AL - 1]) != (chunk *) NULL) {
-	    /* small chunk from free list */
-	    dchunks[(size - MOFFSET) / STRUCT_AL - 1] = c->next;
-	    return c;
-	}
-	if (dchunk == (chunk *) NULL) {
-	    /* get new chunks chunk */
-	    dchunk = dalloc(DCHUNKSZ);	/* cannot use alloc() here */
-	    p = (char *) dchunk + SIZETSIZE;
-	    ((chunk *) p)->size = dchunk->size - SIZETSIZE - SIZETSIZE;
-	    dchunk->size |= DM_MAGIC;
-	    dchunk = (chunk *) p;
-	}
-	sz = dchunk->size - size;
-	c = dchunk;
-	c->size = size;
-	if (sz >= DLIMIT - STRUCT_AL) {
-	    /* enough is left for another small chunk */
-	    dchunk = (chunk *) ((char *) c + size);
-	    dchunk->size = sz;
-	} else {
-	    /* waste sz bytes of memory */
-	    dchunk = (chunk *) NULL;
-	}
-	return c;
-    }
-
     size += SIZETSIZE;
     c = seek(size);
     if (c != (chunk *) NULL) {
@@ -622,6 +679,340 @@ static chunk *dalloc(size_t size)
     return c;
 }
 
+/*
+ * NAME:	slalloc()
+ * DESCRIPTION:	allocate a small dynamic chunk from a slab
+ */
+static chunk *slalloc(size_t size)
+{
+    slab *s;
+    chunk *c;
+    unsigned int cl;
+    size_t csize;
+
+    cl = dclass[(size - 1) / STRUCT_AL];
+    csize = dclsize[cl];
+    if (cl < ntclasses) {
+	/*
+	 * tiny chunk
+	 */
+	if ((c=dtchunks[cl]) != (chunk *) NULL) {
+	    /* tiny chunk from free list */
+	    dtchunks[cl] = c->next;
+	} else {
+	    if (dtchunksz < csize) {
+		/* get new chunks chunk, wasting what is left of the old one */
+		c = dalloc(DTCHUNKSZ);	/* cannot use alloc() here */
+		dtchunk = (char *) c + SIZETSIZE;
+		dtchunksz = c->size - SIZETSIZE - SIZETSIZE;
+		c->size |= DM_MAGIC;
+	    }
+	    c = (chunk *) dtchunk;
+	    dtchunk += csize;
+	    dtchunksz -= csize;
+	}
+	c->size = SL_MAGIC | cl;
+	mstat.dmemused += csize;
+# ifdef MEMSTATS
+	dclstat[cl].size += csize;
+	dclstat[cl].count++;
+# endif
+	return c;
+    }
+
+    s = dslabs[cl];
+    if (s == (slab *) NULL) {
+	/*
+	 * new slab
+	 */
+	s = (slab *) newmem(DSLABSZ, (char **) NULL);
+	mstat.dmemsize += DSLABSZ;
+	s->prev = s->next = (slab *) NULL;
+	s->lprev = (slab *) NULL;
+	if ((s->lnext=slabs) != (slab *) NULL) {
+	    slabs->lprev = s;
+	}
+	slabs = s;
+	s->flist = (chunk *) NULL;
+	s->top = SLABOFFSET;
+	s->nused = 0;
+	s->sclass = cl;
+	dslabs[cl] = s;
+    }
+
+    if (s->flist != (chunk *) NULL) {
+	c = s->flist;
+	s->flist = c->next;
+    } else {
+	c = (chunk *) ((char *) s + s->top);
+	s->top += csize;
+    }
+    s->nused++;
+    if (s->flist == (chunk *) NULL && s->top + csize > DSLABSZ) {
+	/* slab is full */
+	if ((dslabs[cl]=s->next) != (slab *) NULL) {
+	    s->next->prev = (slab *) NULL;
+	}
+    }
+
+    c->size = SL_MAGIC | ((size_t) ((char *) c - (char *) s) << SL_SHIFT) | cl;
+    mstat.dmemused += csize;
+# ifdef MEMSTATS
+    dclstat[cl].size += csize;
+    dclstat[cl].count++;
+# endif
+    return c;
+}
+
+/*
+ * NAME:	slfree()
+ * DESCRIPTION:	free a small dynamic chunk, releasing the slab if it becomes
+ *		empty and there are others with free chunks
+ */
+static void slfree(chunk *c)
+{
+    slab *s;
+    unsigned int cl;
+    size_t csize, offset;
+
+    cl = c->size & SL_CLASS;
+    csize = dclsize[cl];
+    mstat.dmemused -= csize;
+# ifdef MEMSTATS
+    dclstat[cl].size -= csize;
+    --dclstat[cl].count;
+# endif
+    offset = (c->size & SIZE_MASK) >> SL_SHIFT;
+    if (offset == 0) {
+	/* tiny chunk */
+	c->next = dtchunks[cl];
+	dtchunks[cl] = c;
+	return;
+    }
+
+    s = (slab *) ((char *) c - offset);
+    if (s->flist == (chunk *) NULL && s->top + csize > DSLABSZ) {
+	/* slab was full */
+	s->prev = (slab *) NULL;
+	if ((s->next=dslabs[cl]) != (slab *) NULL) {
+	    s->next->prev = s;
+	}
+	dslabs[cl] = s;
+    }
+    c->next = s->flist;
+    s->flist = c;
+
+    if (--s->nused == 0 &&
+	(s->prev != (slab *) NULL || s->next != (slab *) NULL)) {
+	/*
+	 * release empty slab
+	 */
+	if (s->prev != (slab *) NULL) {
+	    s->prev->next = s->next;
+	} else {
+	    dslabs[cl] = s->next;
+	}
+	if (s->next != (slab *) NULL) {
+	    s->next->prev = s->prev;
+	}
+	if (s->lprev != (slab *) NULL) {
+	    s->lprev->lnext = s->lnext;
+	} else {
+	    slabs = s->lnext;
+	}
+	if (s->lnext != (slab *) NULL) {
+	    s->lnext->lprev = s->lprev;
+	}
+	free(s);
+	mstat.dmemsize -= DSLABSZ;
+    }
+}
+
+/*
+ * NAME:	slsize()
+ * DESCRIPTION:	return the size of a small dynamic chunk
+ */
+static size_t slsize(chunk *c)
+{
+    if ((c->size & SL_CLASS) == SL_ARENA) {
+	return *(size_t *) ((char *) c - SIZETSIZE);
+    }
+    return dclsize[c->size & SL_CLASS];
+}
+
+# ifdef MEMSTATS
+/*
+ * NAME:	count()
+ * DESCRIPTION:	tag an allocated chunk with a category, and count it
+ */
+static void count(chunk *c, int cat)
+{
+    allocstat *st;
+
+    c->size |= (size_t) cat << CAT_SHIFT;
+    if ((c->size & MAGIC_MASK) == SM_MAGIC) {
+	st = &scat[cat];
+	st->size += c->size & SIZE_MASK;
+    } else {
+	st = &dcat[cat];
+	st->size += ((c->size & MAGIC_MASK) == SL_MAGIC) ?
+		     slsize(c) : c->size & SIZE_MASK;
+    }
+    st->count++;
+}
+
+/*
+ * NAME:	uncount()
+ * DESCRIPTION:	remove an allocated chunk from the statistics, and return its
+ *		category
+ */
+static int uncount(chunk *c)
+{
+    int cat;
+    allocstat *st;
+
+    cat = (c->size & CAT_MASK) >> CAT_SHIFT;
+    if ((c->size & MAGIC_MASK) == SM_MAGIC) {
+	st = &scat[cat];
+	st->size -= c->size & SIZE_MASK;
+    } else {
+	st = &dcat[cat];
+	st->size -= ((c->size & MAGIC_MASK) == SL_MAGIC) ?
+		     slsize(c) : c->size & SIZE_MASK;
+    }
+    --st->count;
+    c->size &= ~CAT_MASK;
+    return cat;
+}
+# else
+/*
+ * NAME:	count()
+ * DESCRIPTION:	without MEMSTATS, chunks are not counted
+ */
+static void count(chunk*, int)
+{
+}
+
+/*
+ * NAME:	uncount()
+ * DESCRIPTION:	without MEMSTATS, chunks have no category
+ */
+static int uncount(chunk*)
+{
+    return MC_OTHER;
+}
+# endif
+
+# define TBLOCKSZ	16384
+# define TLIMIT		(TBLOCKSZ / 16)
+# define TSPARE		8
+
+/*
+ * Temporary values are allocated from arena blocks of TBLOCKSZ bytes.  Chunks
+ * are never reused individually; a block is reset or released when the last
+ * chunk in it is freed, which normally happens at the end of the task.  The
+ * size of an arena chunk is stored in front of it, and its size field holds
+ * the offset of the chunk in the block.
+ */
+struct tblock {
+    tblock *prev;		/* previous arena block */
+    tblock *next;		/* next arena block */
+    size_t top;			/* offset of unused space */
+    Uint nused;			/* # chunks in use */
+};
+
+# define TBOFFSET	ALGN(sizeof(tblock), STRUCT_AL)
+
+static tblock *tblocks;		/* list of arena blocks */
+static tblock *tcurrent;	/* current arena block */
+static tblock *tspare;		/* list of spare empty blocks */
+static int ntspare;		/* # spare blocks */
+
+/*
+ * NAME:	talloc()
+ * DESCRIPTION:	allocate a temporary chunk from the task arena
+ */
+static chunk *talloc(size_t size)
+{
+    tblock *b;
+    chunk *c;
+    char *p;
+
+    b = tcurrent;
+    if (b == (tblock *) NULL || b->top + SIZETSIZE + size > TBLOCKSZ) {
+	if (b != (tblock *) NULL && b->nused == 0) {
+	    /* empty */
+	    b->top = TBOFFSET;
+	} else {
+	    /*
+	     * new block; the old one is released when it becomes empty
+	     */
+	    if (tspare != (tblock *) NULL) {
+		b = tspare;
+		tspare = b->next;
+		--ntspare;
+	    } else {
+		b = (tblock *) newmem(TBLOCKSZ, (char **) NULL);
+		mstat.dmemsize += TBLOCKSZ;
+	    }
+	    b->prev = (tblock *) NULL;
+	    if ((b->next=tblocks) != (tblock *) NULL) {
+		tblocks->prev = b;
+	    }
+	    tblocks = tcurrent = b;
+	    b->top = TBOFFSET;
+	    b->nused = 0;
+	}
+    }
+
+    p = (char *) b + b->top;
+    *(size_t *) p = size;
+    c = (chunk *) (p + SIZETSIZE);
+    b->top += SIZETSIZE + size;
+    b->nused++;
+
+    c->size = SL_MAGIC | ((size_t) ((char *) c - (char *) b) << SL_SHIFT) |
+	      SL_ARENA;
+    mstat.dmemused += size;
+    return c;
+}
+
+/*
+ * NAME:	tfree()
+ * DESCRIPTION:	free a temporary chunk
+ */
+static void tfree(chunk *c)
+{
+    tblock *b;
+
+    b = (tblock *) ((char *) c - ((c->size & SIZE_MASK) >> SL_SHIFT));
+    mstat.dmemused -= *(size_t *) ((char *) c - SIZETSIZE);
+    if (--b->nused == 0) {
+	if (b == tcurrent) {
+	    /* start over */
+	    b->top = TBOFFSET;
+	} else {
+	    /* release block */
+	    if (b->prev != (tblock *) NULL) {
+		b->prev->next = b->next;
+	    } else {
+		tblocks = b->next;
+	    }
+	    if (b->next != (tblock *) NULL) {
+		b->next->prev = b->prev;
+	    }
+	    if (ntspare < TSPARE) {
+		b->next = tspare;
+		tspare = b;
+		ntspare++;
+	    } else {
+		free(b);
+		mstat.dmemsize -= TBLOCKSZ;
+	    }
+	}
+    }
+}
+
 /*
  * NAME:	dfree()
  * DESCRIPTION:	free dynamic memory
@@ -637,11 +1028,9 @@ static void dfree(chunk *c)
 	free((char *) c);
 	return;
     }
-
     if (c->size < DLIMIT) {
-	/* small chunk */
-	c->next = dchunks[(c->size - MOFFSET) / STRUCT_AL - 1];
-	dchunks[(c->size - MOFFSET) / STRUCT_AL - 1] = c;
+	/* small chunk allocated before initialization */
+	free((char *) c);
 	return;
     }
 
@@ -699,6 +1088,7 @@ void m_init(size_t ssz, size_t dsz)
 	schunk = (chunk *) newmem(schunksz, &slist);
 	mstat.smemsize += schunk->size = schunksz;
     }
+    dclasses();
     dmem = FALSE;
 }
 
@@ -712,9 +1102,9 @@ static header *hlist;			/* list of all dynamic memory chunks */
  * DESCRIPTION:	allocate memory
  */
 # ifdef DEBUG
-char *m_alloc(size_t size, const char *file, int line)
+char *m_alloc(size_t size, int cat, const char *file, int line)
 # else
-char *m_alloc(size_t size)
+char *m_alloc(size_t size, int cat)
 # endif
 {
     chunk *c;
@@ -730,17 +1120,18 @@ char *m_alloc(size_t size)
 	size = ALGN(sizeof(chunk), STRUCT_AL);
     }
 # endif
-    if (size > SIZE_MASK) {
-	fatal("size too big in m_alloc");
-    }
     if (slevel > 0) {
 	c = salloc(size);
 	mstat.smemused += c->size;
 	c->size |= SM_MAGIC;
     } else {
-	c = dalloc(size);
-	mstat.dmemused += c->size;
-	c->size |= DM_MAGIC;
+	if (size < DLIMIT && dchunksz != 0) {
+	    c = slalloc(size);
+	} else {
+	    c = dalloc(size);
+	    mstat.dmemused += c->size;
+	    c->size |= DM_MAGIC;
+	}
 # ifdef DEBUG
 	((header *) c)->prev = (header *) NULL;
 	((header *) c)->next = hlist;
@@ -750,6 +1141,7 @@ char *m_alloc(size_t size)
 	hlist = (header *) c;
 # endif
     }
+    count(c, cat);
 # ifdef DEBUG
     ((header *) c)->file = file;
     ((header *) c)->line = line;
@@ -757,6 +1149,58 @@ char *m_alloc(size_t size)
     return (char *) c + MOFFSET;
 }
 
+/*
+ * NAME:	mem->talloc()
+ * DESCRIPTION:	allocate temporary memory, which is expected to be freed
+ *		before the end of the current task
+ */
+# ifdef DEBUG
+char *m_talloc(size_t size, int cat, const char *file, int line)
+# else
+char *m_talloc(size_t size, int cat)
+# endif
+{
+    chunk *c;
+
+    if (slevel > 0 || dchunksz == 0 || size >= TLIMIT) {
+# ifdef DEBUG
+	return m_alloc(size, cat, file, line);
+# else
+	return m_alloc(size, cat);
+# endif
+    }
+# ifdef DEBUG
+    if (size == 0) {
+	fatal("m_talloc(0)");
+    }
+# endif
+    c = talloc(ALGN(size + MOFFSET, STRUCT_AL));
+    count(c, cat);
+# ifdef DEBUG
+    ((header *) c)->prev = (header *) NULL;
+    ((header *) c)->next = hlist;
+    if (hlist != (header *) NULL) {
+	hlist->prev = (header *) c;
+    }
+    hlist = (header *) c;
+    ((header *) c)->file = file;
+    ((header *) c)->line = line;
+# endif
+    return (char *) c + MOFFSET;
+}
+
+/*
+ * NAME:	mem->temp()
+ * DESCRIPTION:	return TRUE if memory was allocated from the task arena
+ */
+bool m_temp(char *mem)
+{
+    size_t size;
+
+    size = ((chunk *) (mem - MOFFSET))->size;
+    return ((size & MAGIC_MASK) == SL_MAGIC && (size & SL_CLASS) == SL_ARENA);
+}
+
 /*
  * NAME:	mem->free()
  * DESCRIPTION:	free memory
@@ -767,12 +1211,13 @@ void m_free(char *mem)
 
     c = (chunk *) (mem - MOFFSET);
     if ((c->size & MAGIC_MASK) == SM_MAGIC) {
+	uncount(c);
 	c->size &= SIZE_MASK;
 	mstat.smemused -= c->size;
 	sfree(c);
-    } else if ((c->size & MAGIC_MASK) == DM_MAGIC) {
-	c->size &= SIZE_MASK;
-	mstat.dmemused -= c->size;
+    } else if ((c->size & MAGIC_MASK) == DM_MAGIC ||
+	       (c->size & MAGIC_MASK) == SL_MAGIC) {
+	uncount(c);
 # ifdef DEBUG
 	if (((header *) c)->next != (header *) NULL) {
 	    ((header *) c)->next->prev = ((header *) c)->prev;
@@ -783,7 +1228,15 @@ void m_free(char *mem)
 	    ((header *) c)->prev->next = ((header *) c)->next;
 	}
 # endif
-	dfree(c);
+	if ((c->size & MAGIC_MASK) != SL_MAGIC) {
+	    c->size &= SIZE_MASK;
+	    mstat.dmemused -= c->size;
+	    dfree(c);
+	} else if ((c->size & SL_CLASS) == SL_ARENA) {
+	    tfree(c);
+	} else {
+	    slfree(c);
+	}
     } else {
 	fatal("bad pointer in m_free");
     }
@@ -800,15 +1253,16 @@ char *m_realloc(char *mem, size_t size1, size_t size2)
 # endif
 {
     chunk *c1, *c2;
+    int cat;
 
     if (mem == (char *) NULL) {
 	if (size2 == 0) {
 	    return (char *) NULL;
 	}
 # ifdef DEBUG
-	return m_alloc(size2, file, line);
+	return m_alloc(size2, MC_OTHER, file, line);
 # else
-	return m_alloc(size2);
+	return m_alloc(size2, MC_OTHER);
 # endif
     }
     if (size2 == 0) {
@@ -834,27 +1288,38 @@ char *m_realloc(char *mem, size_t size1, size_t size2)
 	    if (size1 != 0) {
 		memcpy((char *) c2 + MOFFSET, mem, size1);
 	    }
+	    cat = uncount(c1);
 	    c1->size &= SIZE_MASK;
 	    mstat.smemused += c2->size - c1->size;
 	    c2->size |= SM_MAGIC;
+	    count(c2, cat);
 	    sfree(c1);
 	    c1 = c2;
 	}
-    } else if ((c1->size & MAGIC_MASK) == DM_MAGIC) {
+    } else if ((c1->size & MAGIC_MASK) == DM_MAGIC ||
+	       (c1->size & MAGIC_MASK) == SL_MAGIC) {
+	size_t size;
+
+	size = ((c1->size & MAGIC_MASK) == SL_MAGIC) ?
+		slsize(c1) : (c1->size & SIZE_MASK) - SIZETSIZE;
 # ifdef DEBUG
-	if (size1 > (c1->size & SIZE_MASK)) {
+	if (size1 > size) {
 	    fatal("bad size1 in m_realloc");
 	}
 # endif
-	if ((c1->size & SIZE_MASK) < ((size2 < DLIMIT) ?
-				       size2 : size2 + SIZETSIZE)) {
-	    c2 = dalloc(size2);
+	if (size < size2) {
+	    if (size2 < DLIMIT && dchunksz != 0) {
+		c2 = slalloc(size2);
+	    } else {
+		c2 = dalloc(size2);
+		mstat.dmemused += c2->size;
+		c2->size |= DM_MAGIC;
+	    }
 	    if (size1 != 0) {
 		memcpy((char *) c2 + MOFFSET, mem, size1);
 	    }
-	    c1->size &= SIZE_MASK;
-	    mstat.dmemused += c2->size - c1->size;
-	    c2->size |= DM_MAGIC;
+	    cat = uncount(c1);
+	    count(c2, cat);
 # ifdef DEBUG
 	    ((header *) c2)->next = ((header *) c1)->next;
 	    if (((header *) c1)->next != (header *) NULL) {
@@ -867,7 +1332,15 @@ char *m_realloc(char *mem, size_t size1, size_t size2)
 		((header *) c2)->prev->next = (header *) c2;
 	    }
 # endif
-	    dfree(c1);
+	    if ((c1->size & MAGIC_MASK) != SL_MAGIC) {
+		c1->size &= SIZE_MASK;
+		mstat.dmemused -= c1->size;
+		dfree(c1);
+	    } else if ((c1->size & SL_CLASS) == SL_ARENA) {
+		tfree(c1);
+	    } else {
+		slfree(c1);
+	    }
 	    c1 = c2;
 	}
     } else {
@@ -907,9 +1380,13 @@ void m_purge()
 	char buf[160];
 	size_t n;
 
-	n = (hlist->size & SIZE_MASK) - MOFFSET;
-	if (n >= DLIMIT) {
-	    n -= SIZETSIZE;
+	if ((hlist->size & MAGIC_MASK) == SL_MAGIC) {
+	    n = slsize((chunk *) hlist) - MOFFSET;
+	} else {
+	    n = (hlist->size & SIZE_MASK) - MOFFSET;
+	    if (n >= DLIMIT) {
+		n -= SIZETSIZE;
+	    }
 	}
 	sprintf(buf, "FREE(%08lx/%u), %s line %u:\012", /* LF */
 		(unsigned long) (hlist + 1), (unsigned int) n, hlist->file,
@@ -936,8 +1413,29 @@ void m_purge()
 	dlist = *(char **) p;
 	free(p);
     }
-    memset(dchunks, '\0', sizeof(dchunks));
-    dchunk = (chunk *) NULL;
+    while (slabs != (slab *) NULL) {
+	p = (char *) slabs;
+	slabs = slabs->lnext;
+	free(p);
+    }
+    memset(dslabs, '\0', sizeof(dslabs));
+    memset(dtchunks, '\0', sizeof(dtchunks));
+    dtchunk = (char *) NULL;
+    dtchunksz = 0;
+    memset(dclstat, '\0', sizeof(dclstat));
+    memset(dcat, '\0', sizeof(dcat));
+    while (tblocks != (tblock *) NULL) {
+	p = (char *) tblocks;
+	tblocks = tblocks->next;
+	free(p);
+    }
+    while (tspare != (tblock *) NULL) {
+	p = (char *) tspare;
+	tspare = tspare->next;
+	free(p);
+    }
+    tcurrent = (tblock *) NULL;
+    ntspare = 0;
     dtree = (spnode *) NULL;
     mstat.dmemsize = mstat.dmemused = 0;
     dmem = FALSE;
@@ -961,9 +1459,60 @@ void m_purge()
  */
 allocinfo *m_info()
 {
+    int i;
+
+    for (i = 0; i < MCATEGORIES; i++) {
+	mstat.category[i].size = scat[i].size + dcat[i].size;
+	mstat.category[i].count = scat[i].count + dcat[i].count;
+    }
+    mstat.nclasses = ndclasses;
+    mstat.clsize = dclsize;
+    mstat.clstat = dclstat;
     return &mstat;
 }
 
+/*
+ * NAME:	mem->dump()
+ * DESCRIPTION:	show memory statistics
+ */
+void m_dump()
+{
+# ifdef MEMSTATS
+    static const char *catname[MCATEGORIES] = {
+	"other", "strings", "arrays", "mappings", "control", "dataspaces",
+	"parser", "editor"
+    };
+    unsigned int i;
+# endif
+    char buf[128];
+    allocinfo *info;
+
+    info = m_info();
+    sprintf(buf, "Static memory: %lu used of %lu\012",	/* LF */
+	    (unsigned long) info->smemused, (unsigned long) info->smemsize);
+    P_message(buf);
+    sprintf(buf, "Dynamic memory: %lu used of %lu\012",	/* LF */
+	    (unsigned long) info->dmemused, (unsigned long) info->dmemsize);
+    P_message(buf);
+# ifdef MEMSTATS
+    for (i = 0; i < MCATEGORIES; i++) {
+	sprintf(buf, "  %-10s %10lu bytes in %8lu chunks\012", /* LF */
+		catname[i], (unsigned long) info->category[i].size,
+		(unsigned long) info->category[i].count);
+	P_message(buf);
+    }
+    for (i = 0; i < info->nclasses; i++) {
+	if (info->clstat[i].count != 0) {
+	    sprintf(buf, "  size %4lu %10lu bytes in %8lu chunks\012", /* LF */
+		    (unsigned long) info->clsize[i],
+		    (unsigned long) info->clstat[i].size,
+		    (unsigned long) info->clstat[i].count);
+	    P_message(buf);
+	}
+    }
+# endif
+}
+
 
 /*
  * NAME:	mem->finish()
@@ -995,4 +1544,5 @@ void m_finish()
     sflist = (chunk *) NULL;
     slevel = 0;
     mstat.smemsize = mstat.smemused = 0;
+    memset(scat, '\0', sizeof(scat));
 }
@@ -17,28 +17,50 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+/* allocation categories */
+# define MC_OTHER	0	/* uncategorized */
+# define MC_STRING	1	/* strings */
+# define MC_ARRAY	2	/* arrays */
+# define MC_MAPPING	3	/* mapping elements */
+# define MC_CONTROL	4	/* control blocks */
+# define MC_DATASPACE	5	/* dataspaces */
+# define MC_PARSER	6	/* parse_string() state */
+# define MC_EDITOR	7	/* editor */
+# define MCATEGORIES	8
+
 # ifdef DEBUG
 
-# define ALLOC(type, size)						      \
+# define ALLOC(type, size)	ALLOC_CAT(type, size, MC_OTHER)
+# define ALLOC_CAT(type, size, cat)					      \
 			((type *) (m_alloc(sizeof(type) * (size_t) (size),    \
-					   __FILE__, __LINE__)))
+					   cat, __FILE__, __LINE__)))
+# define TALLOC(type, size, cat)					      \
+			((type *) (m_talloc(sizeof(type) * (size_t) (size),   \
+					    cat, __FILE__, __LINE__)))
 # define REALLOC(mem, type, size1, size2)				      \
 			((type *) (m_realloc((char *) (mem),		      \
 					     sizeof(type) * (size_t) (size1), \
 					     sizeof(type) * (size_t) (size2), \
 					     __FILE__, __LINE__)))
-extern char *m_alloc	(size_t, const char*, int);
+extern char *m_alloc	(size_t, int, const char*, int);
+extern char *m_talloc	(size_t, int, const char*, int);
 extern char *m_realloc	(char*, size_t, size_t, const char*, int);
 
 # else
 
-# define ALLOC(type, size)						      \
-			((type *) (m_alloc(sizeof(type) * (size_t) (size))))
+# define ALLOC(type, size)	ALLOC_CAT(type, size, MC_OTHER)
+# define ALLOC_CAT(type, size, cat)					      \
+			((type *) (m_alloc(sizeof(type) * (size_t) (size),    \
+					   cat)))
+# define TALLOC(type, size, cat)					      \
+			((type *) (m_talloc(sizeof(type) * (size_t) (size),   \
+					    cat)))
 # define REALLOC(mem, type, size1, size2)				      \
 			((type *) (m_realloc((char *) (mem),		      \
 					     sizeof(type) * (size_t) (size1), \
 					     sizeof(type) * (size_t) (size2))))
-extern char *m_alloc	(size_t);
+extern char *m_alloc	(size_t, int);
+extern char *m_talloc	(size_t, int);
 extern char *m_realloc	(char*, size_t, size_t);
 
 # endif
@@ -47,6 +69,7 @@ extern char *m_realloc	(char*, size_t, size_t);
 
 extern void  m_init	(size_t, size_t);
 extern void  m_free	(char*);
+extern bool  m_temp	(char*);
 extern void  m_dynamic	();
 extern void  m_static	();
 extern bool  m_check	();
@@ -72,8 +95,17 @@ public:
     }
 };
 
-template <class T, int CHUNK> class Chunk : public Allocated {
+template <class T, int CHUNK, int CAT = MC_OTHER>
+class Chunk : public Allocated {
 public:
+    /*
+     * NAME:		new()
+     * DESCRIPTION:	override new for class Chunk
+     */
+    static void *operator new(size_t size) {
+	return ALLOC_CAT(char, size, CAT);
+    }
+
     /*
      * NAME:		Chunk()
      * DESCRIPTION:	constructor
@@ -97,7 +129,7 @@ public:
 	    if (chunk == NULL || chunksize == 0) {
 		Tchunk *b;
 
-		b = ALLOC(Tchunk, 1);
+		b = ALLOC_CAT(Tchunk, 1, CAT);
 		b->prev = chunk;
 		chunk = b;
 		chunksize = CHUNK;
@@ -180,11 +212,21 @@ private:
     int chunksize;		/* size of chunk */
 };
 
+struct allocstat {
+    size_t size;	/* bytes in use */
+    size_t count;	/* # chunks in use */
+};
+
 struct allocinfo {
     size_t smemsize;	/* static memory size */
     size_t smemused;	/* static memory used */
     size_t dmemsize;	/* dynamic memory used */
     size_t dmemused;	/* dynamic memory used */
+    allocstat category[MCATEGORIES];	/* memory in use per category */
+    unsigned int nclasses;		/* # small chunk size classes */
+    const size_t *clsize;		/* chunk size per class */
+    allocstat *clstat;			/* small chunks in use per class */
 };
 
 extern allocinfo *m_info ();
+extern void	  m_dump ();
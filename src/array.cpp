@@ -33,24 +33,47 @@ struct arrh {
     Uint index;			/* building index */
 };
 
-# define MELT_CHUNK	128
-
-struct mapelt {
+/*
+ * The hashed part of a mapping is an open addressing hash table with linear
+ * probing.  A slot holds the hash value of an element and its place in a
+ * separate array of elements, so that empty slots are cheap.  Slots are kept
+ * in Robin Hood order: an element never lies further from its home slot than
+ * the element it displaced, so a search can stop as soon as it passes an
+ * element closer to home than itself, and slots are removed by shifting the
+ * remainder of the run back one slot.  The element array has no holes; a
+ * removed element is replaced by the last one.
+ */
+struct mapslot {
     Uint hashval;		/* hash value of index */
+    unsigned short elt;		/* element + 1, or 0 if unused */
     bool add;			/* new element? */
+};
+
+struct mapelt {
     Value idx;			/* index */
     Value val;			/* value */
-    mapelt *next;		/* next in hash table */
 };
 
 struct maphash {
     unsigned short size;	/* # elements in hash table */
     unsigned short sizemod;	/* mapping size modification */
-    Uint tablesize;		/* actual hash table size */
-    mapelt *table[1];		/* hash table */
+    Uint eltsize;		/* # elements allocated */
+    Uint tablesize;		/* actual hash table size, a power of 2 */
+    int shift;			/* 32 - log2(tablesize) */
+    mapelt *elts;		/* elements */
+    mapslot table[1];		/* hash table */
 };
 
-# define MTABLE_SIZE	16	/* most mappings are quite small */
+# define MTABLE_SIZE	8	/* most mappings are quite small */
+# define MTABLE_SHIFT	29
+# define MELTS_SIZE	4	/* initial # elements */
+
+/* home slot of a hash value: Fibonacci hashing spreads weak hash values */
+# define MHOME(h, hashval)	((Uint) ((hashval) * (Uint) 0x9e3779b1) >> \
+				 (h)->shift)
+/* distance of the element in slot i from its home slot */
+# define MDIST(h, i)		(((i) - MHOME(h, (h)->table[i].hashval)) & \
+				 ((h)->tablesize - 1))
 
 # define ABCHUNKSZ	32
 
@@ -61,8 +84,7 @@ struct arrbak {
     Dataplane *plane;		/* original dataplane */
 };
 
-static Chunk<Array, ARR_CHUNK> achunk;
-static Chunk<mapelt, MELT_CHUNK> echunk;
+static Chunk<Array, ARR_CHUNK, MC_ARRAY> achunk;
 
 static class arrhchunk : public Chunk<arrh, ARR_CHUNK> {
 public:
@@ -146,19 +168,19 @@ public:
 	    }
 
 	    if (a->hashed != (maphash *) NULL) {
-		mapelt *e, *n, **t;
-
-		for (i = a->hashed->size, t = a->hashed->table; i > 0; t++) {
-		    for (e = *t; e != (mapelt *) NULL; e = n) {
-			if (e->add) {
-			    i_del_value(&e->idx);
-			    i_del_value(&e->val);
-			}
-			n = e->next;
-			echunk.del(e);
-			--i;
+		mapslot *s;
+		mapelt *e;
+		Uint n;
+
+		for (s = a->hashed->table, n = a->hashed->tablesize; n != 0;
+		     s++, --n) {
+		    if (s->elt != 0 && s->add) {
+			e = &a->hashed->elts[s->elt - 1];
+			i_del_value(&e->idx);
+			i_del_value(&e->val);
 		    }
 		}
+		FREE(a->hashed->elts);
 		FREE(a->hashed);
 		a->hashed = (maphash *) NULL;
 		a->hashmod = FALSE;
@@ -242,7 +264,7 @@ Array *arr_new(Dataspace *data, long size)
     }
     a = arr_alloc((unsigned short) size);
     if (size > 0) {
-	a->elts = ALLOC(Value, size);
+	a->elts = ALLOC_CAT(Value, size, MC_ARRAY);
     }
     a->tag = tag++;
     a->odcount = odcount;
@@ -305,22 +327,22 @@ void arr_del(Array *a)
 	    }
 
 	    if (a->hashed != (maphash *) NULL) {
-		mapelt *e, *n, **t;
+		mapslot *s;
+		mapelt *e;
+		Uint n;
 
 		/*
 		 * delete the hashtable of a mapping
 		 */
-		for (i = a->hashed->size, t = a->hashed->table; i > 0; t++) {
-		    for (e = *t; e != (mapelt *) NULL; e = n) {
-			if (e->add) {
-			    i_del_value(&e->idx);
-			    i_del_value(&e->val);
-			}
-			n = e->next;
-			echunk.del(e);
-			--i;
+		for (s = a->hashed->table, n = a->hashed->tablesize; n != 0;
+		     s++, --n) {
+		    if (s->elt != 0 && s->add) {
+			e = &a->hashed->elts[s->elt - 1];
+			i_del_value(&e->idx);
+			i_del_value(&e->val);
 		    }
 		}
+		FREE(a->hashed->elts);
 		FREE(a->hashed);
 	    }
 
@@ -342,7 +364,9 @@ void arr_freelist(Array *alist)
     Array *a;
     Value *v;
     unsigned short i;
-    mapelt *e, *n, **t;
+    mapslot *s;
+    mapelt *e;
+    Uint n;
 
     a = alist;
     do {
@@ -362,21 +386,19 @@ void arr_freelist(Array *alist)
 	    /*
 	     * delete the hashtable of a mapping
 	     */
-	    for (i = a->hashed->size, t = a->hashed->table; i > 0; t++) {
-		for (e = *t; e != (mapelt *) NULL; e = n) {
-		    if (e->add) {
-			if (e->idx.type == T_STRING) {
-			    str_del(e->idx.u.string);
-			}
-			if (e->val.type == T_STRING) {
-			    str_del(e->val.u.string);
-			}
+	    for (s = a->hashed->table, n = a->hashed->tablesize; n != 0;
+		 s++, --n) {
+		if (s->elt != 0 && s->add) {
+		    e = &a->hashed->elts[s->elt - 1];
+		    if (e->idx.type == T_STRING) {
+			str_del(e->idx.u.string);
+		    }
+		    if (e->val.type == T_STRING) {
+			str_del(e->val.u.string);
 		    }
-		    n = e->next;
-		    echunk.del(e);
-		    --i;
 		}
 	    }
+	    FREE(a->hashed->elts);
 	    FREE(a->hashed);
 	}
 
@@ -388,12 +410,11 @@ void arr_freelist(Array *alist)
 
 /*
  * NAME:	Array->freeall()
- * DESCRIPTION:	free all array chunks and mapping element chunks
+ * DESCRIPTION:	free all array chunks
  */
 void arr_freeall()
 {
     achunk.clean();
-    echunk.clean();
 }
 
 /*
@@ -456,7 +477,8 @@ void arr_backup(abchunk **ac, Array *a)
     }
 # endif
     if (a->size != 0) {
-	memcpy(elts = ALLOC(Value, a->size), a->elts, a->size * sizeof(Value));
+	memcpy(elts = ALLOC_CAT(Value, a->size, MC_ARRAY), a->elts,
+	       a->size * sizeof(Value));
 	for (i = a->size; i != 0; --i) {
 	    switch (elts->type) {
 	    case T_STRING:
@@ -1091,7 +1113,7 @@ Array *map_new(Dataspace *data, long size)
     }
     m = arr_alloc((unsigned short) size);
     if (size > 0) {
-	m->elts = ALLOC(Value, size);
+	m->elts = ALLOC_CAT(Value, size, MC_MAPPING);
     }
     m->tag = tag++;
     m->odcount = odcount;
@@ -1140,6 +1162,100 @@ void map_sort(Array *m)
     m->size = sz;
 }
 
+/*
+ * NAME:	mapping->hashval()
+ * DESCRIPTION:	compute the hash value of a mapping index
+ */
+static Uint map_hashval(Value *val)
+{
+    switch (val->type) {
+    case T_NIL:
+	return 4747;
+
+    case T_INT:
+	return val->u.number;
+
+    case T_FLOAT:
+	return VFLT_HASH(val);
+
+    case T_STRING:
+	return Hashtab::hashmem(val->u.string->text, val->u.string->len);
+
+    case T_OBJECT:
+	return val->oindex;
+
+    case T_ARRAY:
+    case T_MAPPING:
+    case T_LWOBJECT:
+	return (unsigned short) ((uintptr_t) val->u.array >> 3);
+    }
+
+    return 0;
+}
+
+/*
+ * NAME:	mapping->hadd()
+ * DESCRIPTION:	make room for a new slot in the hash table of a mapping
+ */
+static mapslot *map_hadd(maphash *h, Uint hashval)
+{
+    Uint mask, i, j, k, dist;
+    mapslot *s;
+
+    /*
+     * find the place of the new slot, then shift the rest of the run
+     * forward by one slot
+     */
+    mask = h->tablesize - 1;
+    for (i = MHOME(h, hashval), dist = 0;
+	 h->table[i].elt != 0 && MDIST(h, i) >= dist;
+	 i = (i + 1) & mask, dist++) ;
+    for (j = i; h->table[j].elt != 0; j = k) {
+	k = (j + 1) & mask;
+    }
+    while (j != i) {
+	k = (j - 1) & mask;
+	h->table[j] = h->table[k];
+	j = k;
+    }
+
+    s = &h->table[i];
+    s->hashval = hashval;
+    return s;
+}
+
+/*
+ * NAME:	mapping->hdel()
+ * DESCRIPTION:	remove an element from the hash table of a mapping
+ */
+static void map_hdel(maphash *h, Uint i)
+{
+    Uint mask, j, elt;
+
+    /*
+     * shift the rest of the run back by one slot
+     */
+    elt = h->table[i].elt;
+    mask = h->tablesize - 1;
+    for (j = (i + 1) & mask; h->table[j].elt != 0 && MDIST(h, j) != 0;
+	 j = (j + 1) & mask) {
+	h->table[i] = h->table[j];
+	i = j;
+    }
+    h->table[i].elt = 0;
+
+    if (elt != h->size) {
+	/*
+	 * move the last element into the hole
+	 */
+	for (i = MHOME(h, map_hashval(&h->elts[h->size - 1].idx));
+	     h->table[i].elt != h->size; i = (i + 1) & mask) ;
+	h->table[i].elt = elt;
+	h->elts[elt - 1] = h->elts[h->size - 1];
+    }
+    --h->size;
+}
+
 /*
  * NAME:	mapping->dehash()
  * DESCRIPTION:	commit changes from the hash table to the array part
@@ -1148,7 +1264,10 @@ static void map_dehash(Dataspace *data, Array *m, bool clean)
 {
     unsigned short size, i, j;
     Value *v1, *v2, *v3;
-    mapelt *e, **t, **p;
+    maphash *h;
+    mapslot *s;
+    mapelt *e;
+    Uint mask, k, n;
 
     if (clean && m->size != 0) {
 	/*
@@ -1226,23 +1345,33 @@ static void map_dehash(Dataspace *data, Array *m, bool clean)
 	/*
 	 * merge copy of hashtable with sorted array
 	 */
-	size = m->hashed->size;
+	h = m->hashed;
+	size = h->size;
 	v2 = ALLOCA(Value, size << 1);
-	t = m->hashed->table;
+	mask = h->tablesize - 1;
 	if (clean) {
-	    for (i = size, size = j = 0; i > 0; ) {
-		for (p = t++; (e=*p) != (mapelt *) NULL; --i) {
+	    /*
+	     * Start just after an empty slot.  Removing an element only moves
+	     * elements further on in the same run, which are still to be
+	     * visited, into the freed slot.
+	     */
+	    for (k = 0; h->table[k].elt != 0; k++) ;
+	    j = h->size;
+	    for (n = h->tablesize, size = 0; n != 0; --n) {
+		k = (k + 1) & mask;
+		s = &h->table[k];
+		while (s->elt != 0) {
+		    e = &h->elts[s->elt - 1];
 		    switch (e->idx.type) {
 		    case T_OBJECT:
 			if (DESTRUCTED(&e->idx)) {
 			    /*
 			     * index is destructed object
 			     */
-			    if (e->add) {
+			    if (s->add) {
 				d_assign_elt(data, m, &e->val, &nil_value);
 			    }
-			    *p = e->next;
-			    echunk.del(e);
+			    map_hdel(h, k);
 			    continue;
 			}
 			break;
@@ -1253,12 +1382,11 @@ static void map_dehash(Dataspace *data, Array *m, bool clean)
 			    /*
 			     * index is destructed object
 			     */
-			    if (e->add) {
+			    if (s->add) {
 				d_assign_elt(data, m, &e->idx, &nil_value);
 				d_assign_elt(data, m, &e->val, &nil_value);
 			    }
-			    *p = e->next;
-			    echunk.del(e);
+			    map_hdel(h, k);
 			    continue;
 			}
 			break;
@@ -1269,11 +1397,10 @@ static void map_dehash(Dataspace *data, Array *m, bool clean)
 			    /*
 			     * value is destructed object
 			     */
-			    if (e->add) {
+			    if (s->add) {
 				d_assign_elt(data, m, &e->idx, &nil_value);
 			    }
-			    *p = e->next;
-			    echunk.del(e);
+			    map_hdel(h, k);
 			    continue;
 			}
 			break;
@@ -1284,49 +1411,42 @@ static void map_dehash(Dataspace *data, Array *m, bool clean)
 			    /*
 			     * value is destructed object
 			     */
-			    if (e->add) {
+			    if (s->add) {
 				d_assign_elt(data, m, &e->idx, &nil_value);
 				d_assign_elt(data, m, &e->val, &nil_value);
 			    }
-			    *p = e->next;
-			    echunk.del(e);
+			    map_hdel(h, k);
 			    continue;
 			}
 			break;
 		    }
 
-		    if (e->add) {
-			e->add = FALSE;
+		    if (s->add) {
+			s->add = FALSE;
 			*v2++ = e->idx;
 			*v2++ = e->val;
 			size++;
 		    }
-		    j++;
-
-		    p = &e->next;
+		    break;
 		}
 	    }
 
-	    if (j != m->hashed->size) {
-		m->hashed->size = j;
+	    if (h->size != j) {
 		d_change_map(m);
 	    }
 	} else {
-	    size = m->hashed->sizemod;
-	    for (i = size; i > 0; ) {
-		for (e = *t++; e != (mapelt *) NULL; e = e->next) {
-		    if (e->add) {
-			e->add = FALSE;
-			*v2++ = e->idx;
-			*v2++ = e->val;
-			if (--i == 0) {
-			    break;
-			}
-		    }
+	    size = h->sizemod;
+	    for (i = size, s = h->table; i > 0; s++) {
+		if (s->elt != 0 && s->add) {
+		    s->add = FALSE;
+		    e = &h->elts[s->elt - 1];
+		    *v2++ = e->idx;
+		    *v2++ = e->val;
+		    --i;
 		}
 	    }
 	}
-	m->hashed->sizemod = 0;
+	h->sizemod = 0;
 	m->hashmod = FALSE;
 
 	if (size != 0) {
@@ -1337,7 +1457,7 @@ static void map_dehash(Dataspace *data, Array *m, bool clean)
 	     * merge the two value arrays
 	     */
 	    v1 = m->elts;
-	    v3 = ALLOC(Value, m->size + size);
+	    v3 = ALLOC_CAT(Value, m->size + size, MC_MAPPING);
 	    for (i = m->size, j = size; i > 0 && j > 0; ) {
 		if (cmp(v1, v2) <= 0) {
 		    *v3++ = *v1++;
@@ -1377,19 +1497,10 @@ static void map_dehash(Dataspace *data, Array *m, bool clean)
 void map_rmhash(Array *m)
 {
     if (m->hashed != (maphash *) NULL) {
-	unsigned short i;
-	mapelt *e, *n, **t;
-
 	if (m->hashmod) {
 	    map_dehash(m->primary->data, m, FALSE);
 	}
-	for (i = m->hashed->size, t = m->hashed->table; i > 0; t++) {
-	    for (e = *t; e != (mapelt *) NULL; e = n) {
-		n = e->next;
-		echunk.del(e);
-		--i;
-	    }
-	}
+	FREE(m->hashed->elts);
 	FREE(m->hashed);
 	m->hashed = (maphash *) NULL;
     }
@@ -1681,6 +1792,7 @@ Array *map_intersect(Dataspace *data, Array *m1, Array *a2)
 static mapelt *map_grow(Dataspace *data, Array *m, Uint hashval, bool add)
 {
     maphash *h;
+    mapslot *s;
     mapelt *e;
     Uint i;
 
@@ -1699,51 +1811,60 @@ static mapelt *map_grow(Dataspace *data, Array *m, Uint hashval, bool add)
 	 * add hash table to this mapping
 	 */
 	m->hashed = h = (maphash *)
-	    ALLOC(char, sizeof(maphash) + (MTABLE_SIZE - 1) * sizeof(mapelt*));
+	    ALLOC_CAT(char,
+		      sizeof(maphash) + (MTABLE_SIZE - 1) * sizeof(mapslot),
+		      MC_MAPPING);
 	h->size = 0;
 	h->sizemod = 0;
+	h->eltsize = MELTS_SIZE;
 	h->tablesize = MTABLE_SIZE;
-	memset(h->table, '\0', MTABLE_SIZE * sizeof(mapelt*));
-    } else if (h->size << 2 >= h->tablesize * 3) {
-	mapelt *n, **t;
-	unsigned short j;
-
-	/*
-	 * extend hash table for this mapping
-	 */
-	i = h->tablesize << 1;
-	h = (maphash *) ALLOC(char,
-			      sizeof(maphash) + (i - 1) * sizeof(mapelt*));
-	h->size = m->hashed->size;
-	h->sizemod = m->hashed->sizemod;
-	h->tablesize = i;
-	memset(h->table, '\0', i * sizeof(mapelt*));
-	/*
-	 * copy entries from old hashtable to new hashtable
-	 */
-	for (j = h->size, t = m->hashed->table; j > 0; t++) {
-	    for (e = *t; e != (mapelt *) NULL; e = n) {
-		n = e->next;
-		i = e->hashval % h->tablesize;
-		e->next = h->table[i];
-		h->table[i] = e;
-		--j;
+	h->shift = MTABLE_SHIFT;
+	h->elts = ALLOC_CAT(mapelt, MELTS_SIZE, MC_MAPPING);
+	memset(h->table, '\0', MTABLE_SIZE * sizeof(mapslot));
+    } else {
+	if (h->size << 2 >= h->tablesize * 3) {
+	    /*
+	     * extend hash table for this mapping
+	     */
+	    i = h->tablesize << 1;
+	    h = (maphash *)
+		ALLOC_CAT(char, sizeof(maphash) + (i - 1) * sizeof(mapslot),
+			  MC_MAPPING);
+	    h->size = m->hashed->size;
+	    h->sizemod = m->hashed->sizemod;
+	    h->eltsize = m->hashed->eltsize;
+	    h->tablesize = i;
+	    h->shift = m->hashed->shift - 1;
+	    h->elts = m->hashed->elts;
+	    memset(h->table, '\0', i * sizeof(mapslot));
+	    /*
+	     * copy slots from old hashtable to new hashtable
+	     */
+	    for (s = m->hashed->table, i = m->hashed->tablesize; i != 0;
+		 s++, --i) {
+		if (s->elt != 0) {
+		    *map_hadd(h, s->hashval) = *s;
+		}
 	    }
+	    FREE(m->hashed);
+	    m->hashed = h;
+	}
+	if (h->size == h->eltsize) {
+	    /*
+	     * extend element array
+	     */
+	    i = h->eltsize + (h->eltsize >> 1);
+	    h->elts = REALLOC(h->elts, mapelt, h->eltsize, i);
+	    h->eltsize = i;
 	}
-	FREE(m->hashed);
-	m->hashed = h;
     }
-    h->size++;
 
-    e = echunk.alloc();
-    e->hashval = hashval;
-    e->add = FALSE;
+    s = map_hadd(h, hashval);
+    s->elt = ++h->size;
+    s->add = add;
+    e = &h->elts[h->size - 1];
     e->idx = nil_value;
     e->val = nil_value;
-    i = hashval % h->tablesize;
-    e->next = h->table[i];
-    h->table[i] = e;
-
     return e;
 }
 
@@ -1755,12 +1876,13 @@ static mapelt *map_grow(Dataspace *data, Array *m, Uint hashval, bool add)
 Value *map_index(Dataspace *data, Array *m, Value *val, Value *elt,
 		 Value *verify)
 {
-    Uint i;
-    mapelt *e, **p;
+    Uint i, j, dist, mask;
+    maphash *h;
+    mapslot *s;
+    mapelt *e;
+    Value tmp;
     bool del, add, hash;
 
-    i = 0;
-
     if (elt != (Value *) NULL && VAL_NIL(elt)) {
 	elt = (Value *) NULL;
 	del = TRUE;
@@ -1773,40 +1895,20 @@ Value *map_index(Dataspace *data, Array *m, Value *val, Value *elt,
 	map_dehash(data, m, FALSE);
     }
 
-    switch (val->type) {
-    case T_NIL:
-	i = 4747;
-	break;
-
-    case T_INT:
-	i = val->u.number;
-	break;
-
-    case T_FLOAT:
-	i = VFLT_HASH(val);
-	break;
-
-    case T_STRING:
-	i = Hashtab::hashstr(val->u.string->text, STRMAPHASHSZ) ^
-							    val->u.string->len;
-	break;
-
-    case T_OBJECT:
-	i = val->oindex;
-	break;
-
-    case T_ARRAY:
-    case T_MAPPING:
-    case T_LWOBJECT:
-	i = (unsigned short) ((uintptr_t) val->u.array >> 3);
-	break;
-    }
+    i = map_hashval(val);
 
     hash = FALSE;
-    if (m->hashed != (maphash *) NULL) {
-	for (p = &m->hashed->table[i % m->hashed->tablesize];
-	     (e=*p) != (mapelt *) NULL; p = &e->next) {
-	    if (cmp(val, &e->idx) == 0 &&
+    if ((h=m->hashed) != (maphash *) NULL) {
+# ifdef MAPSTATS
+	Hashtab::stats[HS_MAPPING].lookups++;
+# endif
+	mask = h->tablesize - 1;
+	for (j = MHOME(h, i), dist = 0;
+	     h->table[j].elt != 0 && MDIST(h, j) >= dist;
+	     j = (j + 1) & mask, dist++) {
+	    s = &h->table[j];
+	    e = &h->elts[s->elt - 1];
+	    if (s->hashval == i && cmp(val, &e->idx) == 0 &&
 		(!T_INDEXED(val->type) || val->u.array == e->idx.u.array)) {
 		/*
 		 * found in the hashtable
@@ -1822,10 +1924,14 @@ Value *map_index(Dataspace *data, Array *m, Value *val, Value *elt,
 		    if (val->type == T_OBJECT) {
 			e->idx.u.objcnt = val->u.objcnt;	/* refresh */
 		    }
-		    if (e->add) {
+		    if (s->add) {
 			d_assign_elt(data, m, &e->val, elt);
 		    } else {
-			/* "real" assignment later in array part */
+			/*
+			 * "real" assignment later in array part; store the
+			 * value that the array will hold, not a temporary
+			 */
+			elt = d_promote(elt, &tmp);
 			e->val = *elt;
 			break;
 		    }
@@ -1835,18 +1941,16 @@ Value *map_index(Dataspace *data, Array *m, Value *val, Value *elt,
 		    /*
 		     * delete element
 		     */
-		    add = e->add;
+		    add = s->add;
 		    if (add) {
 			d_assign_elt(data, m, &e->idx, &nil_value);
 			d_assign_elt(data, m, &e->val, &nil_value);
-			if (--m->hashed->sizemod == 0) {
+			if (--h->sizemod == 0) {
 			    m->hashmod = FALSE;
 			}
 		    }
 
-		    *p = e->next;
-		    echunk.del(e);
-		    m->hashed->size--;
+		    map_hdel(h, j);
 
 		    if (!add) {
 			break;		/* change array part also */
@@ -1855,6 +1959,11 @@ Value *map_index(Dataspace *data, Array *m, Value *val, Value *elt,
 		}
 		return &e->val;
 	    }
+# ifdef MAPSTATS
+	    if (s->hashval == i) {
+		Hashtab::stats[HS_MAPPING].collisions++;
+	    }
+# endif
 	}
     }
 
@@ -1918,7 +2027,6 @@ Value *map_index(Dataspace *data, Array *m, Value *val, Value *elt,
 	 */
 	e = map_grow(data, m, i, add);
 	if (add) {
-	    e->add = TRUE;
 	    d_assign_elt(data, m, &e->idx, val);
 	    d_assign_elt(data, m, &e->val, elt);
 	    m->hashed->sizemod++;
@@ -2028,7 +2136,7 @@ Array *lwo_new(Dataspace *data, Object *obj)
     o_lwobj(obj);
     ctrl = o_control(obj);
     a = arr_alloc(ctrl->nvariables + 2);
-    a->elts = ALLOC(Value, ctrl->nvariables + 2);
+    a->elts = ALLOC_CAT(Value, ctrl->nvariables + 2, MC_ARRAY);
     PUT_OBJVAL(&a->elts[0], obj);
     flt.high = FALSE;
     flt.low = obj->update;
@@ -2053,7 +2161,7 @@ Array *lwo_copy(Dataspace *data, Array *a)
     Array *copy;
 
     copy = arr_alloc(a->size);
-    i_copy(copy->elts = ALLOC(Value, a->size), a->elts, a->size);
+    i_copy(copy->elts = ALLOC_CAT(Value, a->size, MC_ARRAY), a->elts, a->size);
     copy->tag = tag++;
     copy->odcount = odcount;
     copy->primary = &data->plane->alocal;
@@ -39,8 +39,8 @@
 
 struct user {
     uindex oindex;		/* associated object index */
-    user *prev;			/* preceding user */
-    user *next;			/* next user */
+    user *prev;			/* preceding ready user */
+    user *next;			/* next ready (or free) user */
     user *flush;		/* next in flush list */
     short flags;		/* connection flags */
     char state;			/* telnet state */
@@ -66,6 +66,7 @@ struct user {
 # define CF_OUTPUT	0x0040	/* pending output */
 # define CF_ODONE	0x0080	/* output done */
 # define CF_OPENDING	0x0100	/* waiting for connect() to complete */
+# define CF_READY	0x0200	/* in ready list */
 
 #ifdef NETWORK_EXTENSIONS
 # error network extensions are not currently supported
@@ -83,7 +84,7 @@ struct user {
 # define TS_SE		8
 
 static user *users;		/* array of users */
-static user *lastuser;		/* last user checked */
+static user *lastuser;		/* next ready user to check */
 static user *freeuser;		/* linked list of free users */
 static user *flush;		/* flush list */
 static user *outbound;		/* pending outbound list */
@@ -91,8 +92,7 @@ static int maxusers;		/* max # of users */
 static int maxdgram;		/* max # of datagram users */
 static int ndgram;		/* # of datagram users */
 static int nusers;		/* # of users */
-static int odone;		/* # of users with output done */
-static long newlines;		/* # of newlines in all input buffers */
+static int nready;		/* # of ready users */
 static uindex this_user;	/* current user */
 static int ntport, nbport;	/* # telnet/binary ports */
 static int ndport;		/* # datagram ports */
@@ -127,7 +127,7 @@ bool comm_init(int n, int p, char **thosts, char **bhosts, char **dhosts,
     freeuser = usr;
     lastuser = (user *) NULL;
     flush = outbound = (user *) NULL;
-    nusers = odone = newlines = 0;
+    nusers = nready = 0;
     this_user = OBJ_NONE;
 
     sprintf(ayt, "\15\12[%s]\15\12", VERSION);
@@ -182,6 +182,50 @@ static void addtoflush(user *usr, Array *arr)
     }
 }
 
+/*
+ * NAME:	comm->ready()
+ * DESCRIPTION:	add a user to the ready list, to be checked for input, output
+ *		and state changes
+ */
+static void comm_ready(user *usr)
+{
+    if (!(usr->flags & CF_READY)) {
+	usr->flags |= CF_READY;
+	if (lastuser != (user *) NULL) {
+	    usr->prev = lastuser->prev;
+	    usr->prev->next = usr;
+	    usr->next = lastuser;
+	    lastuser->prev = usr;
+	} else {
+	    usr->prev = usr;
+	    usr->next = usr;
+	    lastuser = usr;
+	}
+	nready++;
+    }
+}
+
+/*
+ * NAME:	comm->unready()
+ * DESCRIPTION:	remove a user from the ready list
+ */
+static void comm_unready(user *usr)
+{
+    if (usr->flags & CF_READY) {
+	usr->flags &= ~CF_READY;
+	if (usr->next == usr) {
+	    lastuser = (user *) NULL;
+	} else {
+	    usr->next->prev = usr->prev;
+	    usr->prev->next = usr->next;
+	    if (usr == lastuser) {
+		lastuser = usr->next;
+	    }
+	}
+	--nready;
+    }
+}
+
 /*
  * NAME:	comm->setup()
  * DESCRIPTION:	setup a user
@@ -242,16 +286,6 @@ static user *comm_new(Frame *f, Object *obj, connection *conn, int flags)
 
     usr = freeuser;
     freeuser = usr->next;
-    if (lastuser != (user *) NULL) {
-	usr->prev = lastuser->prev;
-	usr->prev->next = usr;
-	usr->next = lastuser;
-	lastuser->prev = usr;
-    } else {
-	usr->prev = usr;
-	usr->next = usr;
-	lastuser = usr;
-    }
 
     arr = comm_setup(usr, f, obj);
     usr->conn = conn;
@@ -271,6 +305,10 @@ static user *comm_new(Frame *f, Object *obj, connection *conn, int flags)
 	PUT_STRVAL_NOREF(&val, str_new(init, (long) sizeof(init)));
 	d_assign_elt(obj->data, arr, &arr->elts[1], &val);
     }
+    if (conn != (connection *) NULL) {
+	conn_owner(conn, usr);
+	comm_ready(usr);
+    }
     nusers++;
 
     return usr;
@@ -432,10 +470,7 @@ static int comm_write(user *usr, Object *obj, String *str, char *text,
 	memcpy(str->text + olen, text, len);
     } else {
 	/* create new buffer */
-	if (usr->flags & CF_ODONE) {
-	    usr->flags &= ~CF_ODONE;
-	    --odone;
-	}
+	usr->flags &= ~CF_ODONE;
 	usr->flags |= CF_OUTPUT;
 	if (str == (String *) NULL) {
 	    str = str_new(text, (long) len);
@@ -640,7 +675,7 @@ static void comm_uflush(user *usr, Object *obj, Dataspace *data, Array *arr)
 		    n = 0;
 		    usr->flags &= ~CF_OUTPUT;
 		    usr->flags |= CF_ODONE;
-		    odone++;
+		    comm_ready(usr);
 		    d_assign_elt(data, arr, &v[1], &nil_value);
 		}
 		usr->osdone = n;
@@ -689,6 +724,7 @@ void comm_flush()
 	    if (usr->conn == (connection *) NULL) {
 		fatal("can't connect to server");
 	    }
+	    conn_owner(usr->conn, usr);
 
 	    d_assign_elt(obj->data, arr, &arr->elts[1], &nil_value);
 	    arr_del(arr);
@@ -736,6 +772,10 @@ void comm_flush()
 	if ((v->u.number ^ usr->flags) & CF_BLOCKED) {
 	    usr->flags ^= CF_BLOCKED;
 	    conn_block(usr->conn, ((usr->flags & CF_BLOCKED) != 0));
+	    if (!(usr->flags & CF_BLOCKED) && (usr->flags & CF_TELNET) &&
+		(usr->newlines != 0 || usr->inbufsz == INBUF_SIZE)) {
+		comm_ready(usr);	/* buffered input */
+	    }
 	}
 
 	/*
@@ -760,23 +800,11 @@ void comm_flush()
 		conn_del(usr->conn);
 	    }
 	    if (usr->flags & CF_TELNET) {
-		newlines -= usr->newlines;
 		FREE(usr->inbuf - 1);
 	    }
-	    if (usr->flags & CF_ODONE) {
-		--odone;
-	    }
 
 	    usr->oindex = OBJ_NONE;
-	    if (usr->next == usr) {
-		lastuser = (user *) NULL;
-	    } else {
-		usr->next->prev = usr->prev;
-		usr->prev->next = usr->next;
-		if (usr == lastuser) {
-		    lastuser = usr->next;
-		}
-	    }
+	    comm_unready(usr);
 	    usr->next = freeuser;
 	    freeuser = usr;
 	    if ((usr->flags & (CF_TELNET | CF_UDP | CF_UDPDATA)) == CF_UDPDATA)
@@ -912,11 +940,14 @@ void comm_receive(Frame *f, Uint timeout, unsigned int mtime)
     char *p, *q;
     connection *conn;
 
-    if (newlines != 0 || odone != 0) {
+    if (lastuser != (user *) NULL) {
 	timeout = mtime = 0;
     }
     n = conn_select(timeout, mtime);
-    if ((n <= 0) && (newlines == 0) && (odone == 0)) {
+    while ((usr=(user *) conn_ready()) != (user *) NULL) {
+	comm_ready(usr);
+    }
+    if (n <= 0 && lastuser == (user *) NULL) {
 	/*
 	 * call_out to do, or timeout
 	 */
@@ -996,9 +1027,9 @@ void comm_receive(Frame *f, Uint timeout, unsigned int mtime)
 	    } while (n != nextdport);
 	}
 
-	for (i = nusers; lastuser != (user *) NULL && i > 0; --i) {
+	for (i = nready; lastuser != (user *) NULL && i > 0; --i) {
 	    usr = lastuser;
-	    lastuser = usr->next;
+	    comm_unready(usr);
 
 	    obj = OBJ(usr->oindex);
 
@@ -1061,7 +1092,6 @@ void comm_receive(Frame *f, Uint timeout, unsigned int mtime)
 	    if (usr->flags & CF_ODONE) {
 		/* callback */
 		usr->flags &= ~CF_ODONE;
-		--odone;
 		this_user = obj->index;
 		if (i_call(f, obj, (Array *) NULL, "message_done", 12, TRUE, 0))
 		{
@@ -1125,14 +1155,12 @@ void comm_receive(Frame *f, Uint timeout, unsigned int mtime)
 
 			    case CR:
 				nls++;
-				newlines++;
 				*q++ = LF;
 				state = TS_CRDATA;
 				break;
 
 			    case LF:
 				nls++;
-				newlines++;
 				/* fall through */
 			    default:
 				*q++ = *p;
@@ -1150,7 +1178,6 @@ void comm_receive(Frame *f, Uint timeout, unsigned int mtime)
 
 			    case CR:
 				nls++;
-				newlines++;
 				*q++ = LF;
 				break;
 
@@ -1273,6 +1300,9 @@ void comm_receive(Frame *f, Uint timeout, unsigned int mtime)
 		    usr->newlines = nls;
 		    usr->inbufsz = q - usr->inbuf;
 		    if (nls == 0) {
+			if (usr->inbufsz == INBUF_SIZE) {
+			    comm_ready(usr);	/* handle full buffer */
+			}
 			continue;
 		    }
 
@@ -1280,8 +1310,9 @@ void comm_receive(Frame *f, Uint timeout, unsigned int mtime)
 		     * input terminated by \n
 		     */
 		    p = (char *) memchr(q = usr->inbuf, LF, usr->inbufsz);
-		    usr->newlines--;
-		    --newlines;
+		    if (--usr->newlines != 0) {
+			comm_ready(usr);	/* more lines to handle */
+		    }
 		    n = p - usr->inbuf;
 		    p++;			/* skip \n */
 		    usr->inbufsz -= n + 1;
@@ -1681,30 +1712,18 @@ bool comm_restore(int fd)
 	    /* allocate user */
 	    usr = freeuser;
 	    freeuser = usr->next;
-	    if (lastuser != (user *) NULL) {
-		usr->prev = lastuser->prev;
-		usr->prev->next = usr;
-		usr->next = lastuser;
-		lastuser->prev = usr;
-	    } else {
-		usr->prev = usr;
-		usr->next = usr;
-		lastuser = usr;
-	    }
 	    nusers++;
 
 	    /* initialize user */
 	    usr->oindex = du->oindex;
 	    OBJ(usr->oindex)->etabi = usr - users;
 	    OBJ(usr->oindex)->flags |= O_USER;
-	    usr->flags = du->flags;
-	    if (usr->flags & CF_ODONE) {
-		odone++;
-	    }
+	    usr->flags = du->flags & ~CF_READY;
 	    usr->state = du->state;
 	    usr->newlines = du->newlines;
-	    newlines += usr->newlines;
 	    usr->conn = conn;
+	    conn_owner(conn, usr);
+	    comm_ready(usr);
 	    if (usr->flags & CF_TELNET) {
 		m_static();
 		usr->inbuf = ALLOC(char, INBUF_SIZE + 1);
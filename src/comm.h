@@ -40,6 +40,8 @@ extern bool	   conn_udp	 (connection*, char*, unsigned int);
 extern void	   conn_del	 (connection*);
 extern void	   conn_block	 (connection*, int);
 extern int	   conn_select	 (Uint, unsigned int);
+extern void	   conn_owner	 (connection*, void*);
+extern void	  *conn_ready	 ();
 extern bool	   conn_udpcheck (connection*);
 extern int	   conn_read	 (connection*, char*, unsigned int);
 extern int	   conn_udpread	 (connection*, char*, unsigned int);
@@ -162,6 +162,13 @@ static codechunk *fcode;			/* free code chunk list */
 static unsigned int cchunksz = CODE_CHUNK;	/* code chunk size */
 static Uint here;				/* current offset */
 static char *last_instruction;			/* last instruction's address */
+static Uint fuse;				/* end of fusable local push */
+static Uint intcmp;				/* end of fusable comparison */
+static char *intkf;				/* comparison kfun */
+# ifdef INTSTATS
+static Uint nintops;				/* # specialized operations */
+static Uint narithops;				/* # arithmetic operations */
+# endif
 
 /*
  * NAME:	code->byte()
@@ -213,13 +220,140 @@ static void code_instr(int i, unsigned short line)
     last_instruction = &tcode->code[cchunksz - 1];
 }
 
+/*
+ * NAME:	code->fuse()
+ * DESCRIPTION:	check if the last instruction is a local push that the next
+ *		instruction can be merged into
+ */
+static bool code_fuse(unsigned short newline)
+{
+    if (here != fuse || here == 0 || (newline != 0 && newline != line)) {
+	return FALSE;
+    }
+    fuse = 0;
+    return TRUE;
+}
+
+/*
+ * NAME:	code->intkfun()
+ * DESCRIPTION:	check if a kfun is an integer operation that can be performed
+ *		without a call
+ */
+static bool code_intkfun(int kf)
+{
+    switch (kf) {
+    case KF_ADD_INT:
+    case KF_ADD1_INT:
+    case KF_AND_INT:
+    case KF_DIV_INT:
+    case KF_EQ_INT:
+    case KF_GE_INT:
+    case KF_GT_INT:
+    case KF_LE_INT:
+    case KF_LSHIFT_INT:
+    case KF_LT_INT:
+    case KF_MOD_INT:
+    case KF_MULT_INT:
+    case KF_NE_INT:
+    case KF_NEG_INT:
+    case KF_NOT_INT:
+    case KF_OR_INT:
+    case KF_RSHIFT_INT:
+    case KF_SUB_INT:
+    case KF_SUB1_INT:
+    case KF_TST_INT:
+    case KF_UMIN_INT:
+    case KF_XOR_INT:
+	return TRUE;
+
+    default:
+	return FALSE;
+    }
+}
+
+# ifdef INTSTATS
+/*
+ * NAME:	code->arith()
+ * DESCRIPTION:	check if a kfun is an arithmetic operation
+ */
+static bool code_arith(int kf)
+{
+    switch (kf) {
+    case KF_ADD:
+    case KF_ADD1:
+    case KF_AND:
+    case KF_DIV:
+    case KF_EQ:
+    case KF_GE:
+    case KF_GT:
+    case KF_LE:
+    case KF_LSHIFT:
+    case KF_LT:
+    case KF_MOD:
+    case KF_MULT:
+    case KF_NE:
+    case KF_NEG:
+    case KF_NOT:
+    case KF_OR:
+    case KF_RSHIFT:
+    case KF_SUB:
+    case KF_SUB1:
+    case KF_TST:
+    case KF_UMIN:
+    case KF_XOR:
+    case KF_ADD_FLT:
+    case KF_ADD1_FLT:
+    case KF_DIV_FLT:
+    case KF_EQ_FLT:
+    case KF_GE_FLT:
+    case KF_GT_FLT:
+    case KF_LE_FLT:
+    case KF_LT_FLT:
+    case KF_MULT_FLT:
+    case KF_NE_FLT:
+    case KF_NOT_FLT:
+    case KF_SUB_FLT:
+    case KF_SUB1_FLT:
+    case KF_TST_FLT:
+    case KF_UMIN_FLT:
+	return TRUE;
+
+    default:
+	return code_intkfun(kf);
+    }
+}
+# endif
+
 /*
  * NAME:	code->kfun()
  * DESCRIPTION:	generate code for a builtin kfun
  */
 static void code_kfun(int kf, unsigned short line)
 {
-    if (kf < 256) {
+# ifdef INTSTATS
+    if (code_arith(kf)) {
+	narithops++;
+	if (code_intkfun(kf)) {
+	    nintops++;
+	}
+    }
+# endif
+    if (code_intkfun(kf)) {
+	code_instr(I_INT_KFUNC, line);
+	code_byte(kf);
+	switch (kf) {
+	case KF_EQ_INT:
+	case KF_GE_INT:
+	case KF_GT_INT:
+	case KF_LE_INT:
+	case KF_LT_INT:
+	case KF_NE_INT:
+	    /* may be merged with a following conditional jump */
+	    intcmp = here;
+	    intkf = &tcode->code[cchunksz - 1];
+	    break;
+	}
+    } else if (kf < 256) {
 	code_instr(I_CALL_KFUNC, line);
 	code_byte(kf);
     } else {
@@ -283,7 +417,7 @@ static char *code_make(unsigned short depth, int nlocals, unsigned short *size)
     tcode = (codechunk *) NULL;
     cchunksz = CODE_CHUNK;
 
-    here = 0;
+    here = fuse = intcmp = 0;
     return code;
 }
 
@@ -388,6 +522,9 @@ static jmplist *jump(int i, jmplist *list)
  */
 static void jump_resolve(jmplist *list, Uint to)
 {
+    if (to == here) {
+	fuse = intcmp = 0;	/* no merging across a jump target */
+    }
     while (list != (jmplist *) NULL) {
 	list->to = to;
 	list = list->next;
@@ -1192,7 +1329,12 @@ static void cg_expr(node *n, int pop)
 
     case N_INT:
 	if (n->l.number >= -128 && n->l.number <= 127) {
-	    code_instr(I_PUSH_INT1, n->line);
+	    if (!pop && code_fuse(n->line)) {
+		*last_instruction = (*last_instruction & I_LINE_MASK) |
+				    I_PUSH_LOCAL_INT1;
+	    } else {
+		code_instr(I_PUSH_INT1, n->line);
+	    }
 	    code_byte((int) n->l.number);
 	} else {
 	    code_instr(I_PUSH_INT4, n->line);
@@ -1243,8 +1385,17 @@ static void cg_expr(node *n, int pop)
 	break;
 
     case N_LOCAL:
-	code_instr(I_PUSH_LOCAL, n->line);
-	code_byte(nparams - (int) n->r.number - 1);
+	if (!pop && code_fuse(n->line)) {
+	    *last_instruction = (*last_instruction & I_LINE_MASK) |
+				I_PUSH_LOCAL2;
+	    code_byte(nparams - (int) n->r.number - 1);
+	} else {
+	    code_instr(I_PUSH_LOCAL, n->line);
+	    code_byte(nparams - (int) n->r.number - 1);
+	    if (!pop) {
+		fuse = here;
+	    }
+	}
 	break;
 
     case N_LOR:
@@ -1738,6 +1889,12 @@ static void cg_expr(node *n, int pop)
     }
 
     if (pop) {
+	if ((*last_instruction & I_INSTR_MASK) == I_INT_KFUNC) {
+	    /* no pop variant, use the kfun call instead */
+	    *last_instruction = (*last_instruction & I_LINE_MASK) |
+				I_CALL_KFUNC;
+	    intcmp = 0;
+	}
 	*last_instruction |= I_POP_BIT;
     }
 }
@@ -1807,7 +1964,26 @@ static void cg_cond(node *n, int jmptrue)
 
 	default:
 	    cg_expr(n, FALSE);
-	    if (jmptrue) {
+	    if (here == intcmp && here != 0) {
+		/* merge integer comparison and conditional jump */
+		if (!jmptrue) {
+		    switch (*intkf) {
+		    case KF_EQ_INT:	*intkf = KF_NE_INT; break;
+		    case KF_GE_INT:	*intkf = KF_LT_INT; break;
+		    case KF_GT_INT:	*intkf = KF_LE_INT; break;
+		    case KF_LE_INT:	*intkf = KF_GT_INT; break;
+		    case KF_LT_INT:	*intkf = KF_GE_INT; break;
+		    case KF_NE_INT:	*intkf = KF_EQ_INT; break;
+		    }
+		}
+		*intkf |= I_INT_JUMP;
+		intcmp = 0;
+		if (jmptrue) {
+		    true_list = jump_addr(true_list);
+		} else {
+		    false_list = jump_addr(false_list);
+		}
+	    } else if (jmptrue) {
 		true_list = jump(I_JUMP_NONZERO, true_list);
 	    } else {
 		false_list = jump(I_JUMP_ZERO, false_list);
@@ -1825,6 +2001,34 @@ struct case_label {
 
 static case_label *switch_table;	/* label table for current switch */
 
+# define SWITCH_DENSE	4		/* min # of labels for a jump table */
+# define SWITCH_HASHED	8		/* min # of labels for a hash table */
+
+/*
+ * NAME:	codegen->switch_value()
+ * DESCRIPTION:	generate a case label value of sz bytes
+ */
+static void cg_switch_value(Int l, int sz)
+{
+    switch (sz) {
+    case 4:
+	code_word((int) (l >> 16));
+	/* fall through */
+    case 2:
+	code_word((int) l);
+	break;
+
+    case 3:
+	code_byte((int) (l >> 16));
+	code_word((int) l);
+	break;
+
+    case 1:
+	code_byte((int) l);
+	break;
+    }
+}
+
 /*
  * NAME:	codegen->switch_start()
  * DESCRIPTION:	generate code for the start of a switch statement
@@ -1885,26 +2089,7 @@ static void cg_switch_int(node *n)
     switch_table[0].jump = jump_addr((jmplist *) NULL);
     i = 1;
     do {
-	Int l;
-
-	l = m->l.left->l.number;
-	switch (sz) {
-	case 4:
-	    code_word((int) (l >> 16));
-	    /* fall through */
-	case 2:
-	    code_word((int) l);
-	    break;
-
-	case 3:
-	    code_byte((int) (l >> 16));
-	    code_word((int) l);
-	    break;
-
-	case 1:
-	    code_byte((int) l);
-	    break;
-	}
+	cg_switch_value(m->l.left->l.number, sz);
 	switch_table[i++].jump = jump_addr((jmplist *) NULL);
 	m = m->r.right;
     } while (i < size);
@@ -1958,47 +2143,122 @@ static void cg_switch_range(node *n)
     switch_table[0].jump = jump_addr((jmplist *) NULL);
     i = 1;
     do {
-	Int l;
+	cg_switch_value(m->l.left->l.number, sz);
+	cg_switch_value(m->l.left->r.number, sz);
+	switch_table[i++].jump = jump_addr((jmplist *) NULL);
+	m = m->r.right;
+    } while (i < size);
 
-	l = m->l.left->l.number;
-	switch (sz) {
-	case 4:
-	    code_word((int) (l >> 16));
-	    /* fall through */
-	case 2:
-	    code_word((int) l);
-	    break;
+    /*
+     * generate code for body
+     */
+    cg_stmt(n->r.right->r.right);
 
-	case 3:
-	    code_byte((int) (l >> 16));
-	    code_word((int) l);
-	    break;
+    /*
+     * resolve jumps
+     */
+    if (size > n->mod) {
+	/* default: across switch */
+	switch_table[0].where = here;
+    }
+    for (i = 0; i < size; i++) {
+	jump_resolve(switch_table[i].jump, switch_table[i].where);
+    }
+    AFREE(switch_table);
+    switch_table = table;
+}
 
-	case 1:
-	    code_byte((int) l);
-	    break;
-	}
-	l = m->l.left->r.number;
-	switch (sz) {
-	case 4:
-	    code_word((int) (l >> 16));
-	    /* fall through */
-	case 2:
-	    code_word((int) l);
-	    break;
+/*
+ * NAME:	codegen->switch_dense()
+ * DESCRIPTION:	check if the labels of an int or range switch statement are
+ *		dense enough to use a jump table
+ */
+static bool cg_switch_dense(node *n)
+{
+    node *m;
+    int size;
+    Int low, high;
 
-	case 3:
-	    code_byte((int) (l >> 16));
-	    code_word((int) l);
-	    break;
+    m = n->l.left;
+    size = n->mod;
+    if (m->l.left == (node *) NULL) {
+	/* explicit default */
+	m = m->r.right;
+	--size;
+    }
+    if (size < SWITCH_DENSE) {
+	return FALSE;
+    }
 
-	case 1:
-	    code_byte((int) l);
+    low = m->l.left->l.number;
+    while (m->r.right != (node *) NULL) {
+	m = m->r.right;
+    }
+    high = (n->type == N_SWITCH_RANGE) ?
+	    m->l.left->r.number : m->l.left->l.number;
+
+    /* the number of values in the table must fit in a word */
+    return ((Uint) high - (Uint) low < (Uint) size * 2 &&
+	    (Uint) high - (Uint) low < 0xffff);
+}
+
+/*
+ * NAME:	codegen->switch_table()
+ * DESCRIPTION:	generate jump table code for an int or range switch statement
+ */
+static void cg_switch_table(node *n)
+{
+    node *m, *last;
+    int i, size, sz;
+    Int l, low, high;
+    bool range;
+    case_label *table;
+
+    cg_switch_start(n);
+    code_byte(SWITCH_TABLE);
+    m = n->l.left;
+    size = n->mod;
+    sz = n->r.right->mod;
+    if (m->l.left == (node *) NULL) {
+	/* explicit default */
+	m = m->r.right;
+    } else {
+	/* implicit default */
+	size++;
+    }
+    range = (n->type == N_SWITCH_RANGE);
+    for (last = m; last->r.right != (node *) NULL; last = last->r.right) ;
+    low = m->l.left->l.number;
+    high = (range) ? last->l.left->r.number : last->l.left->l.number;
+    code_word((int) ((Uint) high - (Uint) low + 1));
+    code_byte(sz);
+
+    table = switch_table;
+    switch_table = ALLOCA(case_label, size);
+    for (i = 0; i < size; i++) {
+	switch_table[i].jump = (jmplist *) NULL;
+    }
+    switch_table[0].jump = jump_addr((jmplist *) NULL);
+    cg_switch_value(low, sz);
+
+    /*
+     * one entry for each value from low to high, holes jump to default
+     */
+    i = 1;
+    for (l = low; ; l++) {
+	if (l < m->l.left->l.number) {
+	    switch_table[0].jump = jump_addr(switch_table[0].jump);
+	} else {
+	    switch_table[i].jump = jump_addr(switch_table[i].jump);
+	    if (l == ((range) ? m->l.left->r.number : m->l.left->l.number)) {
+		m = m->r.right;
+		i++;
+	    }
+	}
+	if (l == high) {
 	    break;
 	}
-	switch_table[i++].jump = jump_addr((jmplist *) NULL);
-	m = m->r.right;
-    } while (i < size);
+    }
 
     /*
      * generate code for body
@@ -2019,6 +2279,37 @@ static void cg_switch_range(node *n)
     switch_table = table;
 }
 
+/*
+ * NAME:	codegen->switch_hash()
+ * DESCRIPTION:	generate the hash table for a string switch statement
+ */
+static void cg_switch_hash(node *m, int size)
+{
+    unsigned short *buckets;
+    Uint hsize, h;
+    String *str;
+    int i;
+
+    for (hsize = 4; hsize < (Uint) size * 2; hsize <<= 1) ;
+    buckets = ALLOCA(unsigned short, hsize);
+    memset(buckets, '\0', hsize * sizeof(unsigned short));
+    for (i = 1; i <= size; i++) {
+	str = m->l.left->l.string;
+	h = Hashtab::hashswitch(str->text, str->len) & (hsize - 1);
+	while (buckets[h] != 0) {
+	    h = (h + 1) & (hsize - 1);	/* linear probing */
+	}
+	buckets[h] = i;
+	m = m->r.right;
+    }
+
+    code_word(hsize);
+    for (h = 0; h < hsize; h++) {
+	code_word(buckets[h]);
+    }
+    AFREE(buckets);
+}
+
 /*
  * NAME:	codegen->switch_str()
  * DESCRIPTION:	generate code for a string switch statement
@@ -2027,10 +2318,10 @@ static void cg_switch_str(node *n)
 {
     node *m;
     int i, size;
+    bool hash;
     case_label *table;
 
     cg_switch_start(n);
-    code_byte(SWITCH_STRING);
     m = n->l.left;
     size = n->mod;
     if (m->l.left == (node *) NULL) {
@@ -2040,6 +2331,8 @@ static void cg_switch_str(node *n)
 	/* implicit default */
 	size++;
     }
+    hash = (size > SWITCH_HASHED && size <= 0x4000);
+    code_byte((hash) ? SWITCH_HASH : SWITCH_STRING);
     code_word(size);
 
     table = switch_table;
@@ -2057,6 +2350,9 @@ static void cg_switch_str(node *n)
 	/* no 0 case */
 	code_byte(1);
     }
+    if (hash) {
+	cg_switch_hash(m, size - i);
+    }
     while (i < size) {
 	Int l;
 
@@ -2104,6 +2400,7 @@ static void cg_stmt(node *n)
 	    m = n;
 	    n = (node *) NULL;
 	}
+	fuse = intcmp = 0;	/* statements may be jumped to */
 	switch (m->type) {
 	case N_BLOCK:
 	    if (m->mod == N_BREAK) {
@@ -2304,11 +2601,19 @@ static void cg_stmt(node *n)
 	    break;
 
 	case N_SWITCH_INT:
-	    cg_switch_int(m);
+	    if (cg_switch_dense(m)) {
+		cg_switch_table(m);
+	    } else {
+		cg_switch_int(m);
+	    }
 	    break;
 
 	case N_SWITCH_RANGE:
-	    cg_switch_range(m);
+	    if (cg_switch_dense(m)) {
+		cg_switch_table(m);
+	    } else {
+		cg_switch_range(m);
+	    }
 	    break;
 
 	case N_SWITCH_STR:
@@ -2332,6 +2637,9 @@ void cg_init(int inherited)
     kd_allocate_int = ((Int) KFCALL << 24) | kf_func("allocate_int");
     kd_allocate_float = ((Int) KFCALL << 24) | kf_func("allocate_float");
     nfuncs = 0;
+# ifdef INTSTATS
+    nintops = narithops = 0;
+# endif
 }
 
 /*
@@ -2363,6 +2671,18 @@ int cg_nfuncs()
     return nfuncs;
 }
 
+# ifdef INTSTATS
+/*
+ * NAME:	codegen->intstats()
+ * DESCRIPTION:	report how many arithmetic operations were specialized
+ */
+void cg_intstats(const char *file)
+{
+    message("/%s: %lu of %lu arithmetic operations specialized\012", file,
+	    (unsigned long) nintops, (unsigned long) narithops);
+}
+# endif
+
 /*
  * NAME:	codegen->clear()
  * DESCRIPTION:	clean up code generator
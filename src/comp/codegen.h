@@ -21,4 +21,7 @@ extern void  cg_init		(int);
 extern char *cg_function	(String*, node*, int, int, unsigned int,
 				   unsigned short*);
 extern int   cg_nfuncs		();
+# ifdef INTSTATS
+extern void  cg_intstats	(const char*);
+# endif
 extern void  cg_clear		();
@@ -597,6 +597,9 @@ Object *c_compile(Frame *f, char *file, Object *obj, String **strs,
 		/*
 		 * successfully compiled
 		 */
+# ifdef INTSTATS
+		cg_intstats(file_c);
+# endif
 		break;
 
 	    } else if (nerrors == 0) {
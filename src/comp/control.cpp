@@ -940,7 +940,7 @@ void ctrl_convert(Control *ctrl)
 	}
 	imapsz += o_control(obj)->ninherits;
     }
-    ctrl->imap = ALLOC(char, ctrl->imapsz = imapsz);
+    ctrl->imap = ALLOC_CAT(char, ctrl->imapsz = imapsz, MC_CONTROL);
     imapsz = 0;
     for (n = ctrl->ninherits, inh = ctrl->inherits; n > 0; --n, inh++) {
 	ctrl->imap[imapsz++] = n;
@@ -973,8 +973,9 @@ void ctrl_create()
     newctrl = d_new_control();
     newctrl->flags |= CTRL_VM_2_1;
     inh = newctrl->inherits =
-	  ALLOC(dinherit, newctrl->ninherits = ninherits + 1);
-    newctrl->imap = ALLOC(char, (ninherits + 2) * (ninherits + 1) / 2);
+	  ALLOC_CAT(dinherit, newctrl->ninherits = ninherits + 1, MC_CONTROL);
+    newctrl->imap = ALLOC_CAT(char, (ninherits + 2) * (ninherits + 1) / 2,
+			      MC_CONTROL);
     nvars = 0;
     str_merge();
 
@@ -1647,7 +1648,7 @@ static void ctrl_mkstrings()
 
     strsize = 0;
     if ((newctrl->nstrings = nstrs) != 0) {
-	newctrl->strings = ALLOC(String*, newctrl->nstrings);
+	newctrl->strings = ALLOC_CAT(String*, newctrl->nstrings, MC_CONTROL);
 	strsize = schunk.mkstrings(newctrl->strings + nstrs);
     }
     newctrl->strsize = strsize;
@@ -1667,8 +1668,8 @@ static void ctrl_mkfuncs()
 
     newctrl->progsize = progsize;
     if ((newctrl->nfuncdefs = nfdefs) != 0) {
-	p = newctrl->prog = ALLOC(char, progsize);
-	d = newctrl->funcdefs = ALLOC(dfuncdef, nfdefs);
+	p = newctrl->prog = ALLOC_CAT(char, progsize, MC_CONTROL);
+	d = newctrl->funcdefs = ALLOC_CAT(dfuncdef, nfdefs, MC_CONTROL);
 	f = functions;
 	for (i = nfdefs; i > 0; --i) {
 	    *d = f->func;
@@ -1693,20 +1694,21 @@ static void ctrl_mkfuncs()
 static void ctrl_mkvars()
 {
     if ((newctrl->nvardefs = nvars) != 0) {
-	newctrl->vardefs = ALLOC(dvardef, nvars);
+	newctrl->vardefs = ALLOC_CAT(dvardef, nvars, MC_CONTROL);
 	memcpy(newctrl->vardefs, variables, nvars * sizeof(dvardef));
 	if ((newctrl->nclassvars = nclassvars) != 0) {
 	    unsigned short i;
 	    String **s;
 
-	    newctrl->cvstrings = ALLOC(String*, nvars * sizeof(String*));
+	    newctrl->cvstrings = ALLOC_CAT(String*, nvars * sizeof(String*),
+					   MC_CONTROL);
 	    memcpy(newctrl->cvstrings, cvstrings, nvars * sizeof(String*));
 	    for (i = nvars, s = newctrl->cvstrings; i != 0; --i, s++) {
 		if (*s != (String *) NULL) {
 		    str_ref(*s);
 		}
 	    }
-	    newctrl->classvars = ALLOC(char, nclassvars * 3);
+	    newctrl->classvars = ALLOC_CAT(char, nclassvars * 3, MC_CONTROL);
 	    memcpy(newctrl->classvars, classvars, nclassvars * 3);
 	}
     }
@@ -1728,7 +1730,8 @@ static void ctrl_mkfcalls()
     if (newctrl->nfuncalls == 0) {
 	return;
     }
-    fc = newctrl->funcalls = ALLOC(char, 2L * newctrl->nfuncalls);
+    fc = newctrl->funcalls = ALLOC_CAT(char, 2L * newctrl->nfuncalls,
+				       MC_CONTROL);
     for (i = 0, inh = newctrl->inherits; i < ninherits; i++, inh++) {
 	/*
 	 * Walk through the list of inherited objects, starting with the auto
@@ -1809,7 +1812,7 @@ static void ctrl_mksymbs()
     }
 
     /* initialize */
-    symtab = newctrl->symbols = ALLOC(dsymbol, nsymbs);
+    symtab = newctrl->symbols = ALLOC_CAT(dsymbol, nsymbs, MC_CONTROL);
     for (i = 0; i < nsymbs; i++) {
 	symtab->next = i;	/* mark as unused */
 	symtab++;
@@ -1923,7 +1926,7 @@ void ctrl_mkvtypes(Control *ctrl)
 	return;
     }
 
-    ctrl->vtypes = type = ALLOC(char, max);
+    ctrl->vtypes = type = ALLOC_CAT(char, max, MC_CONTROL);
     for (nv = 0, inh = ctrl->inherits; nv != max; inh++) {
 	if (inh->varoffset == nv) {
 	    ctrl = o_control(OBJR(inh->oindex));
@@ -2096,7 +2099,7 @@ unsigned short *ctrl_varmap(Control *octrl, Control *nctrl)
      * make variable mapping from old to new, with new just compiled
      */
 
-    vmap = ALLOC(unsigned short, nctrl->nvariables + 1);
+    vmap = ALLOC_CAT(unsigned short, nctrl->nvariables + 1, MC_CONTROL);
 
     voffset = 0;
     for (i = nctrl->ninherits, inh = nctrl->inherits; i > 0; --i, inh++) {
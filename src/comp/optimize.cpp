@@ -202,7 +202,8 @@ static Uint opt_binconst(node **m)
 	    if (n->r.right->l.number == 0) {
 		return 2;	/* runtime error: division by 0 */
 	    }
-	    n->l.left->l.number /= n->r.right->l.number;
+	    n->l.left->l.number = INT_DIV(n->l.left->l.number,
+					  n->r.right->l.number);
 	    break;
 
 	case N_EQ_INT:
@@ -242,7 +243,8 @@ static Uint opt_binconst(node **m)
 	    if (n->r.right->l.number == 0) {
 		return 2;	/* runtime error: % 0 */
 	    }
-	    n->l.left->l.number %= n->r.right->l.number;
+	    n->l.left->l.number = INT_MOD(n->l.left->l.number,
+					  n->r.right->l.number);
 	    break;
 
 	case N_MULT_INT:
@@ -0,0 +1,4469 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison implementation for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* C LALR(1) parser skeleton written by Richard Stallman, by
+   simplifying the original so-called "semantic" parser.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+/* All symbols defined below should begin with yy or YY, to avoid
+   infringing on user name space.  This should be done even for local
+   variables, as they might otherwise be expanded by user macros.
+   There are some unavoidable exceptions within include files to
+   define necessary library symbols; they are noted "INFRINGES ON
+   USER NAME SPACE" below.  */
+
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
+
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
+
+/* Skeleton name.  */
+#define YYSKELETON_NAME "yacc.c"
+
+/* Pure parsers.  */
+#define YYPURE 0
+
+/* Push parsers.  */
+#define YYPUSH 0
+
+/* Pull parsers.  */
+#define YYPULL 1
+
+
+
+
+/* First part of user prologue.  */
+#line 26 "parser.y"
+
+
+# define INCLUDE_CTYPE
+# include "comp.h"
+# include "str.h"
+# include "array.h"
+# include "object.h"
+# include "xfloat.h"
+# include "interpret.h"
+# include "macro.h"
+# include "token.h"
+# include "ppcontrol.h"
+# include "node.h"
+# include "compile.h"
+
+# define yylex		pp_gettok
+# define yyerror	c_error
+
+int nerrors;			/* number of errors encountered so far */
+static int ndeclarations;	/* number of declarations */
+static int nstatements;		/* number of statements in current function */
+static bool typechecking;	/* does the current function have it? */
+
+static void  t_void	(node*);
+static bool  t_unary	(node*, const char*);
+static node *prefix	(int, node*, const char*);
+static node *postfix	(int, node*, const char*);
+static node *cast	(node*, node*);
+static node *idx	(node*, node*);
+static node *range	(node*, node*, node*);
+static node *bini	(int, node*, node*, const char*);
+static node *bina	(int, node*, node*, const char*);
+static node *mult	(int, node*, node*, const char*);
+static node *mdiv	(int, node*, node*, const char*);
+static node *mod	(int, node*, node*, const char*);
+static node *add	(int, node*, node*, const char*);
+static node *sub	(int, node*, node*, const char*);
+static node *umin	(node*);
+static node *lshift	(int, node*, node*, const char*);
+static node *rshift	(int, node*, node*, const char*);
+static node *rel	(int, node*, node*, const char*);
+static node *eq		(node*, node*);
+static node *_and	(int, node*, node*, const char*);
+static node *_xor	(int, node*, node*, const char*);
+static node *_or	(int, node*, node*, const char*);
+static node *land	(node*, node*);
+static node *lor	(node*, node*);
+static node *quest	(node*, node*, node*);
+static node *assign	(node*, node*);
+static node *comma	(node*, node*);
+
+
+#line 124 "y.tab.c"
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
+
+/* Use api.header.include to #include this header
+   instead of duplicating it here.  */
+#ifndef YY_YY_Y_TAB_H_INCLUDED
+# define YY_YY_Y_TAB_H_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+#if YYDEBUG
+extern int yydebug;
+#endif
+
+/* Token kinds.  */
+#ifndef YYTOKENTYPE
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    VOID = 258,                    /* VOID  */
+    INHERIT = 259,                 /* INHERIT  */
+    MAPPING = 260,                 /* MAPPING  */
+    BREAK = 261,                   /* BREAK  */
+    ELSE = 262,                    /* ELSE  */
+    CASE = 263,                    /* CASE  */
+    NIL = 264,                     /* NIL  */
+    FOR = 265,                     /* FOR  */
+    STATIC = 266,                  /* STATIC  */
+    CONTINUE = 267,                /* CONTINUE  */
+    PRIVATE = 268,                 /* PRIVATE  */
+    FUNCTION = 269,                /* FUNCTION  */
+    RLIMITS = 270,                 /* RLIMITS  */
+    RETURN = 271,                  /* RETURN  */
+    OPERATOR = 272,                /* OPERATOR  */
+    FLOAT = 273,                   /* FLOAT  */
+    DO = 274,                      /* DO  */
+    IF = 275,                      /* IF  */
+    OBJECT = 276,                  /* OBJECT  */
+    GOTO = 277,                    /* GOTO  */
+    STRING = 278,                  /* STRING  */
+    WHILE = 279,                   /* WHILE  */
+    NEW = 280,                     /* NEW  */
+    VARARGS = 281,                 /* VARARGS  */
+    CATCH = 282,                   /* CATCH  */
+    SWITCH = 283,                  /* SWITCH  */
+    NOMASK = 284,                  /* NOMASK  */
+    ATOMIC = 285,                  /* ATOMIC  */
+    INT = 286,                     /* INT  */
+    DEFAULT = 287,                 /* DEFAULT  */
+    MIXED = 288,                   /* MIXED  */
+    LARROW = 289,                  /* LARROW  */
+    RARROW = 290,                  /* RARROW  */
+    PLUS_PLUS = 291,               /* PLUS_PLUS  */
+    MIN_MIN = 292,                 /* MIN_MIN  */
+    LSHIFT = 293,                  /* LSHIFT  */
+    RSHIFT = 294,                  /* RSHIFT  */
+    LE = 295,                      /* LE  */
+    GE = 296,                      /* GE  */
+    EQ = 297,                      /* EQ  */
+    NE = 298,                      /* NE  */
+    LAND = 299,                    /* LAND  */
+    LOR = 300,                     /* LOR  */
+    PLUS_EQ = 301,                 /* PLUS_EQ  */
+    MIN_EQ = 302,                  /* MIN_EQ  */
+    MULT_EQ = 303,                 /* MULT_EQ  */
+    DIV_EQ = 304,                  /* DIV_EQ  */
+    MOD_EQ = 305,                  /* MOD_EQ  */
+    LSHIFT_EQ = 306,               /* LSHIFT_EQ  */
+    RSHIFT_EQ = 307,               /* RSHIFT_EQ  */
+    AND_EQ = 308,                  /* AND_EQ  */
+    XOR_EQ = 309,                  /* XOR_EQ  */
+    OR_EQ = 310,                   /* OR_EQ  */
+    COLON_COLON = 311,             /* COLON_COLON  */
+    DOT_DOT = 312,                 /* DOT_DOT  */
+    ELLIPSIS = 313,                /* ELLIPSIS  */
+    STRING_CONST = 314,            /* STRING_CONST  */
+    IDENTIFIER = 315,              /* IDENTIFIER  */
+    INT_CONST = 316,               /* INT_CONST  */
+    FLOAT_CONST = 317,             /* FLOAT_CONST  */
+    MARK = 318,                    /* MARK  */
+    HASH = 319,                    /* HASH  */
+    HASH_HASH = 320,               /* HASH_HASH  */
+    INCL_CONST = 321,              /* INCL_CONST  */
+    NR_TOKENS = 322                /* NR_TOKENS  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
+#endif
+/* Token kinds.  */
+#define YYEMPTY -2
+#define YYEOF 0
+#define YYerror 256
+#define YYUNDEF 257
+#define VOID 258
+#define INHERIT 259
+#define MAPPING 260
+#define BREAK 261
+#define ELSE 262
+#define CASE 263
+#define NIL 264
+#define FOR 265
+#define STATIC 266
+#define CONTINUE 267
+#define PRIVATE 268
+#define FUNCTION 269
+#define RLIMITS 270
+#define RETURN 271
+#define OPERATOR 272
+#define FLOAT 273
+#define DO 274
+#define IF 275
+#define OBJECT 276
+#define GOTO 277
+#define STRING 278
+#define WHILE 279
+#define NEW 280
+#define VARARGS 281
+#define CATCH 282
+#define SWITCH 283
+#define NOMASK 284
+#define ATOMIC 285
+#define INT 286
+#define DEFAULT 287
+#define MIXED 288
+#define LARROW 289
+#define RARROW 290
+#define PLUS_PLUS 291
+#define MIN_MIN 292
+#define LSHIFT 293
+#define RSHIFT 294
+#define LE 295
+#define GE 296
+#define EQ 297
+#define NE 298
+#define LAND 299
+#define LOR 300
+#define PLUS_EQ 301
+#define MIN_EQ 302
+#define MULT_EQ 303
+#define DIV_EQ 304
+#define MOD_EQ 305
+#define LSHIFT_EQ 306
+#define RSHIFT_EQ 307
+#define AND_EQ 308
+#define XOR_EQ 309
+#define OR_EQ 310
+#define COLON_COLON 311
+#define DOT_DOT 312
+#define ELLIPSIS 313
+#define STRING_CONST 314
+#define IDENTIFIER 315
+#define INT_CONST 316
+#define FLOAT_CONST 317
+#define MARK 318
+#define HASH 319
+#define HASH_HASH 320
+#define INCL_CONST 321
+#define NR_TOKENS 322
+
+/* Value type.  */
+#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
+union YYSTYPE
+{
+#line 94 "parser.y"
+
+    Int number;			/* lex input */
+    Float real;			/* lex input */
+    unsigned short type;	/* internal */
+    struct node *node;		/* internal */
+
+#line 318 "y.tab.c"
+
+};
+typedef union YYSTYPE YYSTYPE;
+# define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
+#endif
+
+
+extern YYSTYPE yylval;
+
+
+int yyparse (void);
+
+
+#endif /* !YY_YY_Y_TAB_H_INCLUDED  */
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_VOID = 3,                       /* VOID  */
+  YYSYMBOL_INHERIT = 4,                    /* INHERIT  */
+  YYSYMBOL_MAPPING = 5,                    /* MAPPING  */
+  YYSYMBOL_BREAK = 6,                      /* BREAK  */
+  YYSYMBOL_ELSE = 7,                       /* ELSE  */
+  YYSYMBOL_CASE = 8,                       /* CASE  */
+  YYSYMBOL_NIL = 9,                        /* NIL  */
+  YYSYMBOL_FOR = 10,                       /* FOR  */
+  YYSYMBOL_STATIC = 11,                    /* STATIC  */
+  YYSYMBOL_CONTINUE = 12,                  /* CONTINUE  */
+  YYSYMBOL_PRIVATE = 13,                   /* PRIVATE  */
+  YYSYMBOL_FUNCTION = 14,                  /* FUNCTION  */
+  YYSYMBOL_RLIMITS = 15,                   /* RLIMITS  */
+  YYSYMBOL_RETURN = 16,                    /* RETURN  */
+  YYSYMBOL_OPERATOR = 17,                  /* OPERATOR  */
+  YYSYMBOL_FLOAT = 18,                     /* FLOAT  */
+  YYSYMBOL_DO = 19,                        /* DO  */
+  YYSYMBOL_IF = 20,                        /* IF  */
+  YYSYMBOL_OBJECT = 21,                    /* OBJECT  */
+  YYSYMBOL_GOTO = 22,                      /* GOTO  */
+  YYSYMBOL_STRING = 23,                    /* STRING  */
+  YYSYMBOL_WHILE = 24,                     /* WHILE  */
+  YYSYMBOL_NEW = 25,                       /* NEW  */
+  YYSYMBOL_VARARGS = 26,                   /* VARARGS  */
+  YYSYMBOL_CATCH = 27,                     /* CATCH  */
+  YYSYMBOL_SWITCH = 28,                    /* SWITCH  */
+  YYSYMBOL_NOMASK = 29,                    /* NOMASK  */
+  YYSYMBOL_ATOMIC = 30,                    /* ATOMIC  */
+  YYSYMBOL_INT = 31,                       /* INT  */
+  YYSYMBOL_DEFAULT = 32,                   /* DEFAULT  */
+  YYSYMBOL_MIXED = 33,                     /* MIXED  */
+  YYSYMBOL_LARROW = 34,                    /* LARROW  */
+  YYSYMBOL_RARROW = 35,                    /* RARROW  */
+  YYSYMBOL_PLUS_PLUS = 36,                 /* PLUS_PLUS  */
+  YYSYMBOL_MIN_MIN = 37,                   /* MIN_MIN  */
+  YYSYMBOL_LSHIFT = 38,                    /* LSHIFT  */
+  YYSYMBOL_RSHIFT = 39,                    /* RSHIFT  */
+  YYSYMBOL_LE = 40,                        /* LE  */
+  YYSYMBOL_GE = 41,                        /* GE  */
+  YYSYMBOL_EQ = 42,                        /* EQ  */
+  YYSYMBOL_NE = 43,                        /* NE  */
+  YYSYMBOL_LAND = 44,                      /* LAND  */
+  YYSYMBOL_LOR = 45,                       /* LOR  */
+  YYSYMBOL_PLUS_EQ = 46,                   /* PLUS_EQ  */
+  YYSYMBOL_MIN_EQ = 47,                    /* MIN_EQ  */
+  YYSYMBOL_MULT_EQ = 48,                   /* MULT_EQ  */
+  YYSYMBOL_DIV_EQ = 49,                    /* DIV_EQ  */
+  YYSYMBOL_MOD_EQ = 50,                    /* MOD_EQ  */
+  YYSYMBOL_LSHIFT_EQ = 51,                 /* LSHIFT_EQ  */
+  YYSYMBOL_RSHIFT_EQ = 52,                 /* RSHIFT_EQ  */
+  YYSYMBOL_AND_EQ = 53,                    /* AND_EQ  */
+  YYSYMBOL_XOR_EQ = 54,                    /* XOR_EQ  */
+  YYSYMBOL_OR_EQ = 55,                     /* OR_EQ  */
+  YYSYMBOL_COLON_COLON = 56,               /* COLON_COLON  */
+  YYSYMBOL_DOT_DOT = 57,                   /* DOT_DOT  */
+  YYSYMBOL_ELLIPSIS = 58,                  /* ELLIPSIS  */
+  YYSYMBOL_STRING_CONST = 59,              /* STRING_CONST  */
+  YYSYMBOL_IDENTIFIER = 60,                /* IDENTIFIER  */
+  YYSYMBOL_INT_CONST = 61,                 /* INT_CONST  */
+  YYSYMBOL_FLOAT_CONST = 62,               /* FLOAT_CONST  */
+  YYSYMBOL_MARK = 63,                      /* MARK  */
+  YYSYMBOL_HASH = 64,                      /* HASH  */
+  YYSYMBOL_HASH_HASH = 65,                 /* HASH_HASH  */
+  YYSYMBOL_INCL_CONST = 66,                /* INCL_CONST  */
+  YYSYMBOL_NR_TOKENS = 67,                 /* NR_TOKENS  */
+  YYSYMBOL_68_ = 68,                       /* ';'  */
+  YYSYMBOL_69_ = 69,                       /* '+'  */
+  YYSYMBOL_70_ = 70,                       /* '('  */
+  YYSYMBOL_71_ = 71,                       /* ')'  */
+  YYSYMBOL_72_ = 72,                       /* ','  */
+  YYSYMBOL_73_ = 73,                       /* '*'  */
+  YYSYMBOL_74_ = 74,                       /* '-'  */
+  YYSYMBOL_75_ = 75,                       /* '/'  */
+  YYSYMBOL_76_ = 76,                       /* '%'  */
+  YYSYMBOL_77_ = 77,                       /* '&'  */
+  YYSYMBOL_78_ = 78,                       /* '^'  */
+  YYSYMBOL_79_ = 79,                       /* '|'  */
+  YYSYMBOL_80_ = 80,                       /* '<'  */
+  YYSYMBOL_81_ = 81,                       /* '>'  */
+  YYSYMBOL_82_ = 82,                       /* '~'  */
+  YYSYMBOL_83_ = 83,                       /* '['  */
+  YYSYMBOL_84_ = 84,                       /* ']'  */
+  YYSYMBOL_85_ = 85,                       /* '='  */
+  YYSYMBOL_86_ = 86,                       /* ':'  */
+  YYSYMBOL_87_ = 87,                       /* '{'  */
+  YYSYMBOL_88_ = 88,                       /* '}'  */
+  YYSYMBOL_89_ = 89,                       /* '!'  */
+  YYSYMBOL_90_ = 90,                       /* '?'  */
+  YYSYMBOL_YYACCEPT = 91,                  /* $accept  */
+  YYSYMBOL_program = 92,                   /* program  */
+  YYSYMBOL_93_1 = 93,                      /* $@1  */
+  YYSYMBOL_top_level_declarations = 94,    /* top_level_declarations  */
+  YYSYMBOL_top_level_declaration = 95,     /* top_level_declaration  */
+  YYSYMBOL_opt_inherit_label = 96,         /* opt_inherit_label  */
+  YYSYMBOL_ident = 97,                     /* ident  */
+  YYSYMBOL_composite_string = 98,          /* composite_string  */
+  YYSYMBOL_string_exp = 99,                /* string_exp  */
+  YYSYMBOL_string = 100,                   /* string  */
+  YYSYMBOL_data_declaration = 101,         /* data_declaration  */
+  YYSYMBOL_function_declaration = 102,     /* function_declaration  */
+  YYSYMBOL_103_2 = 103,                    /* $@2  */
+  YYSYMBOL_104_3 = 104,                    /* $@3  */
+  YYSYMBOL_local_data_declaration = 105,   /* local_data_declaration  */
+  YYSYMBOL_formals_declaration = 106,      /* formals_declaration  */
+  YYSYMBOL_formal_declaration_list = 107,  /* formal_declaration_list  */
+  YYSYMBOL_varargs_formal_declaration = 108, /* varargs_formal_declaration  */
+  YYSYMBOL_formal_declaration = 109,       /* formal_declaration  */
+  YYSYMBOL_class_specifier_list = 110,     /* class_specifier_list  */
+  YYSYMBOL_class_specifier_list2 = 111,    /* class_specifier_list2  */
+  YYSYMBOL_class_specifier = 112,          /* class_specifier  */
+  YYSYMBOL_opt_private = 113,              /* opt_private  */
+  YYSYMBOL_non_private = 114,              /* non_private  */
+  YYSYMBOL_type_specifier = 115,           /* type_specifier  */
+  YYSYMBOL_opt_object = 116,               /* opt_object  */
+  YYSYMBOL_star_list = 117,                /* star_list  */
+  YYSYMBOL_data_dcltr = 118,               /* data_dcltr  */
+  YYSYMBOL_operator = 119,                 /* operator  */
+  YYSYMBOL_function_name = 120,            /* function_name  */
+  YYSYMBOL_function_dcltr = 121,           /* function_dcltr  */
+  YYSYMBOL_dcltr = 122,                    /* dcltr  */
+  YYSYMBOL_list_dcltr = 123,               /* list_dcltr  */
+  YYSYMBOL_dcltr_or_stmt_list = 124,       /* dcltr_or_stmt_list  */
+  YYSYMBOL_dcltr_or_stmt = 125,            /* dcltr_or_stmt  */
+  YYSYMBOL_if_stmt = 126,                  /* if_stmt  */
+  YYSYMBOL_127_4 = 127,                    /* $@4  */
+  YYSYMBOL_stmt = 128,                     /* stmt  */
+  YYSYMBOL_129_5 = 129,                    /* $@5  */
+  YYSYMBOL_130_6 = 130,                    /* $@6  */
+  YYSYMBOL_131_7 = 131,                    /* $@7  */
+  YYSYMBOL_132_8 = 132,                    /* $@8  */
+  YYSYMBOL_133_9 = 133,                    /* $@9  */
+  YYSYMBOL_134_10 = 134,                   /* $@10  */
+  YYSYMBOL_135_11 = 135,                   /* $@11  */
+  YYSYMBOL_136_12 = 136,                   /* $@12  */
+  YYSYMBOL_137_13 = 137,                   /* $@13  */
+  YYSYMBOL_138_14 = 138,                   /* $@14  */
+  YYSYMBOL_139_15 = 139,                   /* $@15  */
+  YYSYMBOL_140_16 = 140,                   /* $@16  */
+  YYSYMBOL_compound_stmt = 141,            /* compound_stmt  */
+  YYSYMBOL_142_17 = 142,                   /* $@17  */
+  YYSYMBOL_opt_caught_stmt = 143,          /* opt_caught_stmt  */
+  YYSYMBOL_function_call = 144,            /* function_call  */
+  YYSYMBOL_primary_p1_exp = 145,           /* primary_p1_exp  */
+  YYSYMBOL_146_18 = 146,                   /* $@18  */
+  YYSYMBOL_primary_p2_exp = 147,           /* primary_p2_exp  */
+  YYSYMBOL_postfix_exp = 148,              /* postfix_exp  */
+  YYSYMBOL_prefix_exp = 149,               /* prefix_exp  */
+  YYSYMBOL_cast_exp = 150,                 /* cast_exp  */
+  YYSYMBOL_mult_oper_exp = 151,            /* mult_oper_exp  */
+  YYSYMBOL_add_oper_exp = 152,             /* add_oper_exp  */
+  YYSYMBOL_shift_oper_exp = 153,           /* shift_oper_exp  */
+  YYSYMBOL_rel_oper_exp = 154,             /* rel_oper_exp  */
+  YYSYMBOL_equ_oper_exp = 155,             /* equ_oper_exp  */
+  YYSYMBOL_bitand_oper_exp = 156,          /* bitand_oper_exp  */
+  YYSYMBOL_bitxor_oper_exp = 157,          /* bitxor_oper_exp  */
+  YYSYMBOL_bitor_oper_exp = 158,           /* bitor_oper_exp  */
+  YYSYMBOL_and_oper_exp = 159,             /* and_oper_exp  */
+  YYSYMBOL_or_oper_exp = 160,              /* or_oper_exp  */
+  YYSYMBOL_cond_exp = 161,                 /* cond_exp  */
+  YYSYMBOL_162_19 = 162,                   /* $@19  */
+  YYSYMBOL_163_20 = 163,                   /* $@20  */
+  YYSYMBOL_exp = 164,                      /* exp  */
+  YYSYMBOL_list_exp = 165,                 /* list_exp  */
+  YYSYMBOL_opt_list_exp = 166,             /* opt_list_exp  */
+  YYSYMBOL_f_list_exp = 167,               /* f_list_exp  */
+  YYSYMBOL_f_opt_list_exp = 168,           /* f_opt_list_exp  */
+  YYSYMBOL_arg_list = 169,                 /* arg_list  */
+  YYSYMBOL_opt_arg_list = 170,             /* opt_arg_list  */
+  YYSYMBOL_opt_arg_list_comma = 171,       /* opt_arg_list_comma  */
+  YYSYMBOL_assoc_exp = 172,                /* assoc_exp  */
+  YYSYMBOL_assoc_arg_list = 173,           /* assoc_arg_list  */
+  YYSYMBOL_opt_assoc_arg_list_comma = 174  /* opt_assoc_arg_list_comma  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
+
+
+
+#ifdef short
+# undef short
+#endif
+
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
+
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
+#else
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
+#else
+typedef short yytype_uint8;
+#endif
+
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
+#else
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
+#endif
+
+#ifndef YYSIZE_T
+# ifdef __SIZE_TYPE__
+#  define YYSIZE_T __SIZE_TYPE__
+# elif defined size_t
+#  define YYSIZE_T size_t
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYSIZE_T size_t
+# else
+#  define YYSIZE_T unsigned
+# endif
+#endif
+
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int16 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
+
+#ifndef YY_
+# if defined YYENABLE_NLS && YYENABLE_NLS
+#  if ENABLE_NLS
+#   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
+#  endif
+# endif
+# ifndef YY_
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
+#endif
+
+/* Suppress unused-variable warnings by "using" E.  */
+#if ! defined lint || defined __GNUC__
+# define YY_USE(E) ((void) (E))
+#else
+# define YY_USE(E) /* empty */
+#endif
+
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
+#else
+# define YY_INITIAL_VALUE(Value) Value
+#endif
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
+
+/* The parser invokes alloca or malloc; define the necessary symbols.  */
+
+# ifdef YYSTACK_USE_ALLOCA
+#  if YYSTACK_USE_ALLOCA
+#   ifdef __GNUC__
+#    define YYSTACK_ALLOC __builtin_alloca
+#   elif defined __BUILTIN_VA_ARG_INCR
+#    include <alloca.h> /* INFRINGES ON USER NAME SPACE */
+#   elif defined _AIX
+#    define YYSTACK_ALLOC __alloca
+#   elif defined _MSC_VER
+#    include <malloc.h> /* INFRINGES ON USER NAME SPACE */
+#    define alloca _alloca
+#   else
+#    define YYSTACK_ALLOC alloca
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
+#     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
+#     endif
+#    endif
+#   endif
+#  endif
+# endif
+
+# ifdef YYSTACK_ALLOC
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+    /* The OS might guarantee only one guard page at the bottom of the stack,
+       and a page size can be as small as 4096 bytes.  So we cannot safely
+       invoke alloca (N) if N exceeds 4096.  Use a slightly smaller number
+       to allow for a few compiler-allocated temporary stack slots.  */
+#   define YYSTACK_ALLOC_MAXIMUM 4032 /* reasonable circa 2006 */
+#  endif
+# else
+#  define YYSTACK_ALLOC YYMALLOC
+#  define YYSTACK_FREE YYFREE
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+#   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
+#  endif
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
+       && ! ((defined YYMALLOC || defined malloc) \
+             && (defined YYFREE || defined free)))
+#   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
+#   endif
+#  endif
+#  ifndef YYMALLOC
+#   define YYMALLOC malloc
+#   if ! defined malloc && ! defined EXIT_SUCCESS
+void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+#  ifndef YYFREE
+#   define YYFREE free
+#   if ! defined free && ! defined EXIT_SUCCESS
+void free (void *); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+# endif
+#endif /* !defined yyoverflow */
+
+#if (! defined yyoverflow \
+     && (! defined __cplusplus \
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+
+/* A type that is properly aligned for any stack member.  */
+union yyalloc
+{
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+};
+
+/* The size of the maximum gap between one aligned stack and the next.  */
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
+
+/* The size of an array large to enough to hold all stacks, each with
+   N elements.  */
+# define YYSTACK_BYTES(N) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
+      + YYSTACK_GAP_MAXIMUM)
+
+# define YYCOPY_NEEDED 1
+
+/* Relocate STACK from its old location to the new one.  The
+   local variables YYSIZE and YYSTACKSIZE give the old and new number of
+   elements in the stack, and YYPTR gives the new location of the
+   stack.  Advance YYPTR to a properly aligned location for the next
+   stack.  */
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
+
+#endif
+
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
+/* YYFINAL -- State number of the termination state.  */
+#define YYFINAL  3
+/* YYLAST -- Last index in YYTABLE.  */
+#define YYLAST   620
+
+/* YYNTOKENS -- Number of terminals.  */
+#define YYNTOKENS  91
+/* YYNNTS -- Number of nonterminals.  */
+#define YYNNTS  84
+/* YYNRULES -- Number of rules.  */
+#define YYNRULES  229
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  400
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   322
+
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
+{
+       0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,    89,     2,     2,     2,    76,    77,     2,
+      70,    71,    73,    69,    72,    74,     2,    75,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,    86,    68,
+      80,    85,    81,    90,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,    83,     2,    84,    78,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,    87,    79,    88,    82,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
+       5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
+      25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
+      35,    36,    37,    38,    39,    40,    41,    42,    43,    44,
+      45,    46,    47,    48,    49,    50,    51,    52,    53,    54,
+      55,    56,    57,    58,    59,    60,    61,    62,    63,    64,
+      65,    66,    67
+};
+
+#if YYDEBUG
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
+{
+       0,   132,   132,   132,   145,   146,   155,   168,   170,   176,
+     177,   181,   186,   187,   192,   193,   198,   203,   209,   208,
+     220,   219,   235,   241,   242,   243,   244,   252,   253,   258,
+     263,   267,   276,   283,   284,   285,   290,   291,   296,   298,
+     303,   304,   309,   311,   313,   315,   320,   321,   322,   324,
+     326,   328,   330,   336,   337,   341,   342,   347,   348,   358,
+     366,   368,   370,   372,   374,   376,   378,   380,   382,   384,
+     386,   388,   390,   392,   394,   396,   398,   400,   402,   404,
+     409,   410,   414,   419,   420,   424,   425,   431,   432,   437,
+     444,   448,   459,   458,   464,   466,   467,   474,   473,   480,
+     480,   484,   483,   493,   492,   502,   501,   519,   524,   519,
+     535,   534,   545,   544,   555,   554,   565,   564,   575,   574,
+     577,   581,   585,   589,   591,   595,   595,   608,   609,   614,
+     616,   618,   623,   625,   627,   628,   629,   631,   633,   656,
+     675,   677,   679,   681,   683,   686,   685,   692,   694,   696,
+     701,   706,   707,   709,   714,   715,   717,   722,   723,   725,
+     727,   729,   731,   736,   757,   758,   766,   767,   769,   771,
+     776,   777,   779,   784,   785,   787,   792,   793,   795,   797,
+     799,   804,   805,   807,   812,   813,   818,   819,   824,   825,
+     830,   831,   836,   837,   842,   844,   846,   843,   855,   856,
+     858,   860,   862,   864,   866,   868,   870,   872,   874,   876,
+     881,   882,   888,   889,   893,   898,   903,   904,   913,   914,
+     915,   928,   929,   930,   935,   944,   945,   951,   952,   953
+};
+#endif
+
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
+/* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
+   First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
+static const char *const yytname[] =
+{
+  "\"end of file\"", "error", "\"invalid token\"", "VOID", "INHERIT",
+  "MAPPING", "BREAK", "ELSE", "CASE", "NIL", "FOR", "STATIC", "CONTINUE",
+  "PRIVATE", "FUNCTION", "RLIMITS", "RETURN", "OPERATOR", "FLOAT", "DO",
+  "IF", "OBJECT", "GOTO", "STRING", "WHILE", "NEW", "VARARGS", "CATCH",
+  "SWITCH", "NOMASK", "ATOMIC", "INT", "DEFAULT", "MIXED", "LARROW",
+  "RARROW", "PLUS_PLUS", "MIN_MIN", "LSHIFT", "RSHIFT", "LE", "GE", "EQ",
+  "NE", "LAND", "LOR", "PLUS_EQ", "MIN_EQ", "MULT_EQ", "DIV_EQ", "MOD_EQ",
+  "LSHIFT_EQ", "RSHIFT_EQ", "AND_EQ", "XOR_EQ", "OR_EQ", "COLON_COLON",
+  "DOT_DOT", "ELLIPSIS", "STRING_CONST", "IDENTIFIER", "INT_CONST",
+  "FLOAT_CONST", "MARK", "HASH", "HASH_HASH", "INCL_CONST", "NR_TOKENS",
+  "';'", "'+'", "'('", "')'", "','", "'*'", "'-'", "'/'", "'%'", "'&'",
+  "'^'", "'|'", "'<'", "'>'", "'~'", "'['", "']'", "'='", "':'", "'{'",
+  "'}'", "'!'", "'?'", "$accept", "program", "$@1",
+  "top_level_declarations", "top_level_declaration", "opt_inherit_label",
+  "ident", "composite_string", "string_exp", "string", "data_declaration",
+  "function_declaration", "$@2", "$@3", "local_data_declaration",
+  "formals_declaration", "formal_declaration_list",
+  "varargs_formal_declaration", "formal_declaration",
+  "class_specifier_list", "class_specifier_list2", "class_specifier",
+  "opt_private", "non_private", "type_specifier", "opt_object",
+  "star_list", "data_dcltr", "operator", "function_name", "function_dcltr",
+  "dcltr", "list_dcltr", "dcltr_or_stmt_list", "dcltr_or_stmt", "if_stmt",
+  "$@4", "stmt", "$@5", "$@6", "$@7", "$@8", "$@9", "$@10", "$@11", "$@12",
+  "$@13", "$@14", "$@15", "$@16", "compound_stmt", "$@17",
+  "opt_caught_stmt", "function_call", "primary_p1_exp", "$@18",
+  "primary_p2_exp", "postfix_exp", "prefix_exp", "cast_exp",
+  "mult_oper_exp", "add_oper_exp", "shift_oper_exp", "rel_oper_exp",
+  "equ_oper_exp", "bitand_oper_exp", "bitxor_oper_exp", "bitor_oper_exp",
+  "and_oper_exp", "or_oper_exp", "cond_exp", "$@19", "$@20", "exp",
+  "list_exp", "opt_list_exp", "f_list_exp", "f_opt_list_exp", "arg_list",
+  "opt_arg_list", "opt_arg_list_comma", "assoc_exp", "assoc_arg_list",
+  "opt_assoc_arg_list_comma", YY_NULLPTR
+};
+
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
+{
+  return yytname[yysymbol];
+}
+#endif
+
+#define YYPACT_NINF (-246)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-215)
+
+#define yytable_value_is_error(Yyn) \
+  0
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int16 yypact[] =
+{
+    -246,    22,  -246,  -246,   161,  -246,   184,  -246,  -246,  -246,
+    -246,  -246,  -246,   155,   266,    67,   272,  -246,  -246,  -246,
+    -246,    94,  -246,  -246,  -246,  -246,    21,  -246,  -246,   266,
+    -246,  -246,    -7,  -246,    94,    51,  -246,  -246,    44,    26,
+    -246,    61,  -246,     1,  -246,   142,  -246,   -29,    94,   100,
+     155,  -246,   106,   -17,  -246,  -246,  -246,   537,  -246,   114,
+    -246,   119,   109,  -246,  -246,  -246,    94,  -246,  -246,  -246,
+    -246,  -246,    92,    83,  -246,  -246,  -246,  -246,  -246,  -246,
+    -246,  -246,  -246,  -246,  -246,  -246,  -246,  -246,  -246,  -246,
+    -246,  -246,   -28,    44,  -246,  -246,  -246,  -246,   152,   109,
+    -246,  -246,    70,   108,   134,  -246,  -246,  -246,  -246,  -246,
+    -246,   378,   139,   141,   510,  -246,   146,   143,   160,   510,
+    -246,   164,    -7,   166,   142,   169,   173,   136,   510,   510,
+      -3,  -246,  -246,  -246,   510,   257,   510,   105,   510,  -246,
+     510,   -20,  -246,  -246,   226,  -246,   189,  -246,   246,  -246,
+    -246,   188,  -246,    29,   191,  -246,  -246,   126,    45,   194,
+       4,   199,   187,   203,   193,   245,   -12,   371,  -246,    79,
+    -246,  -246,   169,    12,   -25,   510,  -246,   510,   219,  -246,
+     229,   462,   510,   232,   510,    94,  -246,   109,   510,  -246,
+    -246,  -246,   114,  -246,  -246,   510,   510,   510,  -246,   179,
+    -246,   230,   234,  -246,  -246,  -246,  -246,    -3,  -246,   510,
+     142,    -7,   510,  -246,  -246,   510,   510,   510,   510,   510,
+     510,   510,   510,   510,   510,   510,   510,   510,   510,   510,
+     510,   510,   510,  -246,   510,   510,   510,   510,   510,   510,
+     510,   510,   510,   510,   510,  -246,   510,   510,  -246,   242,
+     219,   243,  -246,   288,   244,  -246,   249,   251,   510,  -246,
+     252,   462,   253,   228,  -246,   250,   241,  -246,   260,   247,
+     133,  -246,   510,   510,   462,   111,  -246,  -246,   462,    49,
+     258,    94,   263,    78,   254,   279,  -246,  -246,  -246,   126,
+     126,    45,    45,   194,   194,   194,   194,     4,     4,   199,
+     187,   203,   193,   245,   510,  -246,  -246,  -246,  -246,  -246,
+    -246,  -246,  -246,  -246,  -246,  -246,  -246,   261,   462,   510,
+     510,   267,  -246,  -246,   510,   196,   262,  -246,  -246,   273,
+     510,   510,   278,   510,   280,   510,   281,   282,  -246,  -246,
+    -246,  -246,   510,  -246,  -246,   510,  -246,   510,    36,  -246,
+    -246,   286,   284,   510,   462,   462,   285,  -246,   462,  -246,
+     109,   510,  -246,  -246,  -246,  -246,  -246,  -246,   287,  -246,
+     290,   274,  -246,   462,   510,  -246,   291,  -246,  -246,  -246,
+    -246,  -246,   292,   510,  -246,  -246,   510,  -246,   293,   109,
+     297,  -246,   295,  -246,  -246,  -246,  -246,  -246,   462,  -246
+};
+
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_uint8 yydefact[] =
+{
+       2,     0,     4,     1,    40,    42,    41,    45,    44,    43,
+       5,     7,     8,     0,     0,    33,    34,    54,    51,    52,
+      47,    49,    48,    46,    53,    11,     0,    57,    38,    35,
+      36,    39,     9,    16,     0,    50,    12,    14,    23,     0,
+      83,    84,    85,     0,    37,    55,    10,     0,     0,    54,
+       0,    32,     0,    25,    27,    30,    57,     0,    58,    59,
+      81,     0,     0,    17,    57,    56,     0,    15,    13,    29,
+      20,    26,     0,     0,    31,    75,    76,    72,    73,    70,
+      71,    60,    62,    61,    63,    64,    65,    66,    67,    68,
+      69,    74,     0,    23,   125,    19,    84,    86,     0,     0,
+      28,    59,     0,    77,     0,    87,     6,    21,    79,    78,
+      82,     0,     0,     0,     0,   134,     0,     0,     0,   212,
+      99,     0,     0,     0,    55,   107,     0,     0,     0,     0,
+       0,   132,   133,   124,     0,     0,     0,     0,     0,   126,
+       0,   138,   135,    89,     0,    33,   129,    88,    96,    90,
+      95,     0,   151,   154,   157,   164,   166,   170,   173,   176,
+     181,   184,   186,   188,   190,   192,   194,   198,   210,     0,
+      91,   121,     0,   138,     0,   212,   122,     0,   213,   215,
+       0,     0,     0,     0,     0,     0,   145,     0,     0,   116,
+     158,   159,   139,   130,   161,     0,   227,   221,    57,     0,
+     160,     0,     0,   163,   162,   118,    57,     0,    97,   218,
+      55,     0,   212,   155,   156,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,   195,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,    94,     0,     0,   112,     0,
+     214,     0,   123,     0,     0,   120,     0,   147,     0,   108,
+       0,     0,     0,     0,   225,   228,     0,   216,   222,     0,
+       0,   140,     0,   218,     0,     0,    80,   131,     0,   219,
+       0,     0,     0,   213,     0,     0,   167,   168,   169,   171,
+     172,   174,   175,   179,   180,   177,   178,   182,   183,   185,
+     187,   189,   191,   193,     0,   200,   201,   202,   203,   204,
+     205,   206,   207,   208,   209,   199,   211,     0,     0,   212,
+       0,     0,    92,   101,   218,     0,   127,   110,   117,     0,
+       0,   229,     0,   223,     0,     0,     0,     0,   119,    22,
+      98,   220,     0,   141,   150,   218,   152,   212,     0,   114,
+     113,     0,     0,     0,     0,     0,     0,   146,     0,   109,
+       0,   218,   224,   226,   137,   217,   136,   165,     0,   142,
+       0,     0,   196,     0,   212,   105,     0,    93,   102,   148,
+     128,   111,     0,   218,   149,   153,     0,   115,     0,     0,
+       0,   144,     0,   197,   103,   106,   100,   143,     0,   104
+};
+
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int16 yypgoto[] =
+{
+    -246,  -246,  -246,  -246,  -246,  -246,   -13,   -14,   -44,   -18,
+    -246,  -246,  -246,  -246,  -246,   275,  -246,   298,   300,   248,
+    -246,    17,   256,    25,    11,  -114,   -54,   313,  -246,   -27,
+     344,   308,   167,  -246,  -246,  -246,  -246,  -173,  -246,  -246,
+    -246,  -246,  -246,  -246,  -246,  -246,  -246,  -246,  -246,  -246,
+     -61,  -246,  -246,  -246,  -246,  -246,  -246,  -246,  -246,  -123,
+      37,    66,    84,    43,   147,   145,   148,   149,   144,  -246,
+      -9,  -246,  -246,  -107,  -101,  -166,  -161,  -177,   185,  -245,
+    -246,    81,  -246,  -246
+};
+
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_int16 yydefgoto[] =
+{
+       0,     1,     2,     4,    10,    45,   173,    35,    36,   142,
+      11,    12,    62,    99,   143,    52,    53,    54,    55,    13,
+      29,    14,    15,    16,    56,    66,    39,    40,    60,   146,
+      96,    42,    43,   111,   147,   148,   354,   149,   278,   181,
+     355,   398,   389,   187,   326,   360,   318,   373,   261,   274,
+     150,   105,   359,   151,   152,   258,   153,   154,   155,   156,
+     157,   158,   159,   160,   161,   162,   163,   164,   165,   166,
+     167,   304,   386,   168,   169,   179,   251,   180,   279,   280,
+     269,   264,   265,   266
+};
+
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int16 yytable[] =
+{
+      26,    95,    73,    37,    68,   190,   191,   174,   253,   249,
+     185,   194,    61,   200,    57,   203,    37,   204,   178,    46,
+      47,   254,     3,   256,    27,    51,    59,   260,   337,   102,
+      37,    30,   247,   232,   199,   285,   -80,    51,   107,    31,
+      48,    71,    67,    57,   222,   223,    44,    49,    37,    18,
+     -80,   284,    98,    25,    31,    72,   103,    25,    19,    51,
+     101,   248,    20,   210,   211,    21,   205,    22,   -80,    63,
+      50,    32,   262,    64,   178,    23,   250,    24,   233,   356,
+      51,   250,   -80,   250,   224,   225,    25,   250,   328,   263,
+     267,    38,   286,   287,   288,    17,   281,    18,   141,    58,
+     370,   338,   267,   193,    25,   340,    19,   341,   246,   183,
+      20,   283,   212,    21,   218,    22,   382,   192,    50,   219,
+      48,   342,   372,    23,   202,    24,   259,   305,   306,   307,
+     308,   309,   310,   311,   312,   313,   314,   315,   392,   316,
+     317,   257,   351,    25,   270,   350,   198,   245,   -18,   336,
+     246,   246,    25,    33,   108,   206,    58,   325,    17,   352,
+      18,    -3,  -214,    65,    34,    25,   267,    37,   141,    19,
+     371,   -24,     5,    20,     6,   201,    21,    70,    22,   339,
+     277,   377,   378,    64,   -80,   380,    23,     7,    24,    93,
+       8,     9,   376,   109,   276,   -38,    94,   -38,   282,   215,
+     387,   216,   217,   348,   335,   110,    58,   170,   388,   171,
+     -38,   176,   367,   -38,   -38,    25,   175,   267,   178,   250,
+     106,    48,   189,   362,   263,   399,   365,   213,   214,    17,
+     177,    18,   220,   221,   182,   365,   184,   344,   267,   186,
+      19,   226,   227,   188,    20,   207,   178,    21,   141,    22,
+     271,   246,   250,   208,   267,   289,   290,    23,   209,    24,
+      17,   141,    18,    37,   228,   141,   115,   357,   246,   297,
+     298,    19,   230,   178,    57,    20,   267,     5,    21,    28,
+      22,   229,   124,   -39,   172,   -39,   291,   292,    23,   231,
+      24,   246,     7,   128,   129,     8,     9,   252,   -39,   381,
+     255,   -39,   -39,   272,   273,   141,   293,   294,   295,   296,
+     319,   320,   321,   130,   330,   322,    33,    25,   131,   132,
+     323,   324,   331,   327,   329,   332,   134,   135,   395,   343,
+     195,   136,   333,   345,   137,   334,   347,   353,   346,   138,
+     196,   141,   141,   361,   197,   141,   140,   349,   358,   364,
+      69,   366,   368,   369,   374,   375,   379,   383,   385,   144,
+     141,   384,   390,   391,   394,   396,   397,   145,   104,    74,
+     100,    41,    97,   275,   300,   299,   303,   393,   301,   112,
+     302,   -40,   268,   -40,   113,   141,   114,   115,   116,     5,
+     117,     6,   -40,   118,   119,    57,   -40,   120,   121,   -40,
+     122,   -40,   123,   124,     7,   125,   126,     8,     9,   -40,
+     127,   -40,   363,     0,   128,   129,     0,   234,   235,   236,
+     237,   238,   239,   240,   241,   242,   243,     0,     0,     0,
+       0,     0,     0,     0,   130,     0,     0,    33,    25,   131,
+     132,     0,     0,     0,     0,     0,   133,   134,   135,     0,
+       0,     0,   136,     0,     0,   137,   244,     0,     0,     0,
+     138,     0,     0,     0,     0,    94,   139,   140,   113,     0,
+     114,   115,   116,     0,   117,     0,     0,   118,   119,    57,
+       0,   120,   121,     0,   122,     0,   123,   124,     0,   125,
+     126,     0,     0,     0,   127,     0,     0,     0,   128,   129,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,   130,   115,
+       0,    33,    25,   131,   132,     0,     0,    57,     0,     0,
+     133,   134,   135,     0,     0,   124,   136,   172,     0,   137,
+       0,     0,     0,     0,   138,     0,   128,   129,     0,    94,
+       0,   140,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,   130,     0,     0,    33,
+      25,   131,   132,    75,    76,    77,    78,    79,    80,   134,
+     135,     0,     0,     0,   136,     0,     0,   137,     0,     0,
+       0,     0,   138,     0,     0,     0,     0,     0,     0,   140,
+       0,     0,     0,     0,     0,     0,    81,     0,     0,     0,
+      82,    83,    84,    85,    86,    87,    88,    89,    90,    91,
+      92
+};
+
+static const yytype_int16 yycheck[] =
+{
+      13,    62,    56,    21,    48,   128,   129,   114,   181,   175,
+     124,   134,    39,   136,    17,   138,    34,   140,   119,    32,
+      34,   182,     0,   184,    13,    38,    39,   188,   273,    57,
+      48,    14,    57,    45,   135,   212,    56,    50,    99,    14,
+      69,    58,    71,    17,    40,    41,    29,     3,    66,     5,
+      70,   212,    66,    60,    29,    72,    84,    60,    14,    72,
+      73,    86,    18,    34,    35,    21,    86,    23,    56,    68,
+      26,     4,   195,    72,   175,    31,   177,    33,    90,   324,
+      93,   182,    70,   184,    80,    81,    60,   188,   261,   196,
+     197,    70,   215,   216,   217,     3,   210,     5,   111,    73,
+     345,   274,   209,   130,    60,   278,    14,    58,    72,   122,
+      18,   212,    83,    21,    69,    23,   361,   130,    26,    74,
+      69,    72,    86,    31,   137,    33,   187,   234,   235,   236,
+     237,   238,   239,   240,   241,   242,   243,   244,   383,   246,
+     247,   185,   319,    60,   198,   318,   135,    68,    87,   272,
+      72,    72,    60,    59,    84,   144,    73,   258,     3,   320,
+       5,     0,    84,    21,    70,    60,   273,   185,   181,    14,
+     347,    71,    11,    18,    13,    70,    21,    71,    23,    68,
+     207,   354,   355,    72,    70,   358,    31,    26,    33,    70,
+      29,    30,   353,    85,   207,    11,    87,    13,   211,    73,
+     373,    75,    76,   304,    71,    71,    73,    68,   374,    68,
+      26,    68,   335,    29,    30,    60,    70,   324,   319,   320,
+      68,    69,    86,   330,   331,   398,   333,    36,    37,     3,
+      70,     5,    38,    39,    70,   342,    70,   281,   345,    70,
+      14,    42,    43,    70,    18,    56,   347,    21,   261,    23,
+      71,    72,   353,     7,   361,   218,   219,    31,    70,    33,
+       3,   274,     5,   281,    77,   278,     9,    71,    72,   226,
+     227,    14,    79,   374,    17,    18,   383,    11,    21,    13,
+      23,    78,    25,    11,    27,    13,   220,   221,    31,    44,
+      33,    72,    26,    36,    37,    29,    30,    68,    26,   360,
+      68,    29,    30,    73,    70,   318,   222,   223,   224,   225,
+      68,    68,    24,    56,    86,    71,    59,    60,    61,    62,
+      71,    70,    72,    71,    71,    84,    69,    70,   389,    71,
+      73,    74,    72,    70,    77,    88,    57,    70,    84,    82,
+      83,   354,   355,    70,    87,   358,    89,    86,    86,    71,
+      50,    71,    71,    71,    68,    71,    71,    70,    84,   111,
+     373,    71,    71,    71,    71,    68,    71,   111,    93,    56,
+      72,    27,    64,   206,   229,   228,   232,   386,   230,     1,
+     231,     3,   197,     5,     6,   398,     8,     9,    10,    11,
+      12,    13,    14,    15,    16,    17,    18,    19,    20,    21,
+      22,    23,    24,    25,    26,    27,    28,    29,    30,    31,
+      32,    33,   331,    -1,    36,    37,    -1,    46,    47,    48,
+      49,    50,    51,    52,    53,    54,    55,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    56,    -1,    -1,    59,    60,    61,
+      62,    -1,    -1,    -1,    -1,    -1,    68,    69,    70,    -1,
+      -1,    -1,    74,    -1,    -1,    77,    85,    -1,    -1,    -1,
+      82,    -1,    -1,    -1,    -1,    87,    88,    89,     6,    -1,
+       8,     9,    10,    -1,    12,    -1,    -1,    15,    16,    17,
+      -1,    19,    20,    -1,    22,    -1,    24,    25,    -1,    27,
+      28,    -1,    -1,    -1,    32,    -1,    -1,    -1,    36,    37,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    56,     9,
+      -1,    59,    60,    61,    62,    -1,    -1,    17,    -1,    -1,
+      68,    69,    70,    -1,    -1,    25,    74,    27,    -1,    77,
+      -1,    -1,    -1,    -1,    82,    -1,    36,    37,    -1,    87,
+      -1,    89,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    56,    -1,    -1,    59,
+      60,    61,    62,    36,    37,    38,    39,    40,    41,    69,
+      70,    -1,    -1,    -1,    74,    -1,    -1,    77,    -1,    -1,
+      -1,    -1,    82,    -1,    -1,    -1,    -1,    -1,    -1,    89,
+      -1,    -1,    -1,    -1,    -1,    -1,    69,    -1,    -1,    -1,
+      73,    74,    75,    76,    77,    78,    79,    80,    81,    82,
+      83
+};
+
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_uint8 yystos[] =
+{
+       0,    92,    93,     0,    94,    11,    13,    26,    29,    30,
+      95,   101,   102,   110,   112,   113,   114,     3,     5,    14,
+      18,    21,    23,    31,    33,    60,    97,   115,    13,   111,
+     112,   114,     4,    59,    70,    98,    99,   100,    70,   117,
+     118,   121,   122,   123,   112,    96,    97,    98,    69,     3,
+      26,    97,   106,   107,   108,   109,   115,    17,    73,    97,
+     119,   120,   103,    68,    72,    21,   116,    71,    99,   109,
+      71,    58,    72,   117,   118,    36,    37,    38,    39,    40,
+      41,    69,    73,    74,    75,    76,    77,    78,    79,    80,
+      81,    82,    83,    70,    87,   141,   121,   122,    98,   104,
+     108,    97,    57,    84,   106,   142,    68,   141,    84,    85,
+      71,   124,     1,     6,     8,     9,    10,    12,    15,    16,
+      19,    20,    22,    24,    25,    27,    28,    32,    36,    37,
+      56,    61,    62,    68,    69,    70,    74,    77,    82,    88,
+      89,    97,   100,   105,   110,   113,   120,   125,   126,   128,
+     141,   144,   145,   147,   148,   149,   150,   151,   152,   153,
+     154,   155,   156,   157,   158,   159,   160,   161,   164,   165,
+      68,    68,    27,    97,   164,    70,    68,    70,   165,   166,
+     168,   130,    70,    97,    70,   116,    70,   134,    70,    86,
+     150,   150,    97,   120,   150,    73,    83,    87,   115,   165,
+     150,    70,    97,   150,   150,    86,   115,    56,     7,    70,
+      34,    35,    83,    36,    37,    73,    75,    76,    69,    74,
+      38,    39,    40,    41,    80,    81,    42,    43,    77,    78,
+      79,    44,    45,    90,    46,    47,    48,    49,    50,    51,
+      52,    53,    54,    55,    85,    68,    72,    57,    86,   166,
+     165,   167,    68,   128,   167,    68,   167,    99,   146,   141,
+     167,   139,   150,   164,   172,   173,   174,   164,   169,   171,
+     117,    71,    73,    70,   140,   123,    97,   120,   129,   169,
+     170,   116,    97,   165,   167,   168,   150,   150,   150,   151,
+     151,   152,   152,   153,   153,   153,   153,   154,   154,   155,
+     156,   157,   158,   159,   162,   164,   164,   164,   164,   164,
+     164,   164,   164,   164,   164,   164,   164,   164,   137,    68,
+      68,    24,    71,    71,    70,   165,   135,    71,   128,    71,
+      86,    72,    84,    72,    88,    71,   150,   170,   128,    68,
+     128,    58,    72,    71,    99,    70,    84,    57,   165,    86,
+     128,   168,   167,    70,   127,   131,   170,    71,    86,   143,
+     136,    70,   164,   172,    71,   164,    71,   150,    71,    71,
+     170,   168,    86,   138,    68,    71,   167,   128,   128,    71,
+     128,   141,   170,    70,    71,    84,   163,   128,   166,   133,
+      71,    71,   170,   161,    71,   141,    68,    71,   132,   128
+};
+
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_uint8 yyr1[] =
+{
+       0,    91,    93,    92,    94,    94,    95,    95,    95,    96,
+      96,    97,    98,    98,    99,    99,   100,   101,   103,   102,
+     104,   102,   105,   106,   106,   106,   106,   107,   107,   108,
+     108,   109,   109,   110,   110,   110,   111,   111,   112,   112,
+     113,   113,   114,   114,   114,   114,   115,   115,   115,   115,
+     115,   115,   115,   115,   115,   116,   116,   117,   117,   118,
+     119,   119,   119,   119,   119,   119,   119,   119,   119,   119,
+     119,   119,   119,   119,   119,   119,   119,   119,   119,   119,
+     120,   120,   121,   122,   122,   123,   123,   124,   124,   125,
+     125,   125,   127,   126,   128,   128,   128,   129,   128,   130,
+     128,   131,   128,   132,   128,   133,   128,   134,   135,   128,
+     136,   128,   137,   128,   138,   128,   139,   128,   140,   128,
+     128,   128,   128,   128,   128,   142,   141,   143,   143,   144,
+     144,   144,   145,   145,   145,   145,   145,   145,   145,   145,
+     145,   145,   145,   145,   145,   146,   145,   145,   145,   145,
+     145,   147,   147,   147,   148,   148,   148,   149,   149,   149,
+     149,   149,   149,   149,   150,   150,   151,   151,   151,   151,
+     152,   152,   152,   153,   153,   153,   154,   154,   154,   154,
+     154,   155,   155,   155,   156,   156,   157,   157,   158,   158,
+     159,   159,   160,   160,   161,   162,   163,   161,   164,   164,
+     164,   164,   164,   164,   164,   164,   164,   164,   164,   164,
+     165,   165,   166,   166,   167,   168,   169,   169,   170,   170,
+     170,   171,   171,   171,   172,   173,   173,   174,   174,   174
+};
+
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     0,     2,     0,     2,     6,     1,     1,     0,
+       1,     1,     1,     3,     1,     3,     1,     4,     0,     5,
+       0,     7,     4,     0,     1,     1,     2,     1,     3,     2,
+       1,     2,     1,     1,     1,     2,     1,     2,     1,     1,
+       0,     1,     1,     1,     1,     1,     1,     1,     1,     1,
+       2,     1,     1,     1,     1,     0,     1,     0,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     3,     4,     4,
+       1,     1,     5,     1,     1,     1,     3,     0,     2,     1,
+       1,     2,     0,     6,     2,     1,     1,     0,     4,     0,
+       8,     0,     6,     0,    10,     0,     8,     0,     0,     5,
+       0,     6,     0,     5,     0,     7,     0,     4,     0,     4,
+       3,     2,     2,     3,     1,     0,     4,     0,     2,     1,
+       2,     3,     1,     1,     1,     1,     5,     5,     1,     2,
+       3,     4,     5,     8,     7,     0,     5,     3,     6,     6,
+       4,     1,     4,     6,     1,     2,     2,     1,     2,     2,
+       2,     2,     2,     2,     1,     5,     1,     3,     3,     3,
+       1,     3,     3,     1,     3,     3,     1,     3,     3,     3,
+       3,     1,     3,     3,     1,     3,     1,     3,     1,     3,
+       1,     3,     1,     3,     1,     0,     0,     7,     1,     3,
+       3,     3,     3,     3,     3,     3,     3,     3,     3,     3,
+       1,     3,     0,     1,     1,     1,     1,     3,     0,     1,
+       2,     0,     1,     2,     3,     1,     3,     0,     1,     2
+};
+
+
+enum { YYENOMEM = -2 };
+
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
+
+
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
+
+
+/* Enable debugging if requested.  */
+#if YYDEBUG
+
+# ifndef YYFPRINTF
+#  include <stdio.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYFPRINTF fprintf
+# endif
+
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
+static void
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+{
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  if (!yyvaluep)
+    return;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
+
+static void
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+{
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
+
+  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  YYFPRINTF (yyo, ")");
+}
+
+/*------------------------------------------------------------------.
+| yy_stack_print -- Print the state stack from its BOTTOM up to its |
+| TOP (included).                                                   |
+`------------------------------------------------------------------*/
+
+static void
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
+{
+  YYFPRINTF (stderr, "Stack now");
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
+  YYFPRINTF (stderr, "\n");
+}
+
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
+
+
+/*------------------------------------------------.
+| Report that the YYRULE is going to be reduced.  |
+`------------------------------------------------*/
+
+static void
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule)
+{
+  int yylno = yyrline[yyrule];
+  int yynrhs = yyr2[yyrule];
+  int yyi;
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
+  /* The symbols being reduced.  */
+  for (yyi = 0; yyi < yynrhs; yyi++)
+    {
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)]);
+      YYFPRINTF (stderr, "\n");
+    }
+}
+
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule); \
+} while (0)
+
+/* Nonzero means print parse trace.  It is left uninitialized so that
+   multiple parsers can coexist.  */
+int yydebug;
+#else /* !YYDEBUG */
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
+# define YY_STACK_PRINT(Bottom, Top)
+# define YY_REDUCE_PRINT(Rule)
+#endif /* !YYDEBUG */
+
+
+/* YYINITDEPTH -- initial size of the parser's stacks.  */
+#ifndef YYINITDEPTH
+# define YYINITDEPTH 200
+#endif
+
+/* YYMAXDEPTH -- maximum size the stacks can grow to (effective only
+   if the built-in stack extension method is used).
+
+   Do not make this value too large; the results are undefined if
+   YYSTACK_ALLOC_MAXIMUM < YYSTACK_BYTES (YYMAXDEPTH)
+   evaluated with infinite-precision integer arithmetic.  */
+
+#ifndef YYMAXDEPTH
+# define YYMAXDEPTH 10000
+#endif
+
+
+
+
+
+
+/*-----------------------------------------------.
+| Release the memory associated to this symbol.  |
+`-----------------------------------------------*/
+
+static void
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
+{
+  YY_USE (yyvaluep);
+  if (!yymsg)
+    yymsg = "Deleting";
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/* Lookahead token kind.  */
+int yychar;
+
+/* The semantic value of the lookahead symbol.  */
+YYSTYPE yylval;
+/* Number of syntax errors so far.  */
+int yynerrs;
+
+
+
+
+/*----------.
+| yyparse.  |
+`----------*/
+
+int
+yyparse (void)
+{
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
+
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
+
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
+
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
+  /* The variables used to return semantic value and location from the
+     action routines.  */
+  YYSTYPE yyval;
+
+
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+
+  /* The number of symbols on the RHS of the reduced rule.
+     Keep to zero when no symbol should be popped.  */
+  int yylen = 0;
+
+  YYDPRINTF ((stderr, "Starting parse\n"));
+
+  yychar = YYEMPTY; /* Cause a token to be read.  */
+
+  goto yysetstate;
+
+
+/*------------------------------------------------------------.
+| yynewstate -- push a new state, which is found in yystate.  |
+`------------------------------------------------------------*/
+yynewstate:
+  /* In all cases, when you get here, the value and location stacks
+     have just been pushed.  So pushing a state here evens the stacks.  */
+  yyssp++;
+
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
+
+  if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
+    {
+      /* Get the current used size of the three stacks, in elements.  */
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
+
+# if defined yyoverflow
+      {
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
+      }
+# else /* defined YYSTACK_RELOCATE */
+      /* Extend the stack our own way.  */
+      if (YYMAXDEPTH <= yystacksize)
+        YYNOMEM;
+      yystacksize *= 2;
+      if (YYMAXDEPTH < yystacksize)
+        yystacksize = YYMAXDEPTH;
+
+      {
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+#  undef YYSTACK_RELOCATE
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
+      }
+# endif
+
+      yyssp = yyss + yysize - 1;
+      yyvsp = yyvs + yysize - 1;
+
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
+
+      if (yyss + yystacksize - 1 <= yyssp)
+        YYABORT;
+    }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
+
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
+
+  goto yybackup;
+
+
+/*-----------.
+| yybackup.  |
+`-----------*/
+yybackup:
+  /* Do appropriate processing given the current state.  Read a
+     lookahead token if we need one and don't already have one.  */
+
+  /* First try to decide what to do without reference to lookahead token.  */
+  yyn = yypact[yystate];
+  if (yypact_value_is_default (yyn))
+    goto yydefault;
+
+  /* Not known => get a lookahead token if don't already have one.  */
+
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
+  if (yychar == YYEMPTY)
+    {
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
+    }
+
+  if (yychar <= YYEOF)
+    {
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
+      YYDPRINTF ((stderr, "Now at end of input.\n"));
+    }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
+  else
+    {
+      yytoken = YYTRANSLATE (yychar);
+      YY_SYMBOL_PRINT ("Next token is", yytoken, &yylval, &yylloc);
+    }
+
+  /* If the proper action on seeing token YYTOKEN is to reduce or to
+     detect an error, take that action.  */
+  yyn += yytoken;
+  if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != yytoken)
+    goto yydefault;
+  yyn = yytable[yyn];
+  if (yyn <= 0)
+    {
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
+      yyn = -yyn;
+      goto yyreduce;
+    }
+
+  /* Count tokens shifted since error; after three, turn off error
+     status.  */
+  if (yyerrstatus)
+    yyerrstatus--;
+
+  /* Shift the lookahead token.  */
+  YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
+  yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
+  goto yynewstate;
+
+
+/*-----------------------------------------------------------.
+| yydefault -- do the default action for the current state.  |
+`-----------------------------------------------------------*/
+yydefault:
+  yyn = yydefact[yystate];
+  if (yyn == 0)
+    goto yyerrlab;
+  goto yyreduce;
+
+
+/*-----------------------------.
+| yyreduce -- do a reduction.  |
+`-----------------------------*/
+yyreduce:
+  /* yyn is the number of a rule to reduce with.  */
+  yylen = yyr2[yyn];
+
+  /* If YYLEN is nonzero, implement the default value of the action:
+     '$$ = $1'.
+
+     Otherwise, the following line sets YYVAL to garbage.
+     This behavior is undocumented and Bison
+     users should not rely upon it.  Assigning to YYVAL
+     unconditionally makes the parser a bit smaller, and it avoids a
+     GCC warning that YYVAL may be used uninitialized.  */
+  yyval = yyvsp[1-yylen];
+
+
+  YY_REDUCE_PRINT (yyn);
+  switch (yyn)
+    {
+  case 2: /* $@1: %empty  */
+#line 132 "parser.y"
+                {
+		  nerrors = 0;
+		  ndeclarations = 0;
+		}
+#line 1820 "y.tab.c"
+    break;
+
+  case 3: /* program: $@1 top_level_declarations  */
+#line 137 "parser.y"
+                {
+		  if (nerrors > 0) {
+		      YYABORT;
+		  }
+		}
+#line 1830 "y.tab.c"
+    break;
+
+  case 5: /* top_level_declarations: top_level_declarations top_level_declaration  */
+#line 147 "parser.y"
+                {
+		  if (nerrors > 0) {
+		      YYABORT;
+		  }
+		}
+#line 1840 "y.tab.c"
+    break;
+
+  case 6: /* top_level_declaration: opt_private INHERIT opt_inherit_label opt_object composite_string ';'  */
+#line 156 "parser.y"
+                {
+		  if (ndeclarations > 0) {
+		      c_error("inherit must precede all declarations");
+		  } else if (nerrors > 0 ||
+			     !c_inherit((yyvsp[-1].node)->l.string->text, (yyvsp[-3].node), (yyvsp[-5].type) != 0)) {
+		      /*
+		       * The object to be inherited may have been compiled;
+		       * abort this compilation and possibly restart later.
+		       */
+		      YYABORT;
+		  }
+		}
+#line 1857 "y.tab.c"
+    break;
+
+  case 7: /* top_level_declaration: data_declaration  */
+#line 169 "parser.y"
+                { ndeclarations++; }
+#line 1863 "y.tab.c"
+    break;
+
+  case 8: /* top_level_declaration: function_declaration  */
+#line 171 "parser.y"
+                { ndeclarations++; }
+#line 1869 "y.tab.c"
+    break;
+
+  case 9: /* opt_inherit_label: %empty  */
+#line 176 "parser.y"
+                { (yyval.node) = (node *) NULL; }
+#line 1875 "y.tab.c"
+    break;
+
+  case 11: /* ident: IDENTIFIER  */
+#line 182 "parser.y"
+                { (yyval.node) = node_str(str_new(yytext, (long) yyleng)); }
+#line 1881 "y.tab.c"
+    break;
+
+  case 13: /* composite_string: composite_string '+' string_exp  */
+#line 188 "parser.y"
+                { (yyval.node) = node_str(str_add((yyvsp[-2].node)->l.string, (yyvsp[0].node)->l.string)); }
+#line 1887 "y.tab.c"
+    break;
+
+  case 15: /* string_exp: '(' composite_string ')'  */
+#line 194 "parser.y"
+                { (yyval.node) = (yyvsp[-1].node); }
+#line 1893 "y.tab.c"
+    break;
+
+  case 16: /* string: STRING_CONST  */
+#line 199 "parser.y"
+                { (yyval.node) = node_str(str_new(yytext, (long) yyleng)); }
+#line 1899 "y.tab.c"
+    break;
+
+  case 17: /* data_declaration: class_specifier_list type_specifier list_dcltr ';'  */
+#line 204 "parser.y"
+                { c_global((yyvsp[-3].type), (yyvsp[-2].node), (yyvsp[-1].node)); }
+#line 1905 "y.tab.c"
+    break;
+
+  case 18: /* $@2: %empty  */
+#line 209 "parser.y"
+                {
+		  typechecking = TRUE;
+		  c_function((yyvsp[-2].type), (yyvsp[-1].node), (yyvsp[0].node));
+		}
+#line 1914 "y.tab.c"
+    break;
+
+  case 19: /* function_declaration: class_specifier_list type_specifier function_dcltr $@2 compound_stmt  */
+#line 214 "parser.y"
+                {
+		  if (nerrors == 0) {
+		      c_funcbody((yyvsp[0].node));
+		  }
+		}
+#line 1924 "y.tab.c"
+    break;
+
+  case 20: /* $@3: %empty  */
+#line 220 "parser.y"
+                {
+		  typechecking = c_typechecking();
+		  c_function((yyvsp[-4].type), node_type((typechecking) ? T_VOID : T_NIL,
+					   (String *) NULL),
+			     node_bin(N_FUNC, 0, (yyvsp[-3].node), (yyvsp[-1].node)));
+		}
+#line 1935 "y.tab.c"
+    break;
+
+  case 21: /* function_declaration: class_specifier_list ident '(' formals_declaration ')' $@3 compound_stmt  */
+#line 227 "parser.y"
+                {
+		  if (nerrors == 0) {
+		      c_funcbody((yyvsp[0].node));
+		  }
+		}
+#line 1945 "y.tab.c"
+    break;
+
+  case 22: /* local_data_declaration: class_specifier_list type_specifier list_dcltr ';'  */
+#line 236 "parser.y"
+                { c_local((yyvsp[-3].type), (yyvsp[-2].node), (yyvsp[-1].node)); }
+#line 1951 "y.tab.c"
+    break;
+
+  case 23: /* formals_declaration: %empty  */
+#line 241 "parser.y"
+                { (yyval.node) = (node *) NULL; }
+#line 1957 "y.tab.c"
+    break;
+
+  case 24: /* formals_declaration: VOID  */
+#line 242 "parser.y"
+                { (yyval.node) = (node *) NULL; }
+#line 1963 "y.tab.c"
+    break;
+
+  case 26: /* formals_declaration: formal_declaration_list ELLIPSIS  */
+#line 245 "parser.y"
+                {
+		  (yyval.node) = (yyvsp[-1].node);
+		  (yyval.node)->flags |= F_ELLIPSIS;
+		}
+#line 1972 "y.tab.c"
+    break;
+
+  case 28: /* formal_declaration_list: formal_declaration_list ',' varargs_formal_declaration  */
+#line 254 "parser.y"
+                { (yyval.node) = node_bin(N_PAIR, 0, (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1978 "y.tab.c"
+    break;
+
+  case 29: /* varargs_formal_declaration: VARARGS formal_declaration  */
+#line 259 "parser.y"
+                {
+		  (yyval.node) = (yyvsp[0].node);
+		  (yyval.node)->flags |= F_VARARGS;
+		}
+#line 1987 "y.tab.c"
+    break;
+
+  case 31: /* formal_declaration: type_specifier data_dcltr  */
+#line 268 "parser.y"
+                {
+		  (yyval.node) = (yyvsp[0].node);
+		  (yyval.node)->mod |= (yyvsp[-1].node)->mod;
+		  (yyval.node)->sclass = (yyvsp[-1].node)->sclass;
+		  if ((yyval.node)->sclass != (String *) NULL) {
+		      str_ref((yyval.node)->sclass);
+		  }
+		}
+#line 2000 "y.tab.c"
+    break;
+
+  case 32: /* formal_declaration: ident  */
+#line 276 "parser.y"
+                {
+		  (yyval.node) = (yyvsp[0].node);
+		  (yyval.node)->mod = T_NIL;	/* only if typechecking, though */
+		}
+#line 2009 "y.tab.c"
+    break;
+
+  case 35: /* class_specifier_list: class_specifier class_specifier_list2  */
+#line 286 "parser.y"
+                { (yyval.type) = (yyvsp[-1].type) | (yyvsp[0].type); }
+#line 2015 "y.tab.c"
+    break;
+
+  case 37: /* class_specifier_list2: class_specifier_list2 class_specifier  */
+#line 292 "parser.y"
+                { (yyval.type) = (yyvsp[-1].type) | (yyvsp[0].type); }
+#line 2021 "y.tab.c"
+    break;
+
+  case 38: /* class_specifier: PRIVATE  */
+#line 297 "parser.y"
+                { (yyval.type) = C_STATIC | C_PRIVATE; }
+#line 2027 "y.tab.c"
+    break;
+
+  case 40: /* opt_private: %empty  */
+#line 303 "parser.y"
+                { (yyval.type) = 0; }
+#line 2033 "y.tab.c"
+    break;
+
+  case 41: /* opt_private: PRIVATE  */
+#line 305 "parser.y"
+                { (yyval.type) = C_STATIC | C_PRIVATE; }
+#line 2039 "y.tab.c"
+    break;
+
+  case 42: /* non_private: STATIC  */
+#line 310 "parser.y"
+                { (yyval.type) = C_STATIC; }
+#line 2045 "y.tab.c"
+    break;
+
+  case 43: /* non_private: ATOMIC  */
+#line 312 "parser.y"
+                { (yyval.type) = C_ATOMIC; }
+#line 2051 "y.tab.c"
+    break;
+
+  case 44: /* non_private: NOMASK  */
+#line 314 "parser.y"
+                { (yyval.type) = C_NOMASK; }
+#line 2057 "y.tab.c"
+    break;
+
+  case 45: /* non_private: VARARGS  */
+#line 316 "parser.y"
+                { (yyval.type) = C_VARARGS; }
+#line 2063 "y.tab.c"
+    break;
+
+  case 46: /* type_specifier: INT  */
+#line 320 "parser.y"
+                { (yyval.node) = node_type(T_INT, (String *) NULL); }
+#line 2069 "y.tab.c"
+    break;
+
+  case 47: /* type_specifier: FLOAT  */
+#line 321 "parser.y"
+                { (yyval.node) = node_type(T_FLOAT, (String *) NULL); }
+#line 2075 "y.tab.c"
+    break;
+
+  case 48: /* type_specifier: STRING  */
+#line 323 "parser.y"
+                { (yyval.node) = node_type(T_STRING, (String *) NULL); }
+#line 2081 "y.tab.c"
+    break;
+
+  case 49: /* type_specifier: OBJECT  */
+#line 325 "parser.y"
+                { (yyval.node) = node_type(T_OBJECT, (String *) NULL); }
+#line 2087 "y.tab.c"
+    break;
+
+  case 50: /* type_specifier: OBJECT composite_string  */
+#line 327 "parser.y"
+                { (yyval.node) = node_type(T_CLASS, c_objecttype((yyvsp[0].node))); }
+#line 2093 "y.tab.c"
+    break;
+
+  case 51: /* type_specifier: MAPPING  */
+#line 329 "parser.y"
+                { (yyval.node) = node_type(T_MAPPING, (String *) NULL); }
+#line 2099 "y.tab.c"
+    break;
+
+  case 52: /* type_specifier: FUNCTION  */
+#line 331 "parser.y"
+                {
+		  (yyval.node) = node_str(str_new("/" BIPREFIX "function",
+					BIPREFIXLEN + 9));
+		  (yyval.node) = node_type(T_CLASS, c_objecttype((yyval.node)));
+		}
+#line 2109 "y.tab.c"
+    break;
+
+  case 53: /* type_specifier: MIXED  */
+#line 336 "parser.y"
+                { (yyval.node) = node_type(T_MIXED, (String *) NULL); }
+#line 2115 "y.tab.c"
+    break;
+
+  case 54: /* type_specifier: VOID  */
+#line 337 "parser.y"
+                { (yyval.node) = node_type(T_VOID, (String *) NULL); }
+#line 2121 "y.tab.c"
+    break;
+
+  case 57: /* star_list: %empty  */
+#line 347 "parser.y"
+                { (yyval.type) = 0; }
+#line 2127 "y.tab.c"
+    break;
+
+  case 58: /* star_list: star_list '*'  */
+#line 349 "parser.y"
+                {
+		  (yyval.type) = (yyvsp[-1].type) + 1;
+		  if ((yyval.type) == 1 << (8 - REFSHIFT)) {
+		      c_error("too deep indirection");
+		  }
+		}
+#line 2138 "y.tab.c"
+    break;
+
+  case 59: /* data_dcltr: star_list ident  */
+#line 359 "parser.y"
+                {
+		  (yyval.node) = (yyvsp[0].node);
+		  (yyval.node)->mod = ((yyvsp[-1].type) << REFSHIFT) & T_REF;
+		}
+#line 2147 "y.tab.c"
+    break;
+
+  case 60: /* operator: OPERATOR '+'  */
+#line 367 "parser.y"
+                { (yyval.node) = node_op("+"); }
+#line 2153 "y.tab.c"
+    break;
+
+  case 61: /* operator: OPERATOR '-'  */
+#line 369 "parser.y"
+                { (yyval.node) = node_op("-"); }
+#line 2159 "y.tab.c"
+    break;
+
+  case 62: /* operator: OPERATOR '*'  */
+#line 371 "parser.y"
+                { (yyval.node) = node_op("*"); }
+#line 2165 "y.tab.c"
+    break;
+
+  case 63: /* operator: OPERATOR '/'  */
+#line 373 "parser.y"
+                { (yyval.node) = node_op("/"); }
+#line 2171 "y.tab.c"
+    break;
+
+  case 64: /* operator: OPERATOR '%'  */
+#line 375 "parser.y"
+                { (yyval.node) = node_op("%"); }
+#line 2177 "y.tab.c"
+    break;
+
+  case 65: /* operator: OPERATOR '&'  */
+#line 377 "parser.y"
+                { (yyval.node) = node_op("&"); }
+#line 2183 "y.tab.c"
+    break;
+
+  case 66: /* operator: OPERATOR '^'  */
+#line 379 "parser.y"
+                { (yyval.node) = node_op("^"); }
+#line 2189 "y.tab.c"
+    break;
+
+  case 67: /* operator: OPERATOR '|'  */
+#line 381 "parser.y"
+                { (yyval.node) = node_op("|"); }
+#line 2195 "y.tab.c"
+    break;
+
+  case 68: /* operator: OPERATOR '<'  */
+#line 383 "parser.y"
+                { (yyval.node) = node_op("<"); }
+#line 2201 "y.tab.c"
+    break;
+
+  case 69: /* operator: OPERATOR '>'  */
+#line 385 "parser.y"
+                { (yyval.node) = node_op(">"); }
+#line 2207 "y.tab.c"
+    break;
+
+  case 70: /* operator: OPERATOR LE  */
+#line 387 "parser.y"
+                { (yyval.node) = node_op("<="); }
+#line 2213 "y.tab.c"
+    break;
+
+  case 71: /* operator: OPERATOR GE  */
+#line 389 "parser.y"
+                { (yyval.node) = node_op(">="); }
+#line 2219 "y.tab.c"
+    break;
+
+  case 72: /* operator: OPERATOR LSHIFT  */
+#line 391 "parser.y"
+                { (yyval.node) = node_op("<<"); }
+#line 2225 "y.tab.c"
+    break;
+
+  case 73: /* operator: OPERATOR RSHIFT  */
+#line 393 "parser.y"
+                { (yyval.node) = node_op(">>"); }
+#line 2231 "y.tab.c"
+    break;
+
+  case 74: /* operator: OPERATOR '~'  */
+#line 395 "parser.y"
+                { (yyval.node) = node_op("~"); }
+#line 2237 "y.tab.c"
+    break;
+
+  case 75: /* operator: OPERATOR PLUS_PLUS  */
+#line 397 "parser.y"
+                { (yyval.node) = node_op("++"); }
+#line 2243 "y.tab.c"
+    break;
+
+  case 76: /* operator: OPERATOR MIN_MIN  */
+#line 399 "parser.y"
+                { (yyval.node) = node_op("--"); }
+#line 2249 "y.tab.c"
+    break;
+
+  case 77: /* operator: OPERATOR '[' ']'  */
+#line 401 "parser.y"
+                { (yyval.node) = node_op("[]"); }
+#line 2255 "y.tab.c"
+    break;
+
+  case 78: /* operator: OPERATOR '[' ']' '='  */
+#line 403 "parser.y"
+                { (yyval.node) = node_op("[]="); }
+#line 2261 "y.tab.c"
+    break;
+
+  case 79: /* operator: OPERATOR '[' DOT_DOT ']'  */
+#line 405 "parser.y"
+                { (yyval.node) = node_op("[..]"); }
+#line 2267 "y.tab.c"
+    break;
+
+  case 82: /* function_dcltr: star_list function_name '(' formals_declaration ')'  */
+#line 415 "parser.y"
+                { (yyval.node) = node_bin(N_FUNC, ((yyvsp[-4].type) << REFSHIFT) & T_REF, (yyvsp[-3].node), (yyvsp[-1].node)); }
+#line 2273 "y.tab.c"
+    break;
+
+  case 86: /* list_dcltr: list_dcltr ',' dcltr  */
+#line 426 "parser.y"
+                { (yyval.node) = node_bin(N_PAIR, 0, (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 2279 "y.tab.c"
+    break;
+
+  case 87: /* dcltr_or_stmt_list: %empty  */
+#line 431 "parser.y"
+                { (yyval.node) = (node *) NULL; }
+#line 2285 "y.tab.c"
+    break;
+
+  case 88: /* dcltr_or_stmt_list: dcltr_or_stmt_list dcltr_or_stmt  */
+#line 433 "parser.y"
+                { (yyval.node) = c_concat((yyvsp[-1].node), (yyvsp[0].node)); }
+#line 2291 "y.tab.c"
+    break;
+
+  case 89: /* dcltr_or_stmt: local_data_declaration  */
+#line 438 "parser.y"
+                {
+		  if (nstatements > 0) {
+		      c_error("declaration after statement");
+		  }
+		  (yyval.node) = (node *) NULL;
+		}
+#line 2302 "y.tab.c"
+    break;
+
+  case 90: /* dcltr_or_stmt: stmt  */
+#line 444 "parser.y"
+                {
+		  nstatements++;
+		  (yyval.node) = (yyvsp[0].node);
+		}
+#line 2311 "y.tab.c"
+    break;
+
+  case 91: /* dcltr_or_stmt: error ';'  */
+#line 449 "parser.y"
+                {
+		  if (nerrors >= MAX_ERRORS) {
+		      YYABORT;
+		  }
+		  (yyval.node) = (node *) NULL;
+		}
+#line 2322 "y.tab.c"
+    break;
+
+  case 92: /* $@4: %empty  */
+#line 459 "parser.y"
+                { c_startcond(); }
+#line 2328 "y.tab.c"
+    break;
+
+  case 93: /* if_stmt: IF '(' f_list_exp ')' $@4 stmt  */
+#line 460 "parser.y"
+                { (yyval.node) = c_if((yyvsp[-3].node), (yyvsp[0].node)); }
+#line 2334 "y.tab.c"
+    break;
+
+  case 94: /* stmt: list_exp ';'  */
+#line 465 "parser.y"
+                { (yyval.node) = c_exp_stmt((yyvsp[-1].node)); }
+#line 2340 "y.tab.c"
+    break;
+
+  case 96: /* stmt: if_stmt  */
+#line 468 "parser.y"
+                {
+		  c_endcond();
+		  (yyval.node) = c_endif((yyvsp[0].node), (node *) NULL);
+		}
+#line 2349 "y.tab.c"
+    break;
+
+  case 97: /* $@5: %empty  */
+#line 474 "parser.y"
+                { c_startcond2(); }
+#line 2355 "y.tab.c"
+    break;
+
+  case 98: /* stmt: if_stmt ELSE $@5 stmt  */
+#line 476 "parser.y"
+                {
+		  c_matchcond();
+		  (yyval.node) = c_endif((yyvsp[-3].node), (yyvsp[0].node));
+		}
+#line 2364 "y.tab.c"
+    break;
+
+  case 99: /* $@6: %empty  */
+#line 480 "parser.y"
+                { c_loop(); }
+#line 2370 "y.tab.c"
+    break;
+
+  case 100: /* stmt: DO $@6 stmt WHILE '(' f_list_exp ')' ';'  */
+#line 482 "parser.y"
+                { (yyval.node) = c_do((yyvsp[-2].node), (yyvsp[-5].node)); }
+#line 2376 "y.tab.c"
+    break;
+
+  case 101: /* $@7: %empty  */
+#line 484 "parser.y"
+                {
+		  c_loop();
+		  c_startcond();
+		}
+#line 2385 "y.tab.c"
+    break;
+
+  case 102: /* stmt: WHILE '(' f_list_exp ')' $@7 stmt  */
+#line 488 "parser.y"
+                {
+		  c_endcond();
+		  (yyval.node) = c_while((yyvsp[-3].node), (yyvsp[0].node));
+		}
+#line 2394 "y.tab.c"
+    break;
+
+  case 103: /* $@8: %empty  */
+#line 493 "parser.y"
+                {
+		  c_loop();
+		  c_startcond();
+		}
+#line 2403 "y.tab.c"
+    break;
+
+  case 104: /* stmt: FOR '(' opt_list_exp ';' f_opt_list_exp ';' opt_list_exp ')' $@8 stmt  */
+#line 497 "parser.y"
+                {
+		  c_endcond();
+		  (yyval.node) = c_for(c_exp_stmt((yyvsp[-7].node)), (yyvsp[-5].node), c_exp_stmt((yyvsp[-3].node)), (yyvsp[0].node));
+		}
+#line 2412 "y.tab.c"
+    break;
+
+  case 105: /* $@9: %empty  */
+#line 502 "parser.y"
+                {
+		  if (typechecking) {
+		      char tnbuf[TNBUFSIZE];
+
+		      if ((yyvsp[-3].node)->mod != T_INT && (yyvsp[-3].node)->mod != T_MIXED) {
+			  c_error("bad type for stack rlimit (%s)",
+				  i_typename(tnbuf, (yyvsp[-3].node)->mod));
+		      }
+		      if ((yyvsp[-1].node)->mod != T_INT && (yyvsp[-1].node)->mod != T_MIXED) {
+			  c_error("bad type for ticks rlimit (%s)",
+				  i_typename(tnbuf, (yyvsp[-1].node)->mod));
+		      }
+		  }
+		  c_startrlimits();
+		}
+#line 2432 "y.tab.c"
+    break;
+
+  case 106: /* stmt: RLIMITS '(' f_list_exp ';' f_list_exp ')' $@9 compound_stmt  */
+#line 518 "parser.y"
+                { (yyval.node) = c_endrlimits((yyvsp[-5].node), (yyvsp[-3].node), (yyvsp[0].node)); }
+#line 2438 "y.tab.c"
+    break;
+
+  case 107: /* $@10: %empty  */
+#line 519 "parser.y"
+                {
+		  c_startcatch();
+		  c_startcond();
+		}
+#line 2447 "y.tab.c"
+    break;
+
+  case 108: /* $@11: %empty  */
+#line 524 "parser.y"
+                {
+		  c_endcond();
+		  c_endcatch();
+		  c_startcond();
+		}
+#line 2457 "y.tab.c"
+    break;
+
+  case 109: /* stmt: CATCH $@10 compound_stmt $@11 opt_caught_stmt  */
+#line 530 "parser.y"
+                {
+		  c_endcond();
+		  (yyval.node) = c_donecatch((yyvsp[-2].node), (yyvsp[0].node));
+		}
+#line 2466 "y.tab.c"
+    break;
+
+  case 110: /* $@12: %empty  */
+#line 535 "parser.y"
+                {
+		  c_startswitch((yyvsp[-1].node), typechecking);
+		  c_startcond();
+		}
+#line 2475 "y.tab.c"
+    break;
+
+  case 111: /* stmt: SWITCH '(' f_list_exp ')' $@12 compound_stmt  */
+#line 540 "parser.y"
+                {
+		  c_endcond();
+		  (yyval.node) = c_endswitch((yyvsp[-3].node), (yyvsp[0].node));
+		}
+#line 2484 "y.tab.c"
+    break;
+
+  case 112: /* $@13: %empty  */
+#line 545 "parser.y"
+                { (yyvsp[-1].node) = c_case((yyvsp[-1].node), (node *) NULL); }
+#line 2490 "y.tab.c"
+    break;
+
+  case 113: /* stmt: CASE exp ':' $@13 stmt  */
+#line 546 "parser.y"
+                {
+		  (yyval.node) = (yyvsp[-3].node);
+		  if ((yyval.node) != (node *) NULL) {
+		      (yyval.node)->l.left = (yyvsp[0].node);
+		  } else {
+		      (yyval.node) = (yyvsp[0].node);
+		  }
+		}
+#line 2503 "y.tab.c"
+    break;
+
+  case 114: /* $@14: %empty  */
+#line 555 "parser.y"
+                { (yyvsp[-3].node) = c_case((yyvsp[-3].node), (yyvsp[-1].node)); }
+#line 2509 "y.tab.c"
+    break;
+
+  case 115: /* stmt: CASE exp DOT_DOT exp ':' $@14 stmt  */
+#line 556 "parser.y"
+                {
+		  (yyval.node) = (yyvsp[-5].node);
+		  if ((yyval.node) != (node *) NULL) {
+		      (yyval.node)->l.left = (yyvsp[0].node);
+		  } else {
+		      (yyval.node) = (yyvsp[0].node);
+		  }
+		}
+#line 2522 "y.tab.c"
+    break;
+
+  case 116: /* $@15: %empty  */
+#line 565 "parser.y"
+                { (yyvsp[0].node) = c_default(); }
+#line 2528 "y.tab.c"
+    break;
+
+  case 117: /* stmt: DEFAULT ':' $@15 stmt  */
+#line 566 "parser.y"
+                {
+		  (yyval.node) = (yyvsp[-2].node);
+		  if ((yyval.node) != (node *) NULL) {
+		      (yyval.node)->l.left = (yyvsp[0].node);
+		  } else {
+		      (yyval.node) = (yyvsp[0].node);
+		  }
+		}
+#line 2541 "y.tab.c"
+    break;
+
+  case 118: /* $@16: %empty  */
+#line 575 "parser.y"
+                { (yyvsp[0].node) = c_label((yyvsp[-1].node)); }
+#line 2547 "y.tab.c"
+    break;
+
+  case 119: /* stmt: ident ':' $@16 stmt  */
+#line 576 "parser.y"
+                { (yyval.node) = c_concat((yyvsp[-2].node), (yyvsp[0].node)); }
+#line 2553 "y.tab.c"
+    break;
+
+  case 120: /* stmt: GOTO ident ';'  */
+#line 578 "parser.y"
+                {
+		  (yyval.node) = c_goto((yyvsp[-1].node));
+		}
+#line 2561 "y.tab.c"
+    break;
+
+  case 121: /* stmt: BREAK ';'  */
+#line 582 "parser.y"
+                {
+		  (yyval.node) = c_break();
+		}
+#line 2569 "y.tab.c"
+    break;
+
+  case 122: /* stmt: CONTINUE ';'  */
+#line 586 "parser.y"
+                {
+		  (yyval.node) = c_continue();
+		}
+#line 2577 "y.tab.c"
+    break;
+
+  case 123: /* stmt: RETURN f_opt_list_exp ';'  */
+#line 590 "parser.y"
+                { (yyval.node) = c_return((yyvsp[-1].node), typechecking); }
+#line 2583 "y.tab.c"
+    break;
+
+  case 124: /* stmt: ';'  */
+#line 591 "parser.y"
+                { (yyval.node) = (node *) NULL; }
+#line 2589 "y.tab.c"
+    break;
+
+  case 125: /* $@17: %empty  */
+#line 595 "parser.y"
+                {
+		  nstatements = 0;
+		  c_startcompound();
+		}
+#line 2598 "y.tab.c"
+    break;
+
+  case 126: /* compound_stmt: '{' $@17 dcltr_or_stmt_list '}'  */
+#line 600 "parser.y"
+                {
+		  nstatements++;
+		  (yyval.node) = c_endcompound((yyvsp[-1].node));
+		}
+#line 2607 "y.tab.c"
+    break;
+
+  case 127: /* opt_caught_stmt: %empty  */
+#line 608 "parser.y"
+                { (yyval.node) = (node *) NULL; }
+#line 2613 "y.tab.c"
+    break;
+
+  case 128: /* opt_caught_stmt: ':' stmt  */
+#line 610 "parser.y"
+                { (yyval.node) = (yyvsp[0].node); }
+#line 2619 "y.tab.c"
+    break;
+
+  case 129: /* function_call: function_name  */
+#line 615 "parser.y"
+                { (yyval.node) = c_flookup((yyvsp[0].node), typechecking); }
+#line 2625 "y.tab.c"
+    break;
+
+  case 130: /* function_call: COLON_COLON function_name  */
+#line 617 "parser.y"
+                { (yyval.node) = c_iflookup((yyvsp[0].node), (node *) NULL); }
+#line 2631 "y.tab.c"
+    break;
+
+  case 131: /* function_call: function_name COLON_COLON function_name  */
+#line 619 "parser.y"
+                { (yyval.node) = c_iflookup((yyvsp[0].node), (yyvsp[-2].node)); }
+#line 2637 "y.tab.c"
+    break;
+
+  case 132: /* primary_p1_exp: INT_CONST  */
+#line 624 "parser.y"
+                { (yyval.node) = node_int((yyvsp[0].number)); }
+#line 2643 "y.tab.c"
+    break;
+
+  case 133: /* primary_p1_exp: FLOAT_CONST  */
+#line 626 "parser.y"
+                { (yyval.node) = node_float(&(yyvsp[0].real)); }
+#line 2649 "y.tab.c"
+    break;
+
+  case 134: /* primary_p1_exp: NIL  */
+#line 627 "parser.y"
+                { (yyval.node) = node_nil(); }
+#line 2655 "y.tab.c"
+    break;
+
+  case 136: /* primary_p1_exp: '(' '{' opt_arg_list_comma '}' ')'  */
+#line 630 "parser.y"
+                { (yyval.node) = c_aggregate((yyvsp[-2].node), T_MIXED | (1 << REFSHIFT)); }
+#line 2661 "y.tab.c"
+    break;
+
+  case 137: /* primary_p1_exp: '(' '[' opt_assoc_arg_list_comma ']' ')'  */
+#line 632 "parser.y"
+                { (yyval.node) = c_aggregate((yyvsp[-2].node), T_MAPPING); }
+#line 2667 "y.tab.c"
+    break;
+
+  case 138: /* primary_p1_exp: ident  */
+#line 633 "parser.y"
+                {
+		  (yyval.node) = c_local_var((yyvsp[0].node));
+		  if ((yyval.node) == (node *) NULL) {
+		      (yyval.node) = c_global_var((yyvsp[0].node));
+		      if (typechecking) {
+			  if ((yyval.node)->mod != T_MIXED && !conf_typechecking()) {
+			      /*
+			       * global vars might be modified by untypechecked
+			       * functions...
+			       */
+			      (yyval.node) = node_mon(N_CAST, (yyval.node)->mod, (yyval.node));
+			      (yyval.node)->sclass = (yyval.node)->l.left->sclass;
+			      if ((yyval.node)->sclass != (String *) NULL) {
+				  str_ref((yyval.node)->sclass);
+			      }
+			  }
+		      }
+		  }
+		  if (!typechecking) {
+		      /* the variable could be anything */
+		      (yyval.node)->mod = T_MIXED;
+		  }
+		}
+#line 2695 "y.tab.c"
+    break;
+
+  case 139: /* primary_p1_exp: COLON_COLON ident  */
+#line 656 "parser.y"
+                            {
+		  (yyval.node) = c_global_var((yyvsp[0].node));
+		  if (typechecking) {
+		      if ((yyval.node)->mod != T_MIXED && !conf_typechecking()) {
+			  /*
+			   * global vars might be modified by untypechecked
+			   * functions...
+			   */
+			  (yyval.node) = node_mon(N_CAST, (yyval.node)->mod, (yyval.node));
+			  (yyval.node)->sclass = (yyval.node)->l.left->sclass;
+			  if ((yyval.node)->sclass != (String *) NULL) {
+			      str_ref((yyval.node)->sclass);
+			  }
+		      }
+		  } else {
+		      /* the variable could be anything */
+		      (yyval.node)->mod = T_MIXED;
+		  }
+		}
+#line 2719 "y.tab.c"
+    break;
+
+  case 140: /* primary_p1_exp: '(' list_exp ')'  */
+#line 676 "parser.y"
+                { (yyval.node) = (yyvsp[-1].node); }
+#line 2725 "y.tab.c"
+    break;
+
+  case 141: /* primary_p1_exp: function_call '(' opt_arg_list ')'  */
+#line 678 "parser.y"
+                { (yyval.node) = c_checkcall(c_funcall((yyvsp[-3].node), (yyvsp[-1].node)), typechecking); }
+#line 2731 "y.tab.c"
+    break;
+
+  case 142: /* primary_p1_exp: '&' ident '(' opt_arg_list ')'  */
+#line 680 "parser.y"
+                { (yyval.node) = c_address((yyvsp[-3].node), (yyvsp[-1].node), typechecking); }
+#line 2737 "y.tab.c"
+    break;
+
+  case 143: /* primary_p1_exp: '&' '(' '*' cast_exp ')' '(' opt_arg_list ')'  */
+#line 682 "parser.y"
+                { (yyval.node) = c_extend((yyvsp[-4].node), (yyvsp[-1].node), typechecking); }
+#line 2743 "y.tab.c"
+    break;
+
+  case 144: /* primary_p1_exp: '(' '*' cast_exp ')' '(' opt_arg_list ')'  */
+#line 684 "parser.y"
+                { (yyval.node) = c_call((yyvsp[-4].node), (yyvsp[-1].node), typechecking); }
+#line 2749 "y.tab.c"
+    break;
+
+  case 145: /* $@18: %empty  */
+#line 686 "parser.y"
+                { c_startcond(); }
+#line 2755 "y.tab.c"
+    break;
+
+  case 146: /* primary_p1_exp: CATCH '(' $@18 list_exp ')'  */
+#line 688 "parser.y"
+                {
+		  c_endcond();
+		  (yyval.node) = node_mon(N_CATCH, T_STRING, (yyvsp[-1].node));
+		}
+#line 2764 "y.tab.c"
+    break;
+
+  case 147: /* primary_p1_exp: NEW opt_object string_exp  */
+#line 693 "parser.y"
+                { (yyval.node) = c_new_object((yyvsp[0].node), (node *) NULL); }
+#line 2770 "y.tab.c"
+    break;
+
+  case 148: /* primary_p1_exp: NEW opt_object string_exp '(' opt_arg_list ')'  */
+#line 695 "parser.y"
+                { (yyval.node) = c_new_object((yyvsp[-3].node), (yyvsp[-1].node)); }
+#line 2776 "y.tab.c"
+    break;
+
+  case 149: /* primary_p1_exp: primary_p2_exp RARROW ident '(' opt_arg_list ')'  */
+#line 697 "parser.y"
+                {
+		  t_void((yyvsp[-5].node));
+		  (yyval.node) = c_checkcall(c_arrow((yyvsp[-5].node), (yyvsp[-3].node), (yyvsp[-1].node)), typechecking);
+		}
+#line 2785 "y.tab.c"
+    break;
+
+  case 150: /* primary_p1_exp: primary_p2_exp LARROW opt_object string_exp  */
+#line 702 "parser.y"
+                { (yyval.node) = c_instanceof((yyvsp[-3].node), (yyvsp[0].node)); }
+#line 2791 "y.tab.c"
+    break;
+
+  case 152: /* primary_p2_exp: primary_p2_exp '[' f_list_exp ']'  */
+#line 708 "parser.y"
+                { (yyval.node) = idx((yyvsp[-3].node), (yyvsp[-1].node)); }
+#line 2797 "y.tab.c"
+    break;
+
+  case 153: /* primary_p2_exp: primary_p2_exp '[' f_opt_list_exp DOT_DOT f_opt_list_exp ']'  */
+#line 710 "parser.y"
+                { (yyval.node) = range((yyvsp[-5].node), (yyvsp[-3].node), (yyvsp[-1].node)); }
+#line 2803 "y.tab.c"
+    break;
+
+  case 155: /* postfix_exp: postfix_exp PLUS_PLUS  */
+#line 716 "parser.y"
+                { (yyval.node) = postfix(N_PLUS_PLUS, (yyvsp[-1].node), "++"); }
+#line 2809 "y.tab.c"
+    break;
+
+  case 156: /* postfix_exp: postfix_exp MIN_MIN  */
+#line 718 "parser.y"
+                { (yyval.node) = postfix(N_MIN_MIN, (yyvsp[-1].node), "--"); }
+#line 2815 "y.tab.c"
+    break;
+
+  case 158: /* prefix_exp: PLUS_PLUS cast_exp  */
+#line 724 "parser.y"
+                { (yyval.node) = prefix(N_ADD_EQ_1, (yyvsp[0].node), "++"); }
+#line 2821 "y.tab.c"
+    break;
+
+  case 159: /* prefix_exp: MIN_MIN cast_exp  */
+#line 726 "parser.y"
+                { (yyval.node) = prefix(N_SUB_EQ_1, (yyvsp[0].node), "--"); }
+#line 2827 "y.tab.c"
+    break;
+
+  case 160: /* prefix_exp: '-' cast_exp  */
+#line 728 "parser.y"
+                { (yyval.node) = umin((yyvsp[0].node)); }
+#line 2833 "y.tab.c"
+    break;
+
+  case 161: /* prefix_exp: '+' cast_exp  */
+#line 730 "parser.y"
+                { (yyval.node) = (yyvsp[0].node); }
+#line 2839 "y.tab.c"
+    break;
+
+  case 162: /* prefix_exp: '!' cast_exp  */
+#line 732 "parser.y"
+                {
+		  t_void((yyvsp[0].node));
+		  (yyval.node) = c_not((yyvsp[0].node));
+		}
+#line 2848 "y.tab.c"
+    break;
+
+  case 163: /* prefix_exp: '~' cast_exp  */
+#line 737 "parser.y"
+                {
+		  (yyval.node) = (yyvsp[0].node);
+		  t_void((yyval.node));
+		  if ((yyval.node)->mod == T_INT) {
+		      (yyval.node) = _xor(N_XOR, (yyval.node), node_int((Int) -1), "^");
+		  } else if ((yyval.node)->mod == T_OBJECT || (yyval.node)->mod == T_CLASS) {
+		      (yyval.node) = node_mon(N_NEG, T_OBJECT, (yyval.node));
+		  } else {
+		      if (typechecking && (yyval.node)->mod != T_MIXED) {
+			  char tnbuf[TNBUFSIZE];
+
+			  c_error("bad argument type for ~ (%s)",
+				  i_typename(tnbuf, (yyval.node)->mod));
+		      }
+		      (yyval.node) = node_mon(N_NEG, T_MIXED, (yyval.node));
+		  }
+		}
+#line 2870 "y.tab.c"
+    break;
+
+  case 165: /* cast_exp: '(' type_specifier star_list ')' cast_exp  */
+#line 759 "parser.y"
+                {
+		  (yyvsp[-3].node)->mod |= ((yyvsp[-2].type) << REFSHIFT) & T_REF;
+		  (yyval.node) = cast((yyvsp[0].node), (yyvsp[-3].node));
+		}
+#line 2879 "y.tab.c"
+    break;
+
+  case 167: /* mult_oper_exp: mult_oper_exp '*' cast_exp  */
+#line 768 "parser.y"
+                { (yyval.node) = mult(N_MULT, (yyvsp[-2].node), (yyvsp[0].node), "*"); }
+#line 2885 "y.tab.c"
+    break;
+
+  case 168: /* mult_oper_exp: mult_oper_exp '/' cast_exp  */
+#line 770 "parser.y"
+                { (yyval.node) = mdiv(N_DIV, (yyvsp[-2].node), (yyvsp[0].node), "/"); }
+#line 2891 "y.tab.c"
+    break;
+
+  case 169: /* mult_oper_exp: mult_oper_exp '%' cast_exp  */
+#line 772 "parser.y"
+                { (yyval.node) = mod(N_MOD, (yyvsp[-2].node), (yyvsp[0].node), "%"); }
+#line 2897 "y.tab.c"
+    break;
+
+  case 171: /* add_oper_exp: add_oper_exp '+' mult_oper_exp  */
+#line 778 "parser.y"
+                { (yyval.node) = add(N_ADD, (yyvsp[-2].node), (yyvsp[0].node), "+"); }
+#line 2903 "y.tab.c"
+    break;
+
+  case 172: /* add_oper_exp: add_oper_exp '-' mult_oper_exp  */
+#line 780 "parser.y"
+                { (yyval.node) = sub(N_SUB, (yyvsp[-2].node), (yyvsp[0].node), "-"); }
+#line 2909 "y.tab.c"
+    break;
+
+  case 174: /* shift_oper_exp: shift_oper_exp LSHIFT add_oper_exp  */
+#line 786 "parser.y"
+                { (yyval.node) = lshift(N_LSHIFT, (yyvsp[-2].node), (yyvsp[0].node), "<<"); }
+#line 2915 "y.tab.c"
+    break;
+
+  case 175: /* shift_oper_exp: shift_oper_exp RSHIFT add_oper_exp  */
+#line 788 "parser.y"
+                { (yyval.node) = rshift(N_RSHIFT, (yyvsp[-2].node), (yyvsp[0].node), ">>"); }
+#line 2921 "y.tab.c"
+    break;
+
+  case 177: /* rel_oper_exp: rel_oper_exp '<' shift_oper_exp  */
+#line 794 "parser.y"
+                { (yyval.node) = rel(N_LT, (yyval.node), (yyvsp[0].node), "<"); }
+#line 2927 "y.tab.c"
+    break;
+
+  case 178: /* rel_oper_exp: rel_oper_exp '>' shift_oper_exp  */
+#line 796 "parser.y"
+                { (yyval.node) = rel(N_GT, (yyval.node), (yyvsp[0].node), ">"); }
+#line 2933 "y.tab.c"
+    break;
+
+  case 179: /* rel_oper_exp: rel_oper_exp LE shift_oper_exp  */
+#line 798 "parser.y"
+                { (yyval.node) = rel(N_LE, (yyval.node), (yyvsp[0].node), "<="); }
+#line 2939 "y.tab.c"
+    break;
+
+  case 180: /* rel_oper_exp: rel_oper_exp GE shift_oper_exp  */
+#line 800 "parser.y"
+                { (yyval.node) = rel(N_GE, (yyval.node), (yyvsp[0].node), ">="); }
+#line 2945 "y.tab.c"
+    break;
+
+  case 182: /* equ_oper_exp: equ_oper_exp EQ rel_oper_exp  */
+#line 806 "parser.y"
+                { (yyval.node) = eq((yyvsp[-2].node), (yyvsp[0].node)); }
+#line 2951 "y.tab.c"
+    break;
+
+  case 183: /* equ_oper_exp: equ_oper_exp NE rel_oper_exp  */
+#line 808 "parser.y"
+                { (yyval.node) = c_not(eq((yyvsp[-2].node), (yyvsp[0].node))); }
+#line 2957 "y.tab.c"
+    break;
+
+  case 185: /* bitand_oper_exp: bitand_oper_exp '&' equ_oper_exp  */
+#line 814 "parser.y"
+                { (yyval.node) = _and(N_AND, (yyvsp[-2].node), (yyvsp[0].node), "&"); }
+#line 2963 "y.tab.c"
+    break;
+
+  case 187: /* bitxor_oper_exp: bitxor_oper_exp '^' bitand_oper_exp  */
+#line 820 "parser.y"
+                { (yyval.node) = _xor(N_XOR, (yyvsp[-2].node), (yyvsp[0].node), "^"); }
+#line 2969 "y.tab.c"
+    break;
+
+  case 189: /* bitor_oper_exp: bitor_oper_exp '|' bitxor_oper_exp  */
+#line 826 "parser.y"
+                { (yyval.node) = _or(N_OR, (yyvsp[-2].node), (yyvsp[0].node), "|"); }
+#line 2975 "y.tab.c"
+    break;
+
+  case 191: /* and_oper_exp: and_oper_exp LAND bitor_oper_exp  */
+#line 832 "parser.y"
+                { (yyval.node) = land((yyvsp[-2].node), (yyvsp[0].node)); }
+#line 2981 "y.tab.c"
+    break;
+
+  case 193: /* or_oper_exp: or_oper_exp LOR and_oper_exp  */
+#line 838 "parser.y"
+                { (yyval.node) = lor((yyvsp[-2].node), (yyvsp[0].node)); }
+#line 2987 "y.tab.c"
+    break;
+
+  case 195: /* $@19: %empty  */
+#line 844 "parser.y"
+                { c_startcond(); }
+#line 2993 "y.tab.c"
+    break;
+
+  case 196: /* $@20: %empty  */
+#line 846 "parser.y"
+                { c_startcond2(); }
+#line 2999 "y.tab.c"
+    break;
+
+  case 197: /* cond_exp: or_oper_exp '?' $@19 list_exp ':' $@20 cond_exp  */
+#line 848 "parser.y"
+                {
+		  c_matchcond();
+		  (yyval.node) = quest((yyvsp[-6].node), (yyvsp[-3].node), (yyvsp[0].node));
+		}
+#line 3008 "y.tab.c"
+    break;
+
+  case 199: /* exp: cond_exp '=' exp  */
+#line 857 "parser.y"
+                { (yyval.node) = assign(c_assign((yyvsp[-2].node)), (yyvsp[0].node)); }
+#line 3014 "y.tab.c"
+    break;
+
+  case 200: /* exp: cond_exp PLUS_EQ exp  */
+#line 859 "parser.y"
+                { (yyval.node) = add(N_ADD_EQ, c_lvalue((yyvsp[-2].node), "+="), (yyvsp[0].node), "+="); }
+#line 3020 "y.tab.c"
+    break;
+
+  case 201: /* exp: cond_exp MIN_EQ exp  */
+#line 861 "parser.y"
+                { (yyval.node) = sub(N_SUB_EQ, c_lvalue((yyvsp[-2].node), "-="), (yyvsp[0].node), "-="); }
+#line 3026 "y.tab.c"
+    break;
+
+  case 202: /* exp: cond_exp MULT_EQ exp  */
+#line 863 "parser.y"
+                { (yyval.node) = mult(N_MULT_EQ, c_lvalue((yyvsp[-2].node), "*="), (yyvsp[0].node), "*="); }
+#line 3032 "y.tab.c"
+    break;
+
+  case 203: /* exp: cond_exp DIV_EQ exp  */
+#line 865 "parser.y"
+                { (yyval.node) = mdiv(N_DIV_EQ, c_lvalue((yyvsp[-2].node), "/="), (yyvsp[0].node), "/="); }
+#line 3038 "y.tab.c"
+    break;
+
+  case 204: /* exp: cond_exp MOD_EQ exp  */
+#line 867 "parser.y"
+                { (yyval.node) = mod(N_MOD_EQ, c_lvalue((yyvsp[-2].node), "%="), (yyvsp[0].node), "%="); }
+#line 3044 "y.tab.c"
+    break;
+
+  case 205: /* exp: cond_exp LSHIFT_EQ exp  */
+#line 869 "parser.y"
+                { (yyval.node) = lshift(N_LSHIFT_EQ, c_lvalue((yyvsp[-2].node), "<<="), (yyvsp[0].node), "<<="); }
+#line 3050 "y.tab.c"
+    break;
+
+  case 206: /* exp: cond_exp RSHIFT_EQ exp  */
+#line 871 "parser.y"
+                { (yyval.node) = rshift(N_RSHIFT_EQ, c_lvalue((yyvsp[-2].node), ">>="), (yyvsp[0].node), ">>="); }
+#line 3056 "y.tab.c"
+    break;
+
+  case 207: /* exp: cond_exp AND_EQ exp  */
+#line 873 "parser.y"
+                { (yyval.node) = _and(N_AND_EQ, c_lvalue((yyvsp[-2].node), "&="), (yyvsp[0].node), "&="); }
+#line 3062 "y.tab.c"
+    break;
+
+  case 208: /* exp: cond_exp XOR_EQ exp  */
+#line 875 "parser.y"
+                { (yyval.node) = _xor(N_XOR_EQ, c_lvalue((yyvsp[-2].node), "^="), (yyvsp[0].node), "^="); }
+#line 3068 "y.tab.c"
+    break;
+
+  case 209: /* exp: cond_exp OR_EQ exp  */
+#line 877 "parser.y"
+                { (yyval.node) = _or(N_OR_EQ, c_lvalue((yyvsp[-2].node), "|="), (yyvsp[0].node), "|="); }
+#line 3074 "y.tab.c"
+    break;
+
+  case 211: /* list_exp: list_exp ',' exp  */
+#line 883 "parser.y"
+                { (yyval.node) = comma((yyvsp[-2].node), (yyvsp[0].node)); }
+#line 3080 "y.tab.c"
+    break;
+
+  case 212: /* opt_list_exp: %empty  */
+#line 888 "parser.y"
+                { (yyval.node) = (node *) NULL; }
+#line 3086 "y.tab.c"
+    break;
+
+  case 214: /* f_list_exp: list_exp  */
+#line 894 "parser.y"
+                { t_void((yyval.node) = (yyvsp[0].node)); }
+#line 3092 "y.tab.c"
+    break;
+
+  case 215: /* f_opt_list_exp: opt_list_exp  */
+#line 899 "parser.y"
+                { t_void((yyval.node) = (yyvsp[0].node)); }
+#line 3098 "y.tab.c"
+    break;
+
+  case 216: /* arg_list: exp  */
+#line 903 "parser.y"
+                { t_void((yyval.node) = (yyvsp[0].node)); }
+#line 3104 "y.tab.c"
+    break;
+
+  case 217: /* arg_list: arg_list ',' exp  */
+#line 905 "parser.y"
+                {
+		  t_void((yyvsp[0].node));
+		  (yyval.node) = node_bin(N_PAIR, 0, (yyvsp[-2].node), (yyvsp[0].node));
+		}
+#line 3113 "y.tab.c"
+    break;
+
+  case 218: /* opt_arg_list: %empty  */
+#line 913 "parser.y"
+                { (yyval.node) = (node *) NULL; }
+#line 3119 "y.tab.c"
+    break;
+
+  case 220: /* opt_arg_list: arg_list ELLIPSIS  */
+#line 916 "parser.y"
+                {
+		  (yyval.node) = (yyvsp[-1].node);
+		  if ((yyval.node)->type == N_PAIR) {
+		      (yyval.node)->r.right = node_mon(N_SPREAD, -1, (yyval.node)->r.right);
+		  } else {
+		      (yyval.node) = node_mon(N_SPREAD, -1, (yyval.node));
+		  }
+		}
+#line 3132 "y.tab.c"
+    break;
+
+  case 221: /* opt_arg_list_comma: %empty  */
+#line 928 "parser.y"
+                { (yyval.node) = (node *) NULL; }
+#line 3138 "y.tab.c"
+    break;
+
+  case 223: /* opt_arg_list_comma: arg_list ','  */
+#line 931 "parser.y"
+                { (yyval.node) = (yyvsp[-1].node); }
+#line 3144 "y.tab.c"
+    break;
+
+  case 224: /* assoc_exp: exp ':' exp  */
+#line 936 "parser.y"
+                {
+		  t_void((yyvsp[-2].node));
+		  t_void((yyvsp[0].node));
+		  (yyval.node) = node_bin(N_COMMA, 0, (yyvsp[-2].node), (yyvsp[0].node));
+		}
+#line 3154 "y.tab.c"
+    break;
+
+  case 226: /* assoc_arg_list: assoc_arg_list ',' assoc_exp  */
+#line 946 "parser.y"
+                { (yyval.node) = node_bin(N_PAIR, 0, (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 3160 "y.tab.c"
+    break;
+
+  case 227: /* opt_assoc_arg_list_comma: %empty  */
+#line 951 "parser.y"
+                { (yyval.node) = (node *) NULL; }
+#line 3166 "y.tab.c"
+    break;
+
+  case 229: /* opt_assoc_arg_list_comma: assoc_arg_list ','  */
+#line 954 "parser.y"
+                { (yyval.node) = (yyvsp[-1].node); }
+#line 3172 "y.tab.c"
+    break;
+
+
+#line 3176 "y.tab.c"
+
+      default: break;
+    }
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
+
+  YYPOPSTACK (yylen);
+  yylen = 0;
+
+  *++yyvsp = yyval;
+
+  /* Now 'shift' the result of the reduction.  Determine what state
+     that goes to, based on the state we popped back to and the rule
+     number reduced by.  */
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
+
+  goto yynewstate;
+
+
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
+yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
+  /* If not already recovering from an error, report this error.  */
+  if (!yyerrstatus)
+    {
+      ++yynerrs;
+      yyerror (YY_("syntax error"));
+    }
+
+  if (yyerrstatus == 3)
+    {
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
+
+      if (yychar <= YYEOF)
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
+      else
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval);
+          yychar = YYEMPTY;
+        }
+    }
+
+  /* Else will try to reuse lookahead token after shifting the error
+     token.  */
+  goto yyerrlab1;
+
+
+/*---------------------------------------------------.
+| yyerrorlab -- error raised explicitly by YYERROR.  |
+`---------------------------------------------------*/
+yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
+
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYERROR.  */
+  YYPOPSTACK (yylen);
+  yylen = 0;
+  YY_STACK_PRINT (yyss, yyssp);
+  yystate = *yyssp;
+  goto yyerrlab1;
+
+
+/*-------------------------------------------------------------.
+| yyerrlab1 -- common code for both syntax error and YYERROR.  |
+`-------------------------------------------------------------*/
+yyerrlab1:
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
+
+  /* Pop stack until we find a state that shifts the error token.  */
+  for (;;)
+    {
+      yyn = yypact[yystate];
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
+
+      /* Pop the current state because it cannot handle the error token.  */
+      if (yyssp == yyss)
+        YYABORT;
+
+
+      yydestruct ("Error: popping",
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp);
+      YYPOPSTACK (1);
+      yystate = *yyssp;
+      YY_STACK_PRINT (yyss, yyssp);
+    }
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+
+  /* Shift the error token.  */
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
+
+  yystate = yyn;
+  goto yynewstate;
+
+
+/*-------------------------------------.
+| yyacceptlab -- YYACCEPT comes here.  |
+`-------------------------------------*/
+yyacceptlab:
+  yyresult = 0;
+  goto yyreturnlab;
+
+
+/*-----------------------------------.
+| yyabortlab -- YYABORT comes here.  |
+`-----------------------------------*/
+yyabortlab:
+  yyresult = 1;
+  goto yyreturnlab;
+
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
+yyexhaustedlab:
+  yyerror (YY_("memory exhausted"));
+  yyresult = 2;
+  goto yyreturnlab;
+
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYABORT or YYACCEPT.  */
+  YYPOPSTACK (yylen);
+  YY_STACK_PRINT (yyss, yyssp);
+  while (yyssp != yyss)
+    {
+      yydestruct ("Cleanup: popping",
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp);
+      YYPOPSTACK (1);
+    }
+#ifndef yyoverflow
+  if (yyss != yyssa)
+    YYSTACK_FREE (yyss);
+#endif
+
+  return yyresult;
+}
+
+#line 957 "parser.y"
+
+
+/*
+ * NAME:	t_void()
+ * DESCRIPTION:	if the argument is of type void, an error will result
+ */
+static void t_void(node *n)
+{
+    if (n != (node *) NULL && n->mod == T_VOID) {
+	c_error("void value not ignored");
+	n->mod = T_MIXED;
+    }
+}
+
+/*
+ * NAME:	t_unary()
+ * DESCRIPTION:	typecheck the argument of a unary operator
+ */
+static bool t_unary(node *n, const char *name)
+{
+    char tnbuf[TNBUFSIZE];
+
+    t_void(n);
+    if (typechecking && !T_ARITHMETIC(n->mod) && n->mod != T_MIXED) {
+	c_error("bad argument type for %s (%s)", name,
+		i_typename(tnbuf, n->mod));
+	n->mod = T_MIXED;
+	return FALSE;
+    }
+    return TRUE;
+}
+
+/*
+ * NAME:	postfix()
+ * DESCRIPTION:	handle a postfix assignment operator
+ */
+static node *postfix(int op, node *n, const char *name)
+{
+    t_unary(n, name);
+    return node_mon((n->mod == T_INT) ? op + 1 : op, n->mod, c_lvalue(n, name));
+}
+
+/*
+ * NAME:	prefix()
+ * DESCRIPTION:	handle a prefix assignment operator
+ */
+static node *prefix(int op, node *n, const char *name)
+{
+    unsigned short type;
+
+    if (n->mod == T_OBJECT || n->mod == T_CLASS) {
+	type = T_OBJECT;
+    } else {
+	t_unary(n, name);
+	type = n->mod;
+    }
+    return node_mon(op, type, c_lvalue(n, name));
+}
+
+/*
+ * NAME:	cast()
+ * DESCRIPTION:	cast an expression to a type
+ */
+static node *cast(node *n, node *type)
+{
+    Float flt;
+    Int i;
+    char *p, buffer[18];
+
+    if (type->mod != n->mod) {
+	switch (type->mod) {
+	case T_INT:
+	    switch (n->type) {
+	    case N_FLOAT:
+		/* cast float constant to int */
+		NFLT_GET(n, flt);
+		return node_int(flt.ftoi());
+
+	    case N_STR:
+		/* cast string to int */
+		p = n->l.string->text;
+		i = strtoint(&p);
+		if (p == n->l.string->text + n->l.string->len) {
+		    return node_int(i);
+		} else {
+		    c_error("cast of invalid string constant");
+		    n->mod = T_MIXED;
+		}
+		break;
+
+	    case N_TOFLOAT:
+	    case N_TOSTRING:
+		if (n->l.left->type == N_INT) {
+		    /* (int) (float) i, (int) (string) i */
+		    return n->l.left;
+		}
+		/* fall through */
+	    default:
+		if (n->mod == T_FLOAT || n->mod == T_STRING ||
+		    n->mod == T_MIXED) {
+		    return node_mon(N_TOINT, T_INT, n);
+		}
+		break;
+	    }
+	    break;
+
+	case T_FLOAT:
+	    switch (n->type) {
+	    case N_INT:
+		/* cast int constant to float */
+		Float::itof(n->l.number, &flt);
+		return node_float(&flt);
+
+	    case N_STR:
+		/* cast string to float */
+		p = n->l.string->text;
+		if (Float::atof(&p, &flt) &&
+		    p == n->l.string->text + n->l.string->len) {
+		    return node_float(&flt);
+		} else {
+		    yyerror("cast of invalid string constant");
+		    n->mod = T_MIXED;
+		}
+		break;
+
+	    case N_TOSTRING:
+		if (n->l.left->mod == T_INT) {
+		    return node_mon(N_TOFLOAT, T_FLOAT, n->l.left);
+		}
+		/* fall through */
+	    default:
+		if (n->mod == T_INT || n->mod == T_STRING || n->mod == T_MIXED)
+		{
+		    return node_mon(N_TOFLOAT, T_FLOAT, n);
+		}
+		break;
+	    }
+	    break;
+
+	case T_STRING:
+	    switch (n->type) {
+	    case N_INT:
+		/* cast int constant to string */
+		sprintf(buffer, "%ld", (long) n->l.number);
+		return node_str(str_new(buffer, (long) strlen(buffer)));
+
+	    case N_FLOAT:
+		/* cast float constant to string */
+		NFLT_GET(n, flt);
+		flt.ftoa(buffer);
+		return node_str(str_new(buffer, (long) strlen(buffer)));
+
+	    default:
+		if (n->mod == T_INT || n->mod == T_FLOAT || n->mod == T_MIXED) {
+		    return node_mon(N_TOSTRING, T_STRING, n);
+		}
+		break;
+	    }
+	    break;
+	}
+
+	if (type->mod == T_MIXED || (type->mod & T_TYPE) == T_VOID) {
+	    /* (mixed), (void), (void *) */
+	    c_error("cannot cast to %s", i_typename(buffer, type->mod));
+	    n->mod = T_MIXED;
+	} else if ((type->mod & T_REF) < (n->mod & T_REF)) {
+	    /* (mixed *) of (mixed **) */
+	    c_error("illegal cast of array type (%s)",
+		    i_typename(buffer, n->mod));
+	} else if ((n->mod & T_TYPE) != T_MIXED &&
+		   ((type->mod & T_TYPE) != T_CLASS ||
+		    ((n->mod & T_TYPE) != T_OBJECT &&
+		     (n->mod & T_TYPE) != T_CLASS) ||
+		    (type->mod & T_REF) != (n->mod & T_REF))) {
+	    /* can only cast from mixed, or object/class to class */
+	    c_error("cast of invalid type (%s)", i_typename(buffer, n->mod));
+	} else {
+	    if ((type->mod & T_REF) == 0 || (n->mod & T_REF) == 0) {
+		/* runtime cast */
+		n = node_mon(N_CAST, type->mod, n);
+	    } else {
+		n->mod = type->mod;
+	    }
+	    n->sclass = type->sclass;
+	    if (n->sclass != (String *) NULL) {
+		str_ref(n->sclass);
+	    }
+	}
+    } else if (type->mod == T_CLASS && str_cmp(type->sclass, n->sclass) != 0) {
+	/*
+	 * cast to different object class
+	 */
+	n = node_mon(N_CAST, type->mod, n);
+	n->sclass = type->sclass;
+	if (n->sclass != (String *) NULL) {
+	    str_ref(n->sclass);
+	}
+    }
+    return n;
+}
+
+/*
+ * NAME:	idx()
+ * DESCRIPTION:	handle the [ ] operator
+ */
+static node *idx(node *n1, node *n2)
+{
+    char tnbuf[TNBUFSIZE];
+    unsigned short type;
+
+    if (n1->type == N_STR && n2->type == N_INT) {
+	/* str [ int ] */
+	if (n2->l.number < 0 || n2->l.number >= (Int) n1->l.string->len) {
+	    c_error("string index out of range");
+	} else {
+	    n2->l.number =
+		    UCHAR(n1->l.string->text[str_index(n1->l.string,
+						       (long) n2->l.number)]);
+	}
+	return n2;
+    }
+
+    if ((n1->mod & T_REF) != 0) {
+	/*
+	 * array
+	 */
+	if (typechecking) {
+	    type = n1->mod - (1 << REFSHIFT);
+	    if (n2->mod != T_INT && n2->mod != T_MIXED) {
+		c_error("bad index type (%s)", i_typename(tnbuf, n2->mod));
+	    }
+	    if (type != T_MIXED) {
+		/* you can't trust these arrays */
+		n2 = node_mon(N_CAST, type, node_bin(N_INDEX, type, n1, n2));
+		n2->sclass = n1->sclass;
+		if (n2->sclass != (String *) NULL) {
+		    str_ref(n2->sclass);
+		}
+		return n2;
+	    }
+	}
+	type = T_MIXED;
+    } else if (n1->mod == T_STRING) {
+	/*
+	 * string
+	 */
+	if (typechecking && n2->mod != T_INT && n2->mod != T_MIXED) {
+	    c_error("bad index type (%s)", i_typename(tnbuf, n2->mod));
+	}
+	type = T_INT;
+    } else {
+	if (typechecking && n1->mod != T_OBJECT && n1->mod != T_CLASS &&
+	    n1->mod != T_MAPPING && n1->mod != T_MIXED) {
+	    c_error("bad indexed type (%s)", i_typename(tnbuf, n1->mod));
+	}
+	type = T_MIXED;
+    }
+    return node_bin(N_INDEX, type, n1, n2);
+}
+
+/*
+ * NAME:	range()
+ * DESCRIPTION:	handle the [ .. ] operator
+ */
+static node *range(node *n1, node *n2, node *n3)
+{
+    unsigned short type;
+
+    if (n1->type == N_STR && (n2 == (node *) NULL || n2->type == N_INT) &&
+	(n3 == (node *) NULL || n3->type == N_INT)) {
+	Int from, to;
+
+	/* str [ int .. int ] */
+	from = (n2 == (node *) NULL) ? 0 : n2->l.number;
+	to = (n3 == (node *) NULL) ? n1->l.string->len - 1 : n3->l.number;
+	if (from < 0 || from > to + 1 || to >= n1->l.string->len) {
+	    c_error("invalid string range");
+	} else {
+	    return node_str(str_range(n1->l.string, (long) from, (long) to));
+	}
+    }
+
+    type = T_MIXED;
+    if (n1->mod == T_OBJECT || n1->mod == T_CLASS) {
+	type = T_OBJECT;
+    } else if (n1->mod == T_MAPPING) {
+	type = T_MAPPING;
+    } else if (typechecking && n1->mod != T_MIXED) {
+	char tnbuf[TNBUFSIZE];
+
+	/* indices */
+	if (n2 != (node *) NULL && n2->mod != T_INT && n2->mod != T_MIXED) {
+	    c_error("bad index type (%s)", i_typename(tnbuf, n2->mod));
+	}
+	if (n3 != (node *) NULL && n3->mod != T_INT && n3->mod != T_MIXED) {
+	    c_error("bad index type (%s)", i_typename(tnbuf, n3->mod));
+	}
+	/* range */
+	if ((n1->mod & T_REF) == 0 && n1->mod != T_STRING && n1->mod != T_MIXED)
+	{
+	    c_error("bad indexed type (%s)", i_typename(tnbuf, n1->mod));
+	}
+	type = n1->mod;
+    }
+
+    return node_bin(N_RANGE, type, n1, node_bin(N_PAIR, 0, n2, n3));
+}
+
+/*
+ * NAME:	bini()
+ * DESCRIPTION:	handle a binary int operator
+ */
+static node *bini(int op, node *n1, node *n2, const char *name)
+{
+    char tnbuf1[TNBUFSIZE], tnbuf2[TNBUFSIZE];
+    unsigned short type;
+
+    t_void(n1);
+    t_void(n2);
+
+    type = T_MIXED;
+    if (n1->mod == T_OBJECT || n1->mod == T_CLASS) {
+	type = T_OBJECT;
+    } else if (n1->mod == T_INT && (n2->mod == T_INT || n2->mod == T_MIXED)) {
+	type = T_INT;
+    } else if (typechecking && n1->mod != T_MIXED) {
+	c_error("bad argument types for %s (%s, %s)", name,
+		i_typename(tnbuf1, n1->mod), i_typename(tnbuf2, n2->mod));
+    }
+    if (n1->mod == T_INT && n2->mod == T_INT) {
+	op++;
+    }
+    return node_bin(op, type, n1, n2);
+}
+
+
+/*
+ * NAME:	bina()
+ * DESCRIPTION:	handle a binary arithmetic operator
+ */
+static node *bina(int op, node *n1, node *n2, const char *name)
+{
+    char tnbuf1[TNBUFSIZE], tnbuf2[TNBUFSIZE];
+    unsigned short type;
+
+    t_void(n1);
+    t_void(n2);
+
+    type = T_MIXED;
+    if (n1->mod == T_OBJECT || n1->mod == T_CLASS) {
+	type = T_OBJECT;
+    } else if (n1->mod == T_INT && (n2->mod == T_INT || n2->mod == T_MIXED)) {
+	if (n1->mod == T_INT && n2->mod == T_INT) {
+	    op++;
+	}
+	type = T_INT;
+    } else if (n1->mod == T_FLOAT && (n2->mod == T_FLOAT || n2->mod == T_MIXED))
+    {
+	type = T_FLOAT;
+	switch(op) {
+	    case N_ADD:
+	    case N_ADD_EQ:
+	    case N_ADD_EQ_1:
+	    case N_DIV:
+	    case N_DIV_EQ:
+	    case N_EQ:
+	    case N_GE:
+	    case N_GT:
+	    case N_LE:
+	    case N_LT:
+	    case N_MULT:
+	    case N_MULT_EQ:
+	    case N_NE:
+	    case N_SUB_EQ_1:
+	    case N_SUB_EQ:
+	    case N_MIN_MIN:
+	    case N_PLUS_PLUS:
+		op+=2;
+		break;
+	    default:
+		break;
+	}
+    } else if (typechecking && n1->mod != T_MIXED) {
+	c_error("bad argument types for %s (%s, %s)", name,
+		i_typename(tnbuf1, n1->mod), i_typename(tnbuf2, n2->mod));
+    }
+
+    return node_bin(op, type, n1, n2);
+}
+
+/*
+ * NAME:	mult()
+ * DESCRIPTION:	handle the * *= operators
+ */
+static node *mult(int op, node *n1, node *n2, const char *name)
+{
+    Float f1, f2;
+
+    if (n1->type == N_INT && n2->type == N_INT) {
+	/* i * i */
+	n1->l.number *= n2->l.number;
+	return n1;
+    }
+    if (n1->type == N_FLOAT && n2->type == N_FLOAT) {
+	NFLT_GET(n1, f1);
+	NFLT_GET(n2, f2);
+	f1.mult(f2);
+	NFLT_PUT(n1, f1);
+	return n1;
+    }
+    return bina(op, n1, n2, name);
+}
+
+/*
+ * NAME:	mdiv()
+ * DESCRIPTION:	handle the / /= operators
+ */
+static node *mdiv(int op, node *n1, node *n2, const char *name)
+{
+    Float f1, f2;
+
+    if (n1->type == N_INT && n2->type == N_INT) {
+	Int i, d;
+
+	/* i / i */
+	i = n1->l.number;
+	d = n2->l.number;
+	if (d == 0) {
+	    /* i / 0 */
+	    c_error("division by zero");
+	    return n1;
+	}
+	n1->l.number = INT_DIV(i, d);
+	return n1;
+    } else if (n1->type == N_FLOAT && n2->type == N_FLOAT) {
+	/* f / f */
+	if (NFLT_ISZERO(n2)) {
+	    /* f / 0.0 */
+	    c_error("division by zero");
+	    return n1;
+	}
+	NFLT_GET(n1, f1);
+	NFLT_GET(n2, f2);
+	f1.div(f2);
+	NFLT_PUT(n1, f1);
+	return n1;
+    }
+
+    return bina(op, n1, n2, name);
+}
+
+/*
+ * NAME:	mod()
+ * DESCRIPTION:	handle the % %= operators
+ */
+static node *mod(int op, node *n1, node *n2, const char *name)
+{
+    if (n1->type == N_INT && n2->type == N_INT) {
+	Int i, d;
+
+	/* i % i */
+	i = n1->l.number;
+	d = n2->l.number;
+	if (d == 0) {
+	    /* i % 0 */
+	    c_error("modulus by zero");
+	    return n1;
+	}
+	n1->l.number = INT_MOD(i, d);
+	return n1;
+    }
+
+    return bini(op, n1, n2, name);
+}
+
+/*
+ * NAME:	add()
+ * DESCRIPTION:	handle the + += operators, possibly rearranging the order
+ *		of the expression
+ */
+static node *add(int op, node *n1, node *n2, const char *name)
+{
+    char tnbuf1[TNBUFSIZE], tnbuf2[TNBUFSIZE];
+    Float f1, f2;
+    unsigned short type;
+
+    t_void(n1);
+    t_void(n2);
+
+    if (n1->mod == T_STRING) {
+	if (n2->mod == T_INT || n2->mod == T_FLOAT ||
+	    (n2->mod == T_MIXED && typechecking)) {
+	    n2 = cast(n2, node_type(T_STRING, (String *) NULL));
+	}
+    } else if (n2->mod == T_STRING && op == N_ADD) {
+	if (n1->mod == T_INT || n1->mod == T_FLOAT) {
+	    n1 = cast(n1, node_type(T_STRING, (String *) NULL));
+	}
+    }
+
+    if (n1->type == N_INT && n2->type == N_INT) {
+	/* i + i */
+	n1->l.number += n2->l.number;
+	return n1;
+    }
+    if (n1->type == N_FLOAT && n2->type == N_FLOAT) {
+	/* f + f */
+	NFLT_GET(n1, f1);
+	NFLT_GET(n2, f2);
+	f1.add(f2);
+	NFLT_PUT(n1, f1);
+	return n1;
+    }
+    if (n1->type == N_STR && n2->type == N_STR) {
+	/* s + s */
+	return node_str(str_add(n1->l.string, n2->l.string));
+    }
+
+    if (n1->mod == T_OBJECT || n1->mod == T_CLASS) {
+	type = T_OBJECT;
+    } else if ((type=c_tmatch(n1->mod, n2->mod)) == T_NIL) {
+	type = T_MIXED;
+	if (typechecking) {
+	    c_error("bad argument types for %s (%s, %s)", name,
+		    i_typename(tnbuf1, n1->mod), i_typename(tnbuf2, n2->mod));
+	}
+    } else if (type == T_INT) {
+	op++;
+    } else if (op == N_ADD_EQ && n1->mod != n2->mod) {
+	type = n1->mod;
+	if (n1->mod == T_INT) {
+	    n2 = node_mon(N_CAST, T_INT, n2);
+	    type = T_INT;
+	    op++;
+	} else if (n1->mod == T_FLOAT) {
+	    n2 = node_mon(N_CAST, T_FLOAT, n2);
+	    type = T_FLOAT;
+	}
+    }
+    return node_bin(op, type, n1, n2);
+}
+
+/*
+ * NAME:	sub()
+ * DESCRIPTION:	handle the - -= operators
+ */
+static node *sub(int op, node *n1, node *n2, const char *name)
+{
+    char tnbuf1[TNBUFSIZE], tnbuf2[TNBUFSIZE];
+    Float f1, f2;
+    unsigned short type;
+
+    t_void(n1);
+    t_void(n2);
+
+    if (n1->type == N_INT && n2->type == N_INT) {
+	/* i - i */
+	n1->l.number -= n2->l.number;
+	return n1;
+    }
+    if (n1->type == N_FLOAT && n2->type == N_FLOAT) {
+	/* f - f */
+	NFLT_GET(n1, f1);
+	NFLT_GET(n2, f2);
+	f1.sub(f2);
+	NFLT_PUT(n1, f1);
+	return n1;
+    }
+
+    if (n1->mod == T_OBJECT || n1->mod == T_CLASS) {
+	type = T_OBJECT;
+    } else if ((type=c_tmatch(n1->mod, n2->mod)) == T_NIL || type == T_STRING ||
+	       type == T_MAPPING) {
+	if ((type=n1->mod) != T_MAPPING ||
+	    (n2->mod != T_MIXED && (n2->mod & T_REF) == 0)) {
+	    type = T_MIXED;
+	    if (typechecking) {
+		c_error("bad argument types for %s (%s, %s)", name,
+			i_typename(tnbuf1, n1->mod),
+			i_typename(tnbuf2, n2->mod));
+	    }
+	}
+    } else if (type == T_INT) {
+	op++;
+    } else if (type == T_MIXED) {
+	type = n1->mod;
+    } else if (n1->mod == T_MIXED && (n2->mod & T_REF)) {
+	type = T_MIXED;
+    }
+    return node_bin(op, type, n1, n2);
+}
+
+/*
+ * NAME:	umin()
+ * DESCRIPTION:	handle unary minus
+ */
+static node *umin(node *n)
+{
+    Float flt;
+
+    if (n->mod == T_OBJECT || n->mod == T_CLASS) {
+	return node_mon(N_UMIN, T_OBJECT, n);
+    } else if (n->mod == T_MIXED) {
+	return node_mon(N_UMIN, T_MIXED, n);
+    } else if (t_unary(n, "unary -")) {
+	if (n->mod == T_FLOAT) {
+	    flt.initZero();
+	    n = sub(N_SUB, node_float(&flt), n, "-");
+	} else {
+	    n = sub(N_SUB, node_int((Int) 0), n, "-");
+	}
+    }
+    return n;
+}
+
+/*
+ * NAME:	lshift()
+ * DESCRIPTION:	handle the << <<= operators
+ */
+static node *lshift(int op, node *n1, node *n2, const char *name)
+{
+    if (n2->type == N_INT) {
+	if (n2->l.number < 0) {
+	    c_error("negative left shift");
+	    n2->l.number = 0;
+	}
+	if (n1->type == N_INT) {
+	    /* i << i */
+	    n1->l.number = (n2->l.number < 32) ?
+			    (Uint) n1->l.number << n2->l.number : 0;
+	    return n1;
+	}
+    }
+
+    return bini(op, n1, n2, name);
+}
+
+/*
+ * NAME:	rshift()
+ * DESCRIPTION:	handle the >> >>= operators
+ */
+static node *rshift(int op, node *n1, node *n2, const char *name)
+{
+    if (n2->type == N_INT) {
+	if (n2->l.number < 0) {
+	    c_error("negative right shift");
+	    n2->l.number = 0;
+	}
+	if (n1->type == N_INT) {
+	    /* i >> i */
+	    n1->l.number = (n2->l.number < 32) ?
+			    (Uint) n1->l.number >> n2->l.number : 0;
+	    return n1;
+	}
+    }
+
+    return bini(op, n1, n2, name);
+}
+
+/*
+ * NAME:	rel()
+ * DESCRIPTION:	handle the < > <= >= operators
+ */
+static node *rel(int op, node *n1, node *n2, const char *name)
+{
+    char tnbuf1[TNBUFSIZE], tnbuf2[TNBUFSIZE];
+
+    t_void(n1);
+    t_void(n2);
+
+    if (n1->type == N_INT && n2->type == N_INT) {
+	/* i . i */
+	switch (op) {
+	case N_GE:
+	    n1->l.number = (n1->l.number >= n2->l.number);
+	    break;
+
+	case N_GT:
+	    n1->l.number = (n1->l.number > n2->l.number);
+	    break;
+
+	case N_LE:
+	    n1->l.number = (n1->l.number <= n2->l.number);
+	    break;
+
+	case N_LT:
+	    n1->l.number = (n1->l.number < n2->l.number);
+	    break;
+	}
+	return n1;
+    }
+    if (n1->type == N_FLOAT && n2->type == N_FLOAT) {
+	Float f1, f2;
+
+	/* f . f */
+	NFLT_GET(n1, f1);
+	NFLT_GET(n2, f2);
+
+	switch (op) {
+	case N_GE:
+	    return node_int((Int) (f1.cmp(f2) >= 0));
+
+	case N_GT:
+	    return node_int((Int) (f1.cmp(f2) > 0));
+
+	case N_LE:
+	    return node_int((Int) (f1.cmp(f2) <= 0));
+
+	case N_LT:
+	    return node_int((Int) (f1.cmp(f2) < 0));
+	}
+	return n1;
+    }
+    if (n1->type == N_STR && n2->type == N_STR) {
+	/* s . s */
+	switch (op) {
+	case N_GE:
+	    return node_int((Int) (str_cmp(n1->l.string, n2->l.string) >= 0));
+
+	case N_GT:
+	    return node_int((Int) (str_cmp(n1->l.string, n2->l.string) > 0));
+
+	case N_LE:
+	    return node_int((Int) (str_cmp(n1->l.string, n2->l.string) <= 0));
+
+	case N_LT:
+	    return node_int((Int) (str_cmp(n1->l.string, n2->l.string) < 0));
+	}
+    }
+
+    if (n1->mod != T_OBJECT && n1->mod != T_CLASS && n1->mod != T_MIXED &&
+	typechecking &&
+	((n1->mod != n2->mod && n2->mod != T_MIXED) || !T_ARITHSTR(n1->mod) ||
+	 (!T_ARITHSTR(n2->mod) && n2->mod != T_MIXED))) {
+	c_error("bad argument types for %s (%s, %s)", name,
+		i_typename(tnbuf1, n1->mod), i_typename(tnbuf2, n2->mod));
+    } else if (n1->mod == T_INT && n2->mod == T_INT) {
+	op++;
+    }
+    return node_bin(op, T_INT, n1, n2);
+}
+
+/*
+ * NAME:	eq()
+ * DESCRIPTION:	handle the == operator
+ */
+static node *eq(node *n1, node *n2)
+{
+    char tnbuf1[TNBUFSIZE], tnbuf2[TNBUFSIZE];
+    Float f1, f2;
+    int op;
+
+    t_void(n1);
+    t_void(n2);
+
+    switch (n1->type) {
+    case N_INT:
+	if (n2->type == N_INT) {
+	    /* i == i */
+	    n1->l.number = (n1->l.number == n2->l.number);
+	    return n1;
+	}
+	if (nil_node == N_INT && n1->l.number == 0 && n2->type == N_STR) {
+	    /* nil == str */
+	    return node_int((Int) FALSE);
+	}
+	break;
+
+    case N_FLOAT:
+	if (n2->type == N_FLOAT) {
+	    /* f == f */
+	    NFLT_GET(n1, f1);
+	    NFLT_GET(n2, f2);
+	    return node_int((Int) (f1.cmp(f2) == 0));
+	}
+	break;
+
+    case N_STR:
+	if (n2->type == N_STR) {
+	    /* s == s */
+	    return node_int((Int) (str_cmp(n1->l.string, n2->l.string) == 0));
+	}
+	if (n2->type == nil_node && n2->l.number == 0) {
+	    /* s == nil */
+	    return node_int((Int) FALSE);
+	}
+	break;
+
+    case N_NIL:
+	if (n2->type == N_NIL) {
+	    /* nil == nil */
+	    return node_int((Int) TRUE);
+	}
+	if (n2->type == N_STR) {
+	    /* nil == str */
+	    return node_int((Int) FALSE);
+	}
+	break;
+    }
+
+    op = N_EQ;
+    if (c_tmatch(n1->mod, n2->mod) == T_NIL &&
+	(!c_nil(n1) || !T_POINTER(n2->mod)) &&
+	(!c_nil(n2) || !T_POINTER(n1->mod))) {
+	if (typechecking) {
+	    c_error("incompatible types for equality (%s, %s)",
+		    i_typename(tnbuf1, n1->mod), i_typename(tnbuf2, n2->mod));
+	}
+    } else if (n1->mod == T_INT && n2->mod == T_INT) {
+	op++;
+    }
+    return node_bin(op, T_INT, n1, n2);
+}
+
+/*
+ * NAME:	_and()
+ * DESCRIPTION:	handle the & &= operators
+ */
+static node *_and(int op, node *n1, node *n2, const char *name)
+{
+    unsigned short type;
+
+    if (n1->type == N_INT && n2->type == N_INT) {
+	/* i & i */
+	n1->l.number &= n2->l.number;
+	return n1;
+    }
+    if ((((type=n1->mod) == T_MIXED || type == T_MAPPING) &&
+	 ((n2->mod & T_REF) != 0 || n2->mod == T_MIXED)) ||
+	((type=c_tmatch(n1->mod, n2->mod)) & T_REF) != T_NIL) {
+	/*
+	 * possibly array & array or mapping & array
+	 */
+	return node_bin(op, type, n1, n2);
+    }
+    return bini(op, n1, n2, name);
+}
+
+/*
+ * NAME:	_xor()
+ * DESCRIPTION:	handle the ^ ^= operators
+ */
+static node *_xor(int op, node *n1, node *n2, const char *name)
+{
+    unsigned short type;
+
+    if (n1->type == N_INT && n2->type == N_INT) {
+	/* i ^ i */
+	n1->l.number ^= n2->l.number;
+	return n1;
+    }
+    if (((type=n1->mod) == T_MIXED && n2->mod == T_MIXED) ||
+	((type=c_tmatch(n1->mod, n2->mod)) & T_REF) != T_NIL) {
+	/*
+	 * possibly array ^ array
+	 */
+	return node_bin(op, type, n1, n2);
+    }
+    return bini(op, n1, n2, name);
+}
+
+/*
+ * NAME:	_or()
+ * DESCRIPTION:	handle the | |= operators
+ */
+static node *_or(int op, node *n1, node *n2, const char *name)
+{
+    unsigned short type;
+
+    if (n1->type == N_INT && n2->type == N_INT) {
+	/* i | i */
+	n1->l.number |= n2->l.number;
+	return n1;
+    }
+    if (((type=n1->mod) == T_MIXED && n2->mod == T_MIXED) ||
+	((type=c_tmatch(n1->mod, n2->mod)) & T_REF) != T_NIL) {
+	/*
+	 * possibly array | array
+	 */
+	return node_bin(op, type, n1, n2);
+    }
+    return bini(op, n1, n2, name);
+}
+
+/*
+ * NAME:	land()
+ * DESCRIPTION:	handle the && operator
+ */
+static node *land(node *n1, node *n2)
+{
+    t_void(n1);
+    t_void(n2);
+
+    if ((n1->flags & F_CONST) && (n2->flags & F_CONST)) {
+	n1 = c_tst(n1);
+	n2 = c_tst(n2);
+	n1->l.number &= n2->l.number;
+	return n1;
+    }
+
+    return node_bin(N_LAND, T_INT, n1, n2);
+}
+
+/*
+ * NAME:	lor()
+ * DESCRIPTION:	handle the || operator
+ */
+static node *lor(node *n1, node *n2)
+{
+    t_void(n1);
+    t_void(n2);
+
+    if ((n1->flags & F_CONST) && (n2->flags & F_CONST)) {
+	n1 = c_tst(n1);
+	n2 = c_tst(n2);
+	n1->l.number |= n2->l.number;
+	return n1;
+    }
+
+    return node_bin(N_LOR, T_INT, n1, n2);
+}
+
+/*
+ * NAME:	quest()
+ * DESCRIPTION:	handle the ? : operator
+ */
+static node *quest(node *n1, node *n2, node *n3)
+{
+    unsigned short type;
+
+    t_void(n1);
+
+    if ((n2->flags & F_CONST) && n3->type == n2->type) {
+	switch (n1->type) {
+	case N_INT:
+	    return (n1->l.number == 0) ? n3 : n2;
+
+	case N_FLOAT:
+	    return (NFLT_ISZERO(n1)) ? n3 : n2;
+
+	case N_STR:
+	    return n2;
+
+	case N_NIL:
+	    return n3;
+	}
+    }
+
+    type = T_MIXED;
+    if (c_nil(n2) && T_POINTER(n3->mod)) {
+	/*
+	 * expr ? nil : expr
+	 */
+	type = n3->mod;
+    } else if (c_nil(n3) && T_POINTER(n2->mod)) {
+	/*
+	 * expr ? expr : nil;
+	 */
+	type = n2->mod;
+    } else if (typechecking) {
+	/*
+	 * typechecked
+	 */
+	if (n2->mod == T_VOID || n3->mod == T_VOID) {
+	    /* result can never be used */
+	    type = T_VOID;
+	} else {
+	    type = c_tmatch(n2->mod, n3->mod);
+	    if (type == T_NIL) {
+		/* no typechecking here, just let the result be mixed */
+		type = T_MIXED;
+	    }
+	}
+    }
+
+    n1 = node_bin(N_QUEST, type, n1, node_bin(N_PAIR, 0, n2, n3));
+    if ((type & T_TYPE) == T_CLASS) {
+	if (n2->sclass == (String *) NULL) {
+	    n1->sclass = n3->sclass;
+	    if (n1->sclass != (String *) NULL) {
+		str_ref(n1->sclass);
+	    }
+	} else if (n3->sclass == (String *) NULL ||
+		   str_cmp(n2->sclass, n3->sclass) == 0) {
+	    n1->sclass = n2->sclass;
+	    if (n1->sclass != (String *) NULL) {
+		str_ref(n1->sclass);
+	    }
+	} else {
+	    /* downgrade to object */
+	    n1->type = (n1->type & T_REF) | T_OBJECT;
+	}
+    }
+    return n1;
+}
+
+/*
+ * NAME:	assign()
+ * DESCRIPTION:	handle the assignment operator
+ */
+static node *assign(node *n1, node *n2)
+{
+    char tnbuf1[TNBUFSIZE], tnbuf2[TNBUFSIZE];
+    node *n, *m;
+    unsigned short type;
+
+    if (n1->type == N_AGGR) {
+	/*
+	 * ({ a, b }) = array;
+	 */
+	if (typechecking) {
+	    type = n2->mod;
+	    if ((n2->mod & T_REF) != 0) {
+		type -= 1 << REFSHIFT;
+		if (type != T_MIXED) {
+		    n = node_mon(N_TYPE, type, (node *) NULL);
+		    n->sclass = n2->sclass;
+		    if (n->sclass != (String *) NULL) {
+			str_ref(n->sclass);
+		    }
+		    n1->r.right = n;
+		}
+	    } else if (type != T_MIXED) {
+		c_error("incompatible types for = (%s, %s)",
+			i_typename(tnbuf1, n1->mod),
+			i_typename(tnbuf2, type));
+		type = T_MIXED;
+	    }
+
+	    n = n1->l.left;
+	    while (n != (node *) NULL) {
+		if (n->type == N_PAIR) {
+		    m = n->l.left;
+		    n = n->r.right;
+		} else {
+		    m = n;
+		    n = (node *) NULL;
+		}
+		if (c_tmatch(m->mod, type) == T_NIL) {
+		    c_error("incompatible types for = (%s, %s)",
+			    i_typename(tnbuf1, m->mod),
+			    i_typename(tnbuf2, type));
+		}
+	    }
+	}
+	n1 = node_bin(N_ASSIGN, n2->mod, n1, n2);
+	n1->sclass = n2->sclass;
+	if (n1->sclass != (String *) NULL) {
+	    str_ref(n1->sclass);
+	}
+	return n1;
+    } else {
+	if (typechecking && (!c_nil(n2) || !T_POINTER(n1->mod))) {
+	    /*
+	     * typechecked
+	     */
+	    if (c_tmatch(n1->mod, n2->mod) == T_NIL) {
+		c_error("incompatible types for = (%s, %s)",
+			i_typename(tnbuf1, n1->mod),
+			i_typename(tnbuf2, n2->mod));
+	    } else if ((n1->mod != T_MIXED && n2->mod == T_MIXED) ||
+		       (n1->mod == T_CLASS &&
+			(n2->mod != T_CLASS ||
+			 str_cmp(n1->sclass, n2->sclass) != 0))) {
+		n2 = node_mon(N_CAST, n1->mod, n2);
+		n2->sclass = n1->sclass;
+		if (n2->sclass != (String *) NULL) {
+		    str_ref(n2->sclass);
+		}
+	    }
+	}
+
+	n2 = node_bin(N_ASSIGN, n1->mod, n1, n2);
+	n2->sclass = n1->sclass;
+	if (n2->sclass != (String *) NULL) {
+	    str_ref(n2->sclass);
+	}
+	return n2;
+    }
+}
+
+/*
+ * NAME:	comma()
+ * DESCRIPTION:	handle the comma operator, rearranging the order of the
+ *		expression if needed
+ */
+static node *comma(node *n1, node *n2)
+{
+    if (n2->type == N_COMMA) {
+	/* a, (b, c) --> (a, b), c */
+	n2->l.left = comma(n1, n2->l.left);
+	return n2;
+    } else {
+	n1 = node_bin(N_COMMA, n2->mod, n1, n2);
+	n1->sclass = n2->sclass;
+	    if (n1->sclass != (String *) NULL) {
+		str_ref(n1->sclass);
+	    }
+	return n1;
+    }
+}
@@ -1386,7 +1386,7 @@ static node *mdiv(int op, node *n1, node *n2, const char *name)
 	    c_error("division by zero");
 	    return n1;
 	}
-	n1->l.number = i / d;
+	n1->l.number = INT_DIV(i, d);
 	return n1;
     } else if (n1->type == N_FLOAT && n2->type == N_FLOAT) {
 	/* f / f */
@@ -1422,7 +1422,7 @@ static node *mod(int op, node *n1, node *n2, const char *name)
 	    c_error("modulus by zero");
 	    return n1;
 	}
-	n1->l.number = i % d;
+	n1->l.number = INT_MOD(i, d);
 	return n1;
     }
 
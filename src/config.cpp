@@ -116,19 +116,22 @@ static config conf[] = {
 # define SWAP_FRAGMENT	24
 				{ "swap_fragment",	INT_CONST, FALSE, FALSE,
 							0, SW_UNUSED },
-# define SWAP_SIZE	25
+# define SWAP_MMAP	25
+				{ "swap_mmap",		INT_CONST, FALSE, FALSE,
+							0, 1 },
+# define SWAP_SIZE	26
 				{ "swap_size",		INT_CONST, FALSE, FALSE,
 							1024, SW_UNUSED },
-# define TELNET_PORT	26
+# define TELNET_PORT	27
 				{ "telnet_port",	'[', FALSE, FALSE,
 							1, USHRT_MAX },
-# define TYPECHECKING	27
+# define TYPECHECKING	28
 				{ "typechecking",	INT_CONST, FALSE, FALSE,
 							0, 2 },
-# define USERS		28
+# define USERS		29
 				{ "users",		INT_CONST, FALSE, FALSE,
 							0, EINDEX_MAX },
-# define NR_OPTIONS	29
+# define NR_OPTIONS	30
 };
 
 
@@ -138,7 +141,7 @@ struct aligni { char fill; Int i;	};
 struct alignp { char fill; char *p;	};
 struct alignz { char c;			};
 
-# define FORMAT_VERSION	15
+# define FORMAT_VERSION	17
 
 # define DUMP_VALID	0	/* valid dump flag */
 # define DUMP_VERSION	1	/* snapshot version number */
@@ -292,6 +295,8 @@ void conf_dump(bool incr, bool boot)
 
     if (!incr) {
 	o_copy(0);
+    } else {
+	o_copy2();
     }
     d_swapout(1);
     dflags = 0;
@@ -437,7 +442,7 @@ static bool conf_restore(int fd, int fd2)
     boottime = P_time();
     co_restore(fd, boottime);
 
-    if (fd2 >= 0) {
+    if (fd2 >= 0 && !(rdflags & FLAGS_PARTIAL)) {
 	P_close(fd2);
     }
 
@@ -1075,7 +1080,7 @@ static bool conf_config()
 
     for (l = 0; l < NR_OPTIONS; l++) {
 	if (!conf[l].set && l != HOTBOOT && l != MODULES && l != CACHE_SIZE &&
-	    l != DATAGRAM_PORT && l != DATAGRAM_USERS) {
+	    l != DATAGRAM_PORT && l != DATAGRAM_USERS && l != SWAP_MMAP) {
 	    char buffer[64];
 
 #ifndef NETWORK_EXTENSIONS
@@ -1218,6 +1223,14 @@ static bool conf_includes()
     cputs("# define ST_DATAGRAMPORTS 24\t/* datagram ports */\012");
     cputs("# define ST_TELNETPORTS\t25\t/* telnet ports */\012");
     cputs("# define ST_BINARYPORTS\t26\t/* binary ports */\012");
+    cputs("# define ST_SWAPRSAVED\t27\t/* swap reads saved by vectored I/O */\012");
+    cputs("# define ST_SWAPWSAVED\t28\t/* swap writes saved by vectored I/O */\012");
+    cputs("# define ST_SWAPHITS\t29\t/* swap cache hits */\012");
+    cputs("# define ST_SWAPMISSES\t30\t/* swap cache misses */\012");
+    cputs("# define ST_SWAPEVICTS\t31\t/* sectors evicted from swap cache */\012");
+    cputs("# define ST_MEMCATEGORIES 32\t/* memory per category (MEMSTATS) */\012");
+    cputs("# define ST_MEMCLASSES\t33\t/* chunks per size class (MEMSTATS) */\012");
+    cputs("# define ST_HASHSTATS\t34\t/* hash lookups, collisions (mappings: MAPSTATS) */\012");
 
     cputs("\012# define O_COMPILETIME\t0\t/* time of compilation */\012");
     cputs("# define O_PROGSIZE\t1\t/* program size of object */\012");
@@ -1231,6 +1244,19 @@ static bool conf_includes()
     cputs("# define CO_FUNCTION\t1\t/* function name */\012");
     cputs("# define CO_DELAY\t2\t/* delay */\012");
     cputs("# define CO_FIRSTXARG\t3\t/* first extra argument */\012");
+
+    cputs("\012# define MC_OTHER\t0\t/* uncategorized */\012");
+    cputs("# define MC_STRING\t1\t/* strings */\012");
+    cputs("# define MC_ARRAY\t2\t/* arrays */\012");
+    cputs("# define MC_MAPPING\t3\t/* mapping elements */\012");
+    cputs("# define MC_CONTROL\t4\t/* control blocks */\012");
+    cputs("# define MC_DATASPACE\t5\t/* dataspaces */\012");
+    cputs("# define MC_PARSER\t6\t/* parse_string() state */\012");
+    cputs("# define MC_EDITOR\t7\t/* editor */\012");
+
+    cputs("\012# define HS_MAPPING\t0\t/* mapping indices */\012");
+    cputs("# define HS_STRMERGE\t1\t/* string merge table */\012");
+    cputs("# define HS_OBJECT\t2\t/* object name table */\012");
     if (!cclose()) {
 	return FALSE;
     }
@@ -1504,7 +1530,8 @@ bool conf_init(char *configfile, char *snapshot, char *snapshot2, char *module,
     /* initialize swap device */
     cache = (sector) ((conf[CACHE_SIZE].set) ? conf[CACHE_SIZE].u.num : 100);
     sw_init(conf[SWAP_FILE].u.str, (sector) conf[SWAP_SIZE].u.num, cache,
-	    (unsigned int) conf[SECTOR_SIZE].u.num);
+	    (unsigned int) conf[SECTOR_SIZE].u.num,
+	    (conf[SWAP_MMAP].set && conf[SWAP_MMAP].u.num != 0));
 
     /* initialize swapped data handler */
     d_init();
@@ -1714,6 +1741,9 @@ bool conf_statusi(Frame *f, Int idx, Value *v)
 {
     const char *version;
     uindex ncoshort, ncolong;
+# ifdef MEMSTATS
+    allocinfo *info;
+# endif
     Array *a;
     Uint t;
     int i;
@@ -1846,6 +1876,73 @@ bool conf_statusi(Frame *f, Int idx, Value *v)
 	}
 	break;
 
+    case 27:	/* ST_SWAPRSAVED */
+	putval(v, sw_info()->rsaved);
+	break;
+
+    case 28:	/* ST_SWAPWSAVED */
+	putval(v, sw_info()->wsaved);
+	break;
+
+    case 29:	/* ST_SWAPHITS */
+	putval(v, sw_info()->hits);
+	break;
+
+    case 30:	/* ST_SWAPMISSES */
+	putval(v, sw_info()->misses);
+	break;
+
+    case 31:	/* ST_SWAPEVICTS */
+	putval(v, sw_info()->evictions);
+	break;
+
+    case 32:	/* ST_MEMCATEGORIES */
+# ifdef MEMSTATS
+	info = m_info();
+	a = arr_new(f->data, (long) MCATEGORIES);
+	PUT_ARRVAL(v, a);
+	for (i = 0, v = a->elts; i < MCATEGORIES; i++, v++) {
+	    PUT_ARRVAL(v, arr_new(f->data, 2L));
+	    putval(&v->u.array->elts[0], info->category[i].size);
+	    putval(&v->u.array->elts[1], info->category[i].count);
+	}
+# else
+	*v = nil_value;
+# endif
+	break;
+
+    case 33:	/* ST_MEMCLASSES */
+# ifdef MEMSTATS
+	info = m_info();
+	a = arr_new(f->data, (long) info->nclasses);
+	PUT_ARRVAL(v, a);
+	for (i = 0, v = a->elts; i < (int) info->nclasses; i++, v++) {
+	    PUT_ARRVAL(v, arr_new(f->data, 3L));
+	    putval(&v->u.array->elts[0], info->clsize[i]);
+	    putval(&v->u.array->elts[1], info->clstat[i].size);
+	    putval(&v->u.array->elts[2], info->clstat[i].count);
+	}
+# else
+	*v = nil_value;
+# endif
+	break;
+
+    case 34:	/* ST_HASHSTATS */
+	a = arr_new(f->data, (long) HASHSTATS);
+	PUT_ARRVAL(v, a);
+	for (i = 0, v = a->elts; i < HASHSTATS; i++, v++) {
+# ifndef MAPSTATS
+	    if (i == HS_MAPPING) {
+		*v = nil_value;	/* not counted */
+		continue;
+	    }
+# endif
+	    PUT_ARRVAL(v, arr_new(f->data, 2L));
+	    putval(&v->u.array->elts[0], Hashtab::stats[i].lookups);
+	    putval(&v->u.array->elts[1], Hashtab::stats[i].collisions);
+	}
+	break;
+
     default:
 	return FALSE;
     }
@@ -1865,8 +1962,8 @@ Array *conf_status(Frame *f)
 
     try {
 	ec_push((ec_ftn) NULL);
-	a = arr_ext_new(f->data, 27L);
-	for (i = 0, v = a->elts; i < 27; i++, v++) {
+	a = arr_ext_new(f->data, 35L);
+	for (i = 0, v = a->elts; i < 35; i++, v++) {
 	    conf_statusi(f, i, v);
 	}
 	ec_pop();
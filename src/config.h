@@ -46,15 +46,15 @@ typedef unsigned char kfindex;
 # define BUF_SIZE	FS_BLOCK_SIZE	/* I/O buffer size */
 # define MAX_LINE_SIZE	4096	/* max. line size in ed and lex (power of 2) */
 # define STRINGSZ	256	/* general (internal) string size */
-# define STRMAPHASHSZ	20	/* # characters to hash of map string indices */
 # define STRMERGETABSZ	4096	/* general string merge table size */
-# define STRMERGEHASHSZ	20	/* # characters in merge strings to hash */
 # define ARRMERGETABSZ	1024	/* general array merge table size */
 # define OBJHASHSZ	256	/* # characters in object names to hash */
 # define COPATCHHTABSZ	1024	/* callout patch hash table size */
 # define OBJPATCHHTABSZ	1024	/* object patch hash table size */
 # define CMPLIMIT	2048	/* compress strings if >= CMPLIMIT */
+# define CMPMETHOD	CMP_LZ	/* CMP_PRED or CMP_LZ */
 # define SWAPCHUNKSZ	10	/* # objects reconstructed in main loop */
+# define RSPREFETCH	8	/* # objects read ahead while restoring */
 
 /* comm */
 # define INBUF_SIZE	2048	/* telnet input buffer size */
@@ -64,12 +64,21 @@ typedef unsigned char kfindex;
 
 /* swap */
 # define SWAPCHUNK	(128 * 1024 * 1024)
+# define SWIOBUFS	32	/* # asynchronous swap I/O buffers */
+# define SWPREFETCH	16	/* max. # sectors prefetched at once */
+# define SWVECTOR	16	/* max. # sectors in a vectored transfer */
+# define SWMAPSIZE	(64 * 1024 * 1024)	/* min. size of a file mapping */
+# define SWDUMPBUF	(64 * 1024)	/* min. size of a snapshot write */
 
 /* interpreter */
 # define MIN_STACK	5	/* minimal stack, # arguments in driver calls */
 # define EXTRA_STACK	32	/* extra space in stack frames */
+# define VALUE_STACK	16384	/* size of contiguous value stack */
 # define MAX_STRLEN	SSIZET_MAX	/* max string length, >= 65535 */
 # define INHASHSZ	4096	/* instanceof hashtable size */
+# define CALLCACHESZ	1024	/* call_other function cache size */
+# define PFHASHSZ	4096	/* profiler call path hash table size */
+# define PFNODES	65536	/* max. # call paths profiled */
 
 /* parser */
 # define MAX_AUTOMSZ	6	/* DFA/PDA storage size, in strings */
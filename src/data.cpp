@@ -56,7 +56,7 @@ public:
 	memset(&cop, '\0', COPATCHHTABSZ * sizeof(copatch*));
     }
 
-    Chunk<copatch, COPCHUNKSZ> chunk;	/* callout patch chunk */
+    Chunk<copatch, COPCHUNKSZ, MC_DATASPACE> chunk; /* callout patch chunk */
     copatch *cop[COPATCHHTABSZ];	/* hash table of callout patches */
 };
 
@@ -182,6 +182,119 @@ static void del_lhs(Dataspace *data, Value *lhs)
 }
 
 
+# define NEWELTS(a)	((a)->primary->arr == (Array *) NULL && \
+			 ((a)->elts != (Value *) NULL || (a)->hashmod))
+
+/*
+ * NAME:	promote_elts()
+ * DESCRIPTION:	copy the temporary strings among the elements of a new array
+ *		or mapping to the heap, and return TRUE if it contains other
+ *		new arrays or mappings
+ */
+static bool promote_elts(Array *arr)
+{
+    String *str;
+    Value *v;
+    unsigned short n;
+    bool nested, promoted;
+
+    if (arr->hashmod) {
+	/* move new mapping elements to the array part */
+	map_compact(arr->primary->data, arr);
+    }
+    nested = promoted = FALSE;
+    for (v = arr->elts, n = arr->size; n != 0; v++, --n) {
+	if (v->type == T_STRING) {
+	    if (m_temp((char *) v->u.string)) {
+		str = str_new(v->u.string->text, v->u.string->len);
+		str_del(v->u.string);
+		PUT_STR(v, str);
+		promoted = TRUE;
+	    }
+	} else if (T_INDEXED(v->type) && NEWELTS(v->u.array)) {
+	    nested = TRUE;
+	}
+    }
+    if (promoted && arr->hashed != (struct maphash *) NULL) {
+	map_rmhash(arr);	/* hashed part refers to the old strings */
+    }
+
+    return nested;
+}
+
+/*
+ * NAME:	promote_nested()
+ * DESCRIPTION:	promote the strings in new arrays and mappings contained in
+ *		a new array or mapping, visiting each one once
+ */
+static void promote_nested(Array *arr)
+{
+    Array **stack, *a;
+    Value *v;
+    unsigned short n;
+    Uint sp, size, narr;
+
+    arr_merge();
+    narr = 0;
+    arr_put(arr, narr++);
+    stack = ALLOC(Array*, size = 16);
+    stack[0] = arr;
+    sp = 1;
+
+    do {
+	arr = stack[--sp];
+	for (v = arr->elts, n = arr->size; n != 0; v++, --n) {
+	    if (T_INDEXED(v->type)) {
+		a = v->u.array;
+		if (NEWELTS(a) && arr_put(a, narr) == narr) {
+		    narr++;
+		    if (promote_elts(a)) {
+			if (sp == size) {
+			    stack = REALLOC(stack, Array*, size, size << 1);
+			    size <<= 1;
+			}
+			stack[sp++] = a;
+		    }
+		}
+	    }
+	}
+    } while (sp != 0);
+
+    FREE(stack);
+    arr_clear();
+}
+
+/*
+ * NAME:	data->promote()
+ * DESCRIPTION:	copy temporary strings to the heap before they are stored,
+ *		including those in new arrays and mappings at any depth
+ */
+Value *d_promote(Value *val, Value *tmp)
+{
+    Array *arr;
+
+    switch (val->type) {
+    case T_STRING:
+	if (m_temp((char *) val->u.string)) {
+	    *tmp = *val;
+	    tmp->u.string = str_new(val->u.string->text, val->u.string->len);
+	    return tmp;
+	}
+	break;
+
+    case T_ARRAY:
+    case T_MAPPING:
+    case T_LWOBJECT:
+	arr = val->u.array;
+	if (NEWELTS(arr) && promote_elts(arr)) {
+	    promote_nested(arr);
+	}
+	break;
+    }
+
+    return val;
+}
+
 /*
  * NAME:	data->alloc_call_out()
  * DESCRIPTION:	allocate a new callout
@@ -195,7 +308,7 @@ static uindex d_alloc_call_out(Dataspace *data, uindex handle, Uint time,
 	/*
 	 * the first in this object
 	 */
-	co = data->callouts = ALLOC(dcallout, 1);
+	co = data->callouts = ALLOC_CAT(dcallout, 1, MC_DATASPACE);
 	data->ncallouts = handle = 1;
 	data->plane->flags |= MOD_NEWCALLOUT;
     } else {
@@ -450,7 +563,7 @@ void d_new_plane(Dataspace *data, Int level)
     Dataplane *p;
     Uint i;
 
-    p = ALLOC(Dataplane, 1);
+    p = ALLOC_CAT(Dataplane, 1, MC_DATASPACE);
 
     p->level = level;
     p->flags = data->plane->flags;
@@ -469,7 +582,7 @@ void d_new_plane(Dataspace *data, Int level)
     if (data->plane->arrays != (arrref *) NULL) {
 	arrref *a, *b;
 
-	p->arrays = ALLOC(arrref, i = data->narrays);
+	p->arrays = ALLOC_CAT(arrref, i = data->narrays, MC_DATASPACE);
 	for (a = p->arrays, b = data->plane->arrays; i != 0; a++, b++, --i) {
 	    if (b->arr != (Array *) NULL) {
 		*a = *b;
@@ -487,7 +600,7 @@ void d_new_plane(Dataspace *data, Int level)
     if (data->plane->strings != (strref *) NULL) {
 	strref *s, *t;
 
-	p->strings = ALLOC(strref, i = data->nstrings);
+	p->strings = ALLOC_CAT(strref, i = data->nstrings, MC_DATASPACE);
 	for (s = p->strings, t = data->plane->strings; i != 0; s++, t++, --i) {
 	    if (t->str != (String *) NULL) {
 		*s = *t;
@@ -682,7 +795,7 @@ void d_commit_plane(Int level, Value *retval)
 	 r = &p->plist, p = *r) {
 	if (p->prev->level != level - 1) {
 	    /* insert commit plane */
-	    commit = ALLOC(Dataplane, 1);
+	    commit = ALLOC_CAT(Dataplane, 1, MC_DATASPACE);
 	    commit->level = level - 1;
 	    commit->original = (Value *) NULL;
 	    commit->alocal.arr = (Array *) NULL;
@@ -983,13 +1096,17 @@ void d_ref_imports(Array *arr)
  */
 void d_assign_var(Dataspace *data, Value *var, Value *val)
 {
+    Value tmp;
+
     if (var >= data->variables && var < data->variables + data->nvariables) {
+	val = d_promote(val, &tmp);
 	if (data->plane->level != 0 &&
 	    data->plane->original == (Value *) NULL) {
 	    /*
 	     * back up variables
 	     */
-	    i_copy(data->plane->original = ALLOC(Value, data->nvariables),
+	    i_copy(data->plane->original = ALLOC_CAT(Value, data->nvariables,
+						     MC_DATASPACE),
 		   data->variables, data->nvariables);
 	}
 	ref_rhs(data, val);
@@ -1045,6 +1162,9 @@ void d_wipe_extravar(Dataspace *data)
  */
 void d_assign_elt(Dataspace *data, Array *arr, Value *elt, Value *val)
 {
+    Value tmp;
+
+    val = d_promote(val, &tmp);
     if (data->plane->level != arr->primary->data->plane->level) {
 	/*
 	 * bring dataspace of imported array up to the current plane level
@@ -1518,7 +1638,7 @@ void d_upgrade_data(Dataspace *data, unsigned int nvar, unsigned short *vmap,
     vars = d_get_variable(data, 0);
 
     /* map variables */
-    for (n = nvar, v = ALLOC(Value, n); n > 0; --n) {
+    for (n = nvar, v = ALLOC_CAT(Value, n, MC_DATASPACE); n > 0; --n) {
 	switch (*vmap) {
 	case NEW_INT:
 	    *v++ = zero_int;
@@ -1609,7 +1729,7 @@ Object *d_upgrade_lwobj(Array *lwobj, Object *obj)
     --nvar;
 
     /* map variables */
-    v = ALLOC(Value, nvar + 2);
+    v = ALLOC_CAT(Value, nvar + 2, MC_ARRAY);
     *v++ = lwobj->elts[0];
     *v = lwobj->elts[1];
     (v++)->u.objcnt = update;
@@ -1728,7 +1848,8 @@ static void d_import(arrimport *imp, Dataspace *data, Value *val,
 				/*
 				 * copy elements
 				 */
-				i_copy(a->elts = ALLOC(Value, a->size),
+				i_copy(a->elts = ALLOC_CAT(Value, a->size,
+							   MC_ARRAY),
 				       d_get_elts(val->u.array), a->size);
 			    }
 
@@ -63,6 +63,7 @@ struct dsymbol {
 struct Control {
     Control *prev, *next;
     uindex ndata;		/* # of data blocks using this control block */
+    Uint serial;		/* unique control block number */
 
     sector nsectors;		/* o # of sectors */
     sector *sectors;		/* o vector with sectors */
@@ -85,8 +86,10 @@ struct Control {
 
     unsigned short nstrings;	/* i/o # strings */
     String **strings;		/* i/o? string table */
+    Control **iprogs;		/* inherited programs */
+    String ***strtabs;		/* inherited string tables */
+    Uint igen;			/* generation of inherited programs */
     ssizet *sslength;		/* o sstrings length */
-    Uint *ssindex;		/* o sstrings index */
     char *stext;		/* o sstrings text */
     Uint strsize;		/* o sstrings text size */
     Uint stroffset;		/* o offset of string index table */
@@ -116,6 +119,9 @@ struct Control {
 
     unsigned short vmapsize;	/* i/o size of variable mapping */
     unsigned short *vmap;	/* variable mapping */
+
+    bool jit;			/* passed to JIT compiler? */
+    voidf **jitfuncs;		/* JIT compiled functions */
 };
 
 # define NEW_INT		((unsigned short) -1)
@@ -241,6 +247,9 @@ extern void		d_ref_control	 (Control*);
 extern void		d_ref_dataspace  (Dataspace*);
 
 extern char	       *d_get_prog	 (Control*);
+extern String	      **d_get_strings	 (Control*);
+extern Control	      **d_get_iprogs	 (Control*);
+extern String	     ***d_get_strtabs	 (Control*);
 extern String	       *d_get_strconst	 (Control*, int, unsigned int);
 extern dfuncdef        *d_get_funcdefs	 (Control*);
 extern dvardef	       *d_get_vardefs	 (Control*);
@@ -259,7 +268,7 @@ extern Control	       *d_restore_ctrl	 (Object*,
 					  void(*)(char*, sector*, Uint, Uint));
 extern Dataspace       *d_restore_data	 (Object*, Uint*,
 					  void(*)(char*, sector*, Uint, Uint));
-extern void		d_restore_obj	 (Object*, Uint*, bool, bool);
+extern void		d_restore_obj	 (Object*, Uint*, bool, bool, bool);
 extern void		d_converted	 ();
 
 extern void		d_free_control	 (Control*);
@@ -274,6 +283,7 @@ extern abchunk	      **d_commit_arr	(Array*, Dataplane*, Dataplane*);
 extern void		d_discard_arr	(Array*, Dataplane*);
 
 extern void		d_ref_imports	(Array*);
+extern Value	       *d_promote	(Value*, Value*);
 extern void		d_assign_var	(Dataspace*, Value*, Value*);
 extern Value	       *d_get_extravar	(Dataspace*);
 extern void		d_set_extravar	(Dataspace*, Value*);
@@ -324,6 +334,7 @@ extern void		d_del_dataspace	(Dataspace*);
 # define CMP_TYPE		0x03
 # define CMP_NONE		0x00	/* no compression */
 # define CMP_PRED		0x01	/* predictor compression */
+# define CMP_LZ			0x02	/* LZ compression */
 
 # define ARR_MOD		0x80000000L	/* in arrref->ref */
 
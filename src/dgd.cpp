@@ -37,6 +37,7 @@ static Uint dcount;		/* driver object count */
 static sector fragment;		/* swap fragment parameter */
 static bool rebuild;		/* rebuild swapfile? */
 bool intr;			/* received an interrupt? */
+static bool mstats;		/* show memory statistics? */
 
 /*
  * NAME:	call_driver_object()
@@ -73,6 +74,15 @@ void interrupt()
     intr = TRUE;
 }
 
+/*
+ * NAME:	memstats()
+ * DESCRIPTION:	register a request for memory statistics
+ */
+void memstats()
+{
+    mstats = TRUE;
+}
+
 /*
  * NAME:	endtask()
  * DESCRIPTION:	clean up after a task has terminated
@@ -102,6 +112,7 @@ void endtask()
 	 */
 	d_swapout(1);
 	arr_freeall();
+	sw_dwait();
 	m_purge();
 	swap = FALSE;
     }
@@ -183,7 +194,7 @@ int dgd_main(int argc, char **argv)
 
     /* initialize */
     dindex = UINDEX_MAX;
-    swap = dump = intr = stop = FALSE;
+    swap = dump = intr = stop = mstats = FALSE;
     rebuild = TRUE;
     rtime = 0;
     if (!conf_init(argv[0], (argc > 1) ? argv[1] : (char *) NULL,
@@ -220,6 +231,12 @@ int dgd_main(int argc, char **argv)
 	    endtask();
 	}
 
+	/* memory statistics */
+	if (mstats) {
+	    mstats = FALSE;
+	    m_dump();
+	}
+
 	/* handle user input */
 	timeout = co_delay(rtime, rmtime, &mtime);
 	comm_receive(cframe, timeout, mtime);
@@ -42,6 +42,7 @@ struct Frame;
 
 extern bool call_driver_object	(Frame*, const char*, int);
 extern void interrupt		();
+extern void memstats		();
 extern void endtask		();
 extern void errhandler		(Frame*, Int);
 extern int  dgd_main		(int, char**);
@@ -32,7 +32,7 @@ editbuf *eb_new(char *tmpfile)
 {
     editbuf *eb;
 
-    eb = ALLOC(editbuf, 1);
+    eb = ALLOC_CAT(editbuf, 1, MC_EDITOR);
     eb->lb = lb_new((linebuf *) NULL, tmpfile);
     eb->buffer = (block) 0;
     eb->lines = 0;
@@ -68,7 +68,7 @@ cmdbuf *cb_new(char *tmpfile)
     cmdbuf *cb;
 
     m_static();
-    cb = ALLOC(cmdbuf, 1);
+    cb = ALLOC_CAT(cmdbuf, 1, MC_EDITOR);
     memset(cb, '\0', sizeof(cmdbuf));
     cb->edbuf = eb_new(tmpfile);
     cb->regexp = rx_new();
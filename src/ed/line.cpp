@@ -105,15 +105,16 @@ linebuf *lb_new(linebuf *lb, char *filename)
 	lb_inact(lb);
     } else {
 	/* allocate new line buffer */
-	lb = ALLOC(linebuf, 1);
+	lb = ALLOC_CAT(linebuf, 1, MC_EDITOR);
 
-	lb->file = strcpy(ALLOC(char, strlen(filename) + 1), filename);
+	lb->file = strcpy(ALLOC_CAT(char, strlen(filename) + 1,
+				    MC_EDITOR), filename);
 
 	bt = lb->bt;
 	for (i = NR_EDBUFS; i > 0; --i) {
 	    bt->prev = bt - 1;
 	    bt->next = bt + 1;
-	    bt->buf = ALLOC(char, BLOCK_SIZE);
+	    bt->buf = ALLOC_CAT(char, BLOCK_SIZE, MC_EDITOR);
 	    bt++;
 	}
 	--bt;
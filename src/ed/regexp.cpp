@@ -53,7 +53,7 @@ rxbuf *rx_new()
 {
     rxbuf *rx;
 
-    rx = ALLOC(rxbuf, 1);
+    rx = ALLOC_CAT(rxbuf, 1, MC_EDITOR);
     rx->valid = 0;
     return rx;
 }
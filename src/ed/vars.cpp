@@ -37,7 +37,7 @@ Vars *va_new()
     };
     Vars *v;
 
-    v = ALLOC(Vars, NUMBER_OF_VARS);
+    v = ALLOC_CAT(Vars, NUMBER_OF_VARS, MC_EDITOR);
     memcpy(v, dflt, sizeof(dflt));
 
     return v;
@@ -53,8 +53,8 @@ void ed_init(char *tmp, int num)
     f = (editor *) NULL;
     neditors = num;
     if (num != 0) {
-	outbuf = ALLOC(char, USHRT_MAX + 1);
-	editors = ALLOC(editor, num);
+	outbuf = ALLOC_CAT(char, USHRT_MAX + 1, MC_EDITOR);
+	editors = ALLOC_CAT(editor, num, MC_EDITOR);
 	for (e = editors + num; num != 0; --num) {
 	    (--e)->ed = (cmdbuf *) NULL;
 	    e->next = f;
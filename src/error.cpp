@@ -179,7 +179,7 @@ void serror(String *str)
     if (cframe->rlim != econtext->rlim) {
 	i_set_rlimits(cframe, econtext->rlim);
     }
-    cframe = i_set_sp(cframe, econtext->f->fp - offset);
+    cframe = i_set_sp(cframe, econtext->f, econtext->f->fp - offset);
     cframe->atomic = econtext->atomic;
     cframe->rlim = econtext->rlim;
     ec_pop();
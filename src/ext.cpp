@@ -29,7 +29,16 @@
 # include <math.h>
 
 # define EXTENSION_MAJOR	0
-# define EXTENSION_MINOR	9
+# define EXTENSION_MINOR	10
+
+/* JIT compiled function status */
+# define EXT_JIT_TICKS		1	/* out of ticks */
+# define EXT_JIT_DIV		2	/* division by zero */
+# define EXT_JIT_MOD		3	/* modulus by zero */
+# define EXT_JIT_LSHIFT		4	/* negative left shift */
+# define EXT_JIT_RSHIFT		5	/* negative right shift */
+
+# define EXT_OCOUNT(obj)	(((uint64_t) (obj)->update << 32) | (obj)->count)
 
 
 /*
@@ -400,6 +409,7 @@ static void ext_runtime_error(Frame *f, char *mesg)
 static int (*jit)(int, int, size_t, size_t, uint16_t*, int, uint8_t*, int);
 static void (*compile)(uint64_t, uint64_t, int, uint8_t*, int, uint8_t*,
                        uint8_t*);
+static bool jitready;		/* kfuns passed to JIT extension */
 
 /*
  * NAME:        ext->jit()
@@ -411,6 +421,7 @@ static void ext_jit(int (*jit_init)(int, int, size_t, size_t, uint16_t*, int,
                                         uint8_t*, uint8_t*))
 {
     jit = jit_init;
+    jitready = FALSE;
     compile = jit_compile;
 }
 
@@ -421,27 +432,56 @@ static void ext_jit(int (*jit_init)(int, int, size_t, size_t, uint16_t*, int,
 void ext_kfuns(kfindex *map, char *protos, int nkfun)
 {
     if (compile != NULL && !(*jit)(VERSION_VM_MAJOR, VERSION_VM_MINOR,
-                                   sizeof(Int), sizeof(char),
+                                   sizeof(Int), sizeof(kfindex),
                                    (uint16_t *) map, nkfun + 128 - KF_BUILTINS,
                                    (uint8_t *) protos, nkfun))
     {
         compile = NULL;
     }
+    jitready = TRUE;
 }
 
 /*
  * NAME:        ext->compile()
- * DESCRIPTION: JIT compile an object
+ * DESCRIPTION: JIT compile a program
  */
-void ext_compile(Object *obj, char *ftypes, char *vtypes)
+void ext_compile(Control *ctrl)
 {
+    if (compile != NULL && !jitready) {
+	return;		/* try again later */
+    }
+    ctrl->jit = TRUE;
     if (compile != NULL) {
-        Control *ctrl;
+	dfuncdef *funcdefs;
+	dvardef *vardefs;
+	char *prog, *ftypes, *vtypes, *p;
+	int i;
+
+	/*
+	 * function types: class and program offset for each function,
+	 * variable types: type of each variable
+	 */
+	prog = d_get_prog(ctrl);
+	funcdefs = d_get_funcdefs(ctrl);
+	vardefs = d_get_vardefs(ctrl);
+	ftypes = ALLOCA(char, 5 * ctrl->nfuncdefs + 1);
+	vtypes = ALLOCA(char, ctrl->nvardefs + 1);
+	for (i = ctrl->nfuncdefs, p = ftypes; i > 0; --i, funcdefs++) {
+	    *p++ = funcdefs->sclass;
+	    *p++ = funcdefs->offset >> 24;
+	    *p++ = funcdefs->offset >> 16;
+	    *p++ = funcdefs->offset >> 8;
+	    *p++ = funcdefs->offset;
+	}
+	for (i = ctrl->nvardefs, p = vtypes; i > 0; --i, vardefs++) {
+	    *p++ = vardefs->type;
+	}
 
-        ctrl = obj->ctrl;
-        (*compile)(obj->index, obj->count, ctrl->ninherits,
-		   (uint8_t *) ctrl->prog, ctrl->nfuncdefs, (uint8_t *) ftypes,
-		   (uint8_t *) vtypes);
+	(*compile)(ctrl->oindex, EXT_OCOUNT(OBJR(ctrl->oindex)),
+		   ctrl->ninherits, (uint8_t *) prog, ctrl->nfuncdefs,
+		   (uint8_t *) ftypes, (uint8_t *) vtypes);
+	AFREE(vtypes);
+	AFREE(ftypes);
     }
 }
 
@@ -451,6 +491,80 @@ void ext_compile(Object *obj, char *ftypes, char *vtypes)
  */
 static void ext_compiled(uint64_t oindex, uint64_t ocount, char *shared)
 {
+    Object *obj;
+
+    obj = OBJR(oindex);
+    if (obj->count != 0 && EXT_OCOUNT(obj) == ocount &&
+	obj->ctrl != (Control *) NULL) {
+	obj->ctrl->jitfuncs = (voidf **) shared;
+    }
+}
+
+/*
+ * NAME:	ext->execute()
+ * DESCRIPTION:	execute a JIT compiled function, if possible
+ */
+bool ext_execute(Frame *f, int funci)
+{
+    int (*func) (Int*, Int*, int, Int*);
+    Int vars[MAX_LOCALS], *argp, ticks, result;
+    Value *v;
+    int nlocals, i, status;
+
+    func = (int (*) (Int*, Int*, int, Int*)) f->p_ctrl->jitfuncs[funci];
+    if (func == NULL) {
+	return FALSE;
+    }
+
+    /* arguments must be integers, local variables start out as 0 */
+    nlocals = f->fp - f->sp;
+    if (nlocals + f->nargs > MAX_LOCALS) {
+	return FALSE;
+    }
+    argp = vars + nlocals;
+    for (i = 0, v = f->argp; i < f->nargs; i++, v++) {
+	if (v->type != T_INT) {
+	    return FALSE;
+	}
+	argp[i] = v->u.number;
+    }
+    memset(vars, '\0', nlocals * sizeof(Int));
+
+    ticks = f->rlim->ticks;
+    status = (*func)(argp, &f->rlim->ticks, f->rlim->noticks, &result);
+    if (!f->rlim->noticks) {
+	tickcount += ticks - f->rlim->ticks;
+    }
+    if (status != 0) {
+	f->pc = f->prog + (status >> 8);
+	switch (status & 0xff) {
+	case EXT_JIT_TICKS:
+	    error("Out of ticks");
+	    break;
+
+	case EXT_JIT_DIV:
+	    error("Division by zero");
+	    break;
+
+	case EXT_JIT_MOD:
+	    error("Modulus by zero");
+	    break;
+
+	case EXT_JIT_LSHIFT:
+	    error("Negative left shift");
+	    break;
+
+	case EXT_JIT_RSHIFT:
+	    error("Negative right shift");
+	    break;
+
+	default:
+	    fatal("unknown JIT status %d", status & 0xff);
+	}
+    }
+
+    PUSH_INTVAL(f, result);
+    return TRUE;
 }
 
 /*
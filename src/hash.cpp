@@ -24,6 +24,8 @@
  * Generic string hash table.
  */
 
+Hashstat Hashtab::stats[HASHSTATS];
+
 unsigned char Hashtab::tab[256] = {
     0001, 0127, 0061, 0014, 0260, 0262, 0146, 0246,
     0171, 0301, 0006, 0124, 0371, 0346, 0054, 0243,
@@ -65,7 +67,17 @@ unsigned char Hashtab::tab[256] = {
  */
 Hashtab *Hashtab::create(unsigned int size, unsigned int maxlen, bool mem)
 {
-    return new HashtabImpl(size, maxlen, mem);
+    return new HashtabImpl(size, maxlen, mem, (Hashstat *) NULL);
+}
+
+/*
+ * NAME:	Hashtab::create()
+ * DESCRIPTION:	hashtable factory, keeping lookup statistics
+ */
+Hashtab *Hashtab::create(unsigned int size, unsigned int maxlen, bool mem,
+			 Hashstat *stat)
+{
+    return new HashtabImpl(size, maxlen, mem, stat);
 }
 
 /*
@@ -87,11 +99,48 @@ unsigned short Hashtab::hashstr(const char *str, unsigned int len)
     return (unsigned short) ((h << 8) | l);
 }
 
+# define HASHMUL1	0x9e3779b97f4a7c15ULL
+# define HASHMUL2	0xff51afd7ed558ccdULL
+
 /*
  * NAME:	Hashtab::hashmem()
- * DESCRIPTION:	hash memory
+ * DESCRIPTION:	Hash len bytes of memory, 8 at a time. Each word is mixed
+ *		in with a multiply and a shift, so that every bit of the
+ *		32 bit result depends on every byte of the input. The result
+ *		depends on the byte order of the host, and may change between
+ *		versions: use it for tables in memory only, never for hash
+ *		values that are saved. Switch tables use hashswitch().
  */
-unsigned short Hashtab::hashmem(const char *mem, unsigned int len)
+Uint Hashtab::hashmem(const char *mem, unsigned int len)
+{
+    Uuint h, w;
+
+    h = (Uuint) len * HASHMUL1;
+    while (len >= 8) {
+	memcpy(&w, mem, 8);
+	h = (h ^ w) * HASHMUL1;
+	h ^= h >> 32;
+	mem += 8;
+	len -= 8;
+    }
+    if (len != 0) {
+	w = 0;
+	memcpy(&w, mem, len);
+	h = (h ^ w) * HASHMUL1;
+	h ^= h >> 32;
+    }
+    h = (h ^ (h >> 29)) * HASHMUL2;
+    return (Uint) (h >> 32);
+}
+
+/*
+ * NAME:	Hashtab::hashswitch()
+ * DESCRIPTION:	Hash the string labels of a switch statement. Switch hash
+ *		tables are computed at compile time and saved with the
+ *		program, so this function is part of the program format, and
+ *		must produce the same value on every host. Never change it.
+ */
+unsigned short Hashtab::hashswitch(const char *mem, unsigned int len)
 {
     unsigned char h, l;
 
@@ -110,11 +159,13 @@ unsigned short Hashtab::hashmem(const char *mem, unsigned int len)
  * DESCRIPTION:	create a new hashtable of size "size", where "maxlen" characters
  *		of each string are significant
  */
-HashtabImpl::HashtabImpl(unsigned int size, unsigned int maxlen, bool mem)
+HashtabImpl::HashtabImpl(unsigned int size, unsigned int maxlen, bool mem,
+			 Hashstat *stat)
 {
     m_size = size;
     m_maxlen = maxlen;
     m_mem = mem;
+    m_stat = stat;
     m_table = ALLOC(Entry*, size);
     memset(m_table, '\0', size * sizeof(Entry*));
 }
@@ -136,7 +187,10 @@ HashtabImpl::~HashtabImpl()
 Hashtab::Entry **HashtabImpl::lookup(const char *name, bool move)
 {
     Entry **first, **e, *next;
+    const char *p;
+    Uint n;
 
+    n = 0;
     if (m_mem) {
 	first = e = &(m_table[hashmem(name, m_maxlen) % m_size]);
 	while (*e != (Entry *) NULL) {
@@ -147,14 +201,17 @@ Hashtab::Entry **HashtabImpl::lookup(const char *name, bool move)
 		    (*e)->next = *first;
 		    *first = *e;
 		    *e = next;
-		    return first;
+		    e = first;
 		}
 		break;
 	    }
 	    e = &((*e)->next);
+	    n++;
 	}
     } else {
-	first = e = &(m_table[hashstr(name, m_maxlen) % m_size]);
+	p = (const char *) memchr(name, '\0', m_maxlen);
+	first = e = &(m_table[hashmem(name, (p != (char *) NULL) ?
+						p - name : m_maxlen) % m_size]);
 	while (*e != (Entry *) NULL) {
 	    if (strcmp((*e)->name, name) == 0) {
 		if (move && e != first) {
@@ -163,12 +220,17 @@ Hashtab::Entry **HashtabImpl::lookup(const char *name, bool move)
 		    (*e)->next = *first;
 		    *first = *e;
 		    *e = next;
-		    return first;
+		    e = first;
 		}
 		break;
 	    }
 	    e = &((*e)->next);
+	    n++;
 	}
     }
+    if (m_stat != (Hashstat *) NULL) {
+	m_stat->lookups++;
+	m_stat->collisions += n;
+    }
     return e;
 }
@@ -20,17 +20,30 @@
 # ifndef H_HASH
 # define H_HASH
 
+struct Hashstat {
+    Uuint lookups;		/* # lookups */
+    Uuint collisions;		/* # keys compared that did not match */
+};
+
+# define HS_MAPPING	0	/* mapping indices, if compiled with MAPSTATS */
+# define HS_STRMERGE	1	/* string merge table */
+# define HS_OBJECT	2	/* object name table */
+# define HASHSTATS	3
+
 class Hashtab : public Allocated {
 public:
     virtual ~Hashtab() { }
 
     static Hashtab *create(unsigned int size, unsigned int maxlen, bool mem);
+    static Hashtab *create(unsigned int size, unsigned int maxlen, bool mem,
+			   Hashstat *stat);
 
     static unsigned char hashchar(char c) {
 	return tab[(unsigned char) c];
     }
     static unsigned short hashstr(const char *str, unsigned int len);
-    static unsigned short hashmem(const char *mem, unsigned int len);
+    static Uint hashmem(const char *mem, unsigned int len);
+    static unsigned short hashswitch(const char *mem, unsigned int len);
 
     struct Entry : public Allocated {
 	Entry *next;		/* next entry in hash table */
@@ -41,13 +54,16 @@ public:
     virtual Uint size() = 0;
     virtual Entry **lookup(const char*, bool) = 0;
 
+    static Hashstat stats[HASHSTATS];
+
 private:
     static unsigned char tab[256];
 };
 
 class HashtabImpl : public Hashtab {
 public:
-    HashtabImpl(unsigned int size, unsigned int maxlen, bool mem);
+    HashtabImpl(unsigned int size, unsigned int maxlen, bool mem,
+		Hashstat *stat);
     virtual ~HashtabImpl();
 
     virtual Entry **table() {
@@ -65,6 +81,7 @@ private:
     unsigned short m_maxlen;	/* max length of string to be used in hashing */
     bool m_mem;			/* \0-terminated string or raw memory? */
     Entry **m_table;		/* hash table entries */
+    Hashstat *m_stat;		/* lookup statistics, if any */
 };
 
 # endif /* H_HASH */
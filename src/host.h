@@ -147,6 +147,7 @@ typedef unsigned int Uint;
 # ifdef INCLUDE_FILE_IO
 # include <fcntl.h>
 # include <sys/stat.h>
+# include <sys/uio.h>
 # endif
 
 # ifdef INCLUDE_CTYPE
@@ -185,6 +186,7 @@ typedef unsigned int Uint;
 # ifdef INCLUDE_FILE_IO
 # include <fcntl.h>
 # include <sys/stat.h>
+# include <sys/uio.h>
 # ifndef FNDELAY
 # define FNDELAY	O_NDELAY
 # endif
@@ -255,6 +257,8 @@ extern void  P_message	(const char*);
 # define P_rmdir	rmdir
 # define P_chdir	chdir
 # define P_execv	execv
+# define P_preadv	preadv
+# define P_pwritev	pwritev
 # else
 	/* filename translation */
 typedef long off_t;
@@ -274,7 +278,36 @@ extern int P_mkdir	(const char*, int);
 extern int P_rmdir	(const char*);
 extern int P_chdir	(const char*);
 extern int P_execv	(const char*, char**);
+
+struct iovec {
+    void *iov_base;		/* buffer */
+    size_t iov_len;		/* size of buffer */
+};
+
+extern int P_preadv	(int, const struct iovec*, int, off_t);
+extern int P_pwritev	(int, const struct iovec*, int, off_t);
 # endif
+
+struct aioreq {
+    aioreq *next;		/* next in queue */
+    int fd;			/* file descriptor */
+    bool write;			/* write rather than read? */
+    volatile char state;	/* request state */
+    unsigned int size;		/* # bytes to transfer */
+    off_t offset;		/* file offset */
+    char *buf;			/* buffer */
+};
+
+# define AIO_DONE	0	/* request completed */
+# define AIO_QUEUED	1	/* request in progress */
+# define AIO_FAILED	2	/* request failed */
+
+extern void P_aio_queue	(aioreq*);
+extern bool P_aio_wait	(aioreq*);
+extern void P_aio_finish ();
+
+extern char *P_mmap	(int, off_t, bool);
+extern void P_munmap	(char*, off_t);
 # endif /* INCLUDE_FILE_IO */
 
 extern bool  P_opendir	(const char*);
@@ -292,6 +325,7 @@ extern long  P_random	();
 
 extern Uint  P_time	();
 extern Uint  P_mtime	(unsigned short*);
+extern Uuint P_utime	();
 extern char *P_ctime	(char*, Uint);
 
 /* these must be the same on all hosts */
@@ -0,0 +1,2508 @@
+/*
+ * This file is part of DGD, https://github.com/dworkin/dgd
+ * Copyright (C) 1993-2010 Dworkin B.V.
+ * Copyright (C) 2010-2017 DGD Authors (see the commit log for details)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+# include <sys/time.h>
+# include <sys/socket.h>
+# include <netinet/in.h>
+# include <arpa/inet.h>
+# include <netdb.h>
+# include <signal.h>
+# include <pthread.h>
+# include <errno.h>
+# define INCLUDE_FILE_IO
+# include "dgd.h"
+# include "hash.h"
+# include "comm.h"
+
+# if defined(LINUX) && !defined(NOEPOLL)
+#  define EPOLL		/* use epoll() rather than select() */
+# endif
+# ifdef EPOLL
+#  include <sys/epoll.h>
+# endif
+
+# ifdef INET6		/* INET6 defined */
+#  if INET6 == 0
+#   undef INET6		/* ... but turned off */
+#  endif
+# else
+#  ifdef AF_INET6	/* define INET6 if AF_INET6 exists */
+#   define INET6
+#  endif
+# endif
+
+# ifndef MAXHOSTNAMELEN
+# define MAXHOSTNAMELEN	1025
+# endif
+
+# ifndef INADDR_NONE
+# define INADDR_NONE	0xffffffffL
+# endif
+
+# define NFREE		32
+
+struct in46addr {
+    union {
+# ifdef INET6
+	struct in6_addr addr6;		/* IPv6 addr */
+# endif
+	struct in_addr addr;		/* IPv4 addr */
+    } in;
+    bool ipv6;				/* IPv6? */
+};
+
+struct ipaddr {
+    ipaddr *link;			/* next in hash table */
+    ipaddr *prev;			/* previous in linked list */
+    ipaddr *next;			/* next in linked list */
+    Uint ref;				/* reference count */
+    in46addr ipnum;			/* ip number */
+    char name[MAXHOSTNAMELEN];		/* ip name */
+};
+
+struct pipes {
+    int in;				/* input file descriptor */
+    int out;				/* output file descriptor */
+};
+
+static int in = -1, out = -1;		/* pipe to/from name resolver */
+static int addrtype;			/* network address family */
+static ipaddr **ipahtab;		/* ip address hash table */
+static unsigned int ipahtabsz;		/* hash table size */
+static ipaddr *qhead, *qtail;		/* request queue */
+static ipaddr *ffirst, *flast;		/* free list */
+static int nfree;			/* # in free list */
+static ipaddr *lastreq;			/* last request */
+static bool busy;			/* name resolver busy */
+static pthread_t lookup;		/* name lookup thread */
+
+
+extern "C" {
+
+/*
+ * NAME:	ipaddr->run()
+ * DESCRIPTION:	host name lookup thread
+ */
+static void *ipa_run(void *arg)
+{
+    char buf[sizeof(in46addr)];
+    struct pipes *inout;
+    struct hostent *host;
+    int len;
+
+    inout = (pipes *) arg;
+
+    while (read(inout->in, buf, sizeof(in46addr)) > 0) {
+	/* lookup host */
+# ifdef INET6
+	if (((in46addr *) &buf)->ipv6) {
+	    host = gethostbyaddr(buf, sizeof(struct in6_addr), AF_INET6);
+	    if (host == (struct hostent *) NULL) {
+		sleep(2);
+		host = gethostbyaddr(buf, sizeof(struct in6_addr), AF_INET6);
+	    }
+	} else
+# endif
+	{
+	    host = gethostbyaddr(buf, sizeof(struct in_addr), AF_INET);
+	    if (host == (struct hostent *) NULL) {
+		sleep(2);
+		host = gethostbyaddr(buf, sizeof(struct in_addr), AF_INET);
+	    }
+	}
+
+	if (host != (struct hostent *) NULL) {
+	    char *name;
+
+	    /* write host name */
+	    name = (char *) host->h_name;
+	    len = strlen(name);
+	    if (len >= MAXHOSTNAMELEN) {
+		len = MAXHOSTNAMELEN - 1;
+	    }
+	    (void) write(inout->out, name, len);
+	    name[0] = '\0';
+	} else {
+	    (void) write(inout->out, "", 1);	/* failure */
+	}
+    }
+
+    close(inout->in);
+    close(inout->out);
+    return NULL;
+}
+
+}
+
+/*
+ * NAME:	ipaddr->init()
+ * DESCRIPTION:	initialize name lookup
+ */
+static bool ipa_init(int maxusers)
+{
+    if (in < 0) {
+	int fd[4];
+	static pipes inout;
+
+	if (pipe(fd) < 0) {
+	    perror("pipe");
+	    return FALSE;
+	}
+	if (pipe(fd + 2) < 0) {
+	    perror("pipe");
+	    close(fd[0]);
+	    close(fd[1]);
+	    return FALSE;
+	}
+	inout.in = fd[0];
+	inout.out = fd[3];
+	if (pthread_create(&lookup, NULL, &ipa_run, &inout) < 0) {
+	    perror("pthread_create");
+	    close(fd[0]);
+	    close(fd[1]);
+	    close(fd[2]);
+	    close(fd[3]);
+	    return FALSE;
+	}
+	in = fd[2];
+	out = fd[1];
+    } else if (busy) {
+	char buf[MAXHOSTNAMELEN];
+
+	/* discard ip name */
+	(void) read(in, buf, MAXHOSTNAMELEN);
+    }
+
+    ipahtab = ALLOC(ipaddr*, ipahtabsz = maxusers);
+    memset(ipahtab, '\0', ipahtabsz * sizeof(ipaddr*));
+    qhead = qtail = ffirst = flast = lastreq = (ipaddr *) NULL;
+    nfree = 0;
+    busy = FALSE;
+
+    return TRUE;
+}
+
+/*
+ * NAME:	ipaddr->finish()
+ * DESCRIPTION:	stop name lookup
+ */
+static void ipa_finish()
+{
+    int status;
+
+    close(out);
+    close(in);
+    pthread_join(lookup, NULL);
+}
+
+/*
+ * NAME:	ipaddr->new()
+ * DESCRIPTION:	return a new ipaddr
+ */
+static ipaddr *ipa_new(in46addr *ipnum)
+{
+    ipaddr *ipa, **hash;
+
+    /* check hash table */
+# ifdef INET6
+    if (ipnum->ipv6) {
+	hash = &ipahtab[Hashtab::hashmem((char *) ipnum,
+					 sizeof(struct in6_addr)) % ipahtabsz];
+    } else
+# endif
+    {
+	hash = &ipahtab[(Uint) ipnum->in.addr.s_addr % ipahtabsz];
+    }
+    while (*hash != (ipaddr *) NULL) {
+	ipa = *hash;
+# ifdef INET6
+	if (ipnum->ipv6 == ipa->ipnum.ipv6 &&
+	    ((ipnum->ipv6) ?
+	      memcmp(&ipnum->in.addr6, &ipa->ipnum.in.addr6,
+		     sizeof(struct in6_addr)) == 0 :
+	      ipnum->in.addr.s_addr == ipa->ipnum.in.addr.s_addr)) {
+# else
+	if (ipnum->in.addr.s_addr == ipa->ipnum.in.addr.s_addr) {
+# endif
+	    /*
+	     * found it
+	     */
+	    if (ipa->ref == 0) {
+		/* remove from free list */
+		if (ipa->prev == (ipaddr *) NULL) {
+		    ffirst = ipa->next;
+		} else {
+		    ipa->prev->next = ipa->next;
+		}
+		if (ipa->next == (ipaddr *) NULL) {
+		    flast = ipa->prev;
+		} else {
+		    ipa->next->prev = ipa->prev;
+		}
+		ipa->prev = ipa->next = (ipaddr *) NULL;
+		--nfree;
+	    }
+	    ipa->ref++;
+
+	    if (ipa->name[0] == '\0' && ipa != lastreq &&
+		ipa->prev == (ipaddr *) NULL && ipa != qhead) {
+		if (!busy) {
+		    /* send query to name resolver */
+		    (void) write(out, (char *) ipnum, sizeof(in46addr));
+		    lastreq = ipa;
+		    busy = TRUE;
+		} else {
+		    /* put in request queue */
+		    ipa->prev = qtail;
+		    if (qtail == (ipaddr *) NULL) {
+			qhead = ipa;
+		    } else {
+			qtail->next = ipa;
+		    }
+		    qtail = ipa;
+		}
+	    }
+	    return ipa;
+	}
+	hash = &ipa->link;
+    }
+
+    if (nfree >= NFREE) {
+	ipaddr **h;
+
+	/*
+	 * use first ipaddr in free list
+	 */
+	ipa = ffirst;
+	ffirst = ipa->next;
+	ffirst->prev = (ipaddr *) NULL;
+	--nfree;
+
+	if (ipa == lastreq) {
+	    lastreq = (ipaddr *) NULL;
+	}
+
+	if (hash != &ipa->link) {
+	    /* remove from hash table */
+# ifdef INET6
+	    if (ipa->ipnum.ipv6) {
+		h = &ipahtab[Hashtab::hashmem((char *) &ipa->ipnum,
+					      sizeof(struct in6_addr)) %
+								    ipahtabsz];
+	    } else
+# endif
+	    {
+		h = &ipahtab[(Uint) ipa->ipnum.in.addr.s_addr % ipahtabsz];
+	    }
+	    while (*h != ipa) {
+		h = &(*h)->link;
+	    }
+	    *h = ipa->link;
+
+	    /* put in hash table */
+	    ipa->link = *hash;
+	    *hash = ipa;
+	}
+    } else {
+	/*
+	 * allocate new ipaddr
+	 */
+	m_static();
+	ipa = ALLOC(ipaddr, 1);
+	m_dynamic();
+
+	/* put in hash table */
+	ipa->link = *hash;
+	*hash = ipa;
+    }
+
+    ipa->ref = 1;
+    ipa->ipnum = *ipnum;
+    ipa->name[0] = '\0';
+    ipa->prev = ipa->next = (ipaddr *) NULL;
+
+    if (!busy) {
+	/* send query to name resolver */
+	(void) write(out, (char *) ipnum, sizeof(in46addr));
+	lastreq = ipa;
+	busy = TRUE;
+    } else {
+	/* put in request queue */
+	ipa->prev = qtail;
+	if (qtail == (ipaddr *) NULL) {
+	    qhead = ipa;
+	} else {
+	    qtail->next = ipa;
+	}
+	qtail = ipa;
+    }
+
+    return ipa;
+}
+
+/*
+ * NAME:	ipaddr->del()
+ * DESCRIPTION:	delete an ipaddr
+ */
+static void ipa_del(ipaddr *ipa)
+{
+    if (--ipa->ref == 0) {
+	if (ipa->prev != (ipaddr *) NULL || qhead == ipa) {
+	    /* remove from queue */
+	    if (ipa->prev != (ipaddr *) NULL) {
+		ipa->prev->next = ipa->next;
+	    } else {
+		qhead = ipa->next;
+	    }
+	    if (ipa->next != (ipaddr *) NULL) {
+		ipa->next->prev = ipa->prev;
+	    } else {
+		qtail = ipa->prev;
+	    }
+	}
+
+	/* add to free list */
+	if (flast != (ipaddr *) NULL) {
+	    flast->next = ipa;
+	    ipa->prev = flast;
+	    flast = ipa;
+	} else {
+	    ffirst = flast = ipa;
+	    ipa->prev = (ipaddr *) NULL;
+	}
+	ipa->next = (ipaddr *) NULL;
+	nfree++;
+    }
+}
+
+/*
+ * NAME:	ipaddr->lookup()
+ * DESCRIPTION:	lookup another ip name
+ */
+static void ipa_lookup()
+{
+    ipaddr *ipa;
+
+    if (lastreq != (ipaddr *) NULL) {
+	/* read ip name */
+	lastreq->name[read(in, lastreq->name, MAXHOSTNAMELEN)] = '\0';
+    } else {
+	char buf[MAXHOSTNAMELEN];
+
+	/* discard ip name */
+	(void) read(in, buf, MAXHOSTNAMELEN);
+    }
+
+    /* if request queue not empty, write new query */
+    if (qhead != (ipaddr *) NULL) {
+	ipa = qhead;
+	(void) write(out, (char *) &ipa->ipnum, sizeof(in46addr));
+	qhead = ipa->next;
+	if (qhead == (ipaddr *) NULL) {
+	    qtail = (ipaddr *) NULL;
+	} else {
+	    qhead->prev = (ipaddr *) NULL;
+	}
+	ipa->prev = ipa->next = (ipaddr *) NULL;
+	lastreq = ipa;
+	busy = TRUE;
+    } else {
+	lastreq = (ipaddr *) NULL;
+	busy = FALSE;
+    }
+}
+
+struct connection : public Hashtab::Entry {
+    int fd;				/* file descriptor */
+    int npkts;				/* # packets in buffer */
+    int bufsz;				/* # bytes in buffer */
+    char *udpbuf;			/* datagram buffer */
+    ipaddr *addr;			/* internet address of connection */
+    unsigned short port;		/* UDP port of connection */
+    short at;				/* port connection was accepted at */
+    void *owner;			/* owner of this connection */
+};
+
+struct portdesc {
+    int in6;				/* IPv6 port descriptor */
+    int in4;				/* IPv4 port descriptor */
+};
+
+struct udpdesc {
+    struct portdesc fd;			/* port descriptors */
+    in46addr addr;			/* source of new packet */
+    unsigned short port;		/* source port of new datagram */
+    bool accept;			/* datagram ready to accept? */
+    unsigned short hashval;		/* address hash */
+    int size;				/* size in buffer */
+    char buffer[BINBUF_SIZE];		/* buffer */
+};
+
+static connection **udphtab;		/* UDP hash table */
+static int udphtabsz;			/* UDP hash table size */
+static Hashtab *chtab;			/* challenge hash table */
+static udpdesc *udescs;			/* UDP port descriptor array */
+static int nudescs;			/* # datagram ports */
+static int inpkts, outpkts;		/* UDP packet notification pipe */
+static pthread_t udp;			/* UDP thread */
+static pthread_mutex_t udpmutex;	/* UDP mutex */
+static bool udpstop;			/* stop UDP thread? */
+static bool udpattach;			/* UDP channel attached? */
+
+# ifdef INET6
+/*
+ * NAME:	udp->recv6()
+ * DESCRIPTION:	receive an UDP packet
+ */
+static void udp_recv6(int n)
+{
+    char buffer[BINBUF_SIZE];
+    struct sockaddr_in6 from;
+    socklen_t fromlen;
+    int size;
+    unsigned short hashval;
+    connection **hash, *conn;
+    char *p;
+
+    memset(buffer, '\0', UDPHASHSZ);
+    fromlen = sizeof(struct sockaddr_in6);
+    size = recvfrom(udescs[n].fd.in6, buffer, BINBUF_SIZE, 0,
+		    (struct sockaddr *) &from, &fromlen);
+    if (size < 0) {
+	return;
+    }
+
+    hashval = (Hashtab::hashmem((char *) &from.sin6_addr,
+				sizeof(struct in6_addr)) ^ from.sin6_port) %
+								    udphtabsz;
+    hash = &udphtab[hashval];
+    pthread_mutex_lock(&udpmutex);
+    for (;;) {
+	conn = *hash;
+	if (conn == (connection *) NULL) {
+	    if (!conf_attach(n)) {
+		if (!udescs[n].accept) {
+		    if (IN6_IS_ADDR_V4MAPPED(&from.sin6_addr)) {
+			/* convert to IPv4 address */
+			udescs[n].addr.in.addr = *(struct in_addr *)
+						    &from.sin6_addr.s6_addr[12];
+			udescs[n].addr.ipv6 = FALSE;
+		    } else {
+			udescs[n].addr.in.addr6 = from.sin6_addr;
+			udescs[n].addr.ipv6 = TRUE;
+		    }
+		    udescs[n].port = from.sin6_port;
+		    udescs[n].hashval = hashval;
+		    udescs[n].size = size;
+		    memcpy(udescs[n].buffer, buffer, size);
+		    udescs[n].accept = TRUE;
+		    write(outpkts, buffer, 1);
+		}
+		break;
+	    }
+
+	    /*
+	     * see if the packet matches an outstanding challenge
+	     */
+	    hash = (connection **) chtab->lookup(buffer, FALSE);
+	    while ((conn=*hash) != (connection *) NULL &&
+		   memcmp(conn->name, buffer, UDPHASHSZ) == 0) {
+		if (conn->bufsz == size &&
+		    memcmp(conn->udpbuf, buffer, size) == 0 &&
+		    conn->addr->ipnum.ipv6 &&
+		    memcmp(&conn->addr->ipnum, &from.sin6_addr,
+			   sizeof(struct in6_addr)) == 0) {
+		    /*
+		     * attach new UDP channel
+		     */
+		    *hash = (connection *) conn->next;
+		    conn->name = (char *) NULL;
+		    conn->bufsz = 0;
+		    conn->port = from.sin6_port;
+		    hash = &udphtab[hashval];
+		    conn->next = *hash;
+		    *hash = conn;
+		    udpattach = TRUE;
+
+		    break;
+		}
+		hash = (connection **) &conn->next;
+	    }
+	    break;
+	}
+
+	if (conn->at == n && conn->port == from.sin6_port &&
+	    memcmp(&conn->addr->ipnum, &from.sin6_addr,
+		   sizeof(struct in6_addr)) == 0) {
+	    /*
+	     * packet from known correspondent
+	     */
+	    if (conn->bufsz + size <= BINBUF_SIZE) {
+		p = conn->udpbuf + conn->bufsz;
+		*p++ = size >> 8;
+		*p++ = size;
+		memcpy(p, buffer, size);
+		conn->bufsz += size + 2;
+		conn->npkts++;
+		write(outpkts, buffer, 1);
+	    }
+	    break;
+	}
+	hash = (connection **) &conn->next;
+    }
+    pthread_mutex_unlock(&udpmutex);
+}
+# endif
+
+/*
+ * NAME:	udp->recv()
+ * DESCRIPTION:	receive an UDP packet
+ */
+static void udp_recv(int n)
+{
+    char buffer[BINBUF_SIZE];
+    struct sockaddr_in from;
+    socklen_t fromlen;
+    int size;
+    unsigned short hashval;
+    connection **hash, *conn;
+    char *p;
+
+    memset(buffer, '\0', UDPHASHSZ);
+    fromlen = sizeof(struct sockaddr_in);
+    size = recvfrom(udescs[n].fd.in4, buffer, BINBUF_SIZE, 0,
+		    (struct sockaddr *) &from, &fromlen);
+    if (size < 0) {
+	return;
+    }
+
+    hashval = ((Uint) from.sin_addr.s_addr ^ from.sin_port) % udphtabsz;
+    hash = &udphtab[hashval];
+    pthread_mutex_lock(&udpmutex);
+    for (;;) {
+	conn = *hash;
+	if (conn == (connection *) NULL) {
+	    if (!conf_attach(n)) {
+		if (!udescs[n].accept) {
+		    udescs[n].addr.in.addr = from.sin_addr;
+		    udescs[n].addr.ipv6 = FALSE;
+		    udescs[n].port = from.sin_port;
+		    udescs[n].hashval = hashval;
+		    udescs[n].size = size;
+		    memcpy(udescs[n].buffer, buffer, size);
+		    udescs[n].accept = TRUE;
+		    write(outpkts, buffer, 1);
+		}
+		break;
+	    }
+
+	    /*
+	     * see if the packet matches an outstanding challenge
+	     */
+	    hash = (connection **) chtab->lookup(buffer, FALSE);
+	    while ((conn=*hash) != (connection *) NULL &&
+		   memcmp((*hash)->name, buffer, UDPHASHSZ) == 0) {
+		if (conn->bufsz == size &&
+		    memcmp(conn->udpbuf, buffer, size) == 0 &&
+		    !conn->addr->ipnum.ipv6 &&
+		    conn->addr->ipnum.in.addr.s_addr == from.sin_addr.s_addr) {
+		    /*
+		     * attach new UDP channel
+		     */
+		    *hash = (connection *) conn->next;
+		    conn->name = (char *) NULL;
+		    conn->bufsz = 0;
+		    conn->port = from.sin_port;
+		    hash = &udphtab[hashval];
+		    conn->next = *hash;
+		    *hash = conn;
+		    udpattach = TRUE;
+
+		    break;
+		}
+		hash = (connection **) &conn->next;
+	    }
+	    break;
+	}
+
+	if (conn->at == n &&
+	    conn->addr->ipnum.in.addr.s_addr == from.sin_addr.s_addr &&
+	    conn->port == from.sin_port) {
+	    /*
+	     * packet from known correspondent
+	     */
+	    if (conn->bufsz + size <= BINBUF_SIZE) {
+		p = conn->udpbuf + conn->bufsz;
+		*p++ = size >> 8;
+		*p++ = size;
+		memcpy(p, buffer, size);
+		conn->bufsz += size + 2;
+		conn->npkts++;
+		write(outpkts, buffer, 1);
+	    }
+	    break;
+	}
+	hash = (connection **) &conn->next;
+    }
+    pthread_mutex_unlock(&udpmutex);
+}
+
+extern "C" {
+
+/*
+ * NAME:	udp->run()
+ * DESCRIPTION:	UDP thread
+ */
+static void *udp_run(void *arg)
+{
+    fd_set udpfds;
+    fd_set readfds;
+    fd_set errorfds;
+    int maxufd, n, retval;
+
+    FD_ZERO(&udpfds);
+    maxufd = 0;
+    for (n = 0; n < nudescs; n++) {
+# ifdef INET6
+	if (udescs[n].fd.in6 >= 0) {
+	    FD_SET(udescs[n].fd.in6, &udpfds);
+	    if (udescs[n].fd.in6 > maxufd) {
+		maxufd = udescs[n].fd.in6;
+	    }
+	}
+# endif
+	if (udescs[n].fd.in4 >= 0) {
+	    FD_SET(udescs[n].fd.in4, &udpfds);
+	    if (udescs[n].fd.in4 > maxufd) {
+		maxufd = udescs[n].fd.in4;
+	    }
+	}
+    }
+
+    for (;;) {
+	memcpy(&readfds, &udpfds, sizeof(fd_set));
+	memcpy(&errorfds, &udpfds, sizeof(fd_set));
+	retval = select(maxufd + 1, &readfds, (fd_set *) NULL, &errorfds,
+		        (struct timeval *) NULL);
+	if (udpstop) {
+	    break;
+	}
+
+	if (retval > 0) {
+	    for (n = 0; n < nudescs; n++) {
+# ifdef INET6
+		if (udescs[n].fd.in6 >= 0 &&
+		    FD_ISSET(udescs[n].fd.in6, &readfds)) {
+		    udp_recv6(n);
+		}
+# endif
+		if (udescs[n].fd.in4 >= 0 &&
+		    FD_ISSET(udescs[n].fd.in4, &readfds)) {
+		    udp_recv(n);
+		}
+	    }
+	}
+    }
+
+    pthread_mutex_destroy(&udpmutex);
+    close(inpkts);
+    close(outpkts);
+    return (void *) NULL;
+}
+
+}
+
+static int nusers;			/* # of users */
+static connection *connections;		/* connections array */
+static connection *flist;		/* list of free connections */
+static portdesc *tdescs, *bdescs;	/* telnet & binary descriptor arrays */
+static int ntdescs, nbdescs;		/* # telnet & binary ports */
+static bool accepting;			/* listening for new connections? */
+static int closed;			/* #fds closed in write */
+static int readyc;			/* next connection to check */
+static bool attach;			/* check for attached UDP channels */
+
+# define FDF_IN		0x01	/* check for input */
+# define FDF_OUT	0x02	/* check for output */
+# define FDF_WAIT	0x04	/* waiting for output */
+# define FDF_READ	0x08	/* input available */
+# define FDF_WRITE	0x10	/* output possible */
+
+# ifdef EPOLL
+static int epfd;			/* epoll descriptor */
+static epoll_event *events;		/* events from last wait */
+static int nevents;			/* # events from last wait */
+static int maxevents;			/* size of events array */
+static int readyev;			/* next event to check */
+static char *fdflags;			/* per-descriptor flags */
+static connection **fdconns;		/* per-descriptor connections */
+static int nfdflags;			/* size of fdflags table */
+
+/*
+ * NAME:	fd->ctl()
+ * DESCRIPTION:	bring the epoll registration of a descriptor up to date
+ */
+static void fd_ctl(int fd, int old)
+{
+    epoll_event ev;
+
+    ev.events = 0;
+    if (fdflags[fd] & FDF_IN) {
+	ev.events |= EPOLLIN;
+    }
+    if (fdflags[fd] & FDF_WAIT) {
+	ev.events |= EPOLLOUT;
+    }
+    ev.data.u64 = 0;
+    ev.data.fd = fd;
+
+    if (ev.events == 0) {
+	/* even an empty registration would report hangups */
+	epoll_ctl(epfd, EPOLL_CTL_DEL, fd, &ev);
+    } else if (old & (FDF_IN | FDF_WAIT)) {
+	epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev);
+    } else {
+	epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+/*
+ * NAME:	fd->on()
+ * DESCRIPTION:	set descriptor flags
+ */
+static void fd_on(int fd, int flags)
+{
+    int old;
+
+    if (fd >= nfdflags) {
+	int size;
+
+	size = (nfdflags == 0) ? 256 : nfdflags;
+	while (size <= fd) {
+	    size <<= 1;
+	}
+	m_static();
+	fdflags = REALLOC(fdflags, char, nfdflags, size);
+	fdconns = REALLOC(fdconns, connection*, nfdflags, size);
+	m_dynamic();
+	memset(fdflags + nfdflags, '\0', size - nfdflags);
+	memset(fdconns + nfdflags, '\0', (size - nfdflags) * sizeof(connection*));
+	nfdflags = size;
+    }
+
+    old = fdflags[fd];
+    fdflags[fd] |= flags;
+    if ((old ^ fdflags[fd]) & (FDF_IN | FDF_WAIT)) {
+	fd_ctl(fd, old);
+    }
+}
+
+/*
+ * NAME:	fd->off()
+ * DESCRIPTION:	clear descriptor flags
+ */
+static void fd_off(int fd, int flags)
+{
+    int old;
+
+    if (fd < nfdflags) {
+	old = fdflags[fd];
+	fdflags[fd] &= ~flags;
+	if ((old ^ fdflags[fd]) & (FDF_IN | FDF_WAIT)) {
+	    fd_ctl(fd, old);
+	}
+    }
+}
+
+/*
+ * NAME:	fd->test()
+ * DESCRIPTION:	test a descriptor flag
+ */
+static bool fd_test(int fd, int flag)
+{
+    return (fd < nfdflags && (fdflags[fd] & flag));
+}
+
+/*
+ * NAME:	fd->close()
+ * DESCRIPTION:	forget about a descriptor that is about to be closed
+ */
+static void fd_close(int fd)
+{
+    fd_off(fd, FDF_IN | FDF_OUT | FDF_WAIT | FDF_READ | FDF_WRITE);
+    if (fd < nfdflags) {
+	fdconns[fd] = (connection *) NULL;
+    }
+}
+
+/*
+ * NAME:	fd->conn()
+ * DESCRIPTION:	associate a descriptor with a connection
+ */
+static void fd_conn(int fd, connection *conn)
+{
+    fdconns[fd] = conn;
+}
+# else
+static fd_set infds;			/* file descriptor input bitmap */
+static fd_set outfds;			/* file descriptor output bitmap */
+static fd_set waitfds;			/* file descriptor wait-write bitmap */
+static fd_set readfds;			/* file descriptor read bitmap */
+static fd_set writefds;			/* file descriptor write map */
+static int maxfd;			/* largest fd opened yet */
+
+/*
+ * NAME:	fd->on()
+ * DESCRIPTION:	set descriptor flags
+ */
+static void fd_on(int fd, int flags)
+{
+    if (flags & FDF_IN) {
+	FD_SET(fd, &infds);
+    }
+    if (flags & FDF_OUT) {
+	FD_SET(fd, &outfds);
+    }
+    if (flags & FDF_WAIT) {
+	FD_SET(fd, &waitfds);
+    }
+    if (flags & FDF_READ) {
+	FD_SET(fd, &readfds);
+    }
+    if (flags & FDF_WRITE) {
+	FD_SET(fd, &writefds);
+    }
+    if (fd > maxfd) {
+	maxfd = fd;
+    }
+}
+
+/*
+ * NAME:	fd->off()
+ * DESCRIPTION:	clear descriptor flags
+ */
+static void fd_off(int fd, int flags)
+{
+    if (flags & FDF_IN) {
+	FD_CLR(fd, &infds);
+    }
+    if (flags & FDF_OUT) {
+	FD_CLR(fd, &outfds);
+    }
+    if (flags & FDF_WAIT) {
+	FD_CLR(fd, &waitfds);
+    }
+    if (flags & FDF_READ) {
+	FD_CLR(fd, &readfds);
+    }
+    if (flags & FDF_WRITE) {
+	FD_CLR(fd, &writefds);
+    }
+}
+
+/*
+ * NAME:	fd->test()
+ * DESCRIPTION:	test a descriptor flag
+ */
+static bool fd_test(int fd, int flag)
+{
+    switch (flag) {
+    case FDF_IN:
+	return FD_ISSET(fd, &infds);
+
+    case FDF_OUT:
+	return FD_ISSET(fd, &outfds);
+
+    case FDF_WAIT:
+	return FD_ISSET(fd, &waitfds);
+
+    case FDF_READ:
+	return FD_ISSET(fd, &readfds);
+
+    case FDF_WRITE:
+	return FD_ISSET(fd, &writefds);
+    }
+    return FALSE;
+}
+
+/*
+ * NAME:	fd->close()
+ * DESCRIPTION:	forget about a descriptor that is about to be closed
+ */
+static void fd_close(int fd)
+{
+    fd_off(fd, FDF_IN | FDF_OUT | FDF_WAIT);
+}
+
+# define fd_conn(fd, conn)	/* connections are found by scanning */
+# endif /* EPOLL */
+
+/*
+ * NAME:	conn->portfd()
+ * DESCRIPTION:	start or stop checking a port descriptor for new connections
+ */
+static void conn_portfd(int fd, bool flag)
+{
+    if (fd >= 0) {
+	if (flag) {
+	    fd_on(fd, FDF_IN);
+	} else {
+	    fd_off(fd, FDF_IN | FDF_READ);
+	}
+    }
+}
+
+/*
+ * NAME:	conn->accepting()
+ * DESCRIPTION:	start or stop checking the ports for new connections
+ */
+static void conn_accepting(bool flag)
+{
+    int n;
+
+    for (n = 0; n < ntdescs; n++) {
+	conn_portfd(tdescs[n].in6, flag);
+	conn_portfd(tdescs[n].in4, flag);
+    }
+    for (n = 0; n < nbdescs; n++) {
+	conn_portfd(bdescs[n].in6, flag);
+	conn_portfd(bdescs[n].in4, flag);
+    }
+    accepting = flag;
+}
+
+# ifdef INET6
+/*
+ * NAME:	conn->port6()
+ * DESCRIPTION:	open an IPv6 port
+ */
+static int conn_port6(int *fd, int type, struct sockaddr_in6 *sin6, unsigned int port)
+{
+    int on;
+
+    if ((*fd=socket(AF_INET6, type, 0)) < 0) {
+	perror("socket IPv6");
+	return FALSE;
+    }
+    on = 1;
+    if (setsockopt(*fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) < 0) {
+	perror("setsockopt");
+	return FALSE;
+    }
+# if defined(IPPROTO_IPV6) && defined(IPV6_V6ONLY)
+    on = 1;
+    if (setsockopt(*fd, IPPROTO_IPV6, IPV6_V6ONLY, &on, sizeof(on)) < 0) {
+	perror("setsockopt");
+	return FALSE;
+    }
+# endif
+# ifdef SO_OOBINLINE
+    if (type == SOCK_STREAM) {
+	on = 1;
+	if (setsockopt(*fd, SOL_SOCKET, SO_OOBINLINE, &on, sizeof(on)) < 0) {
+	    perror("setsockopt");
+	    return FALSE;
+	}
+    }
+# endif
+    sin6->sin6_port = htons(port);
+    if (bind(*fd, (struct sockaddr *) sin6, sizeof(struct sockaddr_in6)) < 0) {
+	perror("bind");
+	return FALSE;
+    }
+
+    if (type == SOCK_STREAM) {
+	fd_on(*fd, FDF_IN);
+    }
+    return TRUE;
+}
+# endif
+
+/*
+ * NAME:	conn->port()
+ * DESCRIPTION:	open an IPv4 port
+ */
+static int conn_port(int *fd, int type, struct sockaddr_in *sin, unsigned int port)
+{
+    int on;
+
+    if ((*fd=socket(AF_INET, type, 0)) < 0) {
+	perror("socket");
+	return FALSE;
+    }
+    on = 1;
+    if (setsockopt(*fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) < 0) {
+	perror("setsockopt");
+	return FALSE;
+    }
+# ifdef SO_OOBINLINE
+    if (type == SOCK_STREAM) {
+	on = 1;
+	if (setsockopt(*fd, SOL_SOCKET, SO_OOBINLINE, &on, sizeof(on)) < 0) {
+	    perror("setsockopt");
+	    return FALSE;
+	}
+    }
+# endif
+    sin->sin_port = htons(port);
+    if (bind(*fd, (struct sockaddr *) sin, sizeof(struct sockaddr_in)) < 0) {
+	perror("bind");
+	return FALSE;
+    }
+
+    if (type == SOCK_STREAM) {
+	fd_on(*fd, FDF_IN);
+    }
+    return TRUE;
+}
+
+/*
+ * NAME:	conn->init()
+ * DESCRIPTION:	initialize connection handling
+ */
+bool conn_init(int maxusers, char **thosts, char **bhosts, char **dhosts,
+	unsigned short *tports, unsigned short *bports, unsigned short *dports,
+	int ntports, int nbports, int ndports)
+{
+# ifdef INET6
+    struct sockaddr_in6 sin6;
+# endif
+    struct sockaddr_in sin;
+    struct hostent *host;
+    int n, fds[2];
+    connection *conn;
+    bool ipv6, ipv4;
+# ifdef AI_DEFAULT
+    int err;
+# endif
+
+    if (!ipa_init(maxusers)) {
+	return FALSE;
+    }
+
+    addrtype = PF_INET;
+
+    nusers = 0;
+
+# ifdef EPOLL
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+	perror("epoll_create1");
+	return FALSE;
+    }
+    fdflags = (char *) NULL;
+    fdconns = (connection **) NULL;
+    nfdflags = 0;
+    nevents = readyev = 0;
+# else
+    maxfd = 0;
+    FD_ZERO(&infds);
+    FD_ZERO(&outfds);
+    FD_ZERO(&waitfds);
+    FD_ZERO(&readfds);
+    FD_ZERO(&writefds);
+# endif
+    fd_on(in, FDF_IN);
+    closed = 0;
+    readyc = maxusers;
+    attach = udpattach = FALSE;
+
+    pipe(fds);
+    inpkts = fds[0];
+    outpkts = fds[1];
+    fd_on(inpkts, FDF_IN);
+
+    ntdescs = ntports;
+    if (ntports != 0) {
+	tdescs = ALLOC(portdesc, ntports);
+	memset(tdescs, -1, ntports * sizeof(portdesc));
+    }
+    nbdescs = nbports;
+    if (nbports != 0) {
+	bdescs = ALLOC(portdesc, nbports);
+	memset(bdescs, -1, nbports * sizeof(portdesc));
+    }
+    nudescs = ndports;
+    if (ndports != 0) {
+	udescs = ALLOC(udpdesc, ndports);
+	memset(udescs, -1, ndports * sizeof(udpdesc));
+    }
+
+# ifdef INET6
+    memset(&sin6, '\0', sizeof(sin6));
+    sin6.sin6_family = AF_INET6;
+# endif
+    memset(&sin, '\0', sizeof(sin));
+    sin.sin_family = AF_INET;
+
+    for (n = 0; n < ntdescs; n++) {
+	/* telnet ports */
+	ipv6 = FALSE;
+	ipv4 = FALSE;
+	if (thosts[n] == (char *) NULL) {
+# ifdef INET6
+	    sin6.sin6_addr = in6addr_any;
+	    ipv6 = TRUE;
+# endif
+	    sin.sin_addr.s_addr = htonl(INADDR_ANY);
+	    ipv4 = TRUE;
+	} else {
+# ifdef INET6
+	    if (inet_pton(AF_INET6, thosts[n], &sin6) > 0) {
+		sin6.sin6_family = AF_INET6;
+		ipv6 = TRUE;
+	    } else {
+# ifdef AI_DEFAULT
+		host = getipnodebyname(thosts[n], AF_INET6, 0, &err);
+		if (host != (struct hostent *) NULL) {
+		    if (host->h_length != 4) {
+			memcpy(&sin6.sin6_addr, host->h_addr, host->h_length);
+			ipv6 = TRUE;
+		    }
+		    freehostent(host);
+		}
+# else
+		host = gethostbyname2(thosts[n], AF_INET6);
+		if (host != (struct hostent *) NULL && host->h_length != 4) {
+		    memcpy(&sin6.sin6_addr, host->h_addr, host->h_length);
+		    ipv6 = TRUE;
+		}
+# endif
+	    }
+# endif
+	    if ((sin.sin_addr.s_addr=inet_addr(thosts[n])) != INADDR_NONE) {
+		ipv4 = TRUE;
+	    } else {
+		host = gethostbyname(thosts[n]);
+		if (host != (struct hostent *) NULL) {
+		    memcpy(&sin.sin_addr, host->h_addr, host->h_length);
+		    ipv4 = TRUE;
+		}
+	    }
+	}
+
+	if (!ipv6 && !ipv4) {
+	    message("unknown host %s\012", thosts[n]);	/* LF */
+	    return FALSE;
+	}
+
+# ifdef INET6
+	if (ipv6 && !conn_port6(&tdescs[n].in6, SOCK_STREAM, &sin6, tports[n]))
+	{
+	    return FALSE;
+	}
+# endif
+	if (ipv4 && !conn_port(&tdescs[n].in4, SOCK_STREAM, &sin, tports[n])) {
+	    return FALSE;
+	}
+    }
+
+    for (n = 0; n < nbdescs; n++) {
+	/* binary ports */
+	ipv6 = FALSE;
+	ipv4 = FALSE;
+	if (bhosts[n] == (char *) NULL) {
+# ifdef INET6
+	    sin6.sin6_addr = in6addr_any;
+	    ipv6 = TRUE;
+# endif
+	    sin.sin_addr.s_addr = htonl(INADDR_ANY);
+	    ipv4 = TRUE;
+	} else {
+# ifdef INET6
+	    if (inet_pton(AF_INET6, bhosts[n], &sin6) > 0) {
+		sin6.sin6_family = AF_INET6;
+		ipv6 = TRUE;
+	    } else {
+# ifdef AI_DEFAULT
+		host = getipnodebyname(bhosts[n], AF_INET6, 0, &err);
+		if (host != (struct hostent *) NULL) {
+		    if (host->h_length != 4) {
+			memcpy(&sin6.sin6_addr, host->h_addr, host->h_length);
+			ipv6 = TRUE;
+		    }
+		    freehostent(host);
+		}
+# else
+		host = gethostbyname2(bhosts[n], AF_INET6);
+		if (host != (struct hostent *) NULL && host->h_length != 4) {
+		    memcpy(&sin6.sin6_addr, host->h_addr, host->h_length);
+		    ipv6 = TRUE;
+		}
+# endif
+	    }
+# endif
+	    if ((sin.sin_addr.s_addr=inet_addr(bhosts[n])) != INADDR_NONE) {
+		ipv4 = TRUE;
+	    } else {
+		host = gethostbyname(bhosts[n]);
+		if (host != (struct hostent *) NULL) {
+		    memcpy(&sin.sin_addr, host->h_addr, host->h_length);
+		    ipv4 = TRUE;
+		}
+	    }
+	}
+
+	if (!ipv6 && !ipv4) {
+	    message("unknown host %s\012", bhosts[n]);	/* LF */
+	    return FALSE;
+	}
+
+# ifdef INET6
+	if (ipv6 && !conn_port6(&bdescs[n].in6, SOCK_STREAM, &sin6, bports[n]))
+	{
+	    return FALSE;
+	}
+# endif
+	if (ipv4 && !conn_port(&bdescs[n].in4, SOCK_STREAM, &sin, bports[n])) {
+	    return FALSE;
+	}
+    }
+
+    for (n = 0; n < nudescs; n++) {
+	/* datagram ports */
+	ipv6 = FALSE;
+	ipv4 = FALSE;
+	if (dhosts[n] == (char *) NULL) {
+# ifdef INET6
+	    sin6.sin6_addr = in6addr_any;
+	    ipv6 = TRUE;
+# endif
+	    sin.sin_addr.s_addr = htonl(INADDR_ANY);
+	    ipv4 = TRUE;
+	} else {
+# ifdef INET6
+	    if (inet_pton(AF_INET6, dhosts[n], &sin6) > 0) {
+		sin6.sin6_family = AF_INET6;
+		ipv6 = TRUE;
+	    } else {
+# ifdef AI_DEFAULT
+		host = getipnodebyname(dhosts[n], AF_INET6, 0, &err);
+		if (host != (struct hostent *) NULL) {
+		    if (host->h_length != 4) {
+			memcpy(&sin6.sin6_addr, host->h_addr, host->h_length);
+			ipv6 = TRUE;
+		    }
+		    freehostent(host);
+		}
+# else
+		host = gethostbyname2(dhosts[n], AF_INET6);
+		if (host != (struct hostent *) NULL && host->h_length != 4) {
+		    memcpy(&sin6.sin6_addr, host->h_addr, host->h_length);
+		    ipv6 = TRUE;
+		}
+# endif
+	    }
+# endif
+	    if ((sin.sin_addr.s_addr=inet_addr(dhosts[n])) != INADDR_NONE) {
+		ipv4 = TRUE;
+	    } else {
+		host = gethostbyname(dhosts[n]);
+		if (host != (struct hostent *) NULL) {
+		    memcpy(&sin.sin_addr, host->h_addr, host->h_length);
+		    ipv4 = TRUE;
+		}
+	    }
+	}
+
+	if (!ipv6 && !ipv4) {
+	    message("unknown host %s\012", dhosts[n]);	/* LF */
+	    return FALSE;
+	}
+
+# ifdef INET6
+	if (ipv6 &&
+	    !conn_port6(&udescs[n].fd.in6, SOCK_DGRAM, &sin6, dports[n])) {
+	    return FALSE;
+	}
+# endif
+	if (ipv4 &&
+	    !conn_port(&udescs[n].fd.in4, SOCK_DGRAM, &sin, dports[n])) {
+	    return FALSE;
+	}
+
+	udescs[n].accept = FALSE;
+    }
+
+    accepting = TRUE;
+# ifdef EPOLL
+    maxevents = maxusers + 2 * (ntdescs + nbdescs) + 2;
+    events = ALLOC(epoll_event, maxevents);
+# endif
+
+    flist = (connection *) NULL;
+    connections = ALLOC(connection, nusers = maxusers);
+    for (n = nusers, conn = connections; n > 0; --n, conn++) {
+	conn->fd = -1;
+	conn->npkts = 0;
+	conn->owner = NULL;
+	conn->next = flist;
+	flist = conn;
+    }
+
+    udphtab = ALLOC(connection*, udphtabsz = maxusers);
+    memset(udphtab, '\0', udphtabsz * sizeof(connection*));
+    chtab = Hashtab::create(maxusers, UDPHASHSZ, TRUE);
+    if (nudescs != 0) {
+	udpstop = FALSE;
+	pthread_mutex_init(&udpmutex, NULL);
+	if (pthread_create(&udp, NULL, &udp_run, (void *) NULL) < 0) {
+	    perror("pthread_create");
+	    return FALSE;
+	}
+    }
+
+    return TRUE;
+}
+
+/*
+ * NAME:	conn->clear()
+ * DESCRIPTION:	clean up connections
+ */
+void conn_clear()
+{
+    int n;
+
+    for (n = 0; n < ntdescs; n++) {
+	if (tdescs[n].in6 >= 0) {
+	    close(tdescs[n].in6);
+	}
+	if (tdescs[n].in4 >= 0) {
+	    close(tdescs[n].in4);
+	}
+    }
+    for (n = 0; n < nbdescs; n++) {
+	if (bdescs[n].in6 >= 0) {
+	    close(bdescs[n].in6);
+	}
+	if (bdescs[n].in4 >= 0) {
+	    close(bdescs[n].in4);
+	}
+    }
+    udpstop = TRUE;
+    for (n = 0; n < nudescs; n++) {
+	if (udescs[n].fd.in6 >= 0) {
+	    close(udescs[n].fd.in6);
+	}
+	if (udescs[n].fd.in4 >= 0) {
+	    close(udescs[n].fd.in4);
+	}
+    }
+
+    ipa_finish();
+# ifdef EPOLL
+    close(epfd);
+# endif
+}
+
+/*
+ * NAME:	conn->finish()
+ * DESCRIPTION:	terminate connections
+ */
+void conn_finish()
+{
+    int n;
+    connection *conn;
+
+    for (n = nusers, conn = connections; n > 0; --n, conn++) {
+	if (conn->fd >= 0) {
+	    shutdown(conn->fd, SHUT_WR);
+	    close(conn->fd);
+	}
+    }
+}
+
+/*
+ * NAME:	conn->listen()
+ * DESCRIPTION:	start listening on telnet port and binary port
+ */
+void conn_listen()
+{
+    int n;
+
+    for (n = 0; n < ntdescs; n++) {
+	if (tdescs[n].in6 >= 0) {
+	    if (listen(tdescs[n].in6, 64) < 0) {
+		perror("listen");
+	    } else if (fcntl(tdescs[n].in6, F_SETFL, FNDELAY) < 0) {
+		perror("fcntl");
+	    } else {
+		continue;
+	    }
+	    fatal("conn_listen failed");
+	}
+    }
+    for (n = 0; n < ntdescs; n++) {
+	if (tdescs[n].in4 >= 0) {
+	    if (listen(tdescs[n].in4, 64) < 0) {
+# ifdef INET6
+		fd_close(tdescs[n].in4);
+		close(tdescs[n].in4);
+		tdescs[n].in4 = -1;
+		continue;
+# else
+		perror("listen");
+# endif
+	    } else if (fcntl(tdescs[n].in4, F_SETFL, FNDELAY) < 0) {
+		perror("fcntl");
+	    } else {
+		continue;
+	    }
+	    fatal("conn_listen failed");
+	}
+    }
+    for (n = 0; n < nbdescs; n++) {
+	if (bdescs[n].in6 >= 0) {
+	    if (listen(bdescs[n].in6, 64) < 0) {
+		perror("listen");
+	    } else if (fcntl(bdescs[n].in6, F_SETFL, FNDELAY) < 0) {
+		perror("fcntl");
+	    } else {
+		continue;
+	    }
+	    fatal("conn_listen failed");
+	}
+    }
+    for (n = 0; n < nbdescs; n++) {
+	if (bdescs[n].in4 >= 0) {
+	    if (listen(bdescs[n].in4, 64) < 0) {
+# ifdef INET6
+		fd_close(bdescs[n].in4);
+		close(bdescs[n].in4);
+		bdescs[n].in4 = -1;
+		continue;
+# else
+		perror("listen");
+# endif
+	    } else if (fcntl(bdescs[n].in4, F_SETFL, FNDELAY) < 0) {
+		perror("fcntl");
+	    } else {
+		continue;
+	    }
+	    fatal("conn_listen failed");
+	}
+    }
+}
+
+# ifdef INET6
+/*
+ * NAME:	conn->accept6()
+ * DESCRIPTION:	accept a new ipv6 connection
+ */
+static connection *conn_accept6(int portfd, int port)
+{
+    int fd;
+    socklen_t len;
+    struct sockaddr_in6 sin6;
+    in46addr addr;
+    connection *conn;
+
+    if (!fd_test(portfd, FDF_READ)) {
+	return (connection *) NULL;
+    }
+    len = sizeof(sin6);
+    fd = accept(portfd, (struct sockaddr *) &sin6, &len);
+    if (fd < 0) {
+	fd_off(portfd, FDF_READ);
+	return (connection *) NULL;
+    }
+    fcntl(fd, F_SETFL, FNDELAY);
+
+    conn = flist;
+    flist = (connection *) conn->next;
+    conn->name = (char *) NULL;
+    conn->fd = fd;
+    conn->udpbuf = (char *) NULL;
+    if (IN6_IS_ADDR_V4MAPPED(&sin6.sin6_addr)) {
+	/* convert to IPv4 address */
+	addr.in.addr = *(struct in_addr *) &sin6.sin6_addr.s6_addr[12];
+	addr.ipv6 = FALSE;
+    } else {
+	addr.in.addr6 = sin6.sin6_addr;
+	addr.ipv6 = TRUE;
+    }
+    conn->addr = ipa_new(&addr);
+    conn->npkts = 0;
+    conn->at = port;
+    conn->owner = NULL;
+    fd_off(fd, FDF_READ);
+    fd_on(fd, FDF_IN | FDF_OUT | FDF_WRITE);
+    fd_conn(fd, conn);
+
+    return conn;
+}
+# endif
+
+/*
+ * NAME:	conn->accept()
+ * DESCRIPTION:	accept a new ipv4 connection
+ */
+static connection *conn_accept(int portfd, int port)
+{
+    int fd;
+    socklen_t len;
+    struct sockaddr_in sin;
+    in46addr addr;
+    connection *conn;
+
+    if (!fd_test(portfd, FDF_READ)) {
+	return (connection *) NULL;
+    }
+    len = sizeof(sin);
+    fd = accept(portfd, (struct sockaddr *) &sin, &len);
+    if (fd < 0) {
+	fd_off(portfd, FDF_READ);
+	return (connection *) NULL;
+    }
+    fcntl(fd, F_SETFL, FNDELAY);
+
+    conn = flist;
+    flist = (connection *) conn->next;
+    conn->name = (char *) NULL;
+    conn->fd = fd;
+    conn->udpbuf = (char *) NULL;
+    addr.in.addr = sin.sin_addr;
+    addr.ipv6 = FALSE;
+    conn->addr = ipa_new(&addr);
+    conn->npkts = 0;
+    conn->at = port;
+    conn->owner = NULL;
+    fd_off(fd, FDF_READ);
+    fd_on(fd, FDF_IN | FDF_OUT | FDF_WRITE);
+    fd_conn(fd, conn);
+
+    return conn;
+}
+
+/*
+ * NAME:	conn->udpaccept()
+ * DESCRIPTION:	accept a new UDP connection
+ */
+static connection *conn_udpaccept(int port)
+{
+    connection *conn, **hash;
+
+    conn = flist;
+    flist = (connection *) conn->next;
+    conn->name = (char *) NULL;
+    m_static();
+    conn->udpbuf = ALLOC(char, BINBUF_SIZE + 2);
+    m_dynamic();
+    hash = &udphtab[udescs[port].hashval];
+    pthread_mutex_lock(&udpmutex);
+    conn->next = *hash;
+    *hash = conn;
+    conn->fd = -2;
+    conn->addr = ipa_new(&udescs[port].addr);
+    conn->port = udescs[port].port;
+    conn->at = port;
+    conn->udpbuf[0] = udescs[port].size >> 8;
+    conn->udpbuf[1] = udescs[port].size;
+    memcpy(conn->udpbuf + 2, udescs[port].buffer, udescs[port].size);
+    conn->bufsz = udescs[port].size + 2;
+    conn->npkts = 1;
+    conn->owner = NULL;
+    udescs[port].accept = FALSE;
+    pthread_mutex_unlock(&udpmutex);
+
+    return conn;
+}
+
+/*
+ * NAME:	conn->tnew6()
+ * DESCRIPTION:	accept a new telnet connection
+ */
+connection *conn_tnew6(int port)
+{
+# ifdef INET6
+    int fd;
+
+    fd = tdescs[port].in6;
+    if (fd >= 0) {
+	return conn_accept6(fd, port);
+    }
+# endif
+    return (connection *) NULL;
+}
+
+/*
+ * NAME:	conn->bnew6()
+ * DESCRIPTION:	accept a new binary connection
+ */
+connection *conn_bnew6(int port)
+{
+# ifdef INET6
+    int fd;
+
+    fd = bdescs[port].in6;
+    if (fd >= 0) {
+	return conn_accept6(fd, port);
+    }
+# endif
+    return (connection *) NULL;
+}
+
+/*
+ * NAME:	conn->dnew6()
+ * DESCRIPTION:	accept a new datagram connection
+ */
+connection *conn_dnew6(int port)
+{
+# ifdef INET6
+    if (udescs[port].accept) {
+	return conn_udpaccept(port);
+    }
+# endif
+    return (connection *) NULL;
+}
+
+/*
+ * NAME:	conn->tnew()
+ * DESCRIPTION:	accept a new telnet connection
+ */
+connection *conn_tnew(int port)
+{
+    int fd;
+
+    fd = tdescs[port].in4;
+    if (fd >= 0) {
+	return conn_accept(fd, port);
+    }
+    return (connection *) NULL;
+}
+
+/*
+ * NAME:	conn->bnew()
+ * DESCRIPTION:	accept a new binary connection
+ */
+connection *conn_bnew(int port)
+{
+    int fd;
+
+    fd = bdescs[port].in4;
+    if (fd >= 0) {
+	return conn_accept(fd, port);
+    }
+    return (connection *) NULL;
+}
+
+/*
+ * NAME:	conn->dnew()
+ * DESCRIPTION:	accept a new datagram connection
+ */
+connection *conn_dnew(int port)
+{
+    if (udescs[port].accept) {
+	return conn_udpaccept(port);
+    }
+    return (connection *) NULL;
+}
+
+/*
+ * NAME:	conn->attach()
+ * DESCRIPTION:	can datagram channe be attached to this connection?
+ */
+bool conn_attach(connection *conn)
+{
+    return conf_attach(conn->at);
+}
+
+/*
+ * NAME:	conn->udp()
+ * DESCRIPTION:	set the challenge for attaching a UDP channel
+ */
+bool conn_udp(connection *conn, char *challenge, unsigned int len)
+{
+    char buffer[UDPHASHSZ];
+    connection **hash;
+
+    if (len == 0 || len > BINBUF_SIZE || conn->udpbuf != (char *) NULL) {
+	return FALSE;	/* invalid challenge */
+    }
+
+    if (len >= UDPHASHSZ) {
+	memcpy(buffer, challenge, UDPHASHSZ);
+    } else {
+	memset(buffer, '\0', UDPHASHSZ);
+	memcpy(buffer, challenge, len);
+    }
+    pthread_mutex_lock(&udpmutex);
+    hash = (connection **) chtab->lookup(buffer, FALSE);
+    while (*hash != (connection *) NULL &&
+	   memcmp((*hash)->name, buffer, UDPHASHSZ) == 0) {
+	if ((*hash)->bufsz == len &&
+	    memcmp((*hash)->udpbuf, challenge, len) == 0) {
+	    pthread_mutex_unlock(&udpmutex);
+	    return FALSE;	/* duplicate challenge */
+	}
+    }
+
+    conn->next = *hash;
+    *hash = conn;
+    conn->npkts = 0;
+    m_static();
+    conn->udpbuf = ALLOC(char, BINBUF_SIZE + 2);
+    m_dynamic();
+    memset(conn->udpbuf, '\0', UDPHASHSZ);
+    conn->name = (const char *) memcpy(conn->udpbuf, challenge, conn->bufsz = len);
+    pthread_mutex_unlock(&udpmutex);
+
+    return TRUE;
+}
+
+/*
+ * NAME:	conn->del()
+ * DESCRIPTION:	delete a connection
+ */
+void conn_del(connection *conn)
+{
+    connection **hash;
+
+    if (conn->fd >= 0) {
+	fd_close(conn->fd);
+	shutdown(conn->fd, SHUT_WR);
+	close(conn->fd);
+	conn->fd = -1;
+    } else if (conn->fd == -1) {
+	--closed;
+    }
+    if (conn->udpbuf != (char *) NULL) {
+	pthread_mutex_lock(&udpmutex);
+	if (conn->name != (char *) NULL) {
+	    hash = (connection **) chtab->lookup(conn->name, FALSE);
+# ifdef INET6
+	} else if (conn->addr->ipnum.ipv6) {
+	    hash = &udphtab[(Hashtab::hashmem((char *) &conn->addr->ipnum,
+			    sizeof(struct in6_addr)) ^ conn->port) % udphtabsz];
+# endif
+	} else {
+	    hash = &udphtab[(((Uint) conn->addr->ipnum.in.addr.s_addr) ^
+						    conn->port) % udphtabsz];
+	}
+	while (*hash != conn) {
+	    hash = (connection **) &(*hash)->next;
+	}
+	*hash = (connection *) conn->next;
+	if (conn->npkts != 0) {
+	    read(inpkts, conn->udpbuf, conn->npkts);
+	}
+	pthread_mutex_unlock(&udpmutex);
+	FREE(conn->udpbuf);
+    }
+    if (conn->addr != (ipaddr *) NULL) {
+      ipa_del(conn->addr);
+    }
+    conn->owner = NULL;
+    conn->next = flist;
+    flist = conn;
+}
+
+/*
+ * NAME:	conn->block()
+ * DESCRIPTION:	block or unblock input from connection
+ */
+void conn_block(connection *conn, int flag)
+{
+    if (conn->fd >= 0) {
+	if (flag) {
+	    fd_off(conn->fd, FDF_IN | FDF_READ);
+	} else {
+	    fd_on(conn->fd, FDF_IN);
+	}
+    }
+}
+
+/*
+ * NAME:	conn->select()
+ * DESCRIPTION:	wait for input from connections
+ */
+int conn_select(Uint t, unsigned int mtime)
+{
+# ifdef EPOLL
+    int retval, timeout, n, fd;
+    epoll_event *ev;
+
+    /*
+     * Input reported by the previous call has been handled.
+     */
+    for (n = nevents, ev = events; n != 0; --n, ev++) {
+	if (ev->data.fd < nfdflags) {
+	    fdflags[ev->data.fd] &= ~FDF_READ;
+	}
+    }
+    nevents = 0;
+
+    if ((flist != (connection *) NULL) != accepting) {
+	/* only check for new connections that can be accepted */
+	conn_accepting(flist != (connection *) NULL);
+    }
+    if (closed != 0) {
+	t = 0;
+	mtime = 0;
+    }
+    if (mtime != 0xffff) {
+	timeout = (t >= 1000000) ? 1000000000 : t * 1000 + mtime;
+    } else {
+	timeout = -1;
+    }
+    retval = epoll_wait(epfd, events, maxevents, timeout);
+    if (retval < 0) {
+	retval = 0;
+    }
+
+    /*
+     * Only descriptors with pending events are visited.  Writability is
+     * tracked for descriptors waiting for output; all others are assumed
+     * to be writable until a write comes up short.
+     */
+    for (n = nevents = retval, ev = events; n != 0; --n, ev++) {
+	fd = ev->data.fd;
+	if ((ev->events & (EPOLLIN | EPOLLHUP | EPOLLERR)) &&
+	    (fdflags[fd] & FDF_IN)) {
+	    fdflags[fd] |= FDF_READ;
+	}
+	if ((ev->events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) &&
+	    (fdflags[fd] & FDF_WAIT)) {
+	    fdflags[fd] |= FDF_WRITE;
+	}
+    }
+    retval += closed;
+# else
+    struct timeval timeout;
+    int retval;
+
+    /*
+     * First, check readability and writability for binary sockets with pending
+     * data only.
+     */
+    if ((flist != (connection *) NULL) != accepting) {
+	/* can't accept new connections, so don't check for them */
+	conn_accepting(flist != (connection *) NULL);
+    }
+    memcpy(&readfds, &infds, sizeof(fd_set));
+    memcpy(&writefds, &waitfds, sizeof(fd_set));
+    if (closed != 0) {
+	t = 0;
+	mtime = 0;
+    }
+    if (mtime != 0xffff) {
+	timeout.tv_sec = t;
+	timeout.tv_usec = mtime * 1000L;
+	retval = select(maxfd + 1, &readfds, &writefds, (fd_set *) NULL,
+			&timeout);
+    } else {
+	retval = select(maxfd + 1, &readfds, &writefds, (fd_set *) NULL,
+			(struct timeval *) NULL);
+    }
+    if (retval < 0) {
+	FD_ZERO(&readfds);
+	retval = 0;
+    }
+    retval += closed;
+
+    /*
+     * Now check writability for all sockets in a polling call.
+     */
+    memcpy(&writefds, &outfds, sizeof(fd_set));
+    timeout.tv_sec = 0;
+    timeout.tv_usec = 0;
+    select(maxfd + 1, (fd_set *) NULL, &writefds, (fd_set *) NULL, &timeout);
+# endif
+
+    /* handle ip name lookup */
+    if (fd_test(in, FDF_READ)) {
+	ipa_lookup();
+    }
+
+    /* prepare for conn_ready() */
+    if (nudescs != 0) {
+	pthread_mutex_lock(&udpmutex);
+	attach = udpattach;
+	udpattach = FALSE;
+	pthread_mutex_unlock(&udpmutex);
+    }
+# ifdef EPOLL
+    readyev = 0;
+    readyc = (closed != 0 || attach || fd_test(inpkts, FDF_READ)) ? 0 : nusers;
+# else
+    readyc = 0;
+# endif
+    return retval;
+}
+
+/*
+ * NAME:	conn->owner()
+ * DESCRIPTION:	set the owner of a connection, as returned by conn_ready()
+ */
+void conn_owner(connection *conn, void *owner)
+{
+    conn->owner = owner;
+}
+
+/*
+ * NAME:	conn->ready()
+ * DESCRIPTION:	return the owner of the next connection that may have to be
+ *		handled after conn_select(), or NULL if there are no more
+ */
+void *conn_ready()
+{
+    connection *conn;
+# ifdef EPOLL
+    int fd;
+
+    /* connections with descriptor events */
+    while (readyev < nevents) {
+	fd = events[readyev++].data.fd;
+	if (fd < nfdflags && (conn=fdconns[fd]) != (connection *) NULL &&
+	    conn->owner != NULL) {
+	    return conn->owner;
+	}
+    }
+# endif
+
+    /* closed connections, pending datagrams and new UDP channels */
+    while (readyc < nusers) {
+	conn = &connections[readyc++];
+	if (conn->owner != NULL &&
+	    (conn->fd == -1 || conn->npkts != 0 ||
+# ifndef EPOLL
+	     (conn->fd >= 0 &&
+	      (fd_test(conn->fd, FDF_READ) ||
+	       (fd_test(conn->fd, FDF_WAIT) && fd_test(conn->fd, FDF_WRITE)))) ||
+# endif
+	     (attach && conn->udpbuf != (char *) NULL &&
+	      conn->name == (char *) NULL))) {
+	    return conn->owner;
+	}
+    }
+    return NULL;
+}
+
+/*
+ * NAME:	conn->udpcheck()
+ * DESCRIPTION:	check if UDP challenge met
+ */
+bool conn_udpcheck(connection *conn)
+{
+    return (conn->name == (char *) NULL);
+}
+
+/*
+ * NAME:	conn->read()
+ * DESCRIPTION:	read from a connection
+ */
+int conn_read(connection *conn, char *buf, unsigned int len)
+{
+    int size;
+
+    if (conn->fd < 0) {
+	return -1;
+    }
+    if (!fd_test(conn->fd, FDF_READ)) {
+	return 0;
+    }
+    size = read(conn->fd, buf, len);
+    if (size < 0) {
+	fd_close(conn->fd);
+	close(conn->fd);
+	conn->fd = -1;
+	closed++;
+    }
+    return (size == 0) ? -1 : size;
+}
+
+/*
+ * NAME:	conn->udpread()
+ * DESCRIPTION:	read a message from a UDP channel
+ */
+int conn_udpread(connection *conn, char *buf, unsigned int len)
+{
+    unsigned short size, n;
+    char *p, *q, discard;
+
+    pthread_mutex_lock(&udpmutex);
+    while (conn->bufsz != 0) {
+	/* udp buffer is not empty */
+	size = (UCHAR(conn->udpbuf[0]) << 8) | UCHAR(conn->udpbuf[1]);
+	if (size <= len) {
+	    memcpy(buf, conn->udpbuf + 2, len = size);
+	}
+	--conn->npkts;
+	read(inpkts, &discard, 1);
+	conn->bufsz -= size + 2;
+	for (p = conn->udpbuf, q = p + size + 2, n = conn->bufsz; n != 0; --n) {
+	    *p++ = *q++;
+	}
+	if (len == size) {
+	    pthread_mutex_unlock(&udpmutex);
+	    return len;
+	}
+    }
+    pthread_mutex_unlock(&udpmutex);
+    return -1;
+}
+
+/*
+ * NAME:	conn->write()
+ * DESCRIPTION:	write to a connection; return the amount of bytes written
+ */
+int conn_write(connection *conn, char *buf, unsigned int len)
+{
+    int size;
+
+    if (conn->fd < 0) {
+	return -1;
+    }
+    if (len == 0) {
+	return 0;
+    }
+    if (!fd_test(conn->fd, FDF_WRITE)) {
+	/* the write would fail */
+	fd_on(conn->fd, FDF_WAIT);
+	return 0;
+    }
+    if ((size=write(conn->fd, buf, len)) < 0 && errno != EWOULDBLOCK) {
+	fd_close(conn->fd);
+	close(conn->fd);
+	conn->fd = -1;
+	closed++;
+    } else if (size != len) {
+	/* waiting for wrdone */
+	fd_off(conn->fd, FDF_WRITE);
+	fd_on(conn->fd, FDF_WAIT);
+	if (size < 0) {
+	    return 0;
+	}
+    }
+    return size;
+}
+
+/*
+ * NAME:	conn->udpwrite()
+ * DESCRIPTION:	write a message to a UDP channel
+ */
+int conn_udpwrite(connection *conn, char *buf, unsigned int len)
+{
+    if (conn->fd != -1) {
+# ifdef INET6
+	if (conn->addr->ipnum.ipv6) {
+	    struct sockaddr_in6 to;
+
+	    memset(&to, '\0', sizeof(struct sockaddr_in6));
+	    to.sin6_family = AF_INET6;
+	    memcpy(&to.sin6_addr, &conn->addr->ipnum.in.addr6,
+		   sizeof(struct in6_addr));
+	    to.sin6_port = conn->port;
+	    return sendto(udescs[conn->at].fd.in6, buf, len, 0,
+			  (struct sockaddr *) &to, sizeof(struct sockaddr_in6));
+	} else
+# endif
+	{
+	    struct sockaddr_in to;
+
+	    memset(&to, '\0', sizeof(struct sockaddr_in));
+	    to.sin_family = AF_INET;
+	    to.sin_addr = conn->addr->ipnum.in.addr;
+	    to.sin_port = conn->port;
+	    return sendto(udescs[conn->at].fd.in4, buf, len, 0,
+			  (struct sockaddr *) &to, sizeof(struct sockaddr_in));
+	}
+    }
+    return -1;
+}
+
+/*
+ * NAME:	conn->wrdone()
+ * DESCRIPTION:	return TRUE if a connection is ready for output
+ */
+bool conn_wrdone(connection *conn)
+{
+    if (conn->fd < 0 || !fd_test(conn->fd, FDF_WAIT)) {
+	return TRUE;
+    }
+    if (fd_test(conn->fd, FDF_WRITE)) {
+	fd_off(conn->fd, FDF_WAIT);
+	return TRUE;
+    }
+    return FALSE;
+}
+
+/*
+ * NAME:	conn->ipnum()
+ * DESCRIPTION:	return the ip number of a connection
+ */
+void conn_ipnum(connection *conn, char *buf)
+{
+# ifdef INET6
+    /* IPv6: maxlen 39 */
+    if (conn->addr->ipnum.ipv6) {
+	inet_ntop(AF_INET6, &conn->addr->ipnum, buf, 40);
+    } else
+# endif
+    {
+	strcpy(buf, inet_ntoa(conn->addr->ipnum.in.addr));
+    }
+
+}
+
+/*
+ * NAME:	conn->ipname()
+ * DESCRIPTION:	return the ip name of a connection
+ */
+void conn_ipname(connection *conn, char *buf)
+{
+    if (conn->addr->name[0] != '\0') {
+	strcpy(buf, conn->addr->name);
+    } else {
+	conn_ipnum(conn, buf);
+    }
+}
+
+/*
+ * NAME:	conn->host()
+ * DESCRIPTION:	look up a host
+ */
+void *conn_host(char *addr, unsigned short port, int *len)
+{
+    struct hostent *host;
+    static union {
+	struct sockaddr_in sin;
+# ifdef INET6
+	struct sockaddr_in6 sin6;
+# endif
+    } inaddr;
+
+    memset(&inaddr.sin, '\0', sizeof(struct sockaddr_in));
+    inaddr.sin.sin_family = AF_INET;
+    inaddr.sin.sin_port = htons(port);
+    *len = sizeof(struct sockaddr_in);
+    if ((inaddr.sin.sin_addr.s_addr=inet_addr(addr)) != INADDR_NONE) {
+	return &inaddr;
+    } else {
+	host = gethostbyname(addr);
+	if (host != (struct hostent *) NULL) {
+	    memcpy(&inaddr.sin.sin_addr, host->h_addr, host->h_length);
+	    return &inaddr;
+	}
+    }
+
+# ifdef INET6
+    memset(&inaddr.sin6, '\0', sizeof(struct sockaddr_in6));
+    inaddr.sin6.sin6_family = AF_INET6;
+    *len = sizeof(struct sockaddr_in6);
+    if (inet_pton(AF_INET6, addr, &inaddr.sin6) > 0) {
+	inaddr.sin6.sin6_family = AF_INET6;
+	inaddr.sin6.sin6_port = htons(port);
+	return &inaddr;
+    } else {
+# ifdef AI_DEFAULT
+	int err;
+
+	host = getipnodebyname(addr, AF_INET6, 0, &err);
+# else
+	host = gethostbyname2(addr, AF_INET6);
+# endif
+	if (host != (struct hostent *) NULL) {
+	    if (host->h_length != 4) {
+		memcpy(&inaddr.sin6.sin6_addr, host->h_addr, host->h_length);
+# ifdef AI_DEFAULT
+		freehostent(host);
+# endif
+		inaddr.sin6.sin6_port = htons(port);
+		return &inaddr;
+	    }
+# ifdef AI_DEFAULT
+	    freehostent(host);
+# endif
+	}
+    }
+# endif
+
+    return (void *) NULL;
+}
+
+/*
+ * NAME:	conn->connect()
+ * DESCRIPTION:	establish an oubound connection
+ */
+connection *conn_connect(void *addr, int len)
+{
+    connection *conn;
+    int sock;
+    int on;
+    long arg;
+
+    if (flist == (connection *) NULL) {
+       return NULL;
+    }
+
+    sock = socket(((struct sockaddr_in *) addr)->sin_family, SOCK_STREAM, 0);
+    if (sock < 0) {
+	perror("socket");
+	return NULL;
+    }
+    on = 1;
+    if (setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, (char *) &on,
+		   sizeof(on)) < 0) {
+	perror("setsockopt");
+	close(sock);
+	return NULL;
+    }
+#ifdef SO_OOBINLINE
+    on = 1;
+    if (setsockopt(sock, SOL_SOCKET, SO_OOBINLINE, (char *) &on,
+		   sizeof(on)) < 0) {
+	perror("setsockopt");
+	close(sock);
+	return NULL;
+    }
+#endif
+    if ((arg = fcntl(sock, F_GETFL, NULL)) < 0) {
+       perror("fcntl");
+       close(sock);
+       return NULL;
+    }
+    arg |= O_NONBLOCK;
+    if (fcntl(sock, F_SETFL, arg) < 0) {
+       perror("fcntl");
+       close(sock);
+       return NULL;
+    }
+
+    connect(sock, (struct sockaddr *) addr, len);
+
+    conn = flist;
+    flist = (connection *) conn->next;
+    conn->fd = sock;
+    conn->name = (char *) NULL;
+    conn->udpbuf = (char *) NULL;
+    conn->addr = (ipaddr *) NULL;
+    conn->npkts = 0;
+    conn->at = -1;
+    conn->owner = NULL;
+    fd_off(sock, FDF_READ | FDF_WRITE);
+    fd_on(sock, FDF_IN | FDF_OUT | FDF_WAIT);
+    fd_conn(sock, conn);
+    return conn;
+}
+
+/*
+ * check for a connection in pending state and see if it is connected.
+ */
+int conn_check_connected(connection *conn, int *errcode)
+{
+    int optval;
+    socklen_t lon;
+
+    /*
+     * indicate that our fd became invalid.
+     */
+    if (conn->fd < 0) {
+	return -2;
+    }
+
+    if (!fd_test(conn->fd, FDF_WRITE)) {
+	return 0;
+    }
+    fd_off(conn->fd, FDF_WAIT);
+
+    /*
+     * Delayed connect completed, check for errors
+     */
+    lon = sizeof(int);
+    /*
+     * Get error state for the socket
+     */
+    *errcode = 0;
+    if (getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, (void *)(&optval), &lon) < 0)
+    {
+	return -1;
+    }
+    if (optval != 0) {
+	switch (optval) {
+	case ECONNREFUSED:
+	    *errcode = 1;
+	    break;
+
+	case EHOSTUNREACH:
+	    *errcode = 2;
+	    break;
+
+	case ENETUNREACH:
+	    *errcode = 3;
+	    break;
+
+	case ETIMEDOUT:
+	    *errcode = 4;
+	    break;
+	}
+	errno = optval;
+	return -1;
+    } else {
+# ifdef INET6
+	struct sockaddr_in6 sin;
+# else
+	struct sockaddr_in sin;
+# endif
+	socklen_t len;
+	in46addr inaddr;
+
+	len = sizeof(sin);
+	getpeername(conn->fd, (struct sockaddr *) &sin, &len);
+	inaddr.ipv6 = FALSE;
+# ifdef INET6
+	if (sin.sin6_family == AF_INET6) {
+	    inaddr.in.addr6 = sin.sin6_addr;
+	    inaddr.ipv6 = TRUE;
+	} else
+# endif
+	inaddr.in.addr = ((struct sockaddr_in *) &sin)->sin_addr;
+	conn->addr = ipa_new(&inaddr);
+	errno = 0;
+	return 1;
+    }
+}
+
+
+# define CONN_READF	0x01	/* read flag set */
+# define CONN_WRITEF	0x02	/* write flag set */
+# define CONN_WAITF	0x04	/* wait flag set */
+# define CONN_UCHAL	0x08	/* UDP challenge issued */
+# define CONN_UCHAN	0x10	/* UDP channel established */
+# define CONN_ADDR	0x20	/* has an address */
+
+/*
+ * NAME:	conn->export()
+ * DESCRIPTION:	export a connection
+ */
+bool conn_export(connection *conn, int *fd, char *addr, unsigned short *port,
+		 short *at, int *npkts, int *bufsz, char **buf, char *flags)
+{
+    *fd = conn->fd;
+    *port = conn->port;
+    if (conn->fd != -1) {
+	*flags = 0;
+	*at = conn->at;
+	*npkts = conn->npkts;
+	*bufsz = conn->bufsz;
+	*buf = conn->udpbuf;
+	if (fd_test(conn->fd, FDF_READ)) {
+	    *flags |= CONN_READF;
+	}
+	if (fd_test(conn->fd, FDF_WRITE)) {
+	    *flags |= CONN_WRITEF;
+	}
+	if (fd_test(conn->fd, FDF_WAIT)) {
+	    *flags |= CONN_WAITF;
+	}
+	if (conn->udpbuf != (char *) NULL) {
+	    if (conn->name != NULL) {
+		*flags |= CONN_UCHAL;
+	    } else {
+		*flags |= CONN_UCHAN;
+	    }
+	}
+	if (conn->addr != (ipaddr *) NULL) {
+	    memcpy(addr, &conn->addr->ipnum, sizeof(in46addr));
+	    *flags |= CONN_ADDR;
+	}
+    }
+
+    return TRUE;
+}
+
+/*
+ * NAME:	conn->import()
+ * DESCRIPTION:	import a connection
+ */
+connection *conn_import(int fd, char *addr, unsigned short port, short at,
+			int npkts, int bufsz, char *buf, char flags,
+			bool telnet)
+{
+    in46addr inaddr;
+    connection *conn;
+
+    conn = flist;
+    flist = (connection *) conn->next;
+    conn->fd = fd;
+    conn->name = (char *) NULL;
+    conn->udpbuf = (char *) NULL;
+    conn->addr = (ipaddr *) NULL;
+    conn->bufsz = 0;
+    conn->npkts = 0;
+    conn->port = port;
+    conn->at = -1;
+    conn->owner = NULL;
+
+    if (fd >= 0) {
+	fd_on(fd, FDF_IN | FDF_OUT);
+	fd_conn(fd, conn);
+	if (flags & CONN_READF) {
+	    fd_on(fd, FDF_READ);
+	}
+	if (flags & CONN_WRITEF) {
+	    fd_on(fd, FDF_WRITE);
+	}
+	if (flags & CONN_WAITF) {
+	    fd_on(fd, FDF_WAIT);
+	}
+    }
+
+    if (fd != -1) {
+	if (at >= 0 && at >= ((telnet) ? ntdescs : nbdescs)) {
+	    at = -1;
+	}
+	conn->at = at;
+	if (flags & CONN_ADDR) {
+	    memcpy(&inaddr, addr, sizeof(in46addr));
+	    conn->addr = ipa_new(&inaddr);
+	}
+
+	if (at >= 0) {
+	    if (flags & CONN_UCHAL) {
+		conn_udp(conn, buf, bufsz);
+	    }
+	    if (flags & CONN_UCHAN) {
+		connection **hash;
+
+		conn->bufsz = bufsz;
+		m_static();
+		conn->udpbuf = ALLOC(char, BINBUF_SIZE + 2);
+		m_dynamic();
+		memcpy(conn->udpbuf, buf, bufsz);
+# ifdef INET6
+		if (inaddr.ipv6) {
+		    hash = &udphtab[(Hashtab::hashmem((char *) &inaddr.in.addr6,
+			   sizeof(struct in6_addr)) ^ conn->port) % udphtabsz];
+		} else
+# endif
+		hash = &udphtab[((Uint) inaddr.in.addr.s_addr ^ conn->port) %
+								    udphtabsz];
+		conn->next = *hash;
+		*hash = conn;
+	    }
+	    conn->npkts = npkts;
+	    write(outpkts, conn->udpbuf, npkts);
+	}
+    } else {
+	closed++;
+    }
+
+    return conn;
+}
@@ -0,0 +1,201 @@
+/*
+ * This file is part of DGD, https://github.com/dworkin/dgd
+ * Copyright (C) 1993-2010 Dworkin B.V.
+ * Copyright (C) 2010-2016 DGD Authors (see the commit log for details)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+# define INCLUDE_FILE_IO
+# include "dgd.h"
+# include <pthread.h>
+# include <sys/mman.h>
+
+static pthread_t thread;		/* I/O thread */
+static pthread_mutex_t mutex;		/* request queue mutex */
+static pthread_cond_t queued;		/* request queued */
+static pthread_cond_t done;		/* request completed */
+static aioreq *qhead, *qtail;		/* request queue */
+static bool running;			/* I/O thread running? */
+static bool stop;			/* stop I/O thread? */
+
+/*
+ * NAME:	aio->transfer()
+ * DESCRIPTION:	perform a request, return the new state
+ */
+static char aio_transfer(aioreq *req)
+{
+    char *buf;
+    unsigned int size;
+    off_t offset;
+    ssize_t n;
+
+    buf = req->buf;
+    size = req->size;
+    offset = req->offset;
+    if (req->write) {
+	while (size != 0) {
+	    n = pwrite(req->fd, buf, size, offset);
+	    if (n <= 0) {
+		return AIO_FAILED;
+	    }
+	    buf += n;
+	    size -= n;
+	    offset += n;
+	}
+    } else if (pread(req->fd, buf, size, offset) <= 0) {
+	return AIO_FAILED;
+    }
+    return AIO_DONE;
+}
+
+extern "C" {
+
+/*
+ * NAME:	aio->run()
+ * DESCRIPTION:	I/O thread
+ */
+static void *aio_run(void *arg)
+{
+    aioreq *req;
+    char state;
+
+    UNREFERENCED_PARAMETER(arg);
+
+    pthread_mutex_lock(&mutex);
+    for (;;) {
+	while (qhead == (aioreq *) NULL && !stop) {
+	    pthread_cond_wait(&queued, &mutex);
+	}
+	if (qhead == (aioreq *) NULL) {
+	    break;
+	}
+
+	/* the request stays in the queue until it has been performed */
+	req = qhead;
+	pthread_mutex_unlock(&mutex);
+	state = aio_transfer(req);
+	pthread_mutex_lock(&mutex);
+
+	qhead = req->next;
+	if (qhead == (aioreq *) NULL) {
+	    qtail = (aioreq *) NULL;
+	}
+	req->state = state;
+	pthread_cond_broadcast(&done);
+    }
+    pthread_mutex_unlock(&mutex);
+
+    return (void *) NULL;
+}
+
+}
+
+/*
+ * NAME:	P->aio_queue()
+ * DESCRIPTION:	queue an I/O request, to be performed in the background in
+ *		the order of queueing
+ */
+void P_aio_queue(aioreq *req)
+{
+    if (!running) {
+	pthread_mutex_init(&mutex, NULL);
+	pthread_cond_init(&queued, NULL);
+	pthread_cond_init(&done, NULL);
+	qhead = qtail = (aioreq *) NULL;
+	stop = FALSE;
+	if (pthread_create(&thread, NULL, &aio_run, (void *) NULL) != 0) {
+	    /* no I/O thread: perform the request right away */
+	    pthread_cond_destroy(&done);
+	    pthread_cond_destroy(&queued);
+	    pthread_mutex_destroy(&mutex);
+	    req->state = aio_transfer(req);
+	    return;
+	}
+	running = TRUE;
+    }
+
+    req->next = (aioreq *) NULL;
+    pthread_mutex_lock(&mutex);
+    req->state = AIO_QUEUED;
+    if (qtail != (aioreq *) NULL) {
+	qtail->next = req;
+    } else {
+	qhead = req;
+	pthread_cond_signal(&queued);
+    }
+    qtail = req;
+    pthread_mutex_unlock(&mutex);
+}
+
+/*
+ * NAME:	P->aio_wait()
+ * DESCRIPTION:	wait for a request to complete, return TRUE if it succeeded
+ */
+bool P_aio_wait(aioreq *req)
+{
+    if (running) {
+	pthread_mutex_lock(&mutex);
+	while (req->state == AIO_QUEUED) {
+	    pthread_cond_wait(&done, &mutex);
+	}
+	pthread_mutex_unlock(&mutex);
+    }
+    return (req->state == AIO_DONE);
+}
+
+/*
+ * NAME:	P->aio_finish()
+ * DESCRIPTION:	complete all requests and stop the I/O thread
+ */
+void P_aio_finish()
+{
+    if (running) {
+	pthread_mutex_lock(&mutex);
+	stop = TRUE;
+	pthread_cond_signal(&queued);
+	pthread_mutex_unlock(&mutex);
+	pthread_join(thread, NULL);
+
+	pthread_cond_destroy(&done);
+	pthread_cond_destroy(&queued);
+	pthread_mutex_destroy(&mutex);
+	running = FALSE;
+    }
+}
+
+/*
+ * NAME:	P->mmap()
+ * DESCRIPTION:	map a file into memory, shared with other processes
+ */
+char *P_mmap(int fd, off_t size, bool write)
+{
+    void *mem;
+
+    if ((off_t) (size_t) size != size) {
+	return (char *) NULL;
+    }
+    mem = mmap((void *) NULL, (size_t) size,
+	       (write) ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    return (mem != MAP_FAILED) ? (char *) mem : (char *) NULL;
+}
+
+/*
+ * NAME:	P->munmap()
+ * DESCRIPTION:	unmap a file from memory
+ */
+void P_munmap(char *mem, off_t size)
+{
+    munmap(mem, (size_t) size);
+}
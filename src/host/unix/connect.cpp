@@ -30,6 +30,13 @@
 # include "hash.h"
 # include "comm.h"
 
+# if defined(LINUX) && !defined(NOEPOLL)
+#  define EPOLL		/* use epoll() rather than select() */
+# endif
+# ifdef EPOLL
+#  include <sys/epoll.h>
+# endif
+
 # ifdef INET6		/* INET6 defined */
 #  if INET6 == 0
 #   undef INET6		/* ... but turned off */
@@ -429,6 +436,7 @@ struct connection : public Hashtab::Entry {
     ipaddr *addr;			/* internet address of connection */
     unsigned short port;		/* UDP port of connection */
     short at;				/* port connection was accepted at */
+    void *owner;			/* owner of this connection */
 };
 
 struct portdesc {
@@ -455,6 +463,7 @@ static int inpkts, outpkts;		/* UDP packet notification pipe */
 static pthread_t udp;			/* UDP thread */
 static pthread_mutex_t udpmutex;	/* UDP mutex */
 static bool udpstop;			/* stop UDP thread? */
+static bool udpattach;			/* UDP channel attached? */
 
 # ifdef INET6
 /*
@@ -529,6 +538,7 @@ static void udp_recv6(int n)
 		    hash = &udphtab[hashval];
 		    conn->next = *hash;
 		    *hash = conn;
+		    udpattach = TRUE;
 
 		    break;
 		}
@@ -622,6 +632,7 @@ static void udp_recv(int n)
 		    hash = &udphtab[hashval];
 		    conn->next = *hash;
 		    *hash = conn;
+		    udpattach = TRUE;
 
 		    break;
 		}
@@ -722,13 +733,259 @@ static connection *connections;		/* connections array */
 static connection *flist;		/* list of free connections */
 static portdesc *tdescs, *bdescs;	/* telnet & binary descriptor arrays */
 static int ntdescs, nbdescs;		/* # telnet & binary ports */
+static bool accepting;			/* listening for new connections? */
+static int closed;			/* #fds closed in write */
+static int readyc;			/* next connection to check */
+static bool attach;			/* check for attached UDP channels */
+
+# define FDF_IN		0x01	/* check for input */
+# define FDF_OUT	0x02	/* check for output */
+# define FDF_WAIT	0x04	/* waiting for output */
+# define FDF_READ	0x08	/* input available */
+# define FDF_WRITE	0x10	/* output possible */
+
+# ifdef EPOLL
+static int epfd;			/* epoll descriptor */
+static epoll_event *events;		/* events from last wait */
+static int nevents;			/* # events from last wait */
+static int maxevents;			/* size of events array */
+static int readyev;			/* next event to check */
+static char *fdflags;			/* per-descriptor flags */
+static connection **fdconns;		/* per-descriptor connections */
+static int nfdflags;			/* size of fdflags table */
+
+/*
+ * NAME:	fd->ctl()
+ * DESCRIPTION:	bring the epoll registration of a descriptor up to date
+ */
+static void fd_ctl(int fd, int old)
+{
+    epoll_event ev;
+
+    ev.events = 0;
+    if (fdflags[fd] & FDF_IN) {
+	ev.events |= EPOLLIN;
+    }
+    if (fdflags[fd] & FDF_WAIT) {
+	ev.events |= EPOLLOUT;
+    }
+    ev.data.u64 = 0;
+    ev.data.fd = fd;
+
+    if (ev.events == 0) {
+	/* even an empty registration would report hangups */
+	epoll_ctl(epfd, EPOLL_CTL_DEL, fd, &ev);
+    } else if (old & (FDF_IN | FDF_WAIT)) {
+	epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev);
+    } else {
+	epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+/*
+ * NAME:	fd->on()
+ * DESCRIPTION:	set descriptor flags
+ */
+static void fd_on(int fd, int flags)
+{
+    int old;
+
+    if (fd >= nfdflags) {
+	int size;
+
+	size = (nfdflags == 0) ? 256 : nfdflags;
+	while (size <= fd) {
+	    size <<= 1;
+	}
+	m_static();
+	fdflags = REALLOC(fdflags, char, nfdflags, size);
+	fdconns = REALLOC(fdconns, connection*, nfdflags, size);
+	m_dynamic();
+	memset(fdflags + nfdflags, '\0', size - nfdflags);
+	memset(fdconns + nfdflags, '\0', (size - nfdflags) * sizeof(connection*));
+	nfdflags = size;
+    }
+
+    old = fdflags[fd];
+    fdflags[fd] |= flags;
+    if ((old ^ fdflags[fd]) & (FDF_IN | FDF_WAIT)) {
+	fd_ctl(fd, old);
+    }
+}
+
+/*
+ * NAME:	fd->off()
+ * DESCRIPTION:	clear descriptor flags
+ */
+static void fd_off(int fd, int flags)
+{
+    int old;
+
+    if (fd < nfdflags) {
+	old = fdflags[fd];
+	fdflags[fd] &= ~flags;
+	if ((old ^ fdflags[fd]) & (FDF_IN | FDF_WAIT)) {
+	    fd_ctl(fd, old);
+	}
+    }
+}
+
+/*
+ * NAME:	fd->test()
+ * DESCRIPTION:	test a descriptor flag
+ */
+static bool fd_test(int fd, int flag)
+{
+    return (fd < nfdflags && (fdflags[fd] & flag));
+}
+
+/*
+ * NAME:	fd->close()
+ * DESCRIPTION:	forget about a descriptor that is about to be closed
+ */
+static void fd_close(int fd)
+{
+    fd_off(fd, FDF_IN | FDF_OUT | FDF_WAIT | FDF_READ | FDF_WRITE);
+    if (fd < nfdflags) {
+	fdconns[fd] = (connection *) NULL;
+    }
+}
+
+/*
+ * NAME:	fd->conn()
+ * DESCRIPTION:	associate a descriptor with a connection
+ */
+static void fd_conn(int fd, connection *conn)
+{
+    fdconns[fd] = conn;
+}
+# else
 static fd_set infds;			/* file descriptor input bitmap */
 static fd_set outfds;			/* file descriptor output bitmap */
 static fd_set waitfds;			/* file descriptor wait-write bitmap */
 static fd_set readfds;			/* file descriptor read bitmap */
 static fd_set writefds;			/* file descriptor write map */
 static int maxfd;			/* largest fd opened yet */
-static int closed;			/* #fds closed in write */
+
+/*
+ * NAME:	fd->on()
+ * DESCRIPTION:	set descriptor flags
+ */
+static void fd_on(int fd, int flags)
+{
+    if (flags & FDF_IN) {
+	FD_SET(fd, &infds);
+    }
+    if (flags & FDF_OUT) {
+	FD_SET(fd, &outfds);
+    }
+    if (flags & FDF_WAIT) {
+	FD_SET(fd, &waitfds);
+    }
+    if (flags & FDF_READ) {
+	FD_SET(fd, &readfds);
+    }
+    if (flags & FDF_WRITE) {
+	FD_SET(fd, &writefds);
+    }
+    if (fd > maxfd) {
+	maxfd = fd;
+    }
+}
+
+/*
+ * NAME:	fd->off()
+ * DESCRIPTION:	clear descriptor flags
+ */
+static void fd_off(int fd, int flags)
+{
+    if (flags & FDF_IN) {
+	FD_CLR(fd, &infds);
+    }
+    if (flags & FDF_OUT) {
+	FD_CLR(fd, &outfds);
+    }
+    if (flags & FDF_WAIT) {
+	FD_CLR(fd, &waitfds);
+    }
+    if (flags & FDF_READ) {
+	FD_CLR(fd, &readfds);
+    }
+    if (flags & FDF_WRITE) {
+	FD_CLR(fd, &writefds);
+    }
+}
+
+/*
+ * NAME:	fd->test()
+ * DESCRIPTION:	test a descriptor flag
+ */
+static bool fd_test(int fd, int flag)
+{
+    switch (flag) {
+    case FDF_IN:
+	return FD_ISSET(fd, &infds);
+
+    case FDF_OUT:
+	return FD_ISSET(fd, &outfds);
+
+    case FDF_WAIT:
+	return FD_ISSET(fd, &waitfds);
+
+    case FDF_READ:
+	return FD_ISSET(fd, &readfds);
+
+    case FDF_WRITE:
+	return FD_ISSET(fd, &writefds);
+    }
+    return FALSE;
+}
+
+/*
+ * NAME:	fd->close()
+ * DESCRIPTION:	forget about a descriptor that is about to be closed
+ */
+static void fd_close(int fd)
+{
+    fd_off(fd, FDF_IN | FDF_OUT | FDF_WAIT);
+}
+
+# define fd_conn(fd, conn)	/* connections are found by scanning */
+# endif /* EPOLL */
+
+/*
+ * NAME:	conn->portfd()
+ * DESCRIPTION:	start or stop checking a port descriptor for new connections
+ */
+static void conn_portfd(int fd, bool flag)
+{
+    if (fd >= 0) {
+	if (flag) {
+	    fd_on(fd, FDF_IN);
+	} else {
+	    fd_off(fd, FDF_IN | FDF_READ);
+	}
+    }
+}
+
+/*
+ * NAME:	conn->accepting()
+ * DESCRIPTION:	start or stop checking the ports for new connections
+ */
+static void conn_accepting(bool flag)
+{
+    int n;
+
+    for (n = 0; n < ntdescs; n++) {
+	conn_portfd(tdescs[n].in6, flag);
+	conn_portfd(tdescs[n].in4, flag);
+    }
+    for (n = 0; n < nbdescs; n++) {
+	conn_portfd(bdescs[n].in6, flag);
+	conn_portfd(bdescs[n].in4, flag);
+    }
+    accepting = flag;
+}
 
 # ifdef INET6
 /*
@@ -771,10 +1028,7 @@ static int conn_port6(int *fd, int type, struct sockaddr_in6 *sin6, unsigned int
     }
 
     if (type == SOCK_STREAM) {
-	if (*fd > maxfd) {
-	    maxfd = *fd;
-	}
-	FD_SET(*fd, &infds);
+	fd_on(*fd, FDF_IN);
     }
     return TRUE;
 }
@@ -813,10 +1067,7 @@ static int conn_port(int *fd, int type, struct sockaddr_in *sin, unsigned int po
     }
 
     if (type == SOCK_STREAM) {
-	if (*fd > maxfd) {
-	    maxfd = *fd;
-	}
-	FD_SET(*fd, &infds);
+	fd_on(*fd, FDF_IN);
     }
     return TRUE;
 }
@@ -849,20 +1100,33 @@ bool conn_init(int maxusers, char **thosts, char **bhosts, char **dhosts,
 
     nusers = 0;
 
+# ifdef EPOLL
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+	perror("epoll_create1");
+	return FALSE;
+    }
+    fdflags = (char *) NULL;
+    fdconns = (connection **) NULL;
+    nfdflags = 0;
+    nevents = readyev = 0;
+# else
     maxfd = 0;
     FD_ZERO(&infds);
     FD_ZERO(&outfds);
     FD_ZERO(&waitfds);
-    FD_SET(in, &infds);
+    FD_ZERO(&readfds);
+    FD_ZERO(&writefds);
+# endif
+    fd_on(in, FDF_IN);
     closed = 0;
+    readyc = maxusers;
+    attach = udpattach = FALSE;
 
     pipe(fds);
     inpkts = fds[0];
     outpkts = fds[1];
-    FD_SET(inpkts, &infds);
-    if (inpkts > maxfd) {
-	maxfd = inpkts;
-    }
+    fd_on(inpkts, FDF_IN);
 
     ntdescs = ntports;
     if (ntports != 0) {
@@ -1076,10 +1340,18 @@ bool conn_init(int maxusers, char **thosts, char **bhosts, char **dhosts,
 	udescs[n].accept = FALSE;
     }
 
+    accepting = TRUE;
+# ifdef EPOLL
+    maxevents = maxusers + 2 * (ntdescs + nbdescs) + 2;
+    events = ALLOC(epoll_event, maxevents);
+# endif
+
     flist = (connection *) NULL;
     connections = ALLOC(connection, nusers = maxusers);
     for (n = nusers, conn = connections; n > 0; --n, conn++) {
 	conn->fd = -1;
+	conn->npkts = 0;
+	conn->owner = NULL;
 	conn->next = flist;
 	flist = conn;
     }
@@ -1134,6 +1406,9 @@ void conn_clear()
     }
 
     ipa_finish();
+# ifdef EPOLL
+    close(epfd);
+# endif
 }
 
 /*
@@ -1177,8 +1452,8 @@ void conn_listen()
 	if (tdescs[n].in4 >= 0) {
 	    if (listen(tdescs[n].in4, 64) < 0) {
 # ifdef INET6
+		fd_close(tdescs[n].in4);
 		close(tdescs[n].in4);
-		FD_CLR(tdescs[n].in4, &infds);
 		tdescs[n].in4 = -1;
 		continue;
 # else
@@ -1208,8 +1483,8 @@ void conn_listen()
 	if (bdescs[n].in4 >= 0) {
 	    if (listen(bdescs[n].in4, 64) < 0) {
 # ifdef INET6
+		fd_close(bdescs[n].in4);
 		close(bdescs[n].in4);
-		FD_CLR(bdescs[n].in4, &infds);
 		bdescs[n].in4 = -1;
 		continue;
 # else
@@ -1238,13 +1513,13 @@ static connection *conn_accept6(int portfd, int port)
     in46addr addr;
     connection *conn;
 
-    if (!FD_ISSET(portfd, &readfds)) {
+    if (!fd_test(portfd, FDF_READ)) {
 	return (connection *) NULL;
     }
     len = sizeof(sin6);
     fd = accept(portfd, (struct sockaddr *) &sin6, &len);
     if (fd < 0) {
-	FD_CLR(portfd, &readfds);
+	fd_off(portfd, FDF_READ);
 	return (connection *) NULL;
     }
     fcntl(fd, F_SETFL, FNDELAY);
@@ -1263,14 +1538,12 @@ static connection *conn_accept6(int portfd, int port)
 	addr.ipv6 = TRUE;
     }
     conn->addr = ipa_new(&addr);
+    conn->npkts = 0;
     conn->at = port;
-    FD_SET(fd, &infds);
-    FD_SET(fd, &outfds);
-    FD_CLR(fd, &readfds);
-    FD_SET(fd, &writefds);
-    if (fd > maxfd) {
-	maxfd = fd;
-    }
+    conn->owner = NULL;
+    fd_off(fd, FDF_READ);
+    fd_on(fd, FDF_IN | FDF_OUT | FDF_WRITE);
+    fd_conn(fd, conn);
 
     return conn;
 }
@@ -1288,13 +1561,13 @@ static connection *conn_accept(int portfd, int port)
     in46addr addr;
     connection *conn;
 
-    if (!FD_ISSET(portfd, &readfds)) {
+    if (!fd_test(portfd, FDF_READ)) {
 	return (connection *) NULL;
     }
     len = sizeof(sin);
     fd = accept(portfd, (struct sockaddr *) &sin, &len);
     if (fd < 0) {
-	FD_CLR(portfd, &readfds);
+	fd_off(portfd, FDF_READ);
 	return (connection *) NULL;
     }
     fcntl(fd, F_SETFL, FNDELAY);
@@ -1307,14 +1580,12 @@ static connection *conn_accept(int portfd, int port)
     addr.in.addr = sin.sin_addr;
     addr.ipv6 = FALSE;
     conn->addr = ipa_new(&addr);
+    conn->npkts = 0;
     conn->at = port;
-    FD_SET(fd, &infds);
-    FD_SET(fd, &outfds);
-    FD_CLR(fd, &readfds);
-    FD_SET(fd, &writefds);
-    if (fd > maxfd) {
-	maxfd = fd;
-    }
+    conn->owner = NULL;
+    fd_off(fd, FDF_READ);
+    fd_on(fd, FDF_IN | FDF_OUT | FDF_WRITE);
+    fd_conn(fd, conn);
 
     return conn;
 }
@@ -1346,6 +1617,7 @@ static connection *conn_udpaccept(int port)
     memcpy(conn->udpbuf + 2, udescs[port].buffer, udescs[port].size);
     conn->bufsz = udescs[port].size + 2;
     conn->npkts = 1;
+    conn->owner = NULL;
     udescs[port].accept = FALSE;
     pthread_mutex_unlock(&udpmutex);
 
@@ -1503,11 +1775,9 @@ void conn_del(connection *conn)
     connection **hash;
 
     if (conn->fd >= 0) {
+	fd_close(conn->fd);
 	shutdown(conn->fd, SHUT_WR);
 	close(conn->fd);
-	FD_CLR(conn->fd, &infds);
-	FD_CLR(conn->fd, &outfds);
-	FD_CLR(conn->fd, &waitfds);
 	conn->fd = -1;
     } else if (conn->fd == -1) {
 	--closed;
@@ -1538,6 +1808,7 @@ void conn_del(connection *conn)
     if (conn->addr != (ipaddr *) NULL) {
       ipa_del(conn->addr);
     }
+    conn->owner = NULL;
     conn->next = flist;
     flist = conn;
 }
@@ -1550,10 +1821,9 @@ void conn_block(connection *conn, int flag)
 {
     if (conn->fd >= 0) {
 	if (flag) {
-	    FD_CLR(conn->fd, &infds);
-	    FD_CLR(conn->fd, &readfds);
+	    fd_off(conn->fd, FDF_IN | FDF_READ);
 	} else {
-	    FD_SET(conn->fd, &infds);
+	    fd_on(conn->fd, FDF_IN);
 	}
     }
 }
@@ -1564,36 +1834,68 @@ void conn_block(connection *conn, int flag)
  */
 int conn_select(Uint t, unsigned int mtime)
 {
+# ifdef EPOLL
+    int retval, timeout, n, fd;
+    epoll_event *ev;
+
+    /*
+     * Input reported by the previous call has been handled.
+     */
+    for (n = nevents, ev = events; n != 0; --n, ev++) {
+	if (ev->data.fd < nfdflags) {
+	    fdflags[ev->data.fd] &= ~FDF_READ;
+	}
+    }
+    nevents = 0;
+
+    if ((flist != (connection *) NULL) != accepting) {
+	/* only check for new connections that can be accepted */
+	conn_accepting(flist != (connection *) NULL);
+    }
+    if (closed != 0) {
+	t = 0;
+	mtime = 0;
+    }
+    if (mtime != 0xffff) {
+	timeout = (t >= 1000000) ? 1000000000 : t * 1000 + mtime;
+    } else {
+	timeout = -1;
+    }
+    retval = epoll_wait(epfd, events, maxevents, timeout);
+    if (retval < 0) {
+	retval = 0;
+    }
+
+    /*
+     * Only descriptors with pending events are visited.  Writability is
+     * tracked for descriptors waiting for output; all others are assumed
+     * to be writable until a write comes up short.
+     */
+    for (n = nevents = retval, ev = events; n != 0; --n, ev++) {
+	fd = ev->data.fd;
+	if ((ev->events & (EPOLLIN | EPOLLHUP | EPOLLERR)) &&
+	    (fdflags[fd] & FDF_IN)) {
+	    fdflags[fd] |= FDF_READ;
+	}
+	if ((ev->events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) &&
+	    (fdflags[fd] & FDF_WAIT)) {
+	    fdflags[fd] |= FDF_WRITE;
+	}
+    }
+    retval += closed;
+# else
     struct timeval timeout;
     int retval;
-    int n;
 
     /*
      * First, check readability and writability for binary sockets with pending
      * data only.
      */
-    memcpy(&readfds, &infds, sizeof(fd_set));
-    if (flist == (connection *) NULL) {
+    if ((flist != (connection *) NULL) != accepting) {
 	/* can't accept new connections, so don't check for them */
-	for (n = ntdescs; n != 0; ) {
-	    --n;
-	    if (tdescs[n].in6 >= 0) {
-		FD_CLR(tdescs[n].in6, &readfds);
-	    }
-	    if (tdescs[n].in4 >= 0) {
-		FD_CLR(tdescs[n].in4, &readfds);
-	    }
-	}
-	for (n = nbdescs; n != 0; ) {
-	    --n;
-	    if (bdescs[n].in6 >= 0) {
-		FD_CLR(bdescs[n].in6, &readfds);
-	    }
-	    if (bdescs[n].in4 >= 0) {
-		FD_CLR(bdescs[n].in4, &readfds);
-	    }
-	}
+	conn_accepting(flist != (connection *) NULL);
     }
+    memcpy(&readfds, &infds, sizeof(fd_set));
     memcpy(&writefds, &waitfds, sizeof(fd_set));
     if (closed != 0) {
 	t = 0;
@@ -1621,14 +1923,77 @@ int conn_select(Uint t, unsigned int mtime)
     timeout.tv_sec = 0;
     timeout.tv_usec = 0;
     select(maxfd + 1, (fd_set *) NULL, &writefds, (fd_set *) NULL, &timeout);
+# endif
 
     /* handle ip name lookup */
-    if (FD_ISSET(in, &readfds)) {
+    if (fd_test(in, FDF_READ)) {
 	ipa_lookup();
     }
+
+    /* prepare for conn_ready() */
+    if (nudescs != 0) {
+	pthread_mutex_lock(&udpmutex);
+	attach = udpattach;
+	udpattach = FALSE;
+	pthread_mutex_unlock(&udpmutex);
+    }
+# ifdef EPOLL
+    readyev = 0;
+    readyc = (closed != 0 || attach || fd_test(inpkts, FDF_READ)) ? 0 : nusers;
+# else
+    readyc = 0;
+# endif
     return retval;
 }
 
+/*
+ * NAME:	conn->owner()
+ * DESCRIPTION:	set the owner of a connection, as returned by conn_ready()
+ */
+void conn_owner(connection *conn, void *owner)
+{
+    conn->owner = owner;
+}
+
+/*
+ * NAME:	conn->ready()
+ * DESCRIPTION:	return the owner of the next connection that may have to be
+ *		handled after conn_select(), or NULL if there are no more
+ */
+void *conn_ready()
+{
+    connection *conn;
+# ifdef EPOLL
+    int fd;
+
+    /* connections with descriptor events */
+    while (readyev < nevents) {
+	fd = events[readyev++].data.fd;
+	if (fd < nfdflags && (conn=fdconns[fd]) != (connection *) NULL &&
+	    conn->owner != NULL) {
+	    return conn->owner;
+	}
+    }
+# endif
+
+    /* closed connections, pending datagrams and new UDP channels */
+    while (readyc < nusers) {
+	conn = &connections[readyc++];
+	if (conn->owner != NULL &&
+	    (conn->fd == -1 || conn->npkts != 0 ||
+# ifndef EPOLL
+	     (conn->fd >= 0 &&
+	      (fd_test(conn->fd, FDF_READ) ||
+	       (fd_test(conn->fd, FDF_WAIT) && fd_test(conn->fd, FDF_WRITE)))) ||
+# endif
+	     (attach && conn->udpbuf != (char *) NULL &&
+	      conn->name == (char *) NULL))) {
+	    return conn->owner;
+	}
+    }
+    return NULL;
+}
+
 /*
  * NAME:	conn->udpcheck()
  * DESCRIPTION:	check if UDP challenge met
@@ -1649,15 +2014,13 @@ int conn_read(connection *conn, char *buf, unsigned int len)
     if (conn->fd < 0) {
 	return -1;
     }
-    if (!FD_ISSET(conn->fd, &readfds)) {
+    if (!fd_test(conn->fd, FDF_READ)) {
 	return 0;
     }
     size = read(conn->fd, buf, len);
     if (size < 0) {
+	fd_close(conn->fd);
 	close(conn->fd);
-	FD_CLR(conn->fd, &infds);
-	FD_CLR(conn->fd, &outfds);
-	FD_CLR(conn->fd, &waitfds);
 	conn->fd = -1;
 	closed++;
     }
@@ -1709,21 +2072,20 @@ int conn_write(connection *conn, char *buf, unsigned int len)
     if (len == 0) {
 	return 0;
     }
-    if (!FD_ISSET(conn->fd, &writefds)) {
+    if (!fd_test(conn->fd, FDF_WRITE)) {
 	/* the write would fail */
-	FD_SET(conn->fd, &waitfds);
+	fd_on(conn->fd, FDF_WAIT);
 	return 0;
     }
     if ((size=write(conn->fd, buf, len)) < 0 && errno != EWOULDBLOCK) {
+	fd_close(conn->fd);
 	close(conn->fd);
-	FD_CLR(conn->fd, &infds);
-	FD_CLR(conn->fd, &outfds);
 	conn->fd = -1;
 	closed++;
     } else if (size != len) {
 	/* waiting for wrdone */
-	FD_SET(conn->fd, &waitfds);
-	FD_CLR(conn->fd, &writefds);
+	fd_off(conn->fd, FDF_WRITE);
+	fd_on(conn->fd, FDF_WAIT);
 	if (size < 0) {
 	    return 0;
 	}
@@ -1771,11 +2133,11 @@ int conn_udpwrite(connection *conn, char *buf, unsigned int len)
  */
 bool conn_wrdone(connection *conn)
 {
-    if (conn->fd < 0 || !FD_ISSET(conn->fd, &waitfds)) {
+    if (conn->fd < 0 || !fd_test(conn->fd, FDF_WAIT)) {
 	return TRUE;
     }
-    if (FD_ISSET(conn->fd, &writefds)) {
-	FD_CLR(conn->fd, &waitfds);
+    if (fd_test(conn->fd, FDF_WRITE)) {
+	fd_off(conn->fd, FDF_WAIT);
 	return TRUE;
     }
     return FALSE;
@@ -1931,15 +2293,12 @@ connection *conn_connect(void *addr, int len)
     conn->name = (char *) NULL;
     conn->udpbuf = (char *) NULL;
     conn->addr = (ipaddr *) NULL;
+    conn->npkts = 0;
     conn->at = -1;
-    FD_SET(sock, &infds);
-    FD_SET(sock, &outfds);
-    FD_CLR(sock, &readfds);
-    FD_CLR(sock, &writefds);
-    FD_SET(sock, &waitfds);
-    if (sock > maxfd) {
-	maxfd = sock;
-    }
+    conn->owner = NULL;
+    fd_off(sock, FDF_READ | FDF_WRITE);
+    fd_on(sock, FDF_IN | FDF_OUT | FDF_WAIT);
+    fd_conn(sock, conn);
     return conn;
 }
 
@@ -1958,10 +2317,10 @@ int conn_check_connected(connection *conn, int *errcode)
 	return -2;
     }
 
-    if (!FD_ISSET(conn->fd, &writefds)) {
+    if (!fd_test(conn->fd, FDF_WRITE)) {
 	return 0;
     }
-    FD_CLR(conn->fd, &waitfds);
+    fd_off(conn->fd, FDF_WAIT);
 
     /*
      * Delayed connect completed, check for errors
@@ -2043,13 +2402,13 @@ bool conn_export(connection *conn, int *fd, char *addr, unsigned short *port,
 	*npkts = conn->npkts;
 	*bufsz = conn->bufsz;
 	*buf = conn->udpbuf;
-	if (FD_ISSET(conn->fd, &readfds)) {
+	if (fd_test(conn->fd, FDF_READ)) {
 	    *flags |= CONN_READF;
 	}
-	if (FD_ISSET(conn->fd, &writefds)) {
+	if (fd_test(conn->fd, FDF_WRITE)) {
 	    *flags |= CONN_WRITEF;
 	}
-	if (FD_ISSET(conn->fd, &waitfds)) {
+	if (fd_test(conn->fd, FDF_WAIT)) {
 	    *flags |= CONN_WAITF;
 	}
 	if (conn->udpbuf != (char *) NULL) {
@@ -2089,21 +2448,19 @@ connection *conn_import(int fd, char *addr, unsigned short port, short at,
     conn->npkts = 0;
     conn->port = port;
     conn->at = -1;
+    conn->owner = NULL;
 
     if (fd >= 0) {
-	FD_SET(fd, &infds);
-	FD_SET(fd, &outfds);
+	fd_on(fd, FDF_IN | FDF_OUT);
+	fd_conn(fd, conn);
 	if (flags & CONN_READF) {
-	    FD_SET(fd, &readfds);
+	    fd_on(fd, FDF_READ);
 	}
 	if (flags & CONN_WRITEF) {
-	    FD_SET(fd, &writefds);
+	    fd_on(fd, FDF_WRITE);
 	}
 	if (flags & CONN_WAITF) {
-	    FD_SET(fd, &waitfds);
-	}
-	if (fd > maxfd) {
-	    maxfd = fd;
+	    fd_on(fd, FDF_WAIT);
 	}
     }
 
@@ -32,6 +32,16 @@ static void term(int arg)
     interrupt();
 }
 
+/*
+ * NAME:	usr1()
+ * DESCRIPTION:	catch SIGUSR1
+ */
+static void usr1(int arg)
+{
+    signal(SIGUSR1, usr1);
+    memstats();
+}
+
 }
 
 /*
@@ -47,6 +57,7 @@ int main(int argc, char *argv[])
     P_srandom(seed ^ ((long) mtime << 22));
     signal(SIGPIPE, SIG_IGN);
     signal(SIGTERM, term);
+    signal(SIGUSR1, usr1);
     return dgd_main(argc, argv);
 }
 
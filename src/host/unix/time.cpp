@@ -43,6 +43,18 @@ Uint P_mtime(unsigned short *milli)
     return (Uint) time.tv_sec;
 }
 
+/*
+ * NAME:	P->utime()
+ * DESCRIPTION:	return a monotonic time in microseconds
+ */
+Uuint P_utime()
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (Uuint) time.tv_sec * 1000000 + time.tv_nsec / 1000;
+}
+
 /*
  * NAME:	P->ctime()
  * DESCRIPTION:	convert the given time to a string
@@ -356,6 +356,7 @@ struct connection : public Hashtab::Entry {
     ipaddr *addr;			/* internet address of connection */
     unsigned short port;		/* UDP port of connection */
     short at;				/* port connection was accepted at */
+    void *owner;			/* owner of this connection */
 };
 
 struct portdesc {
@@ -382,6 +383,7 @@ static int nudescs;			/* # datagram ports */
 static SOCKET inpkts, outpkts;		/* UDP packet notification pip */
 static CRITICAL_SECTION udpmutex;	/* UDP mutex */
 static bool udpstop;			/* stop UDP thread? */
+static bool udpattach;			/* UDP channel attached? */
 
 /*
  * NAME:	udp->recv6()
@@ -448,6 +450,7 @@ static void udp_recv6(int n)
 		    hash = &udphtab[hashval];
 		    conn->next = *hash;
 		    *hash = conn;
+		    udpattach = TRUE;
 
 		    break;
 		}
@@ -540,6 +543,7 @@ static void udp_recv(int n)
 		    hash = &udphtab[hashval];
 		    conn->next = *hash;
 		    *hash = conn;
+		    udpattach = TRUE;
 
 		    break;
 		}
@@ -631,6 +635,8 @@ static fd_set waitfds;			/* file descriptor wait-write bitmap */
 static fd_set readfds;			/* file descriptor read bitmap */
 static fd_set writefds;			/* file descriptor write map */
 static int closed;			/* #fds closed in write */
+static int readyc;			/* next connection to check */
+static bool attach;			/* check for attached UDP channels */
 static SOCKET self;			/* socket to self */
 static bool self6;			/* self socket IPv6? */
 static SOCKET cintr;			/* interrupt socket */
@@ -762,6 +768,8 @@ bool conn_init(int maxusers, char **thosts, char **bhosts, char **dhosts,
     FD_ZERO(&outfds);
     FD_ZERO(&waitfds);
     closed = 0;
+    readyc = maxusers;
+    attach = udpattach = FALSE;
 
     ntdescs = ntports;
     if (ntports != 0) {
@@ -982,6 +990,8 @@ bool conn_init(int maxusers, char **thosts, char **bhosts, char **dhosts,
     connections = ALLOC(connection, nusers = maxusers);
     for (n = nusers, conn = connections; n > 0; --n, conn++) {
 	conn->fd = INVALID_SOCKET;
+	conn->npkts = 0;
+	conn->owner = NULL;
 	conn->next = flist;
 	flist = conn;
     }
@@ -1148,7 +1158,9 @@ static connection *conn_accept6(SOCKET portfd, int port)
     addr.in.addr6 = sin6.sin6_addr;
     addr.ipv6 = TRUE;
     conn->addr = ipa_new(&addr);
+    conn->npkts = 0;
     conn->at = port;
+    conn->owner = NULL;
     FD_SET(fd, &infds);
     FD_SET(fd, &outfds);
     FD_CLR(fd, &readfds);
@@ -1191,7 +1203,9 @@ static connection *conn_accept(SOCKET portfd, int port)
     addr.in.addr = sin.sin_addr;
     addr.ipv6 = FALSE;
     conn->addr = ipa_new(&addr);
+    conn->npkts = 0;
     conn->at = port;
+    conn->owner = NULL;
     FD_SET(fd, &infds);
     FD_SET(fd, &outfds);
     FD_CLR(fd, &readfds);
@@ -1228,6 +1242,7 @@ static connection *conn_udpaccept(int port)
     memcpy(conn->udpbuf + 2, udescs[port].buffer, udescs[port].size);
     conn->bufsz = udescs[port].size + 2;
     conn->npkts = 1;
+    conn->owner = NULL;
     udescs[port].accept = FALSE;
     LeaveCriticalSection(&udpmutex);
 
@@ -1413,6 +1428,7 @@ void conn_del(connection *conn)
     if (conn->addr != (ipaddr *) NULL) {
       ipa_del(conn->addr);
     }
+    conn->owner = NULL;
     conn->next = flist;
     flist = conn;
 }
@@ -1506,9 +1522,52 @@ int conn_select(Uint t, unsigned int mtime)
     if (FD_ISSET(in, &readfds)) {
 	ipa_lookup();
     }
+
+    /* prepare for conn_ready() */
+    if (nudescs != 0) {
+	EnterCriticalSection(&udpmutex);
+	attach = udpattach;
+	udpattach = FALSE;
+	LeaveCriticalSection(&udpmutex);
+    }
+    readyc = 0;
     return retval;
 }
 
+/*
+ * NAME:	conn->owner()
+ * DESCRIPTION:	set the owner of a connection, as returned by conn_ready()
+ */
+void conn_owner(connection *conn, void *owner)
+{
+    conn->owner = owner;
+}
+
+/*
+ * NAME:	conn->ready()
+ * DESCRIPTION:	return the owner of the next connection that may have to be
+ *		handled after conn_select(), or NULL if there are no more
+ */
+void *conn_ready()
+{
+    connection *conn;
+
+    while (readyc < nusers) {
+	conn = &connections[readyc++];
+	if (conn->owner != NULL &&
+	    ((conn->fd == INVALID_SOCKET && !conn->udp) || conn->npkts != 0 ||
+	     (conn->fd != INVALID_SOCKET &&
+	      (FD_ISSET(conn->fd, &readfds) ||
+	       (FD_ISSET(conn->fd, &waitfds) &&
+		FD_ISSET(conn->fd, &writefds)))) ||
+	     (attach && conn->udpbuf != (char *) NULL &&
+	      conn->name == (char *) NULL))) {
+	    return conn->owner;
+	}
+    }
+    return NULL;
+}
+
 /*
  * NAME:	conn->udpcheck()
  * DESCRIPTION:	check if UDP challenge met
@@ -1794,7 +1853,9 @@ connection *conn_connect(void *addr, int len)
     conn->name = (char *) NULL;
     conn->udpbuf = (char *) NULL;
     conn->addr = (ipaddr *) NULL;
+    conn->npkts = 0;
     conn->at = -1;
+    conn->owner = NULL;
     FD_SET(sock, &infds);
     FD_SET(sock, &outfds);
     FD_CLR(sock, &readfds);
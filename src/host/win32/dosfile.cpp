@@ -302,3 +302,120 @@ int P_execv(const char *path, char **argv)
     P_message("Hotbooting not supported on Windows\012");	/* LF */
     return -1;
 }
+
+/*
+ * NAME:	P->preadv()
+ * DESCRIPTION:	read into a vector of buffers at a file offset; unlike on
+ *		Unix, the file position is changed
+ */
+int P_preadv(int fd, const struct iovec *iov, int iovcnt, off_t offset)
+{
+    int n, total;
+
+    if (_lseek(fd, offset, SEEK_SET) < 0) {
+	return -1;
+    }
+    for (total = 0; iovcnt > 0; iov++, --iovcnt) {
+	n = _read(fd, (char *) iov->iov_base, (unsigned int) iov->iov_len);
+	if (n < 0) {
+	    return -1;
+	}
+	total += n;
+	if (n != iov->iov_len) {
+	    break;
+	}
+    }
+    return total;
+}
+
+/*
+ * NAME:	P->pwritev()
+ * DESCRIPTION:	write a vector of buffers at a file offset; unlike on
+ *		Unix, the file position is changed
+ */
+int P_pwritev(int fd, const struct iovec *iov, int iovcnt, off_t offset)
+{
+    int n, total;
+
+    if (_lseek(fd, offset, SEEK_SET) < 0) {
+	return -1;
+    }
+    for (total = 0; iovcnt > 0; iov++, --iovcnt) {
+	n = _write(fd, (char *) iov->iov_base, (unsigned int) iov->iov_len);
+	if (n < 0) {
+	    return -1;
+	}
+	total += n;
+	if (n != iov->iov_len) {
+	    break;
+	}
+    }
+    return total;
+}
+
+/*
+ * NAME:	P->aio_queue()
+ * DESCRIPTION:	perform an I/O request; there is no I/O thread on Windows
+ */
+void P_aio_queue(aioreq *req)
+{
+    char *buf;
+    unsigned int size;
+    int n;
+
+    req->state = AIO_FAILED;
+    if (_lseek(req->fd, req->offset, SEEK_SET) < 0) {
+	return;
+    }
+    if (req->write) {
+	for (buf = req->buf, size = req->size; size != 0; buf += n, size -= n)
+	{
+	    n = _write(req->fd, buf, size);
+	    if (n <= 0) {
+		return;
+	    }
+	}
+    } else if (_read(req->fd, req->buf, req->size) <= 0) {
+	return;
+    }
+    req->state = AIO_DONE;
+}
+
+/*
+ * NAME:	P->aio_wait()
+ * DESCRIPTION:	wait for a request to complete, return TRUE if it succeeded
+ */
+bool P_aio_wait(aioreq *req)
+{
+    return (req->state == AIO_DONE);
+}
+
+/*
+ * NAME:	P->aio_finish()
+ * DESCRIPTION:	complete all requests
+ */
+void P_aio_finish()
+{
+}
+
+/*
+ * NAME:	P->mmap()
+ * DESCRIPTION:	map a file into memory; not supported on Windows
+ */
+char *P_mmap(int fd, off_t size, bool write)
+{
+    UNREFERENCED_PARAMETER(fd);
+    UNREFERENCED_PARAMETER(size);
+    UNREFERENCED_PARAMETER(write);
+    return (char *) NULL;
+}
+
+/*
+ * NAME:	P->munmap()
+ * DESCRIPTION:	unmap a file from memory
+ */
+void P_munmap(char *mem, off_t size)
+{
+    UNREFERENCED_PARAMETER(mem);
+    UNREFERENCED_PARAMETER(size);
+}
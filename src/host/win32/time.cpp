@@ -56,6 +56,23 @@ Uint P_mtime(unsigned short *milli)
     return (Uint) (time / 10000000);
 }
 
+/*
+ * NAME:	P->utime()
+ * DESCRIPTION:	return a monotonic time in microseconds
+ */
+Uuint P_utime()
+{
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER count;
+
+    if (freq.QuadPart == 0) {
+	QueryPerformanceFrequency(&freq);
+    }
+    QueryPerformanceCounter(&count);
+    return (Uuint) (count.QuadPart / freq.QuadPart * 1000000 +
+		    count.QuadPart % freq.QuadPart * 1000000 / freq.QuadPart);
+}
+
 /*
  * NAME:	P->ctime()
  * DESCRIPTION:	return time as string
@@ -26,6 +26,7 @@
 # include "data.h"
 # include "control.h"
 # include "table.h"
+# include "profile.h"
 
 # ifdef DEBUG
 # undef EXTRA_STACK
@@ -33,15 +34,31 @@
 # endif
 
 
-static Value stack[MIN_STACK];	/* initial stack */
+static Value vstack[VALUE_STACK];	/* value stack */
+# define VSTACK(v)	((v) >= vstack && (v) < vstack + VALUE_STACK)
 static Frame topframe;		/* top frame */
 static rlinfo rlim;		/* top rlimits info */
 Frame *cframe;			/* current frame */
+Uuint tickcount;		/* total # ticks used */
 static char *creator;		/* creator function name */
 static unsigned int clen;	/* creator function name length */
 static bool stricttc;		/* strict typechecking */
 static char ihash[INHASHSZ];	/* instanceof hashtable */
 
+# define CCNAMESZ	23		/* max. function name length in cache */
+
+struct callcache {
+    Control *ctrl;		/* control block of called object */
+    Uint serial;		/* serial number of control block */
+    unsigned short len;		/* length of function name */
+    char inherit;		/* function object index */
+    char index;			/* function index */
+    char sclass;		/* function class */
+    char func[CCNAMESZ];	/* function name */
+};
+
+static callcache ccache[CALLCACHESZ];	/* call_other function cache */
+
 int nil_type;			/* type of nil value */
 Value zero_int = { T_INT, TRUE };
 Value zero_float = { T_FLOAT, TRUE };
@@ -54,8 +71,8 @@ Value nil_value = { T_NIL, TRUE };
 void i_init(char *create, bool flag)
 {
     topframe.oindex = OBJ_NONE;
-    topframe.fp = topframe.sp = stack + MIN_STACK;
-    topframe.stack = stack;
+    topframe.fp = topframe.sp = vstack + VALUE_STACK;
+    topframe.stack = topframe.fp - MIN_STACK;
     rlim.maxdepth = 0;
     rlim.ticks = 0;
     rlim.nodepth = TRUE;
@@ -63,6 +80,7 @@ void i_init(char *create, bool flag)
     topframe.rlim = &rlim;
     topframe.level = 0;
     topframe.atomic = FALSE;
+    topframe.prof = (pfnode *) NULL;
     cframe = &topframe;
 
     creator = create;
@@ -161,6 +179,15 @@ void i_grow_stack(Frame *f, int size)
 	Value *v, *stk;
 	intptr_t offset;
 
+	if (VSTACK(f->stack) && f->sp - vstack >= size + MIN_STACK) {
+	    /*
+	     * the current frame is at the end of the value stack: extend it
+	     * in place
+	     */
+	    f->stack = f->sp - (size + MIN_STACK);
+	    return;
+	}
+
 	/*
 	 * extend the local stack
 	 */
@@ -181,7 +208,7 @@ void i_grow_stack(Frame *f, int size)
 	    /* stack on stack: alloca'd */
 	    AFREE(f->stack);
 	    f->sos = FALSE;
-	} else if (f->stack != stack) {
+	} else if (!VSTACK(f->stack)) {
 	    FREE(f->stack);
 	}
 	f->stack = stk;
@@ -1194,21 +1221,17 @@ void i_set_rlimits(Frame *f, rlinfo *rlim)
  * NAME:	interpret->set_sp()
  * DESCRIPTION:	set the current stack pointer
  */
-Frame *i_set_sp(Frame *ftop, Value *sp)
+Frame *i_set_sp(Frame *ftop, Frame *f, Value *sp)
 {
-    Value *v;
-    Frame *f;
+    Value *v, *w;
 
-    for (f = ftop; ; f = f->prev) {
-	v = f->sp;
-	for (;;) {
-	    if (v == sp) {
-		f->sp = v;
-		return f;
-	    }
-	    if (v == f->fp) {
-		break;
-	    }
+    for (;;) {
+	/*
+	 * frames may share the value stack, so the target frame has to be
+	 * known to tell its stack pointer from the end of a callee's stack
+	 */
+	w = (ftop == f) ? sp : ftop->fp;
+	for (v = ftop->sp; v != w; v++) {
 	    switch (v->type) {
 	    case T_STRING:
 		str_del(v->u.string);
@@ -1220,18 +1243,22 @@ Frame *i_set_sp(Frame *ftop, Value *sp)
 		arr_del(v->u.array);
 		break;
 	    }
-	    v++;
+	}
+	if (ftop == f) {
+	    f->sp = sp;
+	    return f;
 	}
 
-	if (f->lwobj != (Array *) NULL) {
-	    arr_del(f->lwobj);
+	if (ftop->lwobj != (Array *) NULL) {
+	    arr_del(ftop->lwobj);
 	}
-	if (f->sos) {
+	if (ftop->sos) {
 	    /* stack on stack */
-	    AFREE(f->stack);
-	} else if (f->oindex != OBJ_NONE) {
-	    FREE(f->stack);
+	    AFREE(ftop->stack);
+	} else if (!VSTACK(ftop->stack)) {
+	    FREE(ftop->stack);
 	}
+	ftop = ftop->prev;
     }
 }
 
@@ -1535,7 +1562,6 @@ static unsigned short i_switch_str(Frame *f, char *pc)
     unsigned short h, l, m, u, u2, dflt;
     int cmp;
     char *p;
-    Control *ctrl;
 
     FETCH2U(pc, h);
     FETCH2U(pc, dflt);
@@ -1550,14 +1576,13 @@ static unsigned short i_switch_str(Frame *f, char *pc)
 	return dflt;
     }
 
-    ctrl = f->p_ctrl;
     l = 0;
     --h;
     while (l < h) {
 	m = (l + h) >> 1;
 	p = pc + 5 * m;
 	u = FETCH1U(p);
-	cmp = str_cmp(f->sp->u.string, d_get_strconst(ctrl, u, FETCH2U(p, u2)));
+	cmp = str_cmp(f->sp->u.string, f->strtabs[u][FETCH2U(p, u2)]);
 	if (cmp == 0) {
 	    return FETCH2U(p, l);
 	} else if (cmp < 0) {
@@ -1569,6 +1594,94 @@ static unsigned short i_switch_str(Frame *f, char *pc)
     return dflt;
 }
 
+/*
+ * NAME:	interpret->switch_table()
+ * DESCRIPTION:	handle an int switch with a jump table
+ */
+static unsigned short i_switch_table(Frame *f, char *pc)
+{
+    unsigned short n, sz, dflt;
+    Uint num;
+    Int low;
+
+    FETCH2U(pc, n);
+    sz = FETCH1U(pc);
+    FETCH2U(pc, dflt);
+    if (f->sp->type != T_INT) {
+	return dflt;
+    }
+
+    switch (sz) {
+    case 1:
+	low = FETCH1S(pc);
+	break;
+
+    case 2:
+	FETCH2S(pc, low);
+	break;
+
+    case 3:
+	FETCH3S(pc, low);
+	break;
+
+    case 4:
+	FETCH4S(pc, low);
+	break;
+    }
+
+    num = (Uint) f->sp->u.number - (Uint) low;
+    if (num >= n) {
+	return dflt;
+    }
+    pc += 2 * num;
+    return FETCH2U(pc, n);
+}
+
+/*
+ * NAME:	interpret->switch_hash()
+ * DESCRIPTION:	handle a string switch with a hash table
+ */
+static unsigned short i_switch_hash(Frame *f, char *pc)
+{
+    unsigned short h, l, u, u2, mask, dflt;
+    char *p, *entries;
+    String *str;
+
+    FETCH2U(pc, h);
+    FETCH2U(pc, dflt);
+    if (FETCH1U(pc) == 0) {
+	FETCH2U(pc, l);
+	if (VAL_NIL(f->sp)) {
+	    return l;
+	}
+    }
+    if (f->sp->type != T_STRING) {
+	return dflt;
+    }
+
+    /*
+     * The hash function is part of the program format: switch tables are
+     * computed at compile time and saved with the program.
+     */
+    FETCH2U(pc, mask);
+    entries = pc + 2 * mask - 5;
+    --mask;
+    str = f->sp->u.string;
+    h = Hashtab::hashswitch(str->text, str->len) & mask;
+    for (;;) {
+	p = pc + 2 * h;
+	if (FETCH2U(p, u) == 0) {
+	    return dflt;
+	}
+	p = entries + 5 * u;
+	u = FETCH1U(p);
+	if (str_cmp(str, f->strtabs[u][FETCH2U(p, u2)]) == 0) {
+	    return FETCH2U(p, l);
+	}
+	h = (h + 1) & mask;
+    }
+}
+
 /*
  * NAME:	interpret->catcherr()
  * DESCRIPTION:	handle caught error
@@ -1578,6 +1691,57 @@ void i_catcherr(Frame *f, Int depth)
     i_runtime_error(f, depth);
 }
 
+/*
+ * With GNU C, each instruction jumps directly to the code for the next one
+ * through a table of label addresses, rather than going back to the switch.
+ * Define NOTHREADING to use only the switch.
+ */
+# if defined(__GNUC__) && !defined(NOTHREADING)
+# define THREADED
+# endif
+
+# ifdef DEBUG
+# define CHECK_STACK(f)	if ((f)->sp < (f)->stack + MIN_STACK) {		      \
+			    fatal("out of value stack");		      \
+			}
+# else
+# define CHECK_STACK(f)
+# endif
+
+/*
+ * Ticks are counted locally, and charged to the rlimits and to tickcount for
+ * a block of instructions at once: before jumps, calls, and anything else
+ * that may look at the ticks or change the limits.  Code without jumps
+ * cannot loop, so running out of ticks is still detected within a block.
+ */
+# define FETCH_INSTR()	CHECK_STACK(f);					      \
+			ticks++;					      \
+			instr = FETCH1U(pc);				      \
+			f->pc = pc
+# define CHARGE_TICKS()	tickcount += ticks;				      \
+			if ((f->rlim->ticks -= ticks) <= 0) {		      \
+			    if (f->rlim->noticks) {			      \
+				f->rlim->ticks = 0x7fffffff;		      \
+			    } else {					      \
+				error("Out of ticks");			      \
+			    }						      \
+			}						      \
+			ticks = 0
+
+# ifdef THREADED
+# define LABEL(name)	L_##name:
+# define DISPATCH()	FETCH_INSTR();					      \
+			goto *dispatch[instr & I_INSTR_MASK]
+# define NEXT()		do { DISPATCH(); } while (FALSE)
+# else
+# define LABEL(name)
+# define DISPATCH()	FETCH_INSTR();					      \
+			if (pf_instr) {					      \
+			    pf_icount[instr & I_INSTR_MASK]++;		      \
+			}
+# define NEXT()		continue
+# endif
+
 /*
  * NAME:	interpret->interpret()
  * DESCRIPTION:	Main interpreter function. Interpret stack machine code.
@@ -1590,88 +1754,146 @@ static void i_interpret(Frame *f, char *pc)
     kfunc *kf;
     int size, instance;
     bool atomic;
-    Int newdepth, newticks;
+    Int newdepth, newticks, ticks;
     Value val;
 
+# ifdef THREADED
+    static void *instrs[I_INSTR_MASK + 1] = {
+	&&L_PUSH_INT1, &&L_PUSH_INT4, &&L_PUSH_LOCAL2, &&L_PUSH_FLOAT6,
+	&&L_PUSH_STRING, &&L_PUSH_FAR_STRING, &&L_PUSH_GLOBAL, &&L_INDEX,
+	&&L_INDEX2, &&L_AGGREGATE, &&L_CAST, &&L_INSTANCEOF,
+	&&L_STORES, &&L_STORE_GLOBAL_INDEX, &&L_CALL_EFUNC, &&L_CALL_CEFUNC,
+	&&L_CALL_CKFUNC, &&L_STORE_LOCAL, &&L_STORE_GLOBAL,
+	&&L_STORE_FAR_GLOBAL, &&L_STORE_INDEX, &&L_STORE_LOCAL_INDEX,
+	&&L_STORE_FAR_GLOBAL_INDEX, &&L_STORE_INDEX_INDEX, &&L_JUMP_ZERO,
+	&&L_JUMP, &&L_CALL_KFUNC, &&L_CALL_AFUNC, &&L_CALL_DFUNC,
+	&&L_CALL_FUNC, &&L_CATCH, &&L_RLIMITS,
+	/* the same with I_POP_BIT, where applicable */
+	&&L_PUSH_INT2, &&L_ILLEGAL, &&L_PUSH_LOCAL_INT1, &&L_ILLEGAL,
+	&&L_PUSH_NEAR_STRING, &&L_PUSH_LOCAL, &&L_PUSH_FAR_GLOBAL, &&L_INDEX,
+	&&L_SPREAD, &&L_AGGREGATE, &&L_CAST, &&L_INSTANCEOF,
+	&&L_INT_KFUNC, &&L_STORE_GLOBAL_INDEX, &&L_CALL_EFUNC, &&L_CALL_CEFUNC,
+	&&L_CALL_CKFUNC, &&L_STORE_LOCAL, &&L_STORE_GLOBAL,
+	&&L_STORE_FAR_GLOBAL, &&L_STORE_INDEX, &&L_STORE_LOCAL_INDEX,
+	&&L_STORE_FAR_GLOBAL_INDEX, &&L_STORE_INDEX_INDEX, &&L_JUMP_NONZERO,
+	&&L_SWITCH, &&L_CALL_KFUNC, &&L_CALL_AFUNC, &&L_CALL_DFUNC,
+	&&L_CALL_FUNC, &&L_CATCH, &&L_RETURN
+    };
+    static void *dispatch[I_INSTR_MASK + 1];
+    static bool profiling = TRUE;
+
+    if (pf_instr != profiling) {
+	/* while profiling, count instructions before dispatching them */
+	for (size = 0; size <= I_INSTR_MASK; size++) {
+	    dispatch[size] = (pf_instr) ? &&L_PROFILE : instrs[size];
+	}
+	profiling = pf_instr;
+    }
+# endif
+
     size = 0;
     l = 0;
+    ticks = 0;
 
     for (;;) {
-# ifdef DEBUG
-	if (f->sp < f->stack + MIN_STACK) {
-	    fatal("out of value stack");
+	DISPATCH();
+# ifdef THREADED
+    L_PROFILE:
+	if (pf_instr) {
+	    pf_icount[instr & I_INSTR_MASK]++;
 	}
+	goto *instrs[instr & I_INSTR_MASK];
 # endif
-	if (--f->rlim->ticks <= 0) {
-	    if (f->rlim->noticks) {
-		f->rlim->ticks = 0x7fffffff;
-	    } else {
-		error("Out of ticks");
-	    }
-	}
-	instr = FETCH1U(pc);
-	f->pc = pc;
 
 	switch (instr & I_INSTR_MASK) {
 	case I_PUSH_INT1:
+	LABEL(PUSH_INT1)
 	    PUSH_INTVAL(f, FETCH1S(pc));
-	    continue;
+	    NEXT();
 
 	case I_PUSH_INT2:
+	LABEL(PUSH_INT2)
 	    PUSH_INTVAL(f, FETCH2S(pc, u));
-	    continue;
+	    NEXT();
 
 	case I_PUSH_INT4:
+	LABEL(PUSH_INT4)
 	    PUSH_INTVAL(f, FETCH4S(pc, l));
-	    continue;
+	    NEXT();
 
 	case I_PUSH_FLOAT6:
+	LABEL(PUSH_FLOAT6)
 	    FETCH2U(pc, u);
 	    PUSH_FLTCONST(f, u, FETCH4U(pc, l));
-	    continue;
+	    NEXT();
 
 	case I_PUSH_STRING:
-	    PUSH_STRVAL(f, d_get_strconst(f->p_ctrl, f->p_ctrl->ninherits - 1,
-					  FETCH1U(pc)));
-	    continue;
+	LABEL(PUSH_STRING)
+	    PUSH_STRVAL(f, f->strings[FETCH1U(pc)]);
+	    NEXT();
 
 	case I_PUSH_NEAR_STRING:
+	LABEL(PUSH_NEAR_STRING)
 	    u = FETCH1U(pc);
-	    PUSH_STRVAL(f, d_get_strconst(f->p_ctrl, u, FETCH1U(pc)));
-	    continue;
+	    PUSH_STRVAL(f, f->strtabs[u][FETCH1U(pc)]);
+	    NEXT();
 
 	case I_PUSH_FAR_STRING:
+	LABEL(PUSH_FAR_STRING)
 	    u = FETCH1U(pc);
-	    PUSH_STRVAL(f, d_get_strconst(f->p_ctrl, u, FETCH2U(pc, u2)));
-	    continue;
+	    PUSH_STRVAL(f, f->strtabs[u][FETCH2U(pc, u2)]);
+	    NEXT();
 
 	case I_PUSH_LOCAL:
+	LABEL(PUSH_LOCAL)
 	    u = FETCH1S(pc);
 	    i_push_value(f, ((short) u < 0) ? f->fp + (short) u : f->argp + u);
-	    continue;
+	    NEXT();
+
+	case I_PUSH_LOCAL2:
+	LABEL(PUSH_LOCAL2)
+	    ticks++;	/* charged as two instructions */
+	    u = FETCH1S(pc);
+	    i_push_value(f, ((short) u < 0) ? f->fp + (short) u : f->argp + u);
+	    u = FETCH1S(pc);
+	    i_push_value(f, ((short) u < 0) ? f->fp + (short) u : f->argp + u);
+	    NEXT();
+
+	case I_PUSH_LOCAL_INT1:
+	LABEL(PUSH_LOCAL_INT1)
+	    ticks++;	/* charged as two instructions */
+	    u = FETCH1S(pc);
+	    i_push_value(f, ((short) u < 0) ? f->fp + (short) u : f->argp + u);
+	    PUSH_INTVAL(f, FETCH1S(pc));
+	    NEXT();
 
 	case I_PUSH_GLOBAL:
+	LABEL(PUSH_GLOBAL)
 	    i_global(f, f->p_ctrl->ninherits - 1, FETCH1U(pc));
-	    continue;
+	    NEXT();
 
 	case I_PUSH_FAR_GLOBAL:
+	LABEL(PUSH_FAR_GLOBAL)
 	    u = FETCH1U(pc);
 	    i_global(f, u, FETCH1U(pc));
-	    continue;
+	    NEXT();
 
 	case I_INDEX:
 	case I_INDEX | I_POP_BIT:
+	LABEL(INDEX)
 	    i_index(f, f->sp + 1, f->sp, &val, FALSE);
 	    *++f->sp = val;
 	    break;
 
 	case I_INDEX2:
+	LABEL(INDEX2)
 	    i_index(f, f->sp + 1, f->sp, &val, TRUE);
 	    *--f->sp = val;
-	    continue;
+	    NEXT();
 
 	case I_AGGREGATE:
 	case I_AGGREGATE | I_POP_BIT:
+	LABEL(AGGREGATE)
 	    if (FETCH1U(pc) == 0) {
 		i_aggregate(f, FETCH2U(pc, u));
 	    } else {
@@ -1680,12 +1902,14 @@ static void i_interpret(Frame *f, char *pc)
 	    break;
 
 	case I_SPREAD:
+	LABEL(SPREAD)
 	    u = FETCH1S(pc);
 	    size = i_spread(f, -(short) u - 2);
-	    continue;
+	    NEXT();
 
 	case I_CAST:
 	case I_CAST | I_POP_BIT:
+	LABEL(CAST)
 	    u = FETCH1U(pc);
 	    if (u == T_CLASS) {
 		FETCH3U(pc, l);
@@ -1695,6 +1919,7 @@ static void i_interpret(Frame *f, char *pc)
 
 	case I_INSTANCEOF:
 	case I_INSTANCEOF | I_POP_BIT:
+	LABEL(INSTANCEOF)
 	    FETCH3U(pc, l);
 	    switch (f->sp->type) {
 	    case T_OBJECT:
@@ -1720,6 +1945,7 @@ static void i_interpret(Frame *f, char *pc)
 	    break;
 
 	case I_STORES:
+	LABEL(STORES)
 	    u = FETCH1U(pc);
 	    if (f->sp->type != T_ARRAY) {
 		error("Value is not an array");
@@ -1731,27 +1957,31 @@ static void i_interpret(Frame *f, char *pc)
 	    f->pc = pc;
 	    i_stores(f, 0, u);
 	    pc = f->pc;
-	    continue;
+	    NEXT();
 
 	case I_STORE_LOCAL:
 	case I_STORE_LOCAL | I_POP_BIT:
+	LABEL(STORE_LOCAL)
 	    i_store_local(f, FETCH1S(pc), f->sp, NULL);
 	    break;
 
 	case I_STORE_GLOBAL:
 	case I_STORE_GLOBAL | I_POP_BIT:
+	LABEL(STORE_GLOBAL)
 	    i_store_global(f, f->p_ctrl->ninherits - 1, FETCH1U(pc), f->sp,
 			   NULL);
 	    break;
 
 	case I_STORE_FAR_GLOBAL:
 	case I_STORE_FAR_GLOBAL | I_POP_BIT:
+	LABEL(STORE_FAR_GLOBAL)
 	    u = FETCH1U(pc);
 	    i_store_global(f, u, FETCH1U(pc), f->sp, NULL);
 	    break;
 
 	case I_STORE_INDEX:
 	case I_STORE_INDEX | I_POP_BIT:
+	LABEL(STORE_INDEX)
 	    val = nil_value;
 	    if (i_store_index(f, &val, f->sp + 2, f->sp + 1, f->sp)) {
 		str_del(f->sp[2].u.string);
@@ -1763,6 +1993,7 @@ static void i_interpret(Frame *f, char *pc)
 
 	case I_STORE_LOCAL_INDEX:
 	case I_STORE_LOCAL_INDEX | I_POP_BIT:
+	LABEL(STORE_LOCAL_INDEX)
 	    u = FETCH1S(pc);
 	    val = nil_value;
 	    if (i_store_index(f, &val, f->sp + 2, f->sp + 1, f->sp)) {
@@ -1776,6 +2007,7 @@ static void i_interpret(Frame *f, char *pc)
 
 	case I_STORE_GLOBAL_INDEX:
 	case I_STORE_GLOBAL_INDEX | I_POP_BIT:
+	LABEL(STORE_GLOBAL_INDEX)
 	    u = FETCH1U(pc);
 	    val = nil_value;
 	    if (i_store_index(f, &val, f->sp + 2, f->sp + 1, f->sp)) {
@@ -1789,6 +2021,7 @@ static void i_interpret(Frame *f, char *pc)
 
 	case I_STORE_FAR_GLOBAL_INDEX:
 	case I_STORE_FAR_GLOBAL_INDEX | I_POP_BIT:
+	LABEL(STORE_FAR_GLOBAL_INDEX)
 	    u = FETCH1U(pc);
 	    u2 = FETCH1U(pc);
 	    val = nil_value;
@@ -1803,6 +2036,7 @@ static void i_interpret(Frame *f, char *pc)
 
 	case I_STORE_INDEX_INDEX:
 	case I_STORE_INDEX_INDEX | I_POP_BIT:
+	LABEL(STORE_INDEX_INDEX)
 	    val = nil_value;
 	    if (i_store_index(f, &val, f->sp + 2, f->sp + 1, f->sp)) {
 		f->sp[1] = val;
@@ -1818,27 +2052,35 @@ static void i_interpret(Frame *f, char *pc)
 	    break;
 
 	case I_JUMP_ZERO:
+	LABEL(JUMP_ZERO)
+	    CHARGE_TICKS();
 	    p = f->prog + FETCH2U(pc, u);
 	    if (!VAL_TRUE(f->sp)) {
 		pc = p;
 	    }
 	    i_del_value(f->sp++);
-	    continue;
+	    NEXT();
 
 	case I_JUMP_NONZERO:
+	LABEL(JUMP_NONZERO)
+	    CHARGE_TICKS();
 	    p = f->prog + FETCH2U(pc, u);
 	    if (VAL_TRUE(f->sp)) {
 		pc = p;
 	    }
 	    i_del_value(f->sp++);
-	    continue;
+	    NEXT();
 
 	case I_JUMP:
+	LABEL(JUMP)
+	    CHARGE_TICKS();
 	    p = f->prog + FETCH2U(pc, u);
 	    pc = p;
-	    continue;
+	    NEXT();
 
 	case I_SWITCH:
+	LABEL(SWITCH)
+	    CHARGE_TICKS();
 	    switch (FETCH1U(pc)) {
 	    case SWITCH_INT:
 		pc = f->prog + i_switch_int(f, pc);
@@ -1851,12 +2093,22 @@ static void i_interpret(Frame *f, char *pc)
 	    case SWITCH_STRING:
 		pc = f->prog + i_switch_str(f, pc);
 		break;
+
+	    case SWITCH_TABLE:
+		pc = f->prog + i_switch_table(f, pc);
+		break;
+
+	    case SWITCH_HASH:
+		pc = f->prog + i_switch_hash(f, pc);
+		break;
 	    }
 	    i_del_value(f->sp++);
-	    continue;
+	    NEXT();
 
 	case I_CALL_KFUNC:
 	case I_CALL_KFUNC | I_POP_BIT:
+	LABEL(CALL_KFUNC)
+	    CHARGE_TICKS();
 	    kf = &KFUN(FETCH1U(pc));
 	    if (PROTO_VARGS(kf->proto) != 0) {
 		/* variable # of arguments */
@@ -1885,8 +2137,182 @@ static void i_interpret(Frame *f, char *pc)
 	    pc = f->pc;
 	    break;
 
+	case I_INT_KFUNC:
+	LABEL(INT_KFUNC)
+	    /* integer kfun without a call */
+	    u = FETCH1U(pc);
+	    if (u & I_INT_JUMP) {
+		/* comparison followed by a conditional jump */
+		ticks++;	/* charged as two instructions */
+		CHARGE_TICKS();
+		switch (u & ~I_INT_JUMP) {
+		case KF_EQ_INT:
+		    u = (f->sp[1].u.number == f->sp->u.number);
+		    break;
+
+		case KF_GE_INT:
+		    u = (f->sp[1].u.number >= f->sp->u.number);
+		    break;
+
+		case KF_GT_INT:
+		    u = (f->sp[1].u.number > f->sp->u.number);
+		    break;
+
+		case KF_LE_INT:
+		    u = (f->sp[1].u.number <= f->sp->u.number);
+		    break;
+
+		case KF_LT_INT:
+		    u = (f->sp[1].u.number < f->sp->u.number);
+		    break;
+
+		case KF_NE_INT:
+		    u = (f->sp[1].u.number != f->sp->u.number);
+		    break;
+		}
+		f->sp += 2;
+		p = f->prog + FETCH2U(pc, u2);
+		if (u) {
+		    pc = p;
+		}
+		NEXT();
+	    }
+
+	    switch (u) {
+	    case KF_ADD_INT:
+		PUT_INT(&f->sp[1], f->sp[1].u.number + f->sp->u.number);
+		f->sp++;
+		break;
+
+	    case KF_ADD1_INT:
+		PUT_INT(f->sp, f->sp->u.number + 1);
+		break;
+
+	    case KF_AND_INT:
+		PUT_INT(&f->sp[1], f->sp[1].u.number & f->sp->u.number);
+		f->sp++;
+		break;
+
+	    case KF_DIV_INT:
+		if (f->sp->u.number == 0) {
+		    error("Division by zero");
+		}
+		PUT_INT(&f->sp[1],
+			INT_DIV(f->sp[1].u.number, f->sp->u.number));
+		f->sp++;
+		break;
+
+	    case KF_EQ_INT:
+		PUT_INT(&f->sp[1], (f->sp[1].u.number == f->sp->u.number));
+		f->sp++;
+		break;
+
+	    case KF_GE_INT:
+		PUT_INT(&f->sp[1], (f->sp[1].u.number >= f->sp->u.number));
+		f->sp++;
+		break;
+
+	    case KF_GT_INT:
+		PUT_INT(&f->sp[1], (f->sp[1].u.number > f->sp->u.number));
+		f->sp++;
+		break;
+
+	    case KF_LE_INT:
+		PUT_INT(&f->sp[1], (f->sp[1].u.number <= f->sp->u.number));
+		f->sp++;
+		break;
+
+	    case KF_LSHIFT_INT:
+		if ((f->sp->u.number & ~31) != 0) {
+		    if (f->sp->u.number < 0) {
+			error("Negative left shift");
+		    }
+		    PUT_INT(&f->sp[1], 0);
+		} else {
+		    PUT_INT(&f->sp[1],
+			    (Uint) f->sp[1].u.number << f->sp->u.number);
+		}
+		f->sp++;
+		break;
+
+	    case KF_LT_INT:
+		PUT_INT(&f->sp[1], (f->sp[1].u.number < f->sp->u.number));
+		f->sp++;
+		break;
+
+	    case KF_MOD_INT:
+		if (f->sp->u.number == 0) {
+		    error("Modulus by zero");
+		}
+		PUT_INT(&f->sp[1],
+			INT_MOD(f->sp[1].u.number, f->sp->u.number));
+		f->sp++;
+		break;
+
+	    case KF_MULT_INT:
+		PUT_INT(&f->sp[1], f->sp[1].u.number * f->sp->u.number);
+		f->sp++;
+		break;
+
+	    case KF_NE_INT:
+		PUT_INT(&f->sp[1], (f->sp[1].u.number != f->sp->u.number));
+		f->sp++;
+		break;
+
+	    case KF_NEG_INT:
+		PUT_INT(f->sp, ~f->sp->u.number);
+		break;
+
+	    case KF_NOT_INT:
+		PUT_INT(f->sp, !f->sp->u.number);
+		break;
+
+	    case KF_OR_INT:
+		PUT_INT(&f->sp[1], f->sp[1].u.number | f->sp->u.number);
+		f->sp++;
+		break;
+
+	    case KF_RSHIFT_INT:
+		if ((f->sp->u.number & ~31) != 0) {
+		    if (f->sp->u.number < 0) {
+			error("Negative right shift");
+		    }
+		    PUT_INT(&f->sp[1], 0);
+		} else {
+		    PUT_INT(&f->sp[1],
+			    (Uint) f->sp[1].u.number >> f->sp->u.number);
+		}
+		f->sp++;
+		break;
+
+	    case KF_SUB_INT:
+		PUT_INT(&f->sp[1], f->sp[1].u.number - f->sp->u.number);
+		f->sp++;
+		break;
+
+	    case KF_SUB1_INT:
+		PUT_INT(f->sp, f->sp->u.number - 1);
+		break;
+
+	    case KF_TST_INT:
+		PUT_INT(f->sp, (f->sp->u.number != 0));
+		break;
+
+	    case KF_UMIN_INT:
+		PUT_INT(f->sp, -f->sp->u.number);
+		break;
+
+	    case KF_XOR_INT:
+		PUT_INT(&f->sp[1], f->sp[1].u.number ^ f->sp->u.number);
+		f->sp++;
+		break;
+	    }
+	    NEXT();
+
 	case I_CALL_EFUNC:
 	case I_CALL_EFUNC | I_POP_BIT:
+	LABEL(CALL_EFUNC)
+	    CHARGE_TICKS();
 	    kf = &KFUN(FETCH2U(pc, u));
 	    if (PROTO_VARGS(kf->proto) != 0) {
 		/* variable # of arguments */
@@ -1917,6 +2343,8 @@ static void i_interpret(Frame *f, char *pc)
 
 	case I_CALL_CKFUNC:
 	case I_CALL_CKFUNC | I_POP_BIT:
+	LABEL(CALL_CKFUNC)
+	    CHARGE_TICKS();
 	    kf = &KFUN(FETCH1U(pc));
 	    u = FETCH1U(pc) + size;
 	    size = 0;
@@ -1941,6 +2369,8 @@ static void i_interpret(Frame *f, char *pc)
 
 	case I_CALL_CEFUNC:
 	case I_CALL_CEFUNC | I_POP_BIT:
+	LABEL(CALL_CEFUNC)
+	    CHARGE_TICKS();
 	    kf = &KFUN(FETCH2U(pc, u));
 	    u = FETCH1U(pc) + size;
 	    size = 0;
@@ -1965,6 +2395,8 @@ static void i_interpret(Frame *f, char *pc)
 
 	case I_CALL_AFUNC:
 	case I_CALL_AFUNC | I_POP_BIT:
+	LABEL(CALL_AFUNC)
+	    CHARGE_TICKS();
 	    u = FETCH1U(pc);
 	    i_funcall(f, (Object *) NULL, (Array *) NULL, 0, u,
 		      FETCH1U(pc) + size);
@@ -1973,6 +2405,8 @@ static void i_interpret(Frame *f, char *pc)
 
 	case I_CALL_DFUNC:
 	case I_CALL_DFUNC | I_POP_BIT:
+	LABEL(CALL_DFUNC)
+	    CHARGE_TICKS();
 	    u = FETCH1U(pc);
 	    u2 = FETCH1U(pc);
 	    i_funcall(f, (Object *) NULL, (Array *) NULL,
@@ -1983,6 +2417,8 @@ static void i_interpret(Frame *f, char *pc)
 
 	case I_CALL_FUNC:
 	case I_CALL_FUNC | I_POP_BIT:
+	LABEL(CALL_FUNC)
+	    CHARGE_TICKS();
 	    p = &f->ctrl->funcalls[2L * (f->foffset + FETCH2U(pc, u))];
 	    i_funcall(f, (Object *) NULL, (Array *) NULL, UCHAR(p[0]),
 		      UCHAR(p[1]), FETCH1U(pc) + size);
@@ -1991,6 +2427,8 @@ static void i_interpret(Frame *f, char *pc)
 
 	case I_CATCH:
 	case I_CATCH | I_POP_BIT:
+	LABEL(CATCH)
+	    CHARGE_TICKS();
 	    atomic = f->atomic;
 	    p = f->prog + FETCH2U(pc, u);
 	    try {
@@ -2009,6 +2447,8 @@ static void i_interpret(Frame *f, char *pc)
 	    break;
 
 	case I_RLIMITS:
+	LABEL(RLIMITS)
+	    CHARGE_TICKS();
 	    if (f->sp[1].type != T_INT) {
 		error("Bad rlimits depth type");
 	    }
@@ -2028,15 +2468,19 @@ static void i_interpret(Frame *f, char *pc)
 	    i_interpret(f, pc);
 	    pc = f->pc;
 	    i_set_rlimits(f, f->rlim->next);
-	    continue;
+	    NEXT();
 
 	case I_RETURN:
+	LABEL(RETURN)
+	    CHARGE_TICKS();
 	    return;
 
-# ifdef DEBUG
 	default:
+	LABEL(ILLEGAL)
+# ifdef DEBUG
 	    fatal("illegal instruction");
 # endif
+	    break;
 	}
 
 	if (instr & I_POP_BIT) {
@@ -2046,6 +2490,9 @@ static void i_interpret(Frame *f, char *pc)
     }
 }
 
+extern void ext_compile (Control*);
+extern bool ext_execute (Frame*, int);
+
 /*
  * NAME:	interpret->funcall()
  * DESCRIPTION:	Call a function in an object. The arguments must be on the
@@ -2111,24 +2558,24 @@ void i_funcall(Frame *prev_f, Object *obj, Array *lwobj, int p_ctrli, int funci,
     }
 
     /* set the program control block */
-    obj = OBJR(f.ctrl->inherits[p_ctrli].oindex);
     f.foffset = f.ctrl->inherits[p_ctrli].funcoffset;
-    f.p_ctrl = o_control(obj);
+    f.p_ctrl = d_get_iprogs(f.ctrl)[p_ctrli];
     f.p_index = f.ctrl->inherits[p_ctrli].progoffset;
+    f.strtabs = d_get_strtabs(f.p_ctrl);
+    f.strings = f.strtabs[f.p_ctrl->ninherits - 1];
 
     /* get the function */
     f.func = &d_get_funcdefs(f.p_ctrl)[funci];
     if (f.func->sclass & C_UNDEFINED) {
 	error("Undefined function %s",
-	      d_get_strconst(f.p_ctrl, f.func->inherit, f.func->index)->text);
+	      f.strtabs[UCHAR(f.func->inherit)][f.func->index]->text);
     }
 
     pc = d_get_prog(f.p_ctrl) + f.func->offset;
     if (f.func->sclass & C_TYPECHECKED) {
 	/* typecheck arguments */
 	i_typecheck(prev_f, &f,
-		    d_get_strconst(f.p_ctrl, f.func->inherit,
-				   f.func->index)->text,
+		    f.strtabs[UCHAR(f.func->inherit)][f.func->index]->text,
 		    "function", pc, nargs, FALSE);
     }
 
@@ -2141,8 +2588,7 @@ void i_funcall(Frame *prev_f, Object *obj, Array *lwobj, int p_ctrli, int funci,
 	/* if fewer actual than formal parameters, check for varargs */
 	if (nargs < PROTO_NARGS(pc) && stricttc) {
 	    error("Insufficient arguments for function %s",
-		  d_get_strconst(f.p_ctrl, f.func->inherit,
-				 f.func->index)->text);
+		  f.strtabs[UCHAR(f.func->inherit)][f.func->index]->text);
 	}
 
 	/* add missing arguments */
@@ -2202,8 +2648,7 @@ void i_funcall(Frame *prev_f, Object *obj, Array *lwobj, int p_ctrli, int funci,
     } else if (nargs > n) {
 	if (stricttc) {
 	    error("Too many arguments for function %s",
-		  d_get_strconst(f.p_ctrl, f.func->inherit,
-				 f.func->index)->text);
+		  f.strtabs[UCHAR(f.func->inherit)][f.func->index]->text);
 	}
 
 	/* pop superfluous arguments */
@@ -2241,9 +2686,16 @@ void i_funcall(Frame *prev_f, Object *obj, Array *lwobj, int p_ctrli, int funci,
     /* create new local stack */
     f.argp = f.sp;
     FETCH2U(pc, n);
-    f.stack = ALLOCA(Value, n + MIN_STACK + EXTRA_STACK);
-    f.fp = f.sp = f.stack + n + MIN_STACK + EXTRA_STACK;
-    f.sos = TRUE;
+    if (VSTACK(f.sp) && f.sp - vstack >= n + MIN_STACK + EXTRA_STACK) {
+	/* continue on the value stack */
+	f.fp = f.sp;
+	f.stack = f.fp - (n + MIN_STACK + EXTRA_STACK);
+	f.sos = FALSE;
+    } else {
+	f.stack = ALLOCA(Value, n + MIN_STACK + EXTRA_STACK);
+	f.fp = f.sp = f.stack + n + MIN_STACK + EXTRA_STACK;
+	f.sos = TRUE;
+    }
 
     /* initialize local variables */
     n = FETCH1U(pc);
@@ -2259,7 +2711,16 @@ void i_funcall(Frame *prev_f, Object *obj, Array *lwobj, int p_ctrli, int funci,
     /* execute code */
     d_get_funcalls(f.ctrl);	/* make sure they are available */
     f.prog = pc += 2;
-    i_interpret(&f, pc);
+    f.prof = (pf_active) ? pf_enter(prev_f, &f, funci) : (pfnode *) NULL;
+    if (!f.p_ctrl->jit) {
+	ext_compile(f.p_ctrl);
+    }
+    if (f.p_ctrl->jitfuncs == (voidf **) NULL || !ext_execute(&f, funci)) {
+	i_interpret(&f, pc);
+    }
+    if (f.prof != (pfnode *) NULL) {
+	pf_leave(&f);
+    }
 
     /* clean up stack, move return value to outer stackframe */
     val = *f.sp++;
@@ -2272,7 +2733,7 @@ void i_funcall(Frame *prev_f, Object *obj, Array *lwobj, int p_ctrli, int funci,
     if (f.sos) {
 	    /* still alloca'd */
 	AFREE(f.stack);
-    } else {
+    } else if (!VSTACK(f.stack)) {
 	/* extended and malloced */
 	FREE(f.stack);
     }
@@ -2302,8 +2763,10 @@ bool i_call(Frame *f, Object *obj, Array *lwobj, const char *func,
 	    unsigned int len, int call_static, int nargs)
 {
     dsymbol *symb;
-    dfuncdef *fdef;
     Control *ctrl;
+    callcache *cc;
+    int inherit, index;
+    char sclass;
 
     if (lwobj != (Array *) NULL) {
 	uindex oindex;
@@ -2370,27 +2833,50 @@ bool i_call(Frame *f, Object *obj, Array *lwobj, const char *func,
 	len = clen;
     }
 
-    /* find the function in the symbol table */
+    /*
+     * find the function, first in the cache, then in the symbol table
+     */
     ctrl = o_control(obj);
-    symb = ctrl_symb(ctrl, func, len);
-    if (symb == (dsymbol *) NULL) {
-	/* function doesn't exist in symbol table */
-	i_pop(f, nargs);
-	return FALSE;
-    }
+    cc = &ccache[(((uintptr_t) ctrl >> 4) ^ ((uintptr_t) func >> 2) ^ len) %
+		 CALLCACHESZ];
+    if (cc->ctrl == ctrl && cc->serial == ctrl->serial && cc->len == len &&
+	memcmp(cc->func, func, len) == 0) {
+	inherit = UCHAR(cc->inherit);
+	index = UCHAR(cc->index);
+	sclass = cc->sclass;
+    } else {
+	symb = ctrl_symb(ctrl, func, len);
+	if (symb == (dsymbol *) NULL) {
+	    /* function doesn't exist in symbol table */
+	    i_pop(f, nargs);
+	    return FALSE;
+	}
+	inherit = UCHAR(symb->inherit);
+	index = UCHAR(symb->index);
+	sclass = d_get_funcdefs(OBJR(ctrl->inherits[inherit].oindex)->ctrl)
+								[index].sclass;
 
-    ctrl = OBJR(ctrl->inherits[UCHAR(symb->inherit)].oindex)->ctrl;
-    fdef = &d_get_funcdefs(ctrl)[UCHAR(symb->index)];
+	if (len <= CCNAMESZ) {
+	    /* the control block is never changed, only replaced */
+	    cc->ctrl = ctrl;
+	    cc->serial = ctrl->serial;
+	    cc->len = len;
+	    cc->inherit = inherit;
+	    cc->index = index;
+	    cc->sclass = sclass;
+	    memcpy(cc->func, func, len);
+	}
+    }
 
     /* check if the function can be called */
-    if (!call_static && (fdef->sclass & C_STATIC) &&
+    if (!call_static && (sclass & C_STATIC) &&
 	(f->oindex != obj->index || f->lwobj != lwobj)) {
 	i_pop(f, nargs);
 	return FALSE;
     }
 
     /* call the function */
-    i_funcall(f, obj, lwobj, UCHAR(symb->inherit), UCHAR(symb->index), nargs);
+    i_funcall(f, obj, lwobj, inherit, index, nargs);
 
     return TRUE;
 }
@@ -2405,7 +2891,7 @@ static unsigned short i_line(Frame *f)
     char *pc, *numbers;
     int instr;
     short offset;
-    unsigned short line, u, sz;
+    unsigned short line, u, u2, sz;
 
     line = 0;
     pc = f->p_ctrl->prog + f->func->offset;
@@ -2449,6 +2935,12 @@ static unsigned short i_line(Frame *f)
 	    }
 	    break;
 
+	case I_INT_KFUNC:
+	    if (FETCH1U(pc) & I_INT_JUMP) {
+		pc += 2;
+	    }
+	    break;
+
 	case I_PUSH_INT1:
 	case I_PUSH_STRING:
 	case I_PUSH_LOCAL:
@@ -2487,6 +2979,8 @@ static unsigned short i_line(Frame *f)
 
 	case I_PUSH_INT2:
 	case I_PUSH_NEAR_STRING:
+	case I_PUSH_LOCAL2:
+	case I_PUSH_LOCAL_INT1:
 	case I_PUSH_FAR_GLOBAL:
 	case I_STORE_FAR_GLOBAL:
 	case I_STORE_FAR_GLOBAL | I_POP_BIT:
@@ -2549,6 +3043,23 @@ static unsigned short i_line(Frame *f)
 		}
 		pc += (u - 1) * 5;
 		break;
+
+	    case 3:
+		FETCH2U(pc, u);
+		sz = FETCH1U(pc);
+		pc += 2 + sz + 2 * u;
+		break;
+
+	    case 4:
+		FETCH2U(pc, u);
+		pc += 2;
+		if (FETCH1U(pc) == 0) {
+		    pc += 2;
+		    --u;
+		}
+		FETCH2U(pc, u2);
+		pc += 2 * u2 + (u - 1) * 5;
+		break;
 	    }
 	    break;
 	}
@@ -2765,7 +3276,7 @@ Frame *i_restore(Frame *ftop, Int level)
     if (!f->rlim->noticks) {
 	f->rlim->ticks *= 2;
     }
-    i_set_sp(ftop, f->sp);
+    i_set_sp(ftop, f, f->sp);
     d_discard_plane(ftop->level);
     o_discard_plane();
 
@@ -2781,11 +3292,11 @@ void i_clear()
     Frame *f;
 
     f = cframe;
-    if (f->stack != stack) {
+    if (!VSTACK(f->stack)) {
 	FREE(f->stack);
-	f->fp = f->sp = stack + MIN_STACK;
-	f->stack = stack;
     }
+    f->fp = f->sp = vstack + VALUE_STACK;
+    f->stack = f->fp - MIN_STACK;
 
     f->rlim = &rlim;
 }
@@ -23,6 +23,8 @@
 # define I_PUSH_INT2		0x20	/* 2 signed */
 # define I_PUSH_INT4		0x01	/* 4 signed */
 # define I_PUSH_INT8		0x21	/* reserved */
+# define I_PUSH_LOCAL2		0x02	/* 1 signed, 1 signed */
+# define I_PUSH_LOCAL_INT1	0x22	/* 1 signed, 1 signed */
 # define I_PUSH_FLOAT6		0x03	/* 6 unsigned */
 # define I_PUSH_FLOAT12		0x23	/* reserved */
 # define I_PUSH_STRING		0x04	/* 1 unsigned */
@@ -38,6 +40,7 @@
 # define I_CAST			0x0a	/* 1+3 unsigned */
 # define I_INSTANCEOF		0x0b	/* 1 unsigned, 2 unsigned */
 # define I_STORES		0x0c	/* 1 unsigned */
+# define I_INT_KFUNC		0x2c	/* 1 unsigned (+ 2 unsigned) */
 # define I_STORE_GLOBAL_INDEX	0x0d	/* 1 unsigned */
 # define I_CALL_EFUNC		0x0e	/* 2 unsigned (+ 1 unsigned) */
 # define I_CALL_CEFUNC		0x0f	/* 2 unsigned, 1 unsigned */
@@ -65,8 +68,10 @@
 # define I_POP_BIT		0x20	/* pop 1 after instruction */
 # define I_LINE_SHIFT		6
 
+# define I_INT_JUMP		0x80	/* I_INT_KFUNC: jump if true */
+
 # define VERSION_VM_MAJOR	2
-# define VERSION_VM_MINOR	1
+# define VERSION_VM_MINOR	4
 
 
 # define FETCH1S(pc)	SCHAR(*(pc)++)
@@ -127,6 +132,10 @@
 				 (f)->sp->type = T_INT)
 # define PUT_INTVAL(v, i)	((v)->u.number = (i), (v)->type = T_INT)
 # define PUT_INT(v, i)		((v)->u.number = (i))
+
+/* integer / and %, where INT_MIN / -1 wraps to INT_MIN, and x % -1 is 0 */
+# define INT_DIV(i, d)		(((d) == -1) ? (Int) -(Uint) (i) : (i) / (d))
+# define INT_MOD(i, d)		(((d) == -1) ? 0 : (i) % (d))
 # define PUSH_FLTVAL(f, fl)	((--(f)->sp)->oindex = (fl).high,	\
 				 (f)->sp->u.objcnt = (fl).low,		\
 				 (f)->sp->type = T_FLOAT)
@@ -193,6 +202,8 @@
 # define SWITCH_INT	0
 # define SWITCH_RANGE	1
 # define SWITCH_STRING	2
+# define SWITCH_TABLE	3	/* int or range switch as a jump table */
+# define SWITCH_HASH	4	/* string switch with a hash table */
 
 
 struct rlinfo {
@@ -211,6 +222,8 @@ struct Frame {
     Dataspace *data;		/* dataspace of current object */
     Control *p_ctrl;		/* program control block */
     unsigned short p_index;	/* program index */
+    String ***strtabs;		/* inherited string tables */
+    String **strings;		/* program string table */
     unsigned short nargs;	/* # arguments */
     bool external;		/* TRUE if it's an external call */
     bool sos;			/* stack on stack */
@@ -226,6 +239,7 @@ struct Frame {
     rlinfo *rlim;		/* rlimits info */
     Int level;			/* plane level */
     bool atomic;		/* within uncaught atomic code */
+    struct pfnode *prof;	/* profiled call path */
 };
 
 extern void	i_init		(char*, bool);
@@ -254,7 +268,7 @@ extern Int	i_get_depth	(Frame*);
 extern Int	i_get_ticks	(Frame*);
 extern void	i_new_rlimits	(Frame*, Int, Int);
 extern void	i_set_rlimits	(Frame*, rlinfo*);
-extern Frame   *i_set_sp	(Frame*, Value*);
+extern Frame   *i_set_sp	(Frame*, Frame*, Value*);
 extern Frame   *i_prev_object	(Frame*, int);
 extern const char    *i_prev_program	(Frame*, int);
 extern void	i_typecheck	(Frame*, Frame*, const char*, const char*,
@@ -272,7 +286,8 @@ extern Frame   *i_restore	(Frame*, Int);
 extern void	i_clear		();
 
 extern Frame *cframe;
+extern Uuint tickcount;
 extern int nil_type;
 extern Value zero_int, zero_float, nil_value;
 
-# define i_add_ticks(f, t)	((f)->rlim->ticks -= (t))
+# define i_add_ticks(f, t)	(tickcount += (t), (f)->rlim->ticks -= (t))
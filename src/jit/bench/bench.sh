@@ -0,0 +1,64 @@
+#!/bin/sh
+#
+# Run the JIT benchmarks, first interpreted and then JIT compiled, and
+# print the best time in milliseconds for each.  Run from the src
+# directory after "make" and "make jit/jit.so":
+#
+#	jit/bench/bench.sh [driver]
+#
+DRIVER=`pwd`/${1:-a.out}
+JIT=`pwd`/jit/jit.so
+BENCH=`pwd`/jit/bench
+TMP=${TMPDIR:-/tmp}/dgdbench.$$
+
+trap 'rm -rf $TMP' 0 1 2 15
+mkdir -p $TMP/state
+cp -r $BENCH/lib $TMP/lib
+
+config() {
+    cat <<END
+telnet_port	= 16047;
+binary_port	= 16048;
+directory	= "$TMP/lib";
+users		= 1;
+editors		= 0;
+ed_tmpfile	= "$TMP/state/ed";
+swap_file	= "$TMP/state/swap";
+swap_size	= 1024;
+sector_size	= 512;
+swap_fragment	= 32;
+static_chunk	= 64512;
+dynamic_chunk	= 261120;
+dump_file	= "$TMP/state/snapshot";
+dump_interval	= 3600;
+typechecking	= 2;
+include_file	= "/include/std.h";
+include_dirs	= ({ "/include" });
+auto_object	= "/sys/auto";
+driver_object	= "/sys/driver";
+create		= "create";
+array_size	= 1000;
+objects		= 100;
+call_outs	= 10;
+END
+}
+
+config > $TMP/interp.dgd
+config > $TMP/jit.dgd
+echo "modules		= ([ \"$JIT\" : \"\" ]);" >> $TMP/jit.dgd
+
+# the driver object reports through send_message(), which goes to stderr
+(cd $TMP && $DRIVER $TMP/interp.dgd 2>&1) | sort > $TMP/interp.out
+(cd $TMP && $DRIVER $TMP/jit.dgd 2>&1) | sort > $TMP/jit.out
+
+echo "benchmark	interp	jit	speedup"
+join -t '	' $TMP/interp.out $TMP/jit.out |
+awk -F '	' '{
+    if (NF != 5) {
+	print;
+    } else if ($3 != $5) {
+	printf "%s\tresults differ: %s %s\n", $1, $3, $5;
+    } else {
+	printf "%s\t%d\t%d\t%.1fx\n", $1, $2, $4, $2 / ($4 ? $4 : 1);
+    }
+}'
@@ -0,0 +1,115 @@
+/*
+ * Integer benchmarks for the JIT compiler.  Each function is of type int,
+ * takes only int arguments and does nothing but integer arithmetic,
+ * comparisons and branches, so that all of them can be compiled.
+ */
+
+/*
+ * sum of 0 .. n - 1, modulo 2^32
+ */
+int loop(int n)
+{
+    int i, sum;
+
+    for (i = 0; i < n; i++) {
+	sum += i;
+    }
+    return sum;
+}
+
+/*
+ * compute fib(k) iteratively, n times over
+ */
+int fib(int n, int k)
+{
+    int i, j, a, b, c;
+
+    for (i = 0; i < n; i++) {
+	a = 0;
+	b = 1;
+	for (j = 0; j < k; j++) {
+	    c = a + b;
+	    a = b;
+	    b = c;
+	}
+    }
+    return a;
+}
+
+/*
+ * sum of gcd(i, n) for i in 1 .. n
+ */
+int gcd(int n)
+{
+    int i, a, b, t, sum;
+
+    for (i = 1; i <= n; i++) {
+	a = i;
+	b = n;
+	while (b != 0) {
+	    t = a % b;
+	    a = b;
+	    b = t;
+	}
+	sum += a;
+    }
+    return sum;
+}
+
+/*
+ * number of primes below n, by trial division
+ */
+int primes(int n)
+{
+    int i, d, count;
+
+    for (i = 2; i < n; i++) {
+	for (d = 2; d * d <= i; d++) {
+	    if (i % d == 0) {
+		break;
+	    }
+	}
+	if (d * d > i) {
+	    count++;
+	}
+    }
+    return count;
+}
+
+/*
+ * total number of Collatz steps for 1 .. n
+ */
+int collatz(int n)
+{
+    int i, x, steps;
+
+    for (i = 1; i <= n; i++) {
+	for (x = i; x != 1; steps++) {
+	    if (x & 1) {
+		x = 3 * x + 1;
+	    } else {
+		x /= 2;
+	    }
+	}
+    }
+    return steps;
+}
+
+/*
+ * total number of bits set in 0 .. n - 1, and an xorshift checksum
+ */
+int bits(int n)
+{
+    int i, x, count, seed;
+
+    seed = 0x2545f491;
+    for (i = 0; i < n; i++) {
+	for (x = i; x != 0; x >>= 1) {
+	    count += x & 1;
+	}
+	seed ^= seed << 13;
+	seed ^= (seed >> 17) & 0x7fff;
+	seed ^= seed << 5;
+    }
+    return count ^ seed;
+}
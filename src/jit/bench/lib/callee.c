@@ -0,0 +1,12 @@
+/*
+ * Called by the call overhead benchmarks in /calls.c, both as a persistent
+ * object and as a light-weight object.
+ */
+
+/*
+ * add two numbers
+ */
+int add(int a, int b)
+{
+    return a + b;
+}
@@ -0,0 +1,58 @@
+/*
+ * Function call benchmarks.  Calls are not compiled by the JIT compiler,
+ * so these measure the call overhead of the interpreter: a local function
+ * call, call_other() on a persistent object, and a call to a light-weight
+ * object.  Each benchmark makes n calls of a function that adds two
+ * numbers, and returns the sum.
+ */
+
+/*
+ * add two numbers
+ */
+static int add(int a, int b)
+{
+    return a + b;
+}
+
+/*
+ * local function calls
+ */
+int local(int n)
+{
+    int i, sum;
+
+    for (i = 0; i < n; i++) {
+	sum = add(sum, i);
+    }
+    return sum;
+}
+
+/*
+ * call_other() on a persistent object
+ */
+int other(int n)
+{
+    object callee;
+    int i, sum;
+
+    callee = find_object("/callee");
+    for (i = 0; i < n; i++) {
+	sum = callee->add(sum, i);
+    }
+    return sum;
+}
+
+/*
+ * calls to a light-weight object
+ */
+int lwobject(int n)
+{
+    object callee;
+    int i, sum;
+
+    callee = new_object(find_object("/callee"));
+    for (i = 0; i < n; i++) {
+	sum = callee->add(sum, i);
+    }
+    return sum;
+}
@@ -0,0 +1,84 @@
+/*
+ * Driver object for the JIT benchmarks.  It runs every benchmark in
+ * /bench.c and /calls.c a few times, reports the best time in milliseconds
+ * for each, and shuts down.
+ */
+
+# define RUNS	3
+
+static int now()
+{
+    mixed *t;
+
+    t = millitime();
+    return t[0] * 1000 + (int) (t[1] * 1000.0);
+}
+
+/*
+ * run one benchmark and report the result and the best time
+ */
+private void run(object bench, string name, int args...)
+{
+    int i, t, best, result;
+
+    best = -1;
+    for (i = 0; i < RUNS; i++) {
+	t = now();
+	result = call_other(bench, name, args...);
+	t = now() - t;
+	if (best < 0 || t < best) {
+	    best = t;
+	}
+    }
+    send_message(name + "\t" + best + "\t" + result + "\n");
+}
+
+/*
+ * run the benchmarks from a callout, since JIT compilation only starts
+ * once the driver has been initialized
+ */
+static void initialize()
+{
+    compile_object("/bench");
+    compile_object("/calls");
+    compile_object("/callee");
+    call_out("benchmarks", 0);
+}
+
+static void benchmarks()
+{
+    object bench, calls;
+
+    bench = find_object("/bench");
+    calls = find_object("/calls");
+    run(bench, "loop", 20000000);
+    run(bench, "fib", 200000, 40);
+    run(bench, "gcd", 2000000);
+    run(bench, "primes", 1000000);
+    run(bench, "collatz", 100000);
+    run(bench, "bits", 2000000);
+    run(calls, "local", 5000000);
+    run(calls, "other", 2000000);
+    run(calls, "lwobject", 2000000);
+    shutdown();
+}
+
+string path_read(string path) { return path; }
+string path_write(string path) { return path; }
+object call_object(string path) { return find_object(path); }
+string path_object(string path) { return path; }
+string path_include(string file, string path)
+{
+    return (path[0] == '/') ? path : file + "/../" + path;
+}
+void runtime_error(string error, int caught, int ticks)
+{
+    if (!caught) {
+	send_message("error: " + error + "\n");
+    }
+}
+void compile_error(string file, int line, string err)
+{
+    send_message(file + ", " + line + ": " + err + "\n");
+}
+void interrupt() { shutdown(); }
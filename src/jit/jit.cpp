@@ -0,0 +1,202 @@
+/*
+ * This file is part of DGD, https://github.com/dworkin/dgd
+ * Copyright (C) 1993-2010 Dworkin B.V.
+ * Copyright (C) 2010-2017 DGD Authors (see the commit log for details)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+# include <sys/mman.h>
+# include "dgd.h"
+# include "interpret.h"
+# include "jit.h"
+
+/*
+ * A JIT compiler for DGD, loaded as a runtime extension:
+ *
+ *	modules = ([ "jit/jit.so" : "" ]);
+ *
+ * Functions are translated when an object's program is first executed;
+ * see x64.cpp for which functions qualify.
+ */
+
+# define CODE_CHUNK	65536		/* size of machine code chunk */
+# define PROG_TABSZ	1024		/* size of program hash table */
+
+struct Program {
+    Program *next;		/* next in hash chain */
+    uint64_t oindex;		/* program object */
+    uint64_t ocount;		/* program object count */
+    jitfunc *funcs;		/* compiled functions, or NULL */
+};
+
+static void (*ext_compiled) (uint64_t, uint64_t, char*);
+static uint16_t *kfmap;		/* kfun index map */
+static int nkfmap;		/* size of kfun index map */
+static Program *progs[PROG_TABSZ]; /* compiled programs */
+static uint8_t *chunk;		/* current machine code chunk */
+static size_t chunkfree;	/* free space in current chunk */
+
+/*
+ * NAME:	jit->code()
+ * DESCRIPTION:	make generated code executable
+ */
+void *jit_code(uint8_t *code, size_t len)
+{
+    uint8_t *c;
+
+    if (len > CODE_CHUNK) {
+	return NULL;
+    }
+    if (len > chunkfree) {
+	c = (uint8_t *) mmap(NULL, CODE_CHUNK, PROT_READ | PROT_WRITE,
+			     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (c == (uint8_t *) MAP_FAILED) {
+	    return NULL;
+	}
+	chunk = c;
+	chunkfree = CODE_CHUNK;
+    } else if (mprotect(chunk, CODE_CHUNK, PROT_READ | PROT_WRITE) != 0) {
+	return NULL;
+    }
+
+    c = chunk + CODE_CHUNK - chunkfree;
+    memcpy(c, code, len);
+    chunkfree -= (len + 15) & ~15;
+    if (chunkfree > CODE_CHUNK) {
+	chunkfree = 0;
+    }
+    mprotect(chunk, CODE_CHUNK, PROT_READ | PROT_EXEC);
+    return c;
+}
+
+/*
+ * NAME:	jit->init()
+ * DESCRIPTION:	initialize the JIT compiler
+ */
+static int jit_init(int major, int minor, size_t intsize, size_t mapsize,
+		    uint16_t *map, int nmap, uint8_t *protos, int nprotos)
+{
+    int i;
+
+    (void) protos;
+    (void) nprotos;
+    if (major != VERSION_VM_MAJOR || minor != VERSION_VM_MINOR || intsize != sizeof(int32_t))
+    {
+	return 0;
+    }
+
+    kfmap = (uint16_t *) malloc(nmap * sizeof(uint16_t));
+    if (kfmap == NULL) {
+	return 0;
+    }
+    for (i = 0; i < nmap; i++) {
+	switch (mapsize) {
+	case sizeof(uint8_t):
+	    kfmap[i] = ((uint8_t *) map)[i];
+	    break;
+
+	case sizeof(uint16_t):
+	    kfmap[i] = map[i];
+	    break;
+
+	default:
+	    free(kfmap);
+	    return 0;
+	}
+    }
+    nkfmap = nmap;
+    return 1;
+}
+
+/*
+ * NAME:	jit->compile()
+ * DESCRIPTION:	compile the functions of a program
+ */
+static void jit_compile(uint64_t oindex, uint64_t ocount, int ninherits,
+			uint8_t *prog, int nfuncdefs, uint8_t *ftypes,
+			uint8_t *vtypes)
+{
+    Program **h, *p;
+    jitfunc *funcs;
+    uint32_t offset;
+    int i;
+    bool compiled;
+
+    (void) ninherits;
+    (void) vtypes;
+    for (h = &progs[oindex % PROG_TABSZ]; (p=*h) != NULL; h = &p->next) {
+	if (p->oindex == oindex && p->ocount == ocount) {
+	    (*ext_compiled)(oindex, ocount, (char *) p->funcs);
+	    return;
+	}
+    }
+
+    funcs = NULL;
+    if (nfuncdefs != 0) {
+	funcs = (jitfunc *) malloc(nfuncdefs * sizeof(jitfunc));
+	if (funcs == NULL) {
+	    return;
+	}
+	compiled = false;
+	for (i = 0; i < nfuncdefs; i++, ftypes += 5) {
+	    funcs[i] = NULL;
+	    if (!(ftypes[0] & C_UNDEFINED)) {
+		offset = ((uint32_t) ftypes[1] << 24) | (ftypes[2] << 16) |
+			 (ftypes[3] << 8) | ftypes[4];
+		funcs[i] = x64_compile(prog + offset, kfmap, nkfmap);
+		compiled |= (funcs[i] != NULL);
+	    }
+	}
+	if (!compiled) {
+	    free(funcs);
+	    funcs = NULL;
+	}
+    }
+
+    p = (Program *) malloc(sizeof(Program));
+    if (p != NULL) {
+	p->next = *h;
+	p->oindex = oindex;
+	p->ocount = ocount;
+	p->funcs = funcs;
+	*h = p;
+    }
+    (*ext_compiled)(oindex, ocount, (char *) funcs);
+}
+
+/*
+ * NAME:	ext_init()
+ * DESCRIPTION:	initialize the extension
+ */
+extern "C" int ext_init(int major, int minor, voidf **ftabs[], int sizes[],
+			const char *config)
+{
+    void (*ext_jit) (int (*) (int, int, size_t, size_t, uint16_t*, int,
+			      uint8_t*, int),
+		     void (*) (uint64_t, uint64_t, int, uint8_t*, int,
+			       uint8_t*, uint8_t*));
+
+    (void) config;
+    if (major != 0 || minor < 10 || sizes[0] < 4) {
+	return 0;
+    }
+    ext_jit = (void (*) (int (*) (int, int, size_t, size_t, uint16_t*, int,
+				  uint8_t*, int),
+			 void (*) (uint64_t, uint64_t, int, uint8_t*, int,
+				   uint8_t*, uint8_t*))) ftabs[0][2];
+    ext_compiled = (void (*) (uint64_t, uint64_t, char*)) ftabs[0][3];
+    (*ext_jit)(&jit_init, &jit_compile);
+    return 1;
+}
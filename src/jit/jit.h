@@ -0,0 +1,41 @@
+/*
+ * This file is part of DGD, https://github.com/dworkin/dgd
+ * Copyright (C) 1993-2010 Dworkin B.V.
+ * Copyright (C) 2010-2017 DGD Authors (see the commit log for details)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+# include <stdint.h>
+# include <stddef.h>
+
+/*
+ * A compiled function is called with a pointer to argument 0, so that
+ * variables are addressed as in the bytecode: arguments at vars[0] and up,
+ * local variables at vars[-1] and down.  It returns 0 with the result of
+ * the function stored in *retval, or an error code combined with the
+ * program counter at which the error occurred (see ext_execute()).
+ */
+typedef int (*jitfunc) (int32_t *vars, int32_t *ticks, int noticks,
+			int32_t *retval);
+
+# define JIT_TICKS	1	/* out of ticks */
+# define JIT_DIV	2	/* division by zero */
+# define JIT_MOD	3	/* modulus by zero */
+# define JIT_LSHIFT	4	/* negative left shift */
+# define JIT_RSHIFT	5	/* negative right shift */
+# define JIT_PC(pc)	((pc) << 8)
+
+extern void    *jit_code	(uint8_t*, size_t);
+extern jitfunc	x64_compile	(uint8_t*, uint16_t*, int);
@@ -0,0 +1,906 @@
+/*
+ * This file is part of DGD, https://github.com/dworkin/dgd
+ * Copyright (C) 1993-2010 Dworkin B.V.
+ * Copyright (C) 2010-2017 DGD Authors (see the commit log for details)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+# include <stdarg.h>
+# include "dgd.h"
+# include "str.h"
+# include "array.h"
+# include "object.h"
+# include "xfloat.h"
+# include "interpret.h"
+# include "data.h"
+# include "control.h"
+# include "table.h"
+# include "jit.h"
+
+/*
+ * Translate the bytecode of a function to x86-64 machine code.  Only
+ * functions that do nothing but integer arithmetic on their arguments and
+ * local variables are translated; everything else is left to the
+ * interpreter.
+ *
+ * The value on top of the evaluation stack is kept in eax, the rest of
+ * the evaluation stack lives on the machine stack.  Registers used:
+ *
+ *	rbx	pointer to argument 0
+ *	r12	pointer to the rlimits ticks
+ *	r13d	noticks flag
+ *	r14	pointer to the return value
+ *	rbp	machine stack pointer at function entry
+ *
+ * Ticks are charged at the same instructions, and in the same amounts,
+ * as in the interpreter.
+ */
+
+# define EXIT		-1		/* jump to the function exit */
+
+struct Insn {
+    int instr;			/* instruction without line bits */
+    int len;			/* instruction length */
+    int32_t a, b;		/* operands */
+    int kf;			/* kfun */
+    int ticks;			/* ticks for the instruction */
+    bool jump;			/* jumps to a */
+};
+
+struct Fixup {
+    size_t pos;			/* position of 32 bit displacement */
+    int target;			/* bytecode target, or EXIT */
+};
+
+class X64Code {
+public:
+    X64Code() {
+	code = (uint8_t *) NULL;
+	fixups = (Fixup *) NULL;
+	len = size = 0;
+	nfixups = fsize = 0;
+	error = false;
+    }
+
+    ~X64Code() {
+	free(code);
+	free(fixups);
+    }
+
+    /*
+     * NAME:		X64Code->emit()
+     * DESCRIPTION:	emit a number of code bytes
+     */
+    void emit(int n, ...) {
+	va_list args;
+
+	if (len + n > size && !grow(n)) {
+	    return;
+	}
+	va_start(args, n);
+	while (--n >= 0) {
+	    code[len++] = (uint8_t) va_arg(args, int);
+	}
+	va_end(args);
+    }
+
+    /*
+     * NAME:		X64Code->emit4()
+     * DESCRIPTION:	emit a 32 bit little-endian value
+     */
+    void emit4(int32_t v) {
+	emit(4, v & 0xff, (v >> 8) & 0xff, (v >> 16) & 0xff, (v >> 24) & 0xff);
+    }
+
+    /*
+     * NAME:		X64Code->jump()
+     * DESCRIPTION:	emit a jump instruction with a 32 bit displacement to
+     *			be resolved later
+     */
+    void jump(int target) {
+	if (nfixups == fsize) {
+	    Fixup *f;
+
+	    f = (Fixup *) realloc(fixups, (fsize + 64) * sizeof(Fixup));
+	    if (f == (Fixup *) NULL) {
+		error = true;
+		return;
+	    }
+	    fixups = f;
+	    fsize += 64;
+	}
+	fixups[nfixups].pos = len;
+	fixups[nfixups++].target = target;
+	emit4(0);
+    }
+
+    /*
+     * NAME:		X64Code->resolve()
+     * DESCRIPTION:	resolve jumps, given the code offsets of the bytecode
+     *			instructions and of the function exit
+     */
+    void resolve(size_t *labels, size_t exit) {
+	int i;
+	size_t to;
+	int32_t disp;
+
+	for (i = 0; i < nfixups; i++) {
+	    to = (fixups[i].target == EXIT) ? exit : labels[fixups[i].target];
+	    disp = (int32_t) (to - (fixups[i].pos + 4));
+	    code[fixups[i].pos] = disp & 0xff;
+	    code[fixups[i].pos + 1] = (disp >> 8) & 0xff;
+	    code[fixups[i].pos + 2] = (disp >> 16) & 0xff;
+	    code[fixups[i].pos + 3] = (disp >> 24) & 0xff;
+	}
+    }
+
+    uint8_t *code;		/* generated code */
+    size_t len;			/* length of generated code */
+    bool error;			/* out of memory */
+
+private:
+    /*
+     * NAME:		X64Code->grow()
+     * DESCRIPTION:	make room for more code
+     */
+    bool grow(int n) {
+	uint8_t *c;
+
+	c = (uint8_t *) realloc(code, size + n + 1024);
+	if (c == (uint8_t *) NULL) {
+	    error = true;
+	    return false;
+	}
+	code = c;
+	size += n + 1024;
+	return true;
+    }
+
+    size_t size;		/* size of code buffer */
+    Fixup *fixups;		/* unresolved jumps */
+    int nfixups;		/* # unresolved jumps */
+    int fsize;			/* size of fixup table */
+};
+
+/*
+ * NAME:	intkfun()
+ * DESCRIPTION:	return true if a kfun is an integer operation that can be
+ *		translated
+ */
+static bool intkfun(int kf)
+{
+    switch (kf) {
+    case KF_ADD_INT:
+    case KF_ADD1_INT:
+    case KF_AND_INT:
+    case KF_DIV_INT:
+    case KF_EQ_INT:
+    case KF_GE_INT:
+    case KF_GT_INT:
+    case KF_LE_INT:
+    case KF_LSHIFT_INT:
+    case KF_LT_INT:
+    case KF_MOD_INT:
+    case KF_MULT_INT:
+    case KF_NE_INT:
+    case KF_NEG_INT:
+    case KF_NOT_INT:
+    case KF_OR_INT:
+    case KF_RSHIFT_INT:
+    case KF_SUB_INT:
+    case KF_SUB1_INT:
+    case KF_TST_INT:
+    case KF_UMIN_INT:
+    case KF_XOR_INT:
+	return true;
+
+    default:
+	return false;
+    }
+}
+
+/*
+ * NAME:	decode()
+ * DESCRIPTION:	decode an instruction, return false if it cannot be
+ *		translated
+ */
+static bool decode(uint8_t *pc, Insn *insn, uint16_t *kfmap, int nkfmap)
+{
+    insn->instr = pc[0] & I_INSTR_MASK;
+    insn->ticks = 1;
+    insn->jump = false;
+    switch (insn->instr) {
+    case I_STORE_LOCAL:
+    case I_STORE_LOCAL | I_POP_BIT:
+	insn->ticks = 2;	/* including the assignment */
+	/* fall through */
+    case I_PUSH_INT1:
+    case I_PUSH_LOCAL:
+	insn->a = (int8_t) pc[1];
+	insn->len = 2;
+	return true;
+
+    case I_PUSH_INT2:
+	insn->a = (int16_t) ((pc[1] << 8) | pc[2]);
+	insn->len = 3;
+	return true;
+
+    case I_PUSH_INT4:
+	insn->a = (int32_t) (((uint32_t) pc[1] << 24) | (pc[2] << 16) |
+			     (pc[3] << 8) | pc[4]);
+	insn->len = 5;
+	return true;
+
+    case I_PUSH_LOCAL2:
+    case I_PUSH_LOCAL_INT1:
+	insn->a = (int8_t) pc[1];
+	insn->b = (int8_t) pc[2];
+	insn->len = 3;
+	insn->ticks = 2;
+	return true;
+
+    case I_JUMP:
+    case I_JUMP_ZERO:
+    case I_JUMP_NONZERO:
+	insn->a = (pc[1] << 8) | pc[2];
+	insn->len = 3;
+	insn->jump = true;
+	return true;
+
+    case I_INT_KFUNC:
+	insn->kf = pc[1] & ~I_INT_JUMP;
+	if (pc[1] & I_INT_JUMP) {
+	    /* comparison and conditional jump */
+	    insn->a = (pc[2] << 8) | pc[3];
+	    insn->len = 4;
+	    insn->ticks = 2;
+	    insn->jump = true;
+	    switch (insn->kf) {
+	    case KF_EQ_INT:
+	    case KF_GE_INT:
+	    case KF_GT_INT:
+	    case KF_LE_INT:
+	    case KF_LT_INT:
+	    case KF_NE_INT:
+		return true;
+	    }
+	    return false;
+	}
+	insn->len = 2;
+	return intkfun(insn->kf);
+
+    case I_CALL_KFUNC:
+    case I_CALL_KFUNC | I_POP_BIT:
+	if (pc[1] >= nkfmap) {
+	    return false;
+	}
+	insn->kf = kfmap[pc[1]];
+	insn->len = 2;
+	return intkfun(insn->kf);
+
+    case I_RETURN:
+	insn->len = 1;
+	return true;
+
+    default:
+	return false;
+    }
+}
+
+/*
+ * NAME:	unary()
+ * DESCRIPTION:	return true if a kfun has a single argument
+ */
+static bool unary(int kf)
+{
+    switch (kf) {
+    case KF_ADD1_INT:
+    case KF_NEG_INT:
+    case KF_NOT_INT:
+    case KF_SUB1_INT:
+    case KF_TST_INT:
+    case KF_UMIN_INT:
+	return true;
+
+    default:
+	return false;
+    }
+}
+
+/*
+ * NAME:	analyze()
+ * DESCRIPTION:	find the instructions and the stack depth at each, return
+ *		false if the function cannot be translated
+ */
+static bool analyze(uint8_t *code, unsigned short size, short *depth,
+		    bool *label, uint16_t *kfmap, int nkfmap)
+{
+    unsigned short *todo, pc;
+    int ntodo, d, i;
+    Insn insn;
+    bool ok;
+
+    todo = (unsigned short *) malloc(size * sizeof(unsigned short));
+    if (todo == (unsigned short *) NULL) {
+	return false;
+    }
+    for (i = 0; i < size; i++) {
+	depth[i] = -1;
+	label[i] = false;
+    }
+    depth[0] = 0;
+    todo[0] = 0;
+    ntodo = 1;
+    ok = true;
+
+    while (ok && ntodo != 0) {
+	pc = todo[--ntodo];
+	d = depth[pc];
+	if (!decode(code + pc, &insn, kfmap, nkfmap) || pc + insn.len > size) {
+	    ok = false;
+	    break;
+	}
+
+	/* compute the stack depth after the instruction */
+	switch (insn.instr) {
+	case I_PUSH_INT1:
+	case I_PUSH_INT2:
+	case I_PUSH_INT4:
+	case I_PUSH_LOCAL:
+	    d++;
+	    break;
+
+	case I_PUSH_LOCAL2:
+	case I_PUSH_LOCAL_INT1:
+	    d += 2;
+	    break;
+
+	case I_STORE_LOCAL:
+	    ok = (d >= 1);
+	    break;
+
+	case I_STORE_LOCAL | I_POP_BIT:
+	    ok = (d >= 1);
+	    --d;
+	    break;
+
+	case I_CALL_KFUNC:
+	case I_CALL_KFUNC | I_POP_BIT:
+	    if (unary(insn.kf)) {
+		ok = (d >= 1);
+	    } else {
+		ok = (d >= 2);
+		--d;
+	    }
+	    if (insn.instr & I_POP_BIT) {
+		--d;
+	    }
+	    break;
+
+	case I_INT_KFUNC:
+	    if (insn.jump) {
+		ok = (d >= 2);
+		d -= 2;
+	    } else if (unary(insn.kf)) {
+		ok = (d >= 1);
+	    } else {
+		ok = (d >= 2);
+		--d;
+	    }
+	    break;
+
+	case I_JUMP_ZERO:
+	case I_JUMP_NONZERO:
+	    ok = (d >= 1);
+	    --d;
+	    break;
+
+	case I_RETURN:
+	    ok = (d >= 1);
+	    continue;
+	}
+	if (d > 255) {
+	    ok = false;
+	}
+
+	/* visit the successors */
+	for (i = 0; ok && i < 2; i++) {
+	    if (i == 0) {
+		if (insn.instr == I_JUMP) {
+		    continue;
+		}
+		pc += insn.len;
+	    } else if (insn.jump) {
+		pc = insn.a;
+	    } else {
+		break;
+	    }
+	    if (pc >= size) {
+		ok = false;
+	    } else if (depth[pc] < 0) {
+		depth[pc] = d;
+		todo[ntodo++] = pc;
+	    } else if (depth[pc] != d) {
+		ok = false;		/* inconsistent stack */
+	    }
+	    if (i != 0) {
+		label[pc] = true;
+	    }
+	}
+    }
+
+    free(todo);
+    return ok;
+}
+
+/*
+ * NAME:	assigned()
+ * DESCRIPTION:	check that no local variable can be read before it has been
+ *		assigned a value, in which case it would still be nil
+ */
+static bool assigned(uint8_t *code, unsigned short size, short *depth,
+		     uint16_t *kfmap, int nkfmap)
+{
+    uint64_t (*set)[2], in[2];
+    unsigned short pc, to;
+    int i, n;
+    Insn insn;
+    bool changed;
+
+    set = (uint64_t (*)[2]) malloc(size * sizeof(uint64_t[2]));
+    if (set == NULL) {
+	return false;
+    }
+    for (pc = 0; pc < size; pc++) {
+	set[pc][0] = set[pc][1] = ~(uint64_t) 0;
+    }
+    set[0][0] = set[0][1] = 0;
+
+    do {
+	changed = false;
+	for (pc = 0; pc < size; pc += insn.len) {
+	    if (depth[pc] < 0) {
+		insn.len = 1;
+		continue;
+	    }
+	    decode(code + pc, &insn, kfmap, nkfmap);
+	    in[0] = set[pc][0];
+	    in[1] = set[pc][1];
+	    switch (insn.instr) {
+	    case I_PUSH_LOCAL:
+	    case I_PUSH_LOCAL2:
+	    case I_PUSH_LOCAL_INT1:
+		for (i = 0; i < 2; i++) {
+		    n = (i == 0) ? insn.a : insn.b;
+		    if (n < 0 && !(in[(-n - 1) >> 6] & (1ULL << ((-n - 1) & 63)))) {
+			free(set);
+			return false;
+		    }
+		    if (insn.instr != I_PUSH_LOCAL2) {
+			break;
+		    }
+		}
+		break;
+
+	    case I_STORE_LOCAL:
+	    case I_STORE_LOCAL | I_POP_BIT:
+		if (insn.a < 0) {
+		    n = -insn.a - 1;
+		    in[n >> 6] |= 1ULL << (n & 63);
+		}
+		break;
+
+	    case I_RETURN:
+		continue;
+	    }
+
+	    /* merge with the successors */
+	    for (i = 0; i < 2; i++) {
+		if (i == 0) {
+		    if (insn.instr == I_JUMP) {
+			continue;
+		    }
+		    to = pc + insn.len;
+		} else if (insn.jump) {
+		    to = insn.a;
+		} else {
+		    break;
+		}
+		if ((set[to][0] & in[0]) != set[to][0] ||
+		    (set[to][1] & in[1]) != set[to][1]) {
+		    set[to][0] &= in[0];
+		    set[to][1] &= in[1];
+		    changed = true;
+		}
+	    }
+	}
+    } while (changed);
+
+    free(set);
+    return true;
+}
+
+/*
+ * NAME:	local()
+ * DESCRIPTION:	emit a load from or a store to a variable
+ */
+static void local(X64Code *x, int op, int32_t var)
+{
+    var *= 4;
+    if (var >= -128 && var <= 127) {
+	x->emit(3, op, 0x43, var & 0xff);		/* op eax, [rbx+d8] */
+    } else {
+	x->emit(2, op, 0x83);				/* op eax, [rbx+d32] */
+	x->emit4(var);
+    }
+}
+
+/*
+ * NAME:	status()
+ * DESCRIPTION:	emit an exit from the function with an error status
+ */
+static void status(X64Code *x, int code)
+{
+    x->emit(1, 0xb8);					/* mov eax, code */
+    x->emit4(code);
+    x->emit(1, 0xe9);					/* jmp exit */
+    x->jump(EXIT);
+}
+
+/*
+ * NAME:	subticks()
+ * DESCRIPTION:	emit code to subtract ticks
+ */
+static void subticks(X64Code *x, int ticks)
+{
+    if (ticks <= 127) {
+	x->emit(4, 0x41, 0x83, 0x2c, 0x24);		/* sub [r12], imm8 */
+	x->emit(1, ticks);
+    } else {
+	x->emit(4, 0x41, 0x81, 0x2c, 0x24);		/* sub [r12], imm32 */
+	x->emit4(ticks);
+    }
+}
+
+/*
+ * NAME:	charge()
+ * DESCRIPTION:	emit code to charge ticks
+ */
+static void charge(X64Code *x, int ticks, int pc)
+{
+    subticks(x, ticks);
+    x->emit(2, 0x7f, 23);				/* jg ok */
+    x->emit(3, 0x45, 0x85, 0xed);			/* test r13d, r13d */
+    x->emit(2, 0x75, 10);				/* jnz noticks */
+    status(x, JIT_PC(pc + 1) | JIT_TICKS);
+    x->emit(4, 0x41, 0xc7, 0x04, 0x24);		/* noticks: */
+    x->emit4(0x7fffffff);				/* mov [r12], max */
+							/* ok: */
+}
+
+/*
+ * NAME:	kfun()
+ * DESCRIPTION:	emit code for an integer kfun
+ */
+static void kfun(X64Code *x, int kf, int pc)
+{
+    if (!unary(kf)) {
+	x->emit(1, 0x59);				/* pop rcx */
+    }
+
+    switch (kf) {
+    case KF_ADD_INT:
+	x->emit(2, 0x01, 0xc8);				/* add eax, ecx */
+	break;
+
+    case KF_ADD1_INT:
+	x->emit(3, 0x83, 0xc0, 0x01);			/* add eax, 1 */
+	break;
+
+    case KF_AND_INT:
+	x->emit(2, 0x21, 0xc8);				/* and eax, ecx */
+	break;
+
+    case KF_DIV_INT:
+    case KF_MOD_INT:
+	x->emit(4, 0x85, 0xc0, 0x75, 10);		/* test eax, eax; jnz */
+	status(x, JIT_PC(pc + 1) | ((kf == KF_DIV_INT) ? JIT_DIV : JIT_MOD));
+	x->emit(5, 0x83, 0xf8, 0xff, 0x75, 6);		/* cmp eax, -1; jne */
+	if (kf == KF_DIV_INT) {
+	    x->emit(2, 0xf7, 0xd9);			/* neg ecx */
+	} else {
+	    x->emit(2, 0x31, 0xc9);			/* xor ecx, ecx */
+	}
+	x->emit(4, 0x89, 0xc8, 0xeb,			/* mov eax, ecx; jmp */
+		(kf == KF_DIV_INT) ? 9 : 11);
+	x->emit(3, 0x41, 0x89, 0xc0);			/* mov r8d, eax */
+	x->emit(3, 0x89, 0xc8, 0x99);			/* mov eax, ecx; cdq */
+	x->emit(3, 0x41, 0xf7, 0xf8);			/* idiv r8d */
+	if (kf == KF_MOD_INT) {
+	    x->emit(2, 0x89, 0xd0);			/* mov eax, edx */
+	}
+	break;
+
+    case KF_EQ_INT:
+    case KF_GE_INT:
+    case KF_GT_INT:
+    case KF_LE_INT:
+    case KF_LT_INT:
+    case KF_NE_INT:
+	x->emit(2, 0x39, 0xc1);				/* cmp ecx, eax */
+	switch (kf) {
+	case KF_EQ_INT:	x->emit(3, 0x0f, 0x94, 0xc0); break;	/* sete */
+	case KF_GE_INT:	x->emit(3, 0x0f, 0x9d, 0xc0); break;	/* setge */
+	case KF_GT_INT:	x->emit(3, 0x0f, 0x9f, 0xc0); break;	/* setg */
+	case KF_LE_INT:	x->emit(3, 0x0f, 0x9e, 0xc0); break;	/* setle */
+	case KF_LT_INT:	x->emit(3, 0x0f, 0x9c, 0xc0); break;	/* setl */
+	case KF_NE_INT:	x->emit(3, 0x0f, 0x95, 0xc0); break;	/* setne */
+	}
+	x->emit(3, 0x0f, 0xb6, 0xc0);			/* movzx eax, al */
+	break;
+
+    case KF_LSHIFT_INT:
+    case KF_RSHIFT_INT:
+	x->emit(5, 0xa9, 0xe0, 0xff, 0xff, 0xff);	/* test eax, ~31 */
+	x->emit(2, 0x74, 18);				/* jz shift */
+	x->emit(4, 0x85, 0xc0, 0x79, 10);		/* test eax, eax; jns */
+	status(x, JIT_PC(pc + 1) |
+		  ((kf == KF_LSHIFT_INT) ? JIT_LSHIFT : JIT_RSHIFT));
+	x->emit(4, 0x31, 0xc0, 0xeb, 3);		/* xor eax, eax; jmp */
+	x->emit(1, 0x91);				/* shift: xchg eax, ecx */
+	if (kf == KF_LSHIFT_INT) {
+	    x->emit(2, 0xd3, 0xe0);			/* shl eax, cl */
+	} else {
+	    x->emit(2, 0xd3, 0xe8);			/* shr eax, cl */
+	}
+	break;
+
+    case KF_MULT_INT:
+	x->emit(3, 0x0f, 0xaf, 0xc1);			/* imul eax, ecx */
+	break;
+
+    case KF_NEG_INT:
+	x->emit(2, 0xf7, 0xd0);				/* not eax */
+	break;
+
+    case KF_NOT_INT:
+	x->emit(2, 0x85, 0xc0);				/* test eax, eax */
+	x->emit(3, 0x0f, 0x94, 0xc0);			/* sete al */
+	x->emit(3, 0x0f, 0xb6, 0xc0);			/* movzx eax, al */
+	break;
+
+    case KF_OR_INT:
+	x->emit(2, 0x09, 0xc8);				/* or eax, ecx */
+	break;
+
+    case KF_SUB_INT:
+	x->emit(4, 0x29, 0xc1, 0x89, 0xc8);		/* sub ecx, eax; mov */
+	break;
+
+    case KF_SUB1_INT:
+	x->emit(3, 0x83, 0xe8, 0x01);			/* sub eax, 1 */
+	break;
+
+    case KF_TST_INT:
+	x->emit(2, 0x85, 0xc0);				/* test eax, eax */
+	x->emit(3, 0x0f, 0x95, 0xc0);			/* setne al */
+	x->emit(3, 0x0f, 0xb6, 0xc0);			/* movzx eax, al */
+	break;
+
+    case KF_UMIN_INT:
+	x->emit(2, 0xf7, 0xd8);				/* neg eax */
+	break;
+
+    case KF_XOR_INT:
+	x->emit(2, 0x31, 0xc8);				/* xor eax, ecx */
+	break;
+    }
+}
+
+/*
+ * NAME:	x64->compile()
+ * DESCRIPTION:	translate a function, return NULL if it cannot be done
+ */
+jitfunc x64_compile(uint8_t *func, uint16_t *kfmap, int nkfmap)
+{
+    uint8_t *code;
+    unsigned short size;
+    short *depth;
+    bool *label;
+    size_t *labels;
+    int pc, ticks, d;
+    Insn insn;
+    X64Code x;
+    jitfunc result;
+
+    int i;
+
+    /* only functions of type int with int arguments */
+    if (!(PROTO_CLASS(func) & C_TYPECHECKED) ||
+	(PROTO_CLASS(func) & C_ELLIPSIS) || PROTO_FTYPE(func) != T_INT) {
+	return (jitfunc) NULL;
+    }
+    for (i = 0; i < PROTO_NARGS(func) + PROTO_VARGS(func); i++) {
+	if (PROTO_ARGS(func)[i] != T_INT) {
+	    return (jitfunc) NULL;
+	}
+    }
+    code = func + PROTO_SIZE(func) + 3;
+    size = (code[0] << 8) | code[1];
+    code += 2;
+    if (size == 0) {
+	return (jitfunc) NULL;
+    }
+
+    depth = (short *) malloc(size * sizeof(short));
+    label = (bool *) malloc(size * sizeof(bool));
+    labels = (size_t *) malloc(size * sizeof(size_t));
+    if (depth == (short *) NULL || label == (bool *) NULL ||
+	labels == (size_t *) NULL ||
+	!analyze(code, size, depth, label, kfmap, nkfmap) ||
+	!assigned(code, size, depth, kfmap, nkfmap)) {
+	free(labels);
+	free(label);
+	free(depth);
+	return (jitfunc) NULL;
+    }
+
+    /* prologue */
+    x.emit(7, 0x53, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56);
+							/* push rbx, r12-r14 */
+    x.emit(4, 0x55, 0x48, 0x89, 0xe5);			/* push rbp; mov rbp, rsp */
+    x.emit(3, 0x48, 0x89, 0xfb);			/* mov rbx, rdi */
+    x.emit(3, 0x49, 0x89, 0xf4);			/* mov r12, rsi */
+    x.emit(3, 0x41, 0x89, 0xd5);			/* mov r13d, edx */
+    x.emit(3, 0x49, 0x89, 0xce);			/* mov r14, rcx */
+
+    ticks = 0;
+    for (pc = 0; pc < size; pc += insn.len) {
+	d = depth[pc];
+	if (d < 0) {
+	    insn.len = 1;	/* not reached */
+	    continue;
+	}
+	decode(code + pc, &insn, kfmap, nkfmap);
+	if (label[pc] && ticks != 0) {
+	    /* falling through: charge without checking */
+	    subticks(&x, ticks);
+	    ticks = 0;
+	}
+	labels[pc] = x.len;
+	ticks += insn.ticks;
+
+	switch (insn.instr) {
+	case I_PUSH_INT1:
+	case I_PUSH_INT2:
+	case I_PUSH_INT4:
+	    if (d != 0) {
+		x.emit(1, 0x50);			/* push rax */
+	    }
+	    if (insn.a == 0) {
+		x.emit(2, 0x31, 0xc0);			/* xor eax, eax */
+	    } else {
+		x.emit(1, 0xb8);			/* mov eax, imm */
+		x.emit4(insn.a);
+	    }
+	    break;
+
+	case I_PUSH_LOCAL:
+	    if (d != 0) {
+		x.emit(1, 0x50);			/* push rax */
+	    }
+	    local(&x, 0x8b, insn.a);			/* mov eax, var */
+	    break;
+
+	case I_PUSH_LOCAL2:
+	case I_PUSH_LOCAL_INT1:
+	    if (d != 0) {
+		x.emit(1, 0x50);			/* push rax */
+	    }
+	    local(&x, 0x8b, insn.a);			/* mov eax, var */
+	    x.emit(1, 0x50);				/* push rax */
+	    if (insn.instr == I_PUSH_LOCAL2) {
+		local(&x, 0x8b, insn.b);		/* mov eax, var */
+	    } else {
+		x.emit(1, 0xb8);			/* mov eax, imm */
+		x.emit4(insn.b);
+	    }
+	    break;
+
+	case I_STORE_LOCAL:
+	    local(&x, 0x89, insn.a);			/* mov var, eax */
+	    break;
+
+	case I_STORE_LOCAL | I_POP_BIT:
+	    local(&x, 0x89, insn.a);			/* mov var, eax */
+	    if (d > 1) {
+		x.emit(1, 0x58);			/* pop rax */
+	    }
+	    break;
+
+	case I_CALL_KFUNC:
+	case I_CALL_KFUNC | I_POP_BIT:
+	    charge(&x, ticks, pc);
+	    ticks = 0;
+	    kfun(&x, insn.kf, pc);
+	    if ((insn.instr & I_POP_BIT) && d - !unary(insn.kf) > 1) {
+		x.emit(1, 0x58);			/* pop rax */
+	    }
+	    break;
+
+	case I_INT_KFUNC:
+	    if (!insn.jump) {
+		kfun(&x, insn.kf, pc);
+		break;
+	    }
+	    charge(&x, ticks, pc);
+	    ticks = 0;
+	    x.emit(3, 0x59, 0x39, 0xc1);		/* pop rcx; cmp ecx, eax */
+	    if (d > 2) {
+		x.emit(1, 0x58);			/* pop rax */
+	    }
+	    switch (insn.kf) {
+	    case KF_EQ_INT:	x.emit(2, 0x0f, 0x84); break;	/* je */
+	    case KF_GE_INT:	x.emit(2, 0x0f, 0x8d); break;	/* jge */
+	    case KF_GT_INT:	x.emit(2, 0x0f, 0x8f); break;	/* jg */
+	    case KF_LE_INT:	x.emit(2, 0x0f, 0x8e); break;	/* jle */
+	    case KF_LT_INT:	x.emit(2, 0x0f, 0x8c); break;	/* jl */
+	    case KF_NE_INT:	x.emit(2, 0x0f, 0x85); break;	/* jne */
+	    }
+	    x.jump(insn.a);
+	    break;
+
+	case I_JUMP:
+	    charge(&x, ticks, pc);
+	    ticks = 0;
+	    x.emit(1, 0xe9);				/* jmp */
+	    x.jump(insn.a);
+	    break;
+
+	case I_JUMP_ZERO:
+	case I_JUMP_NONZERO:
+	    charge(&x, ticks, pc);
+	    ticks = 0;
+	    x.emit(2, 0x85, 0xc0);			/* test eax, eax */
+	    if (d > 1) {
+		x.emit(1, 0x58);			/* pop rax */
+	    }
+	    x.emit(2, 0x0f, (insn.instr == I_JUMP_ZERO) ? 0x84 : 0x85);
+	    x.jump(insn.a);				/* jz/jnz */
+	    break;
+
+	case I_RETURN:
+	    charge(&x, ticks, pc);
+	    ticks = 0;
+	    x.emit(3, 0x41, 0x89, 0x06);		/* mov [r14], eax */
+	    x.emit(2, 0x31, 0xc0);			/* xor eax, eax */
+	    x.emit(1, 0xe9);				/* jmp exit */
+	    x.jump(EXIT);
+	    break;
+	}
+    }
+
+    /* epilogue */
+    x.resolve(labels, x.len);
+    x.emit(3, 0x48, 0x89, 0xec);			/* mov rsp, rbp */
+    x.emit(6, 0x5d, 0x41, 0x5e, 0x41, 0x5d, 0x41);	/* pop rbp, r14, r13 */
+    x.emit(3, 0x5c, 0x5b, 0xc3);			/* pop r12, rbx; ret */
+
+    result = (x.error) ? (jitfunc) NULL : (jitfunc) jit_code(x.code, x.len);
+    free(labels);
+    free(label);
+    free(depth);
+    return result;
+}
@@ -175,7 +175,7 @@ int kf_add(Frame *f, int n, kfunc *kf)
 	case T_STRING:
 	    i_add_ticks(f, 2);
 	    num = kf_itoa(f->sp[1].u.number, buffer);
-	    str = str_new((char *) NULL,
+	    str = str_tmp((char *) NULL,
 			  (l=(long) strlen(num)) + f->sp->u.string->len);
 	    strcpy(str->text, num);
 	    memcpy(str->text + l, f->sp->u.string->text, f->sp->u.string->len);
@@ -201,7 +201,7 @@ int kf_add(Frame *f, int n, kfunc *kf)
 	    i_add_ticks(f, 2);
 	    GET_FLT(&f->sp[1], f1);
 	    f1.ftoa(buffer);
-	    str = str_new((char *) NULL,
+	    str = str_tmp((char *) NULL,
 			  (l=(long) strlen(buffer)) + f->sp->u.string->len);
 	    strcpy(str->text, buffer);
 	    memcpy(str->text + l, f->sp->u.string->text, f->sp->u.string->len);
@@ -218,7 +218,7 @@ int kf_add(Frame *f, int n, kfunc *kf)
 	case T_INT:
 	    num = kf_itoa(f->sp->u.number, buffer);
 	    f->sp++;
-	    str = str_new((char *) NULL,
+	    str = str_tmp((char *) NULL,
 			  f->sp->u.string->len + (long) strlen(num));
 	    memcpy(str->text, f->sp->u.string->text, f->sp->u.string->len);
 	    strcpy(str->text + f->sp->u.string->len, num);
@@ -231,7 +231,7 @@ int kf_add(Frame *f, int n, kfunc *kf)
 	    GET_FLT(f->sp, f2);
 	    f2.ftoa(buffer);
 	    f->sp++;
-	    str = str_new((char *) NULL,
+	    str = str_tmp((char *) NULL,
 			  f->sp->u.string->len + (long) strlen(buffer));
 	    memcpy(str->text, f->sp->u.string->text, f->sp->u.string->len);
 	    strcpy(str->text + f->sp->u.string->len, buffer);
@@ -477,7 +477,7 @@ int kf_div(Frame *f, int n, kfunc *kf)
 	if (d == 0) {
 	    error("Division by zero");
 	}
-	PUT_INT(&f->sp[1], i / d);
+	PUT_INT(&f->sp[1], INT_DIV(i, d));
 	f->sp++;
 	return 0;
 
@@ -529,7 +529,7 @@ int kf_div_int(Frame *f, int n, kfunc *kf)
     if (d == 0) {
 	error("Division by zero");
     }
-    PUT_INT(&f->sp[1], i / d);
+    PUT_INT(&f->sp[1], INT_DIV(i, d));
     f->sp++;
     return 0;
 }
@@ -1068,7 +1068,7 @@ int kf_mod(Frame *f, int n, kfunc *kf)
     if (d == 0) {
 	error("Modulus by zero");
     }
-    PUT_INT(&f->sp[1], i % d);
+    PUT_INT(&f->sp[1], INT_MOD(i, d));
     f->sp++;
     return 0;
 }
@@ -1096,7 +1096,7 @@ int kf_mod_int(Frame *f, int n, kfunc *kf)
     if (d == 0) {
 	error("Modulus by zero");
     }
-    PUT_INT(&f->sp[1], i % d);
+    PUT_INT(&f->sp[1], INT_MOD(i, d));
     f->sp++;
     return 0;
 }
@@ -2637,7 +2637,7 @@ int kf_add_float_string(Frame *f, int n, kfunc *kf)
     i_add_ticks(f, 3);
     GET_FLT(&f->sp[1], flt);
     flt.ftoa(buffer);
-    str = str_new((char *) NULL, (l=strlen(buffer)) + f->sp->u.string->len);
+    str = str_tmp((char *) NULL, (l=strlen(buffer)) + f->sp->u.string->len);
     strcpy(str->text, buffer);
     memcpy(str->text + l, f->sp->u.string->text, f->sp->u.string->len);
     str_del(f->sp->u.string);
@@ -2668,7 +2668,7 @@ int kf_add_int_string(Frame *f, int n, kfunc *kf)
 
     i_add_ticks(f, 2);
     num = kf_itoa(f->sp[1].u.number, buffer);
-    str = str_new((char *) NULL, (l=strlen(num)) + f->sp->u.string->len);
+    str = str_tmp((char *) NULL, (l=strlen(num)) + f->sp->u.string->len);
     strcpy(str->text, num);
     memcpy(str->text + l, f->sp->u.string->text, f->sp->u.string->len);
     str_del(f->sp->u.string);
@@ -2729,7 +2729,7 @@ int kf_add_string_float(Frame *f, int n, kfunc *kf)
     GET_FLT(f->sp, flt);
     flt.ftoa(buffer);
     f->sp++;
-    str = str_new((char *) NULL, f->sp->u.string->len + (long) strlen(buffer));
+    str = str_tmp((char *) NULL, f->sp->u.string->len + (long) strlen(buffer));
     memcpy(str->text, f->sp->u.string->text, f->sp->u.string->len);
     strcpy(str->text + f->sp->u.string->len, buffer);
     str_del(f->sp->u.string);
@@ -2759,7 +2759,7 @@ int kf_add_string_int(Frame *f, int n, kfunc *kf)
     i_add_ticks(f, 2);
     num = kf_itoa(f->sp->u.number, buffer);
     f->sp++;
-    str = str_new((char *) NULL, f->sp->u.string->len + (long) strlen(num));
+    str = str_tmp((char *) NULL, f->sp->u.string->len + (long) strlen(num));
     memcpy(str->text, f->sp->u.string->text, f->sp->u.string->len);
     strcpy(str->text + f->sp->u.string->len, num);
     str_del(f->sp->u.string);
@@ -3450,7 +3450,7 @@ int kf_sum(Frame *f, int nargs, kfunc *kf)
      */
     result = 0;
     if (type == T_STRING) {
-	s = str_new((char *) NULL, size);
+	s = str_tmp((char *) NULL, size);
 	s->text[size] = '\0';
 	for (v = f->sp, i = nargs; --i >= 0; v++) {
 	    if (v->u.number == SUM_SIMPLE) {
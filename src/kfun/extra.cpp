@@ -167,7 +167,7 @@ int kf_explode(Frame *f, int n, kfunc *kf)
 	 */
 	a = arr_new(f->data, (long) len);
 	for (v = a->elts; len > 0; v++, --len) {
-	    PUT_STRVAL(v, str_new(p, 1L));
+	    PUT_STRVAL(v, str_tmp(p, 1L));
 	    p++;
 	}
     } else {
@@ -207,7 +207,7 @@ int kf_explode(Frame *f, int n, kfunc *kf)
 	while (len > slen) {
 	    if (memcmp(p, s, slen) == 0) {
 		/* separator found */
-		PUT_STRVAL(v, str_new(p - size, (long) size));
+		PUT_STRVAL(v, str_tmp(p - size, (long) size));
 		v++;
 		p += slen;
 		len -= slen;
@@ -225,7 +225,7 @@ int kf_explode(Frame *f, int n, kfunc *kf)
 	    p += len;
 	}
 	/* final array element */
-	PUT_STRVAL(v, str_new(p - size, (long) size));
+	PUT_STRVAL(v, str_tmp(p - size, (long) size));
     }
 
     str_del((f->sp++)->u.string);
@@ -651,7 +651,7 @@ no_match:
 
 	case T_STRING:
 	    PUT_STRVAL(elts,
-		       str_new(results[size].u.text, results[size].o.len));
+		       str_tmp(results[size].u.text, results[size].o.len));
 	    break;
 	}
     }
@@ -26,6 +26,7 @@
 # include "node.h"
 # include "control.h"
 # include "compile.h"
+# include "profile.h"
 # endif
 
 
@@ -1496,6 +1497,87 @@ int kf_status(Frame *f, int nargs, kfunc *kf)
 # endif
 
 
+# ifdef FUNCDEF
+FUNCDEF("profile", kf_profile, pt_profile, 0)
+# else
+char pt_profile[] = { C_TYPECHECKED | C_STATIC, 1, 0, 0, 7, T_VOID, T_INT };
+
+/*
+ * NAME:	kfun->profile()
+ * DESCRIPTION:	start or stop profiling: 0 stops, any other value starts
+ *		profiling call paths, and with 2 or 4 added also measures
+ *		their time or counts instructions, respectively
+ */
+int kf_profile(Frame *f, int n, kfunc *kf)
+{
+    UNREFERENCED_PARAMETER(n);
+    UNREFERENCED_PARAMETER(kf);
+
+    if (f->sp->u.number != 0) {
+	pf_start((int) f->sp->u.number);
+    } else {
+	pf_stop();
+    }
+    *f->sp = nil_value;
+    return 0;
+}
+# endif
+
+
+# ifdef FUNCDEF
+FUNCDEF("profile_info", kf_profile_info, pt_profile_info, 0)
+# else
+char pt_profile_info[] = { C_STATIC, 0, 0, 0, 6, T_MIXED | (1 << REFSHIFT) };
+
+/*
+ * NAME:	kfun->profile_info()
+ * DESCRIPTION:	return the data collected by the profiler
+ */
+int kf_profile_info(Frame *f, int n, kfunc *kf)
+{
+    UNREFERENCED_PARAMETER(n);
+    UNREFERENCED_PARAMETER(kf);
+
+    i_add_ticks(f, 1000);
+    PUSH_ARRVAL(f, pf_info(f->data));
+    return 0;
+}
+# endif
+
+
+# ifdef FUNCDEF
+FUNCDEF("profile_dump", kf_profile_dump, pt_profile_dump, 0)
+# else
+char pt_profile_dump[] = { C_TYPECHECKED | C_STATIC, 1, 0, 0, 7, T_INT,
+			   T_STRING };
+
+/*
+ * NAME:	kfun->profile_dump()
+ * DESCRIPTION:	write the profiled call paths to a file
+ */
+int kf_profile_dump(Frame *f, int n, kfunc *kf)
+{
+    char file[STRINGSZ];
+
+    UNREFERENCED_PARAMETER(n);
+    UNREFERENCED_PARAMETER(kf);
+
+    if (path_string(file, f->sp->u.string->text,
+		    f->sp->u.string->len) == (char *) NULL) {
+	return 1;
+    }
+    if (f->level != 0) {
+	error("profile_dump() within atomic function");
+    }
+
+    i_add_ticks(f, 1000);
+    str_del(f->sp->u.string);
+    PUT_INTVAL(f->sp, pf_dump(f, file));
+    return 0;
+}
+# endif
+
+
 # ifdef CLOSURES
 # ifdef FUNCDEF
 FUNCDEF("new.function", kf_new_function, pt_new_function, 0)
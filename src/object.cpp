@@ -75,9 +75,12 @@ static uindex uobjects;		/* objects to check for upgrades */
 static objplane baseplane;	/* base object plane */
 static objplane *oplane;	/* current object plane */
 static Uint *omap;		/* object dump bitmap */
+static Uint *o2map;		/* objects in secondary snapshot */
+static uindex d2objects;	/* objects to copy from secondary snapshot */
 static Uint *counttab;		/* object count table */
 static Object *upgraded;	/* list of upgraded objects */
 static uindex dobjects, dobject;/* objects to copy */
+static uindex pobject;		/* next object to prefetch */
 static uindex mobjects;		/* max objects to copy */
 static uindex dchunksz;		/* copy chunk size */
 static Uint dinterval;		/* copy interval */
@@ -95,7 +98,8 @@ void o_init(unsigned int n, Uint interval)
     ocmap = ALLOC(Uint, BMAP(n));
     memset(ocmap, '\0', BMAP(n) * sizeof(Uint));
     for (n = 4; n < otabsize; n <<= 1) ;
-    baseplane.htab = Hashtab::create(n >> 2, OBJHASHSZ, FALSE);
+    baseplane.htab = Hashtab::create(n >> 2, OBJHASHSZ, FALSE,
+				     &Hashtab::stats[HS_OBJECT]);
     baseplane.optab = (optable *) NULL;
     baseplane.upgrade = baseplane.clean = OBJ_NONE;
     baseplane.destruct = baseplane.free = OBJ_NONE;
@@ -200,7 +204,8 @@ static Object *o_oaccess(unsigned int index, int access)
 	    if (obj->count != 0) {
 		if (oplane->htab == (Hashtab *) NULL) {
 		    oplane->htab = Hashtab::create(OBJPATCHHTABSZ, OBJHASHSZ,
-						   FALSE);
+						   FALSE,
+						   &Hashtab::stats[HS_OBJECT]);
 		}
 		h = oplane->htab->lookup(name, FALSE);
 		obj->next = *h;
@@ -576,7 +581,8 @@ Object *o_new(char *name, Control *ctrl)
     if (obase) {
 	m_dynamic();
     } else if (oplane->htab == (Hashtab *) NULL) {
-	oplane->htab = Hashtab::create(OBJPATCHHTABSZ, OBJHASHSZ, FALSE);
+	oplane->htab = Hashtab::create(OBJPATCHHTABSZ, OBJHASHSZ, FALSE,
+				       &Hashtab::stats[HS_OBJECT]);
     }
     h = oplane->htab->lookup(name, FALSE);
     o->next = *h;
@@ -904,7 +910,19 @@ static void o_restore_obj(Object *obj, bool cactive, bool dactive)
 {
     BCLR(omap, obj->index);
     --dobjects;
-    d_restore_obj(obj, (recount) ? counttab : (Uint *) NULL, cactive, dactive);
+    if (d2objects != 0 && BTST(o2map, obj->index)) {
+	BCLR(o2map, obj->index);
+	d_restore_obj(obj, counttab, cactive, dactive, TRUE);
+	if (--d2objects == 0) {
+	    /* secondary snapshot no longer needed */
+	    FREE(o2map);
+	    o2map = (Uint *) NULL;
+	    sw_restore2(-1);
+	}
+    } else {
+	d_restore_obj(obj, (recount) ? counttab : (Uint *) NULL, cactive,
+		      dactive, FALSE);
+    }
 }
 
 /*
@@ -1210,7 +1228,7 @@ static void o_sweep(uindex n)
     Object *obj;
 
     uobjects = n;
-    dobject = 0;
+    dobject = pobject = 0;
     for (obj = otable; n > 0; obj++, --n) {
 	if (obj->count != 0) {
 	    if (obj->cfirst != SW_UNUSED || obj->dfirst != SW_UNUSED) {
@@ -1330,6 +1348,31 @@ bool o_dump(int fd, bool incr)
     return TRUE;
 }
 
+/*
+ * NAME:	Object->mark2()
+ * DESCRIPTION:	mark objects to be copied from the secondary snapshot
+ */
+static void o_mark2(Uint *map, uindex i, uindex n)
+{
+    Object *obj;
+
+    for (; n > 0; i++) {
+	if (BTST(map, i)) {
+	    obj = OBJ(i);
+	    if ((obj->cfirst != SW_UNUSED || obj->dfirst != SW_UNUSED) &&
+		!BTST(o2map, i)) {
+		BSET(o2map, i);
+		d2objects++;
+		if (!BTST(omap, i)) {
+		    BSET(omap, i);
+		    dobjects++;
+		}
+	    }
+	    --n;
+	}
+    }
+}
+
 /*
  * NAME:	Object->restore()
  * DESCRIPTION:	restore the object table
@@ -1407,7 +1450,6 @@ void o_restore(int fd, bool part)
 
     if (part) {
 	map_header mh;
-	off_t offset;
 	Uint *cmap, *dmap;
 	uindex nctrl, ndata;
 
@@ -1438,46 +1480,19 @@ void o_restore(int fd, bool part)
 	}
 
 	/*
-	 * copy all objects from the secondary restore file
+	 * objects in the secondary restore file are copied on demand
 	 */
-	offset = P_lseek(fd, (off_t) 0, SEEK_CUR);
-	i = mh.cobject;
-	while (nctrl > 0) {
-	    while (!BTST(cmap, i)) {
-		i++;
-	    }
-	    BCLR(cmap, i);
-
-	    o = OBJ(i);
-	    if (o->cfirst != SW_UNUSED) {
-		if (BTST(omap, i)) {
-		    BCLR(omap, i);
-		    --dobjects;
-		}
-		d_restore_ctrl(o, &sw_conv2);
-		d_swapout(1);
-	    }
-	    i++;
-	    --nctrl;
+	if (nctrl != 0 || ndata != 0) {
+	    m_static();
+	    o2map = ALLOC(Uint, BMAP(dh.nobjects));
+	    m_dynamic();
+	    memset(o2map, '\0', BMAP(dh.nobjects) * sizeof(Uint));
+	    o_mark2(cmap, mh.cobject, nctrl);
+	    o_mark2(dmap, mh.dobject, ndata);
+	    mobjects = dobjects;
 	}
-	i = mh.dobject;
-	while (ndata > 0) {
-	    while (!BTST(dmap, i)) {
-		i++;
-	    }
-	    BCLR(dmap, i);
-
-	    o = OBJ(i);
-	    if (o->dfirst != SW_UNUSED) {
-		if (BTST(omap, i)) {
-		    BCLR(omap, i);
-		    --dobjects;
-		}
-		d_restore_data(o, counttab, &sw_conv2);
-		d_swapout(1);
-	    }
-	    i++;
-	    --ndata;
+	if (d2objects == 0) {
+	    sw_restore2(-1);
 	}
 
 	if (cmap != (Uint *) NULL) {
@@ -1486,7 +1501,6 @@ void o_restore(int fd, bool part)
 	if (dmap != (Uint *) NULL) {
 	    FREE(dmap);
 	}
-	P_lseek(fd, offset, SEEK_SET);
     } else {
 	count = o_recount(baseplane.nobjects);
     }
@@ -1494,6 +1508,34 @@ void o_restore(int fd, bool part)
     baseplane.ocount = count;
 }
 
+/*
+ * NAME:	Object->prefetch()
+ * DESCRIPTION:	start reading the first sectors of the objects to be copied
+ *		after this one, so that reading the snapshot overlaps with
+ *		converting the objects
+ */
+static void o_prefetch(Object *obj)
+{
+    uindex n;
+
+    if (pobject <= obj->index) {
+	pobject = obj->index + 1;
+    }
+    for (n = obj->index + RSPREFETCH; pobject <= n && pobject < uobjects;
+	 pobject++) {
+	if (BTST(omap, pobject) &&
+	    (d2objects == 0 || !BTST(o2map, pobject))) {
+	    obj = OBJ(pobject);
+	    if (obj->cfirst != SW_UNUSED) {
+		sw_prefetchv(&obj->cfirst, 1, TRUE);
+	    }
+	    if (obj->count != 0 && obj->dfirst != SW_UNUSED) {
+		sw_prefetchv(&obj->dfirst, 1, TRUE);
+	    }
+	}
+    }
+}
+
 /*
  * NAME:	Object->copy()
  * DESCRIPTION:	copy objects from dump to swap
@@ -1534,6 +1576,7 @@ bool o_copy(Uint time)
 	while (dobjects > n) {
 	    for (obj = OBJ(dobject); !BTST(omap, obj->index); obj++) ;
 	    dobject = obj->index + 1;
+	    o_prefetch(obj);
 	    o_restore_obj(obj, FALSE, FALSE);
 	    if (time == 0) {
 		o_clean();
@@ -1569,6 +1612,25 @@ bool o_copy(Uint time)
     }
 }
 
+/*
+ * NAME:	Object->copy2()
+ * DESCRIPTION:	copy the remaining objects from the secondary snapshot to
+ *		swap, before the snapshot they are in is superseded
+ */
+void o_copy2()
+{
+    uindex i;
+
+    for (i = 0; d2objects != 0; i++) {
+	if (BTST(o2map, i)) {
+	    o_restore_obj(OBJ(i), FALSE, FALSE);
+	    o_clean();
+	    d_swapout(1);
+	}
+    }
+}
+
+
 
 /*
  * NAME:	swapout()
@@ -90,6 +90,7 @@ extern uindex	  o_dobjects		();
 extern bool	  o_dump		(int, bool);
 extern void	  o_restore		(int, bool);
 extern bool	  o_copy		(Uint);
+extern void	  o_copy2		();
 
 extern void	  swapout		();
 extern void	  dump_state		(bool);
@@ -184,7 +184,7 @@ struct rgxposn : public Hashtab::Entry {
 
 # define RPCHUNKSZ	32
 
-class rpchunk : public Chunk<rgxposn, RPCHUNKSZ> {
+class rpchunk : public Chunk<rgxposn, RPCHUNKSZ, MC_PARSER> {
 public:
     /*
      * NAME:		~rpchunk()
@@ -246,7 +246,7 @@ static rgxposn *rp_new(Hashtab *htab, char *posn, unsigned short size, rpchunk *
 
     rp = rp_alloc(htab, posn, size, c, rgx, nposn, ruleno, final);
     if (rp->nposn == nposn) {
-	rp->name = strcpy(ALLOC(char, size + 3), posn);
+	rp->name = strcpy(ALLOC_CAT(char, size + 3, MC_PARSER), posn);
 	rp->alloc = TRUE;
     }
     return rp;
@@ -706,7 +706,7 @@ static char *ds_loadtmp(dfastate *state, char *sbuf, char *pbuf, Hashtab *htab,
 
     if (state->nposn != 0) {
 	if (state->nposn != 1) {
-	    rrp = state->posn.a = ALLOC(rgxposn*, state->nposn);
+	    rrp = state->posn.a = ALLOC_CAT(rgxposn*, state->nposn, MC_PARSER);
 	} else {
 	    rrp = &state->posn.e;
 	}
@@ -722,7 +722,8 @@ static char *ds_loadtmp(dfastate *state, char *sbuf, char *pbuf, Hashtab *htab,
     }
     if (state->nstr != 0) {
 	if (state->nstr > 2) {
-	    s = state->str.a = ALLOC(unsigned short, state->nstr);
+	    s = state->str.a = ALLOC_CAT(unsigned short, state->nstr,
+					 MC_PARSER);
 	} else {
 	    s = state->str.e;
 	}
@@ -848,7 +849,7 @@ dfa *dfa_new(char *source, char *grammar)
     dfastate *state;
     bool final;
 
-    fa = ALLOC(dfa, 1);
+    fa = ALLOC_CAT(dfa, 1, MC_PARSER);
 
     /* grammar info */
     fa->source = source;
@@ -871,7 +872,7 @@ dfa *dfa_new(char *source, char *grammar)
 
     /* equivalence classes */
     fa->ecnum = 1;
-    fa->ecsplit = ALLOC(char, 256 + 256 + 32 * 256);
+    fa->ecsplit = ALLOC_CAT(char, 256 + 256 + 32 * 256, MC_PARSER);
     fa->ecmembers = fa->ecsplit + 256;
     fa->ecset = (Uint *) (fa->ecmembers + 256);
     memset(fa->eclass, '\0', 256);
@@ -890,8 +891,8 @@ dfa *dfa_new(char *source, char *grammar)
     fa->sthsize = (Uint) fa->sttsize << 1;
     fa->nexpanded = 0;
     fa->endstates = 1;
-    fa->states = ALLOC(dfastate, fa->sttsize);
-    fa->sthtab = ALLOC(unsigned short, fa->sthsize);
+    fa->states = ALLOC_CAT(dfastate, fa->sttsize, MC_PARSER);
+    fa->sthtab = ALLOC_CAT(unsigned short, fa->sthsize, MC_PARSER);
     memset(fa->sthtab, '\0', sizeof(unsigned short) * fa->sthsize);
 
     /* initial states */
@@ -903,9 +904,11 @@ dfa *dfa_new(char *source, char *grammar)
     state->ntrans = state->len = 0;
     (state++)->final = -1;
     state->posn.a = (fa->nposn > 1) ?
-		     ALLOC(rgxposn*, fa->nposn) : (rgxposn **) NULL;
+		     ALLOC_CAT(rgxposn*, fa->nposn, MC_PARSER) :
+		     (rgxposn **) NULL;
     state->str.a = (nstrings > 2) ?
-		    ALLOC(unsigned short, nstrings) : (unsigned short *) NULL;
+		    ALLOC_CAT(unsigned short, nstrings, MC_PARSER) :
+		    (unsigned short *) NULL;
     state->trans = (char *) NULL;
     state->nposn = fa->nposn;
     state->nstr = nstrings;
@@ -1008,7 +1011,7 @@ static void dfa_extend(dfa *fa, dfastate *state, unsigned short limit)
 
     /* extend transition table */
     if (!state->alloc) {
-	p = ALLOC(char, 2 * 256);
+	p = ALLOC_CAT(char, 2 * 256, MC_PARSER);
 	memcpy(p, state->trans, state->ntrans << 1);
 	state->trans = p;
 	state->alloc = TRUE;
@@ -1071,7 +1074,7 @@ dfa *dfa_load(char *source, char *grammar, char *str, Uint len)
 	return dfa_new(source, grammar);
     }
 
-    fa = ALLOC(dfa, 1);
+    fa = ALLOC_CAT(dfa, 1, MC_PARSER);
     fa->dfastr = buf = str;
 
     /* grammar info */
@@ -1095,7 +1098,7 @@ dfa *dfa_load(char *source, char *grammar, char *str, Uint len)
     fa->endstates = (UCHAR(buf[5]) << 8) + UCHAR(buf[6]);
     fa->sttsize = fa->nstates + 1;
     fa->sthsize = (Uint) (fa->nposn + nstrings + 1) << 2;
-    fa->states = ALLOC(dfastate, fa->sttsize);
+    fa->states = ALLOC_CAT(dfastate, fa->sttsize, MC_PARSER);
     fa->sthtab = (unsigned short *) NULL;
 
     /* equivalence classes */
@@ -1150,7 +1153,7 @@ static void dfa_loadtmp(dfa *fa)
     buf += 4;
 
     /* equivalence classes */
-    fa->ecsplit = ALLOC(char, 256 + 256 + 32 * 256);
+    fa->ecsplit = ALLOC_CAT(char, 256 + 256 + 32 * 256, MC_PARSER);
     fa->ecmembers = fa->ecsplit + 256;
     fa->ecset = (Uint *) (fa->ecmembers + 256);
     memcpy(fa->ecsplit, buf, fa->ecnum);
@@ -1168,7 +1171,7 @@ static void dfa_loadtmp(dfa *fa)
     fa->posnhtab = Hashtab::create((fa->nposn + 1) << 2, 257, FALSE);
 
     /* states */
-    fa->sthtab = ALLOC(unsigned short, fa->sthsize);
+    fa->sthtab = ALLOC_CAT(unsigned short, fa->sthsize, MC_PARSER);
     memset(fa->sthtab, '\0', sizeof(unsigned short) * fa->sthsize);
 
     fa->nposn = 0;
@@ -1208,7 +1211,9 @@ bool dfa_save(dfa *fa, char **str, Uint *len)
 	FREE(fa->dfastr);
     }
     fa->dfastr = buf = *str =
-		 ALLOC(char, *len = fa->dfasize + fa->tmpssize + fa->tmppsize);
+		 ALLOC_CAT(char,
+			   *len = fa->dfasize + fa->tmpssize + fa->tmppsize,
+			   MC_PARSER);
     *buf++ = DFA_VERSION;
     *buf++ = fa->nstates >> 8;
     *buf++ = fa->nstates;
@@ -1446,7 +1451,7 @@ static dfastate *dfa_expand(dfa *fa, dfastate *state)
     if (state->nstr != 0) {
 	newstr = ALLOCA(unsigned short, state->nstr);
     }
-    p = state->trans = ALLOC(char, 2 * 256);
+    p = state->trans = ALLOC_CAT(char, 2 * 256, MC_PARSER);
     state->ntrans = fa->ecnum;
     state->alloc = TRUE;
     cset += (Uint) state->nstr << 3;
@@ -1487,12 +1492,14 @@ static dfastate *dfa_expand(dfa *fa, dfastate *state)
 		 * genuinely new state
 		 */
 		if (newstate->nposn > 1) {
-		    newstate->posn.a = ALLOC(rgxposn*, newstate->nposn);
+		    newstate->posn.a = ALLOC_CAT(rgxposn*, newstate->nposn,
+						 MC_PARSER);
 		    memcpy(newstate->posn.a, newposn,
 			   newstate->nposn * sizeof(rgxposn*));
 		}
 		if (newstate->nstr > 2) {
-		    newstate->str.a = ALLOC(unsigned short, newstate->nstr);
+		    newstate->str.a = ALLOC_CAT(unsigned short, newstate->nstr,
+						MC_PARSER);
 		    memcpy(newstate->str.a, newstr,
 			   newstate->nstr * sizeof(unsigned short));
 		}
@@ -480,9 +480,9 @@ struct rule : public Hashtab::Entry {
 # define RULE_STRING	2	/* string rule */
 # define RULE_PROD	3	/* production rule */
 
-typedef Chunk<rulesym, RSCHUNKSZ> rschunk;
+typedef Chunk<rulesym, RSCHUNKSZ, MC_PARSER> rschunk;
 
-class rlchunk : public Chunk<rule, RLCHUNKSZ> {
+class rlchunk : public Chunk<rule, RLCHUNKSZ, MC_PARSER> {
 public:
     /*
      * NAME:		~rlchunk()
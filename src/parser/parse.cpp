@@ -45,7 +45,7 @@ struct pnode {
 
 # define PNCHUNKSZ	256
 
-typedef Chunk<pnode, PNCHUNKSZ> pnchunk;
+typedef Chunk<pnode, PNCHUNKSZ, MC_PARSER> pnchunk;
 
 /*
  * NAME:	pnode->new()
@@ -78,7 +78,7 @@ struct snode {
 
 # define SNCHUNKSZ	32
 
-typedef Chunk<snode, SNCHUNKSZ> snchunk;
+typedef Chunk<snode, SNCHUNKSZ, MC_PARSER> snchunk;
 
 struct snlist {
     snchunk *snc;		/* snode chunk */
@@ -158,7 +158,7 @@ static void sn_clear(snlist *list)
 
 # define STRCHUNKSZ	256
 
-class strpchunk : public Chunk<String*, STRCHUNKSZ> {
+class strpchunk : public Chunk<String*, STRCHUNKSZ, MC_PARSER> {
 public:
     /*
      * NAME:		~strpchunk()
@@ -194,7 +194,7 @@ static void sc_add(strpchunk **c, String *str)
 
 # define ARRCHUNKSZ	256
 
-class arrpchunk : public Chunk<Array*, ARRCHUNKSZ> {
+class arrpchunk : public Chunk<Array*, ARRCHUNKSZ, MC_PARSER> {
 public:
     /*
      * NAME:		~arrpchunk()
@@ -263,7 +263,7 @@ static parser *ps_new(Frame *f, String *source, String *grammar)
     parser *ps;
     char *p;
 
-    ps = ALLOC(parser, 1);
+    ps = ALLOC_CAT(parser, 1, MC_PARSER);
     ps->frame = f;
     ps->data = f->data;
     ps->data->parser = ps;
@@ -423,7 +423,7 @@ static pnode *ps_parse(parser *ps, String *str, bool *toobig)
     if (ps->nstates < ps->nprod) {
 	ps->nstates = ps->nprod;
     }
-    ps->states = ALLOC(snode*, ps->nstates);
+    ps->states = ALLOC_CAT(snode*, ps->nstates, MC_PARSER);
     memset(ps->states, '\0', ps->nstates * sizeof(snode*));
     ps->list.first = (snode *) NULL;
 
@@ -740,7 +740,7 @@ static parser *ps_load(Frame *f, Value *elts)
     Uint len;
     short fasize, lrsize;
 
-    ps = ALLOC(parser, 1);
+    ps = ALLOC_CAT(parser, 1, MC_PARSER);
     ps->frame = f;
     ps->data = f->data;
     ps->data->parser = ps;
@@ -753,7 +753,7 @@ static parser *ps_load(Frame *f, Value *elts)
 	for (i = fasize, len = 0; --i >= 0; ) {
 	    len += elts[i].u.string->len;
 	}
-	p = ps->fastr = ALLOC(char, len);
+	p = ps->fastr = ALLOC_CAT(char, len, MC_PARSER);
 	for (i = fasize; --i >= 0; ) {
 	    memcpy(p, elts->u.string->text, elts->u.string->len);
 	    p += (elts++)->u.string->len;
@@ -770,7 +770,7 @@ static parser *ps_load(Frame *f, Value *elts)
 	for (i = lrsize, len = 0; --i >= 0; ) {
 	    len += elts[i].u.string->len;
 	}
-	p = ps->lrstr = ALLOC(char, len);
+	p = ps->lrstr = ALLOC_CAT(char, len, MC_PARSER);
 	for (i = lrsize; --i >= 0; ) {
 	    memcpy(p, elts->u.string->text, elts->u.string->len);
 	    p += (elts++)->u.string->len;
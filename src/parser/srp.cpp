@@ -29,7 +29,7 @@ struct item {
 
 # define ITCHUNKSZ	32
 
-typedef Chunk<item, ITCHUNKSZ> itchunk;
+typedef Chunk<item, ITCHUNKSZ, MC_PARSER> itchunk;
 
 /*
  * NAME:	item->new()
@@ -278,7 +278,7 @@ struct shlink {
 
 # define SLCHUNKSZ	64
 
-typedef Chunk<shlink, SLCHUNKSZ> slchunk;
+typedef Chunk<shlink, SLCHUNKSZ, MC_PARSER> slchunk;
 
 /*
  * NAME:	shlink->hash()
@@ -370,7 +370,7 @@ srp *srp_new(char *grammar)
     char *p;
     Uint nrule;
 
-    lr = ALLOC(srp, 1);
+    lr = ALLOC_CAT(srp, 1, MC_PARSER);
 
     /* grammar info */
     lr->grammar = grammar;
@@ -395,8 +395,8 @@ srp *srp_new(char *grammar)
     lr->nexpanded = 0;
     lr->sttsize = nrule << 1;
     lr->sthsize = nrule << 2;
-    lr->states = ALLOC(srpstate, lr->sttsize);
-    lr->sthtab = ALLOC(unsigned short, lr->sthsize);
+    lr->states = ALLOC_CAT(srpstate, lr->sttsize, MC_PARSER);
+    lr->sthtab = ALLOC_CAT(unsigned short, lr->sthsize, MC_PARSER);
     memset(lr->sthtab, '\0', lr->sthsize * sizeof(unsigned short));
     lr->itc = (itchunk *) NULL;
 
@@ -414,9 +414,9 @@ srp *srp_new(char *grammar)
     /* packed mapping for shift */
     lr->gap = lr->spread = 0;
     lr->mapsize = (Uint) (lr->ntoken + lr->nprod) << 2;
-    lr->data = ALLOC(char, lr->mapsize);
+    lr->data = ALLOC_CAT(char, lr->mapsize, MC_PARSER);
     memset(lr->data, '\0', lr->mapsize);
-    lr->check = ALLOC(char, lr->mapsize);
+    lr->check = ALLOC_CAT(char, lr->mapsize, MC_PARSER);
     memset(lr->check, '\xff', lr->mapsize);
     lr->alloc = TRUE;
 
@@ -425,8 +425,8 @@ srp *srp_new(char *grammar)
     lr->nshift = 0;
     lr->shtsize = lr->mapsize;
     lr->shhsize = nrule << 2;
-    lr->shtab = ALLOC(char, lr->shtsize);
-    lr->shhtab = ALLOC(shlink*, lr->shhsize);
+    lr->shtab = ALLOC_CAT(char, lr->shtsize, MC_PARSER);
+    lr->shhtab = ALLOC_CAT(shlink*, lr->shhsize, MC_PARSER);
     memset(lr->shhtab, '\0', lr->shhsize * sizeof(shlink*));
 
     return lr;
@@ -520,7 +520,7 @@ srp *srp_load(char *grammar, char *str, Uint len)
 	return srp_new(grammar);
     }
 
-    lr = ALLOC(srp, 1);
+    lr = ALLOC_CAT(srp, 1, MC_PARSER);
 
     /* grammar info */
     lr->grammar = grammar;
@@ -546,7 +546,7 @@ srp *srp_load(char *grammar, char *str, Uint len)
     /* states */
     lr->sttsize = lr->nstates + 1;
     lr->sthsize = 0;
-    lr->states = ALLOC(srpstate, lr->sttsize);
+    lr->states = ALLOC_CAT(srpstate, lr->sttsize, MC_PARSER);
     lr->sthtab = (unsigned short *) NULL;
     lr->itc = (itchunk *) NULL;
 
@@ -607,7 +607,7 @@ static void srp_loadtmp(srp *lr)
 
     /* states */
     lr->sthsize = nrule << 2;
-    lr->sthtab = ALLOC(unsigned short, lr->sthsize);
+    lr->sthtab = ALLOC_CAT(unsigned short, lr->sthsize, MC_PARSER);
     memset(lr->sthtab, '\0', lr->sthsize * sizeof(unsigned short));
     for (i = 0, state = lr->states; i < lr->nstates; i++, state++) {
 	if (state->nitem != 0) {
@@ -619,9 +619,9 @@ static void srp_loadtmp(srp *lr)
     /* shifts */
     lr->shtsize = lr->nshift * 2;
     lr->shhsize = nrule << 2;
-    lr->shtab = ALLOC(char, lr->shtsize);
+    lr->shtab = ALLOC_CAT(char, lr->shtsize, MC_PARSER);
     memcpy(lr->shtab, buf, lr->nshift);
-    lr->shhtab = ALLOC(shlink*, lr->shhsize);
+    lr->shhtab = ALLOC_CAT(shlink*, lr->shhsize, MC_PARSER);
     memset(lr->shhtab, '\0', lr->shhsize * sizeof(shlink*));
     for (i = 0, p = buf; i != lr->nshift; i += n, p += n) {
 	n = (Uint) 4 * ((UCHAR(p[5]) << 8) + UCHAR(p[6])) + 7;
@@ -653,7 +653,8 @@ bool srp_save(srp *lr, char **str, Uint *len)
     if (lr->allocated) {
 	FREE(lr->srpstr);
     }
-    lr->srpstr = buf = *str = ALLOC(char, *len = lr->srpsize + lr->tmpsize);
+    lr->srpstr = buf = *str = ALLOC_CAT(char, *len = lr->srpsize + lr->tmpsize,
+					MC_PARSER);
 
     /* header */
     *buf++ = SRP_VERSION;
@@ -791,10 +792,10 @@ next:
 	} else {
 	    char *table;
 
-	    table = ALLOC(char, j);
+	    table = ALLOC_CAT(char, j, MC_PARSER);
 	    memcpy(table, lr->data, lr->mapsize);
 	    lr->data = table;
-	    table = ALLOC(char, j);
+	    table = ALLOC_CAT(char, j, MC_PARSER);
 	    memcpy(table, lr->check, lr->mapsize);
 	    lr->check = table;
 	    lr->alloc = TRUE;
@@ -916,7 +917,7 @@ static srpstate *srp_expand(srp *lr, srpstate *state)
     state->nred = nred;
     if (nred != 0) {
 	if (nred > 1) {
-	    state->reds.a = ALLOC(char, (Uint) nred << 2);
+	    state->reds.a = ALLOC_CAT(char, (Uint) nred << 2, MC_PARSER);
 	    state->alloc = TRUE;
 	}
 	lr->nred += nred;
@@ -0,0 +1,578 @@
+/*
+ * This file is part of DGD, https://github.com/dworkin/dgd
+ * Copyright (C) 1993-2010 Dworkin B.V.
+ * Copyright (C) 2010-2017 DGD Authors (see the commit log for details)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+# define INCLUDE_FILE_IO
+# include "dgd.h"
+# include "str.h"
+# include "array.h"
+# include "object.h"
+# include "xfloat.h"
+# include "interpret.h"
+# include "data.h"
+# include "profile.h"
+
+# define PFCHUNK	128		/* # profile nodes allocated at once */
+# define PFNAMESZ	256		/* name hash table size */
+
+/*
+ * A profiled function, with the totals collected from all call paths in
+ * which it occurs.
+ */
+struct pfname : public Hashtab::Entry {
+    unsigned short plen;	/* length of program name */
+    bool active;		/* in a call path being summed up? */
+    Uuint calls;		/* # calls */
+    Uuint ticks;		/* ticks, including called functions */
+    Uuint sticks;		/* ticks spent in function itself */
+    Uuint time;			/* time, including called functions */
+    Uuint stime;		/* time spent in function itself */
+};
+
+/*
+ * A function in a call path.  Functions are identified by their control
+ * block, which is never changed, only replaced.
+ */
+struct pfnode {
+    pfnode *next;		/* next in hash table */
+    pfnode *parent;		/* calling function */
+    pfnode *child;		/* first function called from here */
+    pfnode *sibling;		/* next function called from parent */
+    pfnode *last;		/* function called last from here */
+    Control *ctrl;		/* control block of program */
+    Uint serial;		/* serial number of control block */
+    unsigned short funci;	/* function index */
+    pfname *name;		/* "program:function" */
+    Uuint calls;		/* # calls */
+    Uuint ticks;		/* ticks spent in function itself */
+    Uuint time;			/* time spent in function itself */
+};
+
+static Chunk<pfnode, PFCHUNK> pchunk;	/* profile node chunks */
+static pfnode *ntab[PFHASHSZ];		/* profile node hash table */
+static pfnode *roots;			/* call paths started by the driver */
+static pfnode *rlast;			/* call path started last */
+static Uint nnodes;			/* # profile nodes */
+static Hashtab *names;			/* function names */
+static Uuint lticks;			/* ticks at last call or return */
+static Uuint ltime;			/* time at last call or return */
+static int pflags;			/* PF_TIME, PF_INSTR */
+bool pf_active;				/* profiling? */
+bool pf_instr;				/* counting instructions? */
+Uuint pf_icount[I_INSTR_MASK + 1];	/* instruction counts */
+
+static const char *opnames[I_INSTR_MASK + 1] = {
+    "PUSH_INT1", "PUSH_INT4", "PUSH_LOCAL2", "PUSH_FLOAT6",
+    "PUSH_STRING", "PUSH_FAR_STRING", "PUSH_GLOBAL", "INDEX",
+    "INDEX2", "AGGREGATE", "CAST", "INSTANCEOF",
+    "STORES", "STORE_GLOBAL_INDEX", "CALL_EFUNC", "CALL_CEFUNC",
+    "CALL_CKFUNC", "STORE_LOCAL", "STORE_GLOBAL", "STORE_FAR_GLOBAL",
+    "STORE_INDEX", "STORE_LOCAL_INDEX", "STORE_FAR_GLOBAL_INDEX",
+    "STORE_INDEX_INDEX", "JUMP_ZERO", "JUMP", "CALL_KFUNC", "CALL_AFUNC",
+    "CALL_DFUNC", "CALL_FUNC", "CATCH", "RLIMITS",
+    "PUSH_INT2", (char *) NULL, "PUSH_LOCAL_INT1", (char *) NULL,
+    "PUSH_NEAR_STRING", "PUSH_LOCAL", "PUSH_FAR_GLOBAL", "INDEX_POP",
+    "SPREAD", "AGGREGATE_POP", "CAST_POP", "INSTANCEOF_POP",
+    "INT_KFUNC", "STORE_GLOBAL_INDEX_POP", "CALL_EFUNC_POP",
+    "CALL_CEFUNC_POP", "CALL_CKFUNC_POP", "STORE_LOCAL_POP",
+    "STORE_GLOBAL_POP", "STORE_FAR_GLOBAL_POP", "STORE_INDEX_POP",
+    "STORE_LOCAL_INDEX_POP", "STORE_FAR_GLOBAL_INDEX_POP",
+    "STORE_INDEX_INDEX_POP", "JUMP_NONZERO", "SWITCH", "CALL_KFUNC_POP",
+    "CALL_AFUNC_POP", "CALL_DFUNC_POP", "CALL_FUNC_POP", "CATCH_POP",
+    "RETURN"
+};
+
+/*
+ * NAME:	profile->start()
+ * DESCRIPTION:	clear the collected data and start profiling call paths,
+ *		optionally with their time and with instruction counts
+ */
+void pf_start(int flags)
+{
+    pfnode **n, *p;
+    Hashtab::Entry **t;
+    Uint i;
+
+    /*
+     * Frames of functions that are still running may refer to nodes, so
+     * nodes are reset rather than deleted.
+     */
+    for (i = PFHASHSZ, n = ntab; i != 0; --i, n++) {
+	for (p = *n; p != (pfnode *) NULL; p = p->next) {
+	    p->calls = p->ticks = p->time = 0;
+	}
+    }
+    if (names != (Hashtab *) NULL) {
+	for (i = names->size(), t = names->table(); i != 0; --i, t++) {
+	    pfname *name;
+
+	    for (name = (pfname *) *t; name != (pfname *) NULL;
+		 name = (pfname *) name->next) {
+		name->calls = name->ticks = name->sticks = 0;
+		name->time = name->stime = 0;
+	    }
+	}
+    }
+    memset(pf_icount, '\0', sizeof(pf_icount));
+
+    pflags = flags;
+    lticks = tickcount;
+    if (flags & PF_TIME) {
+	ltime = P_utime();
+    }
+    pf_instr = ((flags & PF_INSTR) != 0);
+    pf_active = TRUE;
+}
+
+/*
+ * NAME:	profile->stop()
+ * DESCRIPTION:	stop profiling, keeping the collected data
+ */
+void pf_stop()
+{
+    pf_active = pf_instr = FALSE;
+}
+
+/*
+ * NAME:	profile->charge()
+ * DESCRIPTION:	charge the ticks and time used since the last call or return
+ *		to a function
+ */
+static void pf_charge(pfnode *node)
+{
+    Uuint ticks, time;
+
+    ticks = tickcount;
+    if (node != (pfnode *) NULL) {
+	node->ticks += ticks - lticks;
+    }
+    lticks = ticks;
+
+    if (pflags & PF_TIME) {
+	/* reading the clock costs more than the rest of a call */
+	time = P_utime();
+	if (node != (pfnode *) NULL) {
+	    node->time += time - ltime;
+	}
+	ltime = time;
+    }
+}
+
+/*
+ * NAME:	profile->name()
+ * DESCRIPTION:	find or add the name of a function
+ */
+static pfname *pf_name(Frame *f)
+{
+    const char *prog;
+    String *func;
+    char *buffer;
+    unsigned int len;
+    pfname **h, *name;
+
+    prog = OBJR(f->p_ctrl->oindex)->name;
+    func = d_get_strconst(f->p_ctrl, f->func->inherit, f->func->index);
+    len = strlen(prog);
+    buffer = ALLOC(char, len + func->len + 2);
+    memcpy(buffer, prog, len);
+    buffer[len] = ':';
+    memcpy(buffer + len + 1, func->text, func->len + 1);
+
+    if (names == (Hashtab *) NULL) {
+	names = Hashtab::create(PFNAMESZ, OBJHASHSZ, FALSE);
+    }
+    h = (pfname **) names->lookup(buffer, FALSE);
+    if (*h != (pfname *) NULL) {
+	FREE(buffer);
+	return *h;
+    }
+
+    name = *h = ALLOC(pfname, 1);
+    name->next = (Hashtab::Entry *) NULL;
+    name->name = buffer;
+    name->plen = len;
+    name->active = FALSE;
+    name->calls = name->ticks = name->sticks = 0;
+    name->time = name->stime = 0;
+    return name;
+}
+
+/*
+ * NAME:	profile->enter()
+ * DESCRIPTION:	a function is called, return its node in the call path
+ */
+pfnode *pf_enter(Frame *prev_f, Frame *f, int funci)
+{
+    pfnode **h, *node, *parent, **last;
+
+    parent = prev_f->prof;
+    pf_charge(parent);
+
+    /* a function usually calls the same function as the last time */
+    last = (parent != (pfnode *) NULL) ? &parent->last : &rlast;
+    node = *last;
+    if (node != (pfnode *) NULL && node->ctrl == f->p_ctrl &&
+	node->serial == f->p_ctrl->serial && node->funci == funci) {
+	node->calls++;
+	return node;
+    }
+
+    h = &ntab[((uintptr_t) parent >> 4 ^ f->p_ctrl->serial ^ funci) %
+	      PFHASHSZ];
+    for (node = *h; node != (pfnode *) NULL; node = node->next) {
+	if (node->parent == parent && node->ctrl == f->p_ctrl &&
+	    node->serial == f->p_ctrl->serial && node->funci == funci) {
+	    node->calls++;
+	    return *last = node;
+	}
+    }
+
+    if (nnodes >= PFNODES) {
+	/* profile full: charge to the caller */
+	return parent;
+    }
+
+    m_static();		/* must survive swapping out */
+    node = pchunk.alloc();
+    node->name = pf_name(f);
+    m_dynamic();
+    node->next = *h;
+    *h = node;
+    node->parent = parent;
+    node->child = (pfnode *) NULL;
+    node->last = (pfnode *) NULL;
+    if (parent != (pfnode *) NULL) {
+	node->sibling = parent->child;
+	parent->child = node;
+    } else {
+	node->sibling = roots;
+	roots = node;
+    }
+    node->ctrl = f->p_ctrl;
+    node->serial = f->p_ctrl->serial;
+    node->funci = funci;
+    node->calls = 1;
+    node->ticks = node->time = 0;
+    nnodes++;
+
+    return *last = node;
+}
+
+/*
+ * NAME:	profile->leave()
+ * DESCRIPTION:	a function returns
+ */
+void pf_leave(Frame *f)
+{
+    if (pf_active) {
+	pf_charge(f->prof);
+    }
+}
+
+/*
+ * NAME:	profile->sum()
+ * DESCRIPTION:	add the totals of a call path to its functions, and return
+ *		the ticks and time including called functions
+ */
+static Uuint pf_sum(pfnode *node, Uuint *time)
+{
+    pfname *name;
+    pfnode *n;
+    Uuint ticks, t;
+    bool outer;
+
+    name = node->name;
+    outer = !name->active;
+    name->active = TRUE;
+
+    ticks = node->ticks;
+    *time = node->time;
+    for (n = node->child; n != (pfnode *) NULL; n = n->sibling) {
+	ticks += pf_sum(n, &t);
+	*time += t;
+    }
+
+    name->calls += node->calls;
+    name->sticks += node->ticks;
+    name->stime += node->time;
+    if (outer) {
+	/* don't count recursive calls twice */
+	name->ticks += ticks;
+	name->time += *time;
+	name->active = FALSE;
+    }
+    return ticks;
+}
+
+/*
+ * NAME:	putval()
+ * DESCRIPTION:	store a count as an integer or as a float approximation
+ */
+static void putval(Value *v, Uuint n)
+{
+    Float f1, f2;
+
+    if (n <= 0x7fffffffL) {
+	PUT_INTVAL(v, n);
+    } else {
+	Float::itof((Int) (n >> 31), &f1);
+	f1.ldexp(31);
+	Float::itof((Int) (n & 0x7fffffffL), &f2);
+	f1.add(f2);
+	PUT_FLTVAL(v, f1);
+    }
+}
+
+/*
+ * NAME:	puttime()
+ * DESCRIPTION:	store a time in microseconds as a float in seconds
+ */
+static void puttime(Value *v, Uuint n)
+{
+    Float f1, f2;
+
+    Float::itof((Int) (n >> 31), &f1);
+    f1.ldexp(31);
+    Float::itof((Int) (n & 0x7fffffffL), &f2);
+    f1.add(f2);
+    f1.mult(thousandth);
+    f1.mult(thousandth);
+    PUT_FLTVAL(v, f1);
+}
+
+/*
+ * NAME:	profile->info()
+ * DESCRIPTION:	return the collected data as ({ functions, instructions }),
+ *		with an array ({ program, function, calls, ticks, self ticks,
+ *		time, self time }) for each profiled function, and a
+ *		mapping from instruction names to counts
+ */
+Array *pf_info(Dataspace *data)
+{
+    pfnode *n;
+    pfname *name;
+    Hashtab::Entry **t;
+    Array *a, *funcs, *instrs;
+    Value *v, *elts;
+    Uint i, size;
+    Uuint time;
+
+    size = 0;
+    if (names != (Hashtab *) NULL) {
+	for (i = names->size(), t = names->table(); i != 0; --i, t++) {
+	    for (name = (pfname *) *t; name != (pfname *) NULL;
+		 name = (pfname *) name->next) {
+		name->calls = name->ticks = name->sticks = 0;
+		name->time = name->stime = 0;
+	    }
+	}
+	for (n = roots; n != (pfnode *) NULL; n = n->sibling) {
+	    pf_sum(n, &time);
+	}
+	for (i = names->size(), t = names->table(); i != 0; --i, t++) {
+	    for (name = (pfname *) *t; name != (pfname *) NULL;
+		 name = (pfname *) name->next) {
+		if (name->calls != 0) {
+		    size++;
+		}
+	    }
+	}
+    }
+
+    a = (Array *) NULL;
+    try {
+	ec_push((ec_ftn) NULL);
+	a = arr_ext_new(data, 2L);
+	PUT_ARRVAL(&a->elts[0], funcs = arr_ext_new(data, (long) size));
+	v = funcs->elts;
+	if (size != 0) {
+	    for (i = names->size(), t = names->table(); i != 0; --i, t++) {
+		for (name = (pfname *) *t; name != (pfname *) NULL;
+		     name = (pfname *) name->next) {
+		    if (name->calls != 0) {
+			PUT_ARRVAL(v, arr_ext_new(data, 7L));
+			elts = v->u.array->elts;
+			PUT_STRVAL(&elts[0], str_new(name->name, name->plen));
+			PUT_STRVAL(&elts[1],
+				   str_new(name->name + name->plen + 1,
+					   strlen(name->name + name->plen + 1)));
+			putval(&elts[2], name->calls);
+			putval(&elts[3], name->ticks);
+			putval(&elts[4], name->sticks);
+			puttime(&elts[5], name->time);
+			puttime(&elts[6], name->stime);
+			v++;
+		    }
+		}
+	    }
+	}
+
+	for (i = size = 0; i <= I_INSTR_MASK; i++) {
+	    if (pf_icount[i] != 0) {
+		size++;
+	    }
+	}
+	PUT_MAPVAL(&a->elts[1], instrs = map_new(data, 2L * size));
+	v = instrs->elts;
+	for (i = 0; i <= I_INSTR_MASK; i++) {
+	    if (pf_icount[i] != 0) {
+		PUT_STRVAL(v, str_new(opnames[i], strlen(opnames[i])));
+		v++;
+		putval(v++, pf_icount[i]);
+	    }
+	}
+	map_sort(instrs);
+	ec_pop();
+    } catch (...) {
+	if (a != (Array *) NULL) {
+	    arr_ref(a);
+	    arr_del(a);
+	}
+	error((char *) NULL);
+    }
+
+    return a;
+}
+
+struct pfdump {
+    int fd;			/* output file */
+    unsigned int size;		/* # bytes in buffer */
+    char buffer[BUF_SIZE];	/* output buffer */
+    char *path;			/* call path */
+    unsigned int pathsz;	/* size of call path buffer */
+};
+
+/*
+ * NAME:	profile->write()
+ * DESCRIPTION:	buffered write to the profile dump file
+ */
+static bool pf_write(pfdump *d, const char *text, unsigned int len)
+{
+    unsigned int n;
+
+    while (d->size + len > BUF_SIZE) {
+	n = BUF_SIZE - d->size;
+	memcpy(d->buffer + d->size, text, n);
+	if (P_write(d->fd, d->buffer, BUF_SIZE) != BUF_SIZE) {
+	    return FALSE;
+	}
+	d->size = 0;
+	text += n;
+	len -= n;
+    }
+    memcpy(d->buffer + d->size, text, len);
+    d->size += len;
+    return TRUE;
+}
+
+/*
+ * NAME:	profile->folded()
+ * DESCRIPTION:	write the call paths starting at a node in folded format,
+ *		one line for each path with its ticks
+ */
+static bool pf_folded(pfdump *d, pfnode *node, unsigned int len)
+{
+    char num[24];
+    unsigned int nlen;
+
+    for ( ; node != (pfnode *) NULL; node = node->sibling) {
+	nlen = strlen(node->name->name);
+	if (len + nlen + 1 > d->pathsz) {
+	    d->path = REALLOC(d->path, char, d->pathsz,
+			      len + nlen + 1 + STRINGSZ);
+	    d->pathsz = len + nlen + 1 + STRINGSZ;
+	}
+	if (len != 0) {
+	    d->path[len - 1] = ';';
+	}
+	memcpy(d->path + len, node->name->name, nlen);
+
+	if (node->ticks != 0) {
+	    sprintf(num, " %llu\n", (unsigned long long) node->ticks);
+	    if (!pf_write(d, d->path, len + nlen) ||
+		!pf_write(d, num, strlen(num))) {
+		return FALSE;
+	    }
+	}
+	if (!pf_folded(d, node->child, len + nlen + 1)) {
+	    return FALSE;
+	}
+    }
+    return TRUE;
+}
+
+/*
+ * NAME:	profile->clear()
+ * DESCRIPTION:	free the call paths and function names, and detach the
+ *		running functions from them
+ */
+static void pf_clear(Frame *f)
+{
+    Hashtab::Entry **t, *e;
+    pfname *name;
+    Uint i;
+
+    for ( ; f != (Frame *) NULL; f = f->prev) {
+	f->prof = (pfnode *) NULL;
+    }
+    memset(ntab, '\0', sizeof(ntab));
+    roots = rlast = (pfnode *) NULL;
+    nnodes = 0;
+    pchunk.clean();
+
+    if (names != (Hashtab *) NULL) {
+	for (i = names->size(), t = names->table(); i != 0; --i, t++) {
+	    for (e = *t; e != (Hashtab::Entry *) NULL; ) {
+		name = (pfname *) e;
+		e = e->next;
+		FREE(name->name);
+		FREE(name);
+	    }
+	}
+	delete names;
+	names = (Hashtab *) NULL;
+    }
+}
+
+/*
+ * NAME:	profile->dump()
+ * DESCRIPTION:	write the call paths to a file in the folded format used by
+ *		flame graph tools, and start over with an empty profile
+ */
+bool pf_dump(Frame *f, char *file)
+{
+    pfdump d;
+    bool ok;
+
+    d.fd = P_open(file, O_CREAT | O_TRUNC | O_WRONLY | O_BINARY, 0664);
+    if (d.fd < 0) {
+	return FALSE;
+    }
+    d.size = 0;
+    d.path = (char *) NULL;
+    d.pathsz = 0;
+
+    ok = pf_folded(&d, roots, 0) &&
+	 (d.size == 0 || P_write(d.fd, d.buffer, d.size) == (int) d.size);
+    if (d.path != (char *) NULL) {
+	FREE(d.path);
+    }
+    P_close(d.fd);
+    pf_clear(f);
+    return ok;
+}
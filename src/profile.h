@@ -0,0 +1,34 @@
+/*
+ * This file is part of DGD, https://github.com/dworkin/dgd
+ * Copyright (C) 1993-2010 Dworkin B.V.
+ * Copyright (C) 2010-2017 DGD Authors (see the commit log for details)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+struct pfnode;
+
+# define PF_TIME	0x02	/* measure time */
+# define PF_INSTR	0x04	/* count instructions */
+
+extern void	pf_start	(int);
+extern void	pf_stop		();
+extern pfnode  *pf_enter	(Frame*, Frame*, int);
+extern void	pf_leave	(Frame*);
+extern Array   *pf_info		(Dataspace*);
+extern bool	pf_dump		(Frame*, char*);
+
+extern bool pf_active;			/* profiling? */
+extern bool pf_instr;			/* counting instructions? */
+extern Uuint pf_icount[];		/* instruction counts */
@@ -150,6 +150,8 @@ static Dataspace *dhead, *dtail;	/* list of dataspace blocks */
 static Dataspace *gcdata;		/* next dataspace to garbage collect */
 static sector nctrl;			/* # control blocks */
 static sector ndata;			/* # dataspace blocks */
+static Uint cserial;			/* control block serial number */
+static Uint igen;			/* inherit cache generation */
 static bool conv_14;			/* convert arrays & strings? */
 static bool converted;			/* conversion complete? */
 
@@ -164,6 +166,7 @@ void d_init()
     dhead = dtail = (Dataspace *) NULL;
     gcdata = (Dataspace *) NULL;
     nctrl = ndata = 0;
+    igen = 1;
     conv_14 = FALSE;
     converted = FALSE;
 }
@@ -185,7 +188,7 @@ Control *d_new_control()
 {
     Control *ctrl;
 
-    ctrl = ALLOC(Control, 1);
+    ctrl = ALLOC_CAT(Control, 1, MC_CONTROL);
     if (chead != (Control *) NULL) {
 	/* insert at beginning of list */
 	chead->prev = ctrl;
@@ -198,6 +201,7 @@ Control *d_new_control()
 	chead = ctail = ctrl;
     }
     ctrl->ndata = 0;
+    ctrl->serial = ++cserial;
     nctrl++;
 
     ctrl->flags = 0;
@@ -214,8 +218,10 @@ Control *d_new_control()
     ctrl->prog = (char *) NULL;
     ctrl->nstrings = 0;
     ctrl->strings = (String **) NULL;
+    ctrl->iprogs = (Control **) NULL;
+    ctrl->strtabs = (String ***) NULL;
+    ctrl->igen = 0;
     ctrl->sslength = (ssizet *) NULL;
-    ctrl->ssindex = (Uint *) NULL;
     ctrl->stext = (char *) NULL;
     ctrl->nfuncdefs = 0;
     ctrl->funcdefs = (dfuncdef *) NULL;
@@ -232,6 +238,8 @@ Control *d_new_control()
     ctrl->vtypes = (char *) NULL;
     ctrl->vmapsize = 0;
     ctrl->vmap = (unsigned short *) NULL;
+    ctrl->jit = FALSE;
+    ctrl->jitfuncs = (voidf **) NULL;
 
     return ctrl;
 }
@@ -244,7 +252,7 @@ static Dataspace *d_alloc_dataspace(Object *obj)
 {
     Dataspace *data;
 
-    data = ALLOC(Dataspace, 1);
+    data = ALLOC_CAT(Dataspace, 1, MC_DATASPACE);
     if (dhead != (Dataspace *) NULL) {
 	/* insert at beginning of list */
 	dhead->prev = data;
@@ -357,12 +365,17 @@ static Control *load_control(Object *obj, void (*readv) (char*, sector*, Uint, U
     /* header */
     (*readv)((char *) &header, &obj->cfirst, (Uint) sizeof(scontrol), (Uint) 0);
     ctrl->nsectors = header.nsectors;
-    ctrl->sectors = ALLOC(sector, header.nsectors);
+    ctrl->sectors = ALLOC_CAT(sector, header.nsectors, MC_CONTROL);
     ctrl->sectors[0] = obj->cfirst;
     size = header.nsectors * (Uint) sizeof(sector);
     if (header.nsectors > 1) {
 	(*readv)((char *) ctrl->sectors, ctrl->sectors, size,
 		 (Uint) sizeof(scontrol));
+	if (readv == sw_readv || readv == sw_dreadv) {
+	    /* the rest of the control block will be needed soon */
+	    sw_prefetchv(ctrl->sectors + 1, header.nsectors - 1,
+			 (readv == sw_dreadv));
+	}
     }
     size += sizeof(scontrol);
 
@@ -377,7 +390,7 @@ static Control *load_control(Object *obj, void (*readv) (char*, sector*, Uint, U
 	 * The load offsets will be invalid (and unused).
 	 */
 	ctrl->vmapsize = header.vmapsize;
-	ctrl->vmap = ALLOC(unsigned short, header.vmapsize);
+	ctrl->vmap = ALLOC_CAT(unsigned short, header.vmapsize, MC_CONTROL);
 	(*readv)((char *) ctrl->vmap, ctrl->sectors,
 		 header.vmapsize * (Uint) sizeof(unsigned short), size);
     } else {
@@ -387,7 +400,7 @@ static Control *load_control(Object *obj, void (*readv) (char*, sector*, Uint, U
 
 	/* load inherits */
 	n = header.ninherits; /* at least one */
-	ctrl->inherits = inherits = ALLOC(dinherit, n);
+	ctrl->inherits = inherits = ALLOC_CAT(dinherit, n, MC_CONTROL);
 	sinherits = ALLOCA(sinherit, n);
 	(*readv)((char *) sinherits, ctrl->sectors, n * (Uint) sizeof(sinherit),
 		 size);
@@ -403,7 +416,7 @@ static Control *load_control(Object *obj, void (*readv) (char*, sector*, Uint, U
 
 	/* load iindices */
 	ctrl->imapsz = header.imapsz;
-	ctrl->imap = ALLOC(char, header.imapsz);
+	ctrl->imap = ALLOC_CAT(char, header.imapsz, MC_CONTROL);
 	(*readv)(ctrl->imap, ctrl->sectors, ctrl->imapsz, size);
 	size += ctrl->imapsz;
     }
@@ -478,12 +491,17 @@ static Dataspace *load_dataspace(Object *obj, void (*readv) (char*, sector*, Uin
     (*readv)((char *) &header, &obj->dfirst, (Uint) sizeof(sdataspace),
 	     (Uint) 0);
     data->nsectors = header.nsectors;
-    data->sectors = ALLOC(sector, header.nsectors);
+    data->sectors = ALLOC_CAT(sector, header.nsectors, MC_DATASPACE);
     data->sectors[0] = obj->dfirst;
     size = header.nsectors * (Uint) sizeof(sector);
     if (header.nsectors > 1) {
 	(*readv)((char *) data->sectors, data->sectors, size,
 		 (Uint) sizeof(sdataspace));
+	if (readv == sw_readv || readv == sw_dreadv) {
+	    /* the rest of the dataspace will be needed soon */
+	    sw_prefetchv(data->sectors + 1, header.nsectors - 1,
+			 (readv == sw_dreadv));
+	}
     }
     size += sizeof(sdataspace);
 
@@ -577,10 +595,10 @@ void d_ref_dataspace(Dataspace *data)
 
 
 /*
- * NAME:	compress()
- * DESCRIPTION:	compress data
+ * NAME:	pred_compress()
+ * DESCRIPTION:	compress data with the 1-byte predictor
  */
-static Uint compress(char *data, char *text, Uint size)
+static Uint pred_compress(char *data, char *text, Uint size)
 {
     char htab[16384];
     unsigned short buf, bufsize, x;
@@ -647,10 +665,11 @@ static Uint compress(char *data, char *text, Uint size)
 }
 
 /*
- * NAME:	decompress()
- * DESCRIPTION:	read and decompress data from the swap file
+ * NAME:	pred_decompress()
+ * DESCRIPTION:	read and decompress predictor compressed data from the swap
+ *		file
  */
-static char *decompress(sector *sectors, void (*readv) (char*, sector*, Uint, Uint), Uint size, Uint offset, Uint *dsize)
+static char *pred_decompress(sector *sectors, void (*readv) (char*, sector*, Uint, Uint), Uint size, Uint offset, Uint *dsize)
 {
     char buffer[8192], htab[16384];
     unsigned short buf, bufsize, x;
@@ -717,6 +736,218 @@ static char *decompress(sector *sectors, void (*readv) (char*, sector*, Uint, Ui
     }
 }
 
+# define LZ_HBITS	12		/* log2 of hash table size */
+# define LZ_HASH(p)	((((Uint) UCHAR((p)[0]) << 24 |			\
+			   (Uint) UCHAR((p)[1]) << 16 |			\
+			   (Uint) UCHAR((p)[2]) << 8 |			\
+			   (Uint) UCHAR((p)[3])) * 2654435761U) >>		\
+			 (32 - LZ_HBITS))
+# define LZ_MINMATCH	4		/* minimum match length */
+# define LZ_MAXOFFSET	0xffff		/* maximum match offset */
+
+/*
+ * NAME:	lz_length()
+ * DESCRIPTION:	# bytes needed to store the extension of a length
+ */
+static Uint lz_length(Uint len)
+{
+    return (len >= 15) ? (len - 15) / 255 + 1 : 0;
+}
+
+/*
+ * NAME:	lz_sequence()
+ * DESCRIPTION:	add literals followed by a match (if any) to compressed data,
+ *		return NULL if there is not enough space
+ */
+static char *lz_sequence(char *q, char *end, char *lit, Uint nlit, Uint offset,
+			 Uint len)
+{
+    Uint n;
+
+    n = 1 + lz_length(nlit) + nlit;
+    if (len != 0) {
+	len -= LZ_MINMATCH;
+	n += 2 + lz_length(len);
+    }
+    if (n > (Uint) (end - q)) {
+	return (char *) NULL;
+    }
+
+    *q++ = ((nlit < 15) ? nlit : 15) << 4 | ((len < 15) ? len : 15);
+    if (nlit >= 15) {
+	for (n = nlit - 15; n >= 255; n -= 255) {
+	    *q++ = (char) 255;
+	}
+	*q++ = n;
+    }
+    memcpy(q, lit, nlit);
+    q += nlit;
+
+    if (offset != 0) {
+	*q++ = offset;
+	*q++ = offset >> 8;
+	if (len >= 15) {
+	    for (n = len - 15; n >= 255; n -= 255) {
+		*q++ = (char) 255;
+	    }
+	    *q++ = n;
+	}
+    }
+    return q;
+}
+
+/*
+ * NAME:	lz_compress()
+ * DESCRIPTION:	compress data with a byte-oriented LZ77 variant: a sequence
+ *		of literals and matches, each with a 4-bit length in a
+ *		token byte, extended with 255-bytes if needed
+ */
+static Uint lz_compress(char *data, char *text, Uint size)
+{
+    Uint htab[1 << LZ_HBITS];
+    Uint i, anchor, ref, len, h;
+    char *q, *end;
+
+    if (size <= 4 + 1) {
+	/* can't get smaller than this */
+	return 0;
+    }
+
+    /* clear the hash table; positions are stored + 1 */
+    memset(htab, '\0', sizeof(htab));
+
+    q = data;
+    *q++ = size >> 24;
+    *q++ = size >> 16;
+    *q++ = size >> 8;
+    *q++ = size;
+    end = data + size - 1;
+
+    i = anchor = 0;
+    while (i + LZ_MINMATCH <= size) {
+	h = LZ_HASH(text + i);
+	ref = htab[h];
+	htab[h] = i + 1;
+	if (ref == 0 || i - --ref > LZ_MAXOFFSET ||
+	    memcmp(text + ref, text + i, LZ_MINMATCH) != 0) {
+	    /* skip faster through incompressible data */
+	    i += 1 + ((i - anchor) >> 6);
+	    continue;
+	}
+
+	/* extend the match */
+	for (len = LZ_MINMATCH;
+	     i + len < size && text[ref + len] == text[i + len]; len++) ;
+	q = lz_sequence(q, end, text + anchor, i - anchor, i - ref, len);
+	if (q == (char *) NULL) {
+	    return 0;	/* out of space */
+	}
+	i += len;
+	anchor = i;
+    }
+
+    if (anchor < size) {
+	/* trailing literals */
+	q = lz_sequence(q, end, text + anchor, size - anchor, 0, 0);
+	if (q == (char *) NULL) {
+	    return 0;	/* compression did not reduce size */
+	}
+    }
+
+    return (intptr_t) q - (intptr_t) data;
+}
+
+/*
+ * NAME:	lz_decompress()
+ * DESCRIPTION:	read and decompress LZ compressed data from the swap file
+ */
+static char *lz_decompress(sector *sectors, void (*readv) (char*, sector*, Uint, Uint), Uint size, Uint offset, Uint *dsize)
+{
+    char *buffer, *p, *q, *r, *end;
+    Uint len, n;
+    int token;
+
+    buffer = ALLOC(char, size);
+    (*readv)(p = buffer, sectors, size, offset);
+    *dsize = (UCHAR(p[0]) << 24) | (UCHAR(p[1]) << 16) | (UCHAR(p[2]) << 8) |
+	     UCHAR(p[3]);
+    q = ALLOC(char, *dsize);
+    end = q + *dsize;
+    p += 4;
+
+    while (q < end) {
+	/* literals */
+	token = UCHAR(*p++);
+	len = token >> 4;
+	if (len == 15) {
+	    do {
+		len += n = UCHAR(*p++);
+	    } while (n == 255);
+	}
+	memcpy(q, p, len);
+	q += len;
+	p += len;
+	if (q == end) {
+	    break;
+	}
+
+	/* match */
+	r = q - (UCHAR(p[0]) | (UCHAR(p[1]) << 8));
+	p += 2;
+	len = token & 15;
+	if (len == 15) {
+	    do {
+		len += n = UCHAR(*p++);
+	    } while (n == 255);
+	}
+	len += LZ_MINMATCH;
+	do {
+	    *q++ = *r++;	/* may overlap */
+	} while (--len != 0);
+    }
+
+    FREE(buffer);
+    return q - *dsize;
+}
+
+/*
+ * NAME:	compress()
+ * DESCRIPTION:	compress data, return the size of the compressed data or 0 if
+ *		it could not be reduced in size
+ */
+static Uint compress(int type, char *data, char *text, Uint size)
+{
+    switch (type) {
+    case CMP_PRED:
+	return pred_compress(data, text, size);
+
+    case CMP_LZ:
+	return lz_compress(data, text, size);
+
+    default:
+	return 0;
+    }
+}
+
+/*
+ * NAME:	decompress()
+ * DESCRIPTION:	read and decompress data from the swap file
+ */
+static char *decompress(int type, sector *sectors, void (*readv) (char*, sector*, Uint, Uint), Uint size, Uint offset, Uint *dsize)
+{
+    switch (type) {
+    case CMP_PRED:
+	return pred_decompress(sectors, readv, size, offset, dsize);
+
+    case CMP_LZ:
+	return lz_decompress(sectors, readv, size, offset, dsize);
+
+    default:
+	fatal("unknown compression type %d", type);
+	return (char *) NULL;
+    }
+}
+
 
 /*
  * NAME:	get_prog()
@@ -726,10 +957,11 @@ static void get_prog(Control *ctrl, void (*readv) (char*, sector*, Uint, Uint))
 {
     if (ctrl->progsize != 0) {
 	if (ctrl->flags & CTRL_PROGCMP) {
-	    ctrl->prog = decompress(ctrl->sectors, readv, ctrl->progsize,
-				    ctrl->progoffset, &ctrl->progsize);
+	    ctrl->prog = decompress(ctrl->flags & CTRL_PROGCMP, ctrl->sectors,
+				    readv, ctrl->progsize, ctrl->progoffset,
+				    &ctrl->progsize);
 	} else {
-	    ctrl->prog = ALLOC(char, ctrl->progsize);
+	    ctrl->prog = ALLOC_CAT(char, ctrl->progsize, MC_CONTROL);
 	    (*readv)(ctrl->prog, ctrl->sectors, ctrl->progsize,
 		     ctrl->progoffset);
 	}
@@ -756,13 +988,13 @@ static void get_stext(Control *ctrl, void (*readv) (char*, sector*, Uint, Uint))
 {
     /* load strings text */
     if (ctrl->flags & CTRL_STRCMP) {
-	ctrl->stext = decompress(ctrl->sectors, readv,
-				 ctrl->strsize,
+	ctrl->stext = decompress((ctrl->flags & CTRL_STRCMP) >> 2,
+				 ctrl->sectors, readv, ctrl->strsize,
 				 ctrl->stroffset +
 				 ctrl->nstrings * sizeof(ssizet),
 				 &ctrl->strsize);
     } else {
-	ctrl->stext = ALLOC(char, ctrl->strsize);
+	ctrl->stext = ALLOC_CAT(char, ctrl->strsize, MC_CONTROL);
 	(*readv)(ctrl->stext, ctrl->sectors, ctrl->strsize,
 		 ctrl->stroffset + ctrl->nstrings * (Uint) sizeof(ssizet));
     }
@@ -776,7 +1008,7 @@ static void get_strconsts(Control *ctrl, void (*readv) (char*, sector*, Uint, Ui
 {
     if (ctrl->nstrings != 0) {
 	/* load strings */
-	ctrl->sslength = ALLOC(ssizet, ctrl->nstrings);
+	ctrl->sslength = ALLOC_CAT(ssizet, ctrl->nstrings, MC_CONTROL);
 	(*readv)((char *) ctrl->sslength, ctrl->sectors,
 		 ctrl->nstrings * (Uint) sizeof(ssizet), ctrl->stroffset);
 	if (ctrl->strsize > 0 && ctrl->stext == (char *) NULL) {
@@ -786,45 +1018,98 @@ static void get_strconsts(Control *ctrl, void (*readv) (char*, sector*, Uint, Ui
 }
 
 /*
- * NAME:	data->get_strconst()
- * DESCRIPTION:	get a string constant
+ * NAME:	data->get_strings()
+ * DESCRIPTION:	get the string table of a control block, with all string
+ *		constants materialized
  */
-String *d_get_strconst(Control *ctrl, int inherit, Uint idx)
+String **d_get_strings(Control *ctrl)
 {
-    if (UCHAR(inherit) < ctrl->ninherits - 1) {
-	/* get the proper control block */
-	ctrl = o_control(OBJR(ctrl->inherits[UCHAR(inherit)].oindex));
-    }
-
-    if (ctrl->strings == (String **) NULL) {
-	/* make string pointer block */
-	ctrl->strings = ALLOC(String*, ctrl->nstrings);
-	memset(ctrl->strings, '\0', ctrl->nstrings * sizeof(String *));
+    if (ctrl->strings == (String **) NULL && ctrl->nstrings != 0) {
+	String **strs;
+	ssizet *l;
+	char *text;
+	unsigned short i;
 
 	if (ctrl->sslength == (ssizet *) NULL) {
 	    get_strconsts(ctrl, sw_readv);
 	}
-	if (ctrl->ssindex == (Uint *) NULL) {
-	    Uint size;
-	    unsigned short i;
 
-	    ctrl->ssindex = ALLOC(Uint, ctrl->nstrings);
-	    for (size = 0, i = 0; i < ctrl->nstrings; i++) {
-		ctrl->ssindex[i] = size;
-		size += ctrl->sslength[i];
-	    }
+	/* make string pointer block */
+	strs = ctrl->strings = ALLOC_CAT(String*, ctrl->nstrings, MC_CONTROL);
+	l = ctrl->sslength;
+	text = ctrl->stext;
+	for (i = ctrl->nstrings; i > 0; --i) {
+	    str_ref(*strs++ = str_alloc(text, (long) *l));
+	    text += *l++;
 	}
     }
 
-    if (ctrl->strings[idx] == (String *) NULL) {
-	String *str;
+    return ctrl->strings;
+}
+
+/*
+ * NAME:	get_inherits()
+ * DESCRIPTION:	cache the control blocks and string tables of all programs
+ *		inherited by a control block, valid until the end of the task
+ *		or until a control block is freed
+ */
+static void get_inherits(Control *ctrl)
+{
+    Control **iprogs;
+    String ***strtabs;
+    dinherit *inh;
+    int i;
 
-	str = str_alloc(ctrl->stext + ctrl->ssindex[idx],
-			(long) ctrl->sslength[idx]);
-	str_ref(ctrl->strings[idx] = str);
+    if (ctrl->iprogs == (Control **) NULL) {
+	ctrl->iprogs = ALLOC_CAT(Control*, ctrl->ninherits, MC_CONTROL);
+	ctrl->strtabs = ALLOC_CAT(String**, ctrl->ninherits, MC_CONTROL);
+    }
+    iprogs = ctrl->iprogs;
+    strtabs = ctrl->strtabs;
+    for (i = ctrl->ninherits - 1, inh = ctrl->inherits; i > 0; --i, inh++) {
+	*strtabs++ = d_get_strings(*iprogs++ = o_control(OBJR(inh->oindex)));
+    }
+    *iprogs = o_control(OBJR(inh->oindex));
+    *strtabs = d_get_strings(ctrl);
+    ctrl->igen = igen;
+}
+
+/*
+ * NAME:	data->get_iprogs()
+ * DESCRIPTION:	get the control blocks of all inherited programs
+ */
+Control **d_get_iprogs(Control *ctrl)
+{
+    if (ctrl->igen != igen) {
+	get_inherits(ctrl);
     }
+    return ctrl->iprogs;
+}
 
-    return ctrl->strings[idx];
+/*
+ * NAME:	data->get_strtabs()
+ * DESCRIPTION:	get the string tables of all inherited programs
+ */
+String ***d_get_strtabs(Control *ctrl)
+{
+    if (ctrl->igen != igen) {
+	get_inherits(ctrl);
+    }
+    return ctrl->strtabs;
+}
+
+/*
+ * NAME:	data->get_strconst()
+ * DESCRIPTION:	get a string constant
+ */
+String *d_get_strconst(Control *ctrl, int inherit, Uint idx)
+{
+    if (UCHAR(inherit) < ctrl->ninherits - 1) {
+	/* get the proper control block */
+	ctrl = o_control(OBJR(ctrl->inherits[UCHAR(inherit)].oindex));
+    }
+
+    return d_get_strings(ctrl)[idx];
 }
 
 /*
@@ -834,7 +1119,7 @@ String *d_get_strconst(Control *ctrl, int inherit, Uint idx)
 static void get_funcdefs(Control *ctrl, void (*readv) (char*, sector*, Uint, Uint))
 {
     if (ctrl->nfuncdefs != 0) {
-	ctrl->funcdefs = ALLOC(dfuncdef, ctrl->nfuncdefs);
+	ctrl->funcdefs = ALLOC_CAT(dfuncdef, ctrl->nfuncdefs, MC_CONTROL);
 	(*readv)((char *) ctrl->funcdefs, ctrl->sectors,
 		 ctrl->nfuncdefs * (Uint) sizeof(dfuncdef), ctrl->funcdoffset);
     }
@@ -859,11 +1144,12 @@ dfuncdef *d_get_funcdefs(Control *ctrl)
 static void get_vardefs(Control *ctrl, void (*readv) (char*, sector*, Uint, Uint))
 {
     if (ctrl->nvardefs != 0) {
-	ctrl->vardefs = ALLOC(dvardef, ctrl->nvardefs);
+	ctrl->vardefs = ALLOC_CAT(dvardef, ctrl->nvardefs, MC_CONTROL);
 	(*readv)((char *) ctrl->vardefs, ctrl->sectors,
 		 ctrl->nvardefs * (Uint) sizeof(dvardef), ctrl->vardoffset);
 	if (ctrl->nclassvars != 0) {
-	    ctrl->classvars = ALLOC(char, ctrl->nclassvars * 3);
+	    ctrl->classvars = ALLOC_CAT(char, ctrl->nclassvars * 3,
+					MC_CONTROL);
 	    (*readv)(ctrl->classvars, ctrl->sectors, ctrl->nclassvars * 3,
 		     ctrl->vardoffset + ctrl->nvardefs * sizeof(dvardef));
 	}
@@ -885,7 +1171,8 @@ dvardef *d_get_vardefs(Control *ctrl)
 	String **strs;
 	unsigned short n, inherit, u;
 
-	ctrl->cvstrings = strs = ALLOC(String*, ctrl->nvardefs);
+	ctrl->cvstrings = strs = ALLOC_CAT(String*, ctrl->nvardefs,
+					   MC_CONTROL);
 	memset(strs, '\0', ctrl->nvardefs * sizeof(String*));
 	p = ctrl->classvars;
 	for (n = ctrl->nclassvars, vars = ctrl->vardefs; n != 0; vars++) {
@@ -907,7 +1194,7 @@ dvardef *d_get_vardefs(Control *ctrl)
 static void get_funcalls(Control *ctrl, void (*readv) (char*, sector*, Uint, Uint))
 {
     if (ctrl->nfuncalls != 0) {
-	ctrl->funcalls = ALLOC(char, 2L * ctrl->nfuncalls);
+	ctrl->funcalls = ALLOC_CAT(char, 2L * ctrl->nfuncalls, MC_CONTROL);
 	(*readv)((char *) ctrl->funcalls, ctrl->sectors,
 		 ctrl->nfuncalls * (Uint) 2, ctrl->funccoffset);
     }
@@ -932,7 +1219,7 @@ char *d_get_funcalls(Control *ctrl)
 static void get_symbols(Control *ctrl, void (*readv) (char*, sector*, Uint, Uint))
 {
     if (ctrl->nsymbols > 0) {
-	ctrl->symbols = ALLOC(dsymbol, ctrl->nsymbols);
+	ctrl->symbols = ALLOC_CAT(dsymbol, ctrl->nsymbols, MC_CONTROL);
 	(*readv)((char *) ctrl->symbols, ctrl->sectors,
 		 ctrl->nsymbols * (Uint) sizeof(dsymbol), ctrl->symboffset);
     }
@@ -957,7 +1244,8 @@ dsymbol *d_get_symbols(Control *ctrl)
 static void get_vtypes(Control *ctrl, void (*readv) (char*, sector*, Uint, Uint))
 {
     if (ctrl->nvariables > ctrl->nvardefs) {
-	ctrl->vtypes = ALLOC(char, ctrl->nvariables - ctrl->nvardefs);
+	ctrl->vtypes = ALLOC_CAT(char, ctrl->nvariables - ctrl->nvardefs,
+				 MC_CONTROL);
 	(*readv)(ctrl->vtypes, ctrl->sectors, ctrl->nvariables - ctrl->nvardefs,
 		 ctrl->vtypeoffset);
     }
@@ -1012,18 +1300,19 @@ static void get_strings(Dataspace *data, void (*readv) (char*, sector*, Uint, Ui
 {
     if (data->nstrings != 0) {
 	/* load strings */
-	data->sstrings = ALLOC(sstring, data->nstrings);
+	data->sstrings = ALLOC_CAT(sstring, data->nstrings, MC_DATASPACE);
 	(*readv)((char *) data->sstrings, data->sectors,
 		 data->nstrings * sizeof(sstring), data->stroffset);
 	if (data->strsize > 0) {
 	    /* load strings text */
 	    if (data->flags & DATA_STRCMP) {
-		data->stext = decompress(data->sectors, readv, data->strsize,
+		data->stext = decompress(data->flags & DATA_STRCMP,
+					 data->sectors, readv, data->strsize,
 					 data->stroffset +
 					       data->nstrings * sizeof(sstring),
 					 &data->strsize);
 	    } else {
-		data->stext = ALLOC(char, data->strsize);
+		data->stext = ALLOC_CAT(char, data->strsize, MC_DATASPACE);
 		(*readv)(data->stext, data->sectors, data->strsize,
 			 data->stroffset + data->nstrings * sizeof(sstring));
 	    }
@@ -1050,7 +1339,7 @@ static String *d_get_string(Dataspace *data, Uint idx)
 	if (data->ssindex == (Uint *) NULL) {
 	    Uint size;
 
-	    data->ssindex = ALLOC(Uint, data->nstrings);
+	    data->ssindex = ALLOC_CAT(Uint, data->nstrings, MC_DATASPACE);
 	    for (size = 0, i = 0; i < data->nstrings; i++) {
 		data->ssindex[i] = size;
 		size += data->sstrings[i].len;
@@ -1065,7 +1354,8 @@ static String *d_get_string(Dataspace *data, Uint idx)
 	do {
 	    if (p->strings == (strref *) NULL) {
 		/* initialize string pointers */
-		s = p->strings = ALLOC(strref, data->nstrings);
+		s = p->strings = ALLOC_CAT(strref, data->nstrings,
+					   MC_DATASPACE);
 		for (i = data->nstrings; i > 0; --i) {
 		    (s++)->str = (String *) NULL;
 		}
@@ -1091,7 +1381,7 @@ static void get_arrays(Dataspace *data, void (*readv) (char*, sector*, Uint, Uin
 {
     if (data->narrays != 0) {
 	/* load arrays */
-	data->sarrays = ALLOC(sarray, data->narrays);
+	data->sarrays = ALLOC_CAT(sarray, data->narrays, MC_DATASPACE);
 	(*readv)((char *) data->sarrays, data->sectors,
 		 data->narrays * (Uint) sizeof(sarray), data->arroffset);
     }
@@ -1123,7 +1413,7 @@ static Array *d_get_array(Dataspace *data, Uint idx)
 	do {
 	    if (p->arrays == (arrref *) NULL) {
 		/* create array pointers */
-		a = p->arrays = ALLOC(arrref, data->narrays);
+		a = p->arrays = ALLOC_CAT(arrref, data->narrays, MC_DATASPACE);
 		for (i = data->narrays; i > 0; --i) {
 		    (a++)->arr = (Array *) NULL;
 		}
@@ -1218,7 +1508,7 @@ void d_new_variables(Control *ctrl, Value *val)
  */
 static void get_variables(Dataspace *data, void (*readv) (char*, sector*, Uint, Uint))
 {
-    data->svariables = ALLOC(svalue, data->nvariables);
+    data->svariables = ALLOC_CAT(svalue, data->nvariables, MC_DATASPACE);
     (*readv)((char *) data->svariables, data->sectors,
 	     data->nvariables * (Uint) sizeof(svalue), data->varoffset);
 }
@@ -1231,7 +1521,7 @@ Value *d_get_variable(Dataspace *data, unsigned int idx)
 {
     if (data->variables == (Value *) NULL) {
 	/* create room for variables */
-	data->variables = ALLOC(Value, data->nvariables);
+	data->variables = ALLOC_CAT(Value, data->nvariables, MC_DATASPACE);
 	if (data->nsectors == 0 && data->svariables == (svalue *) NULL) {
 	    /* new datablock */
 	    d_new_variables(data->ctrl, data->variables);
@@ -1260,7 +1550,8 @@ static void get_elts(Dataspace *data, void (*readv) (char*, sector*, Uint, Uint)
 {
     if (data->eltsize != 0) {
 	/* load array elements */
-	data->selts = (svalue *) ALLOC(svalue, data->eltsize);
+	data->selts = (svalue *) ALLOC_CAT(svalue, data->eltsize,
+					   MC_DATASPACE);
 	(*readv)((char *) data->selts, data->sectors,
 		 data->eltsize * sizeof(svalue),
 		 data->arroffset + data->narrays * sizeof(sarray));
@@ -1287,14 +1578,14 @@ Value *d_get_elts(Array *arr)
 	if (data->saindex == (Uint *) NULL) {
 	    Uint size;
 
-	    data->saindex = ALLOC(Uint, data->narrays);
+	    data->saindex = ALLOC_CAT(Uint, data->narrays, MC_DATASPACE);
 	    for (size = 0, idx = 0; idx < data->narrays; idx++) {
 		data->saindex[idx] = size;
 		size += data->sarrays[idx].size;
 	    }
 	}
 
-	v = arr->elts = ALLOC(Value, arr->size);
+	v = arr->elts = ALLOC_CAT(Value, arr->size, MC_ARRAY);
 	idx = data->saindex[arr->primary - data->plane->arrays];
 	d_get_values(data, &data->selts[idx], v, arr->size);
     }
@@ -1309,7 +1600,7 @@ Value *d_get_elts(Array *arr)
 static void get_callouts(Dataspace *data, void (*readv) (char*, sector*, Uint, Uint))
 {
     if (data->ncallouts != 0) {
-	data->scallouts = ALLOC(scallout, data->ncallouts);
+	data->scallouts = ALLOC_CAT(scallout, data->ncallouts, MC_DATASPACE);
 	(*readv)((char *) data->scallouts, data->sectors,
 		 data->ncallouts * (Uint) sizeof(scallout), data->cooffset);
     }
@@ -1329,7 +1620,7 @@ void d_get_callouts(Dataspace *data)
 	get_callouts(data, sw_readv);
     }
     sco = data->scallouts;
-    co = data->callouts = ALLOC(dcallout, data->ncallouts);
+    co = data->callouts = ALLOC_CAT(dcallout, data->ncallouts, MC_DATASPACE);
 
     for (n = data->ncallouts; n > 0; --n) {
 	co->time = sco->time;
@@ -1421,9 +1712,9 @@ static void d_save_control(Control *ctrl)
 	prog = ctrl->prog;
 	if (header.progsize >= CMPLIMIT) {
 	    prog = ALLOC(char, header.progsize);
-	    size = compress(prog, ctrl->prog, header.progsize);
+	    size = compress(CMPMETHOD, prog, ctrl->prog, header.progsize);
 	    if (size != 0) {
-		header.flags |= CMP_PRED;
+		header.flags |= CMPMETHOD;
 		header.progsize = size;
 	    } else {
 		FREE(prog);
@@ -1458,9 +1749,9 @@ static void d_save_control(Control *ctrl)
 	text = stext;
 	if (header.strsize >= CMPLIMIT) {
 	    text = ALLOC(char, header.strsize);
-	    size = compress(text, stext, header.strsize);
+	    size = compress(CMPMETHOD, text, stext, header.strsize);
 	    if (size != 0) {
-		header.flags |= CMP_PRED << 2;
+		header.flags |= CMPMETHOD << 2;
 		header.strsize = size;
 	    } else {
 		FREE(text);
@@ -2036,7 +2327,8 @@ static bool d_save_dataspace(Dataspace *data, bool swap)
 
 	d_get_variable(data, 0);
 	if (data->svariables == (svalue *) NULL) {
-	    data->svariables = ALLOC(svalue, data->nvariables);
+	    data->svariables = ALLOC_CAT(svalue, data->nvariables,
+					 MC_DATASPACE);
 	}
 	d_count(&save, data->variables, data->nvariables);
 
@@ -2158,9 +2450,9 @@ static bool d_save_dataspace(Dataspace *data, bool swap)
 	    text = save.stext;
 	    if (header.strsize >= CMPLIMIT) {
 		text = ALLOC(char, header.strsize);
-		size = compress(text, save.stext, header.strsize);
+		size = compress(CMPMETHOD, text, save.stext, header.strsize);
 		if (size != 0) {
-		    header.flags |= CMP_PRED;
+		    header.flags |= CMPMETHOD;
 		    header.strsize = size;
 		} else {
 		    FREE(text);
@@ -2270,6 +2562,11 @@ sector d_swapout(unsigned int frag)
 
     count = 0;
 
+    /* upgrades may have replaced inherited control blocks */
+    if (++igen == 0) {
+	igen = 1;
+    }
+
     if (frag != 0) {
 	/* swap out dataspace blocks */
 	data = dtail;
@@ -2400,16 +2697,21 @@ static Control *d_conv_control(Object *obj,
     ctrl->vmapsize = header.vmapsize;
 
     /* sectors */
-    ctrl->sectors = ALLOC(sector, ctrl->nsectors = header.nsectors);
+    ctrl->sectors = ALLOC_CAT(sector, ctrl->nsectors = header.nsectors,
+			      MC_CONTROL);
     ctrl->sectors[0] = obj->cfirst;
     for (n = 0; n < header.nsectors; n++) {
 	size += d_conv((char *) (ctrl->sectors + n), ctrl->sectors, "d",
 		       (Uint) 1, size, readv);
     }
+    if (readv == sw_conv && header.nsectors > 1) {
+	/* read the rest in the background while converting */
+	sw_prefetchv(ctrl->sectors + 1, header.nsectors - 1, TRUE);
+    }
 
     if (header.vmapsize != 0) {
 	/* only vmap */
-	ctrl->vmap = ALLOC(unsigned short, header.vmapsize);
+	ctrl->vmap = ALLOC_CAT(unsigned short, header.vmapsize, MC_CONTROL);
 	d_conv((char *) ctrl->vmap, ctrl->sectors, "s", (Uint) header.vmapsize,
 	       size, readv);
     } else {
@@ -2418,7 +2720,7 @@ static Control *d_conv_control(Object *obj,
 
 	/* inherits */
 	n = header.ninherits; /* at least one */
-	ctrl->inherits = inherits = ALLOC(dinherit, n);
+	ctrl->inherits = inherits = ALLOC_CAT(dinherit, n, MC_CONTROL);
 
 	sinherits = ALLOCA(sinherit, n);
 	size += d_conv((char *) sinherits, ctrl->sectors, si_layout, (Uint) n,
@@ -2432,17 +2734,18 @@ static Control *d_conv_control(Object *obj,
 	} while (--n > 0);
 	AFREE(sinherits - header.ninherits);
 
-	ctrl->imap = ALLOC(char, header.imapsz);
+	ctrl->imap = ALLOC_CAT(char, header.imapsz, MC_CONTROL);
 	(*readv)(ctrl->imap, ctrl->sectors, header.imapsz, size);
 	size += header.imapsz;
 
 	if (header.progsize != 0) {
 	    /* program */
 	    if (header.flags & CMP_TYPE) {
-		ctrl->prog = decompress(ctrl->sectors, readv, header.progsize,
-					size, &ctrl->progsize);
+		ctrl->prog = decompress(header.flags & CMP_TYPE, ctrl->sectors,
+					readv, header.progsize, size,
+					&ctrl->progsize);
 	    } else {
-		ctrl->prog = ALLOC(char, header.progsize);
+		ctrl->prog = ALLOC_CAT(char, header.progsize, MC_CONTROL);
 		(*readv)(ctrl->prog, ctrl->sectors, header.progsize, size);
 	    }
 	    size += header.progsize;
@@ -2450,7 +2753,7 @@ static Control *d_conv_control(Object *obj,
 
 	if (header.nstrings != 0) {
 	    /* strings */
-	    ctrl->sslength = ALLOC(ssizet, header.nstrings);
+	    ctrl->sslength = ALLOC_CAT(ssizet, header.nstrings, MC_CONTROL);
 	    if (conv_14) {
 		dstrconst0 *sstrings;
 		unsigned short i;
@@ -2468,11 +2771,12 @@ static Control *d_conv_control(Object *obj,
 	    }
 	    if (header.strsize != 0) {
 		if (header.flags & (CMP_TYPE << 2)) {
-		    ctrl->stext = decompress(ctrl->sectors, readv,
+		    ctrl->stext = decompress((header.flags >> 2) & CMP_TYPE,
+					     ctrl->sectors, readv,
 					     header.strsize, size,
 					     &ctrl->strsize);
 		} else {
-		    ctrl->stext = ALLOC(char, header.strsize);
+		    ctrl->stext = ALLOC_CAT(char, header.strsize, MC_CONTROL);
 		    (*readv)(ctrl->stext, ctrl->sectors, header.strsize, size);
 		}
 		size += header.strsize;
@@ -2481,18 +2785,21 @@ static Control *d_conv_control(Object *obj,
 
 	if (header.nfuncdefs != 0) {
 	    /* function definitions */
-	    ctrl->funcdefs = ALLOC(dfuncdef, UCHAR(header.nfuncdefs));
+	    ctrl->funcdefs = ALLOC_CAT(dfuncdef, UCHAR(header.nfuncdefs),
+				       MC_CONTROL);
 	    size += d_conv((char *) ctrl->funcdefs, ctrl->sectors, DF_LAYOUT,
 			   (Uint) UCHAR(header.nfuncdefs), size, readv);
 	}
 
 	if (header.nvardefs != 0) {
 	    /* variable definitions */
-	    ctrl->vardefs = ALLOC(dvardef, UCHAR(header.nvardefs));
+	    ctrl->vardefs = ALLOC_CAT(dvardef, UCHAR(header.nvardefs),
+				      MC_CONTROL);
 	    size += d_conv((char *) ctrl->vardefs, ctrl->sectors, DV_LAYOUT,
 			   (Uint) UCHAR(header.nvardefs), size, readv);
 	    if (ctrl->nclassvars != 0) {
-		ctrl->classvars = ALLOC(char, ctrl->nclassvars * 3);
+		ctrl->classvars = ALLOC_CAT(char, ctrl->nclassvars * 3,
+					    MC_CONTROL);
 		(*readv)(ctrl->classvars, ctrl->sectors,
 			 ctrl->nclassvars * (Uint) 3, size);
 		size += ctrl->nclassvars * (Uint) 3;
@@ -2501,7 +2808,7 @@ static Control *d_conv_control(Object *obj,
 
 	if (header.nfuncalls != 0) {
 	    /* function calls */
-	    ctrl->funcalls = ALLOC(char, 2 * header.nfuncalls);
+	    ctrl->funcalls = ALLOC_CAT(char, 2 * header.nfuncalls, MC_CONTROL);
 	    (*readv)(ctrl->funcalls, ctrl->sectors, header.nfuncalls * (Uint) 2,
 		     size);
 	    size += header.nfuncalls * (Uint) 2;
@@ -2509,15 +2816,15 @@ static Control *d_conv_control(Object *obj,
 
 	if (header.nsymbols != 0) {
 	    /* symbol table */
-	    ctrl->symbols = ALLOC(dsymbol, header.nsymbols);
+	    ctrl->symbols = ALLOC_CAT(dsymbol, header.nsymbols, MC_CONTROL);
 	    size += d_conv((char *) ctrl->symbols, ctrl->sectors, DSYM_LAYOUT,
 			   (Uint) header.nsymbols, size, readv);
 	}
 
 	if (header.nvariables > UCHAR(header.nvardefs)) {
 	    /* variable types */
-	    ctrl->vtypes = ALLOC(char, header.nvariables -
-				       UCHAR(header.nvardefs));
+	    ctrl->vtypes = ALLOC_CAT(char, header.nvariables -
+				       UCHAR(header.nvardefs), MC_CONTROL);
 	    (*readv)(ctrl->vtypes, ctrl->sectors,
 		     header.nvariables - UCHAR(header.nvardefs), size);
 	}
@@ -2640,21 +2947,26 @@ static Dataspace *d_conv_dataspace(Object *obj, Uint *counttab,
     data->fcallouts = header.fcallouts;
 
     /* sectors */
-    data->sectors = ALLOC(sector, data->nsectors = header.nsectors);
+    data->sectors = ALLOC_CAT(sector, data->nsectors = header.nsectors,
+			      MC_DATASPACE);
     data->sectors[0] = obj->dfirst;
     for (n = 0; n < header.nsectors; n++) {
 	size += d_conv((char *) (data->sectors + n), data->sectors, "d",
 		       (Uint) 1, size, readv);
     }
+    if (readv == sw_conv && header.nsectors > 1) {
+	/* read the rest in the background while converting */
+	sw_prefetchv(data->sectors + 1, header.nsectors - 1, TRUE);
+    }
 
     /* variables */
-    data->svariables = ALLOC(svalue, header.nvariables);
+    data->svariables = ALLOC_CAT(svalue, header.nvariables, MC_DATASPACE);
     size += d_conv((char *) data->svariables, data->sectors, sv_layout,
 		   (Uint) header.nvariables, size, readv);
 
     if (header.narrays != 0) {
 	/* arrays */
-	data->sarrays = ALLOC(sarray, header.narrays);
+	data->sarrays = ALLOC_CAT(sarray, header.narrays, MC_DATASPACE);
 	if (conv_14) {
 	    size += d_conv_sarray1(data->sarrays, data->sectors,
 				   header.narrays, size);
@@ -2663,7 +2975,7 @@ static Dataspace *d_conv_dataspace(Object *obj, Uint *counttab,
 			   header.narrays, size, readv);
 	}
 	if (header.eltsize != 0) {
-	    data->selts = ALLOC(svalue, header.eltsize);
+	    data->selts = ALLOC_CAT(svalue, header.eltsize, MC_DATASPACE);
 	    size += d_conv((char *) data->selts, data->sectors, sv_layout,
 			   header.eltsize, size, readv);
 	}
@@ -2671,7 +2983,7 @@ static Dataspace *d_conv_dataspace(Object *obj, Uint *counttab,
 
     if (header.nstrings != 0) {
 	/* strings */
-	data->sstrings = ALLOC(sstring, header.nstrings);
+	data->sstrings = ALLOC_CAT(sstring, header.nstrings, MC_DATASPACE);
 	if (conv_14) {
 	    size += d_conv_sstring0(data->sstrings, data->sectors,
 				    (Uint) header.nstrings, size);
@@ -2681,10 +2993,11 @@ static Dataspace *d_conv_dataspace(Object *obj, Uint *counttab,
 	}
 	if (header.strsize != 0) {
 	    if (header.flags & CMP_TYPE) {
-		data->stext = decompress(data->sectors, readv, header.strsize,
+		data->stext = decompress(header.flags & CMP_TYPE,
+					 data->sectors, readv, header.strsize,
 					 size, &data->strsize);
 	    } else {
-		data->stext = ALLOC(char, header.strsize);
+		data->stext = ALLOC_CAT(char, header.strsize, MC_DATASPACE);
 		(*readv)(data->stext, data->sectors, header.strsize, size);
 	    }
 	    size += header.strsize;
@@ -2697,7 +3010,8 @@ static Dataspace *d_conv_dataspace(Object *obj, Uint *counttab,
 
 	/* callouts */
 	co_time(&dummy);
-	sco = data->scallouts = ALLOC(scallout, header.ncallouts);
+	sco = data->scallouts = ALLOC_CAT(scallout, header.ncallouts,
+					  MC_DATASPACE);
 	d_conv((char *) data->scallouts, data->sectors, sco_layout,
 	       (Uint) header.ncallouts, size, readv);
     }
@@ -2778,14 +3092,18 @@ Dataspace *d_restore_data(Object *obj, Uint *counttab,
 
 /*
  * NAME:	data->restore_obj()
- * DESCRIPTION:	restore an object
+ * DESCRIPTION:	restore an object from the snapshot or secondary snapshot
  */
-void d_restore_obj(Object *obj, Uint *counttab, bool cactive, bool dactive)
+void d_restore_obj(Object *obj, Uint *counttab, bool cactive, bool dactive,
+		   bool secondary)
 {
     Control *ctrl;
     Dataspace *data;
 
-    if (!converted) {
+    if (secondary) {
+	ctrl = d_restore_ctrl(obj, sw_conv2);
+	data = d_restore_data(obj, counttab, sw_conv2);
+    } else if (!converted) {
 	ctrl = d_restore_ctrl(obj, sw_conv);
 	data = d_restore_data(obj, counttab, sw_conv);
     } else {
@@ -2856,6 +3174,13 @@ void d_free_control(Control *ctrl)
 	}
 	FREE(ctrl->strings);
     }
+    if (ctrl->iprogs != (Control **) NULL) {
+	FREE(ctrl->iprogs);
+	FREE(ctrl->strtabs);
+    }
+    if (++igen == 0) {
+	igen = 1;	/* invalidate all cached inherits */
+    }
     if (ctrl->cvstrings != (String **) NULL) {
 	strs = ctrl->cvstrings;
 	for (i = ctrl->nvardefs; i > 0; --i) {
@@ -2895,9 +3220,6 @@ void d_free_control(Control *ctrl)
     if (ctrl->sslength != (ssizet *) NULL) {
 	FREE(ctrl->sslength);
     }
-    if (ctrl->ssindex != (Uint *) NULL) {
-	FREE(ctrl->ssindex);
-    }
     if (ctrl->stext != (char *) NULL) {
 	FREE(ctrl->stext);
     }
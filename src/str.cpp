@@ -25,14 +25,15 @@
 
 # define STR_CHUNK	128
 
-struct strh : public Hashtab::Entry {
+struct strh {
+    strh *next;			/* next in hash chain */
     String *str;		/* string entry */
     Uint index;			/* building index */
 };
 
 static Chunk<strh, STR_CHUNK> hchunk;
 
-static Hashtab *sht;		/* string merge table */
+static strh **sht;		/* string merge table */
 
 
 /*
@@ -46,7 +47,8 @@ String *str_alloc(const char *text, long len)
     String dummy;
 
     /* allocate string struct & text in one block */
-    s = (String *) ALLOC(char, dummy.text - (char *) &dummy + 1 + len);
+    s = (String *) ALLOC_CAT(char, dummy.text - (char *) &dummy + 1 + len,
+				 MC_STRING);
     if (text != (char *) NULL && len > 0) {
 	memcpy(s->text, text, (unsigned int) len);
     }
@@ -63,12 +65,36 @@ String *str_alloc(const char *text, long len)
  */
 String *str_new(const char *text, long len)
 {
-    if (len > (unsigned long) MAX_STRLEN) {
+    if ((unsigned long) len > (unsigned long) MAX_STRLEN) {
 	error("String too long");
     }
     return str_alloc(text, len);
 }
 
+/*
+ * NAME:	String->tmp()
+ * DESCRIPTION:	create a new temporary string, allocated from the task arena
+ */
+String *str_tmp(const char *text, long len)
+{
+    String *s;
+    String dummy;
+
+    if ((unsigned long) len > (unsigned long) MAX_STRLEN) {
+	error("String too long");
+    }
+    s = (String *) TALLOC(char, dummy.text - (char *) &dummy + 1 + len,
+				  MC_STRING);
+    if (text != (char *) NULL && len > 0) {
+	memcpy(s->text, text, (unsigned int) len);
+    }
+    s->text[s->len = len] = '\0';
+    s->ref = 0;
+    s->primary = (strref *) NULL;
+
+    return s;
+}
+
 /*
  * NAME:	String->del()
  * DESCRIPTION:	remove a reference from a string. If there are none left, the
@@ -87,7 +113,8 @@ void str_del(String *s)
  */
 void str_merge()
 {
-    sht = Hashtab::create(STRMERGETABSZ, STRMERGEHASHSZ, FALSE);
+    sht = ALLOC(strh*, STRMERGETABSZ);
+    memset(sht, '\0', STRMERGETABSZ * sizeof(strh*));
 }
 
 /*
@@ -96,34 +123,33 @@ void str_merge()
  */
 Uint str_put(String *str, Uint n)
 {
-    strh **h;
-
-    h = (strh **) sht->lookup(str->text, FALSE);
-    for (;;) {
-	/*
-	 * The hasher doesn't handle \0 in strings, and so may not have
-	 * found the proper string. Follow the hash table chain until
-	 * the end is reached, or until a match is found using str_cmp().
-	 */
-	if (*h == (strh *) NULL) {
-	    strh *s;
-
-	    /*
-	     * Not in the hash table. Make a new entry.
-	     */
-	    s = *h = hchunk.alloc();
-	    s->next = (Hashtab::Entry *) NULL;
-	    s->name = str->text;
-	    s->str = str;
-	    s->index = n;
-
-	    return n;
-	} else if (str_cmp(str, (*h)->str) == 0) {
+    strh **h, *s;
+    Hashstat *stat;
+
+    /*
+     * Strings may contain \0, so they are hashed and compared using their
+     * full length.
+     */
+    stat = &Hashtab::stats[HS_STRMERGE];
+    stat->lookups++;
+    for (h = &sht[Hashtab::hashmem(str->text, str->len) % STRMERGETABSZ];
+	 *h != (strh *) NULL; h = &(*h)->next) {
+	if (str_cmp(str, (*h)->str) == 0) {
 	    /* already in the hash table */
 	    return (*h)->index;
 	}
-	h = (strh **) &(*h)->next;
+	stat->collisions++;
     }
+
+    /*
+     * Not in the hash table. Make a new entry.
+     */
+    s = *h = hchunk.alloc();
+    s->next = (strh *) NULL;
+    s->str = str;
+    s->index = n;
+
+    return n;
 }
 
 /*
@@ -132,11 +158,11 @@ Uint str_put(String *str, Uint n)
  */
 void str_clear()
 {
-    if (sht != (Hashtab *) NULL) {
-	delete sht;
+    if (sht != (strh **) NULL) {
+	FREE(sht);
 
 	hchunk.clean();
-	sht = (Hashtab *) NULL;
+	sht = (strh **) NULL;
     }
 }
 
@@ -181,7 +207,7 @@ String *str_add(String *s1, String *s2)
 {
     String *s;
 
-    s = str_new((char *) NULL, (long) s1->len + s2->len);
+    s = str_tmp((char *) NULL, (long) s1->len + s2->len);
     memcpy(s->text, s1->text, s1->len);
     memcpy(s->text + s1->len, s2->text, s2->len);
 
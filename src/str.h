@@ -26,6 +26,7 @@ struct String {
 
 extern String	       *str_alloc	(const char*, long);
 extern String	       *str_new		(const char*, long);
+extern String	       *str_tmp		(const char*, long);
 # define str_ref(s)	((s)->ref++)
 extern void		str_del		(String*);
 
@@ -22,11 +22,54 @@
 # include "swap.h"
 
 struct header {			/* swap slot header */
-    header *prev;		/* previous in swap slot list */
-    header *next;		/* next in swap slot list */
+    header *prev;		/* previous in swap slot queue */
+    header *next;		/* next in swap slot queue */
     sector sec;			/* the sector that uses this slot */
     sector swap;		/* the swap sector (if any) */
     bool dirty;			/* has the swap slot been written to? */
+    char queue;			/* swap slot queue */
+};
+
+/*
+ * The swap slots are managed with the 2Q replacement policy.  Newly loaded
+ * sectors enter the NEW queue, which is FIFO.  Sectors evicted from it are
+ * remembered for a while as ghosts; if they are loaded again during that
+ * time, they enter the HOT queue, which is LRU.  A sweep across many
+ * sectors thus only replaces the NEW queue, leaving the HOT queue intact.
+ */
+# define Q_NEW		0	/* recently loaded sectors */
+# define Q_HOT		1	/* sectors loaded again while a ghost */
+
+struct slotq {			/* swap slot queue */
+    header *first;		/* first (most recent) in queue */
+    header *last;		/* last in queue */
+    sector size;		/* # slots in queue */
+};
+
+struct filemap {		/* file mapped into memory */
+    char *base;			/* start of mapping */
+    off_t size;			/* size of mapping */
+    off_t fsize;		/* size of file, as far as known */
+};
+
+struct iobuf {			/* asynchronous I/O buffer */
+    aioreq req;			/* I/O request */
+    sector swap;		/* sector in file (if any) */
+};
+
+/*
+ * Snapshot writes are collected in memory while the snapshot is made, and
+ * performed by the I/O thread afterwards.  The sectors of a snapshot are
+ * never changed once it is made, since new swap sectors are allocated
+ * beyond the barrier; only reads of the snapshot must wait for the
+ * writes that cover them.  The buffers are in dynamic memory and are
+ * released as the writes complete; any still pending are waited for before
+ * dynamic memory is purged.
+ */
+struct dumpreq {		/* background snapshot write */
+    dumpreq *next;		/* next in list */
+    unsigned int space;		/* room left in buffer */
+    aioreq req;			/* write request */
 };
 
 static char *swapfile;			/* swap file name */
@@ -37,7 +80,12 @@ static sector *map, *smap;		/* sector map, swap free map */
 static sector mfree, sfree;		/* free sector lists */
 static char *cbuf;			/* sector buffer */
 static sector cached;			/* sector currently cached in cbuf */
-static header *first, *last;		/* first and last swap slot */
+static slotq queues[2];			/* NEW and HOT swap slot queues */
+static sector newsize;			/* preferred max. size of NEW queue */
+static sector *ghosts;			/* sectors recently evicted from NEW */
+static sector *gmap;			/* sector ghost map */
+static sector nghosts, gnext;		/* # ghosts, next ghost to replace */
+static swapinfo info;			/* swap statistics */
 static header *lfree;			/* free swap slot list */
 static off_t slotsize;			/* sizeof(header) + size of sector */
 static unsigned int sectorsize;		/* size of sector */
@@ -48,15 +96,25 @@ static sector nfree;			/* # free sectors */
 static sector ssectors;			/* sectors actually in swap file */
 static sector sbarrier;			/* swap sector barrier */
 static bool swapping;			/* currently using a swapfile? */
+static iobuf *iobufs;			/* asynchronous I/O buffers */
+static int ionext;			/* next I/O buffer to use */
+static bool mapped;			/* use memory mapped files? */
+static filemap swapmap, dumpmap;	/* swap file and snapshot maps */
+static dumpreq *dwhead, *dwtail;	/* background snapshot writes */
+static bool dumping;			/* collecting snapshot writes? */
+static off_t doffset;			/* snapshot write offset */
 
 /*
  * NAME:	swap->init()
  * DESCRIPTION:	initialize the swap device
  */
-void sw_init(char *file, unsigned int total, unsigned int cache, unsigned int secsize)
+void sw_init(char *file, unsigned int total, unsigned int cache,
+	     unsigned int secsize, bool mmap)
 {
     header *h;
     sector i;
+    iobuf *b;
+    char *p;
 
     /* allocate and initialize all tables */
     swapfile = file;
@@ -67,8 +125,26 @@ void sw_init(char *file, unsigned int total, unsigned int cache, unsigned int se
     mem = ALLOC(char, slotsize * cache);
     map = ALLOC(sector, total);
     smap = ALLOC(sector, total);
+    gmap = ALLOC(sector, total);
+    for (i = 0; i < total; i++) {
+	gmap[i] = SW_UNUSED;
+    }
+    nghosts = (cache > 1) ? cache / 2 : 1;
+    ghosts = ALLOC(sector, nghosts);
+    for (gnext = nghosts; gnext > 0; ) {
+	ghosts[--gnext] = SW_UNUSED;
+    }
+    newsize = cache / 4;
     cbuf = ALLOC(char, secsize);
     cached = SW_UNUSED;
+    iobufs = b = ALLOC(iobuf, SWIOBUFS);
+    p = ALLOC(char, SWIOBUFS * secsize);
+    for (ionext = SWIOBUFS; ionext > 0; --ionext) {
+	b->req.state = AIO_DONE;
+	b->req.buf = p;
+	(b++)->swap = SW_UNUSED;
+	p += secsize;
+    }
 
     /* 0 sectors allocated */
     nsectors = 0;
@@ -89,11 +165,315 @@ void sw_init(char *file, unsigned int total, unsigned int cache, unsigned int se
     h->next = (header *) NULL;
 
     /* no swap slots in use yet */
-    first = (header *) NULL;
-    last = (header *) NULL;
+    queues[Q_NEW].first = queues[Q_NEW].last = (header *) NULL;
+    queues[Q_NEW].size = 0;
+    queues[Q_HOT].first = queues[Q_HOT].last = (header *) NULL;
+    queues[Q_HOT].size = 0;
 
-    swap = dump = -1;
+    swap = dump = dump2 = -1;
     swapping = TRUE;
+    mapped = mmap;
+}
+
+/*
+ * NAME:	swap->unmap()
+ * DESCRIPTION:	forget about a file mapping
+ */
+static void sw_unmap(filemap *fm)
+{
+    if (fm->base != (char *) NULL) {
+	P_munmap(fm->base, fm->size);
+	fm->base = (char *) NULL;
+    }
+    fm->size = fm->fsize = 0;
+}
+
+/*
+ * NAME:	swap->dnew()
+ * DESCRIPTION:	start a new snapshot write at the current offset
+ */
+static dumpreq *sw_dnew(unsigned int space)
+{
+    dumpreq *w;
+
+    w = (dumpreq *) ALLOC(char, sizeof(dumpreq) + space);
+    w->next = (dumpreq *) NULL;
+    w->space = space;
+    w->req.fd = -1;
+    w->req.write = TRUE;
+    w->req.state = AIO_DONE;
+    w->req.size = 0;
+    w->req.offset = doffset;
+    w->req.buf = (char *) (w + 1);
+    if (dwtail != (dumpreq *) NULL) {
+	dwtail->next = w;
+    } else {
+	dwhead = w;
+    }
+    return dwtail = w;
+}
+
+/*
+ * NAME:	swap->dcollect()
+ * DESCRIPTION:	collect bytes to be written to the snapshot at the current
+ *		offset
+ */
+static void sw_dcollect(char *buf, size_t size)
+{
+    dumpreq *w;
+    unsigned int len;
+
+    while (size != 0) {
+	w = dwtail;
+	if (w == (dumpreq *) NULL || w->space == 0 ||
+	    w->req.offset + w->req.size != doffset) {
+	    len = (size > SWAPCHUNK) ? SWAPCHUNK : size;
+	    w = sw_dnew((len < SWDUMPBUF) ? SWDUMPBUF : len);
+	}
+	len = (size > w->space) ? w->space : size;
+	memcpy(w->req.buf + w->req.size, buf, len);
+	w->req.size += len;
+	w->space -= len;
+	buf += len;
+	size -= len;
+	doffset += len;
+    }
+}
+
+/*
+ * NAME:	swap->dqueue()
+ * DESCRIPTION:	queue the collected snapshot writes
+ */
+static void sw_dqueue(int fd)
+{
+    dumpreq *w;
+
+    for (w = dwhead; w != (dumpreq *) NULL; w = w->next) {
+	w->req.fd = fd;
+	P_aio_queue(&w->req);
+    }
+}
+
+/*
+ * NAME:	swap->dsync()
+ * DESCRIPTION:	wait for the snapshot writes to a range of a file, or for
+ *		all of them if the size is 0, and release completed writes
+ */
+static void sw_dsync(int fd, off_t offset, off_t size)
+{
+    dumpreq *w, *last;
+
+    if (dumping) {
+	return;		/* nothing in the background while collecting */
+    }
+    last = (dumpreq *) NULL;
+    for (w = dwhead; w != (dumpreq *) NULL; w = w->next) {
+	if (size == 0 ||
+	    (w->req.fd == fd && w->req.offset < offset + size &&
+	     offset < w->req.offset + w->req.size)) {
+	    last = w;
+	}
+    }
+
+    /* writes complete in order */
+    while ((w = dwhead) != (dumpreq *) NULL &&
+	   (last != (dumpreq *) NULL || w->req.state != AIO_QUEUED)) {
+	if (!P_aio_wait(&w->req)) {
+	    fatal("cannot write snapshot");
+	}
+	if (w == last) {
+	    last = (dumpreq *) NULL;
+	}
+	dwhead = w->next;
+	FREE(w);
+    }
+    if (dwhead == (dumpreq *) NULL) {
+	dwtail = (dumpreq *) NULL;
+    }
+}
+
+/*
+ * NAME:	swap->dwait()
+ * DESCRIPTION:	wait for all background snapshot writes, so that their
+ *		buffers are released before dynamic memory is purged
+ */
+void sw_dwait()
+{
+    sw_dsync(-1, 0, 0);
+}
+
+/*
+ * NAME:	swap->mapped()
+ * DESCRIPTION:	return a pointer to a range of a file in memory, or NULL if
+ *		the range is beyond the end of the file
+ */
+static char *sw_mapped(int fd, filemap *fm, off_t offset, unsigned int size)
+{
+    struct stat sbuf;
+    off_t msize;
+
+    if (fd < 0) {
+	return (char *) NULL;
+    }
+    sw_dsync(fd, offset, size);
+    if (offset + size > fm->fsize) {
+	/* the file may have been extended */
+	if (P_fstat(fd, &sbuf) < 0 || offset + size > sbuf.st_size) {
+	    return (char *) NULL;
+	}
+	fm->fsize = sbuf.st_size;
+    }
+    if (offset + size > fm->size) {
+	/*
+	 * map the file again, leaving room to grow
+	 */
+	if (fm->base != (char *) NULL) {
+	    P_munmap(fm->base, fm->size);
+	}
+	msize = fm->fsize * 2;
+	if (msize < SWMAPSIZE) {
+	    msize = SWMAPSIZE;
+	}
+	fm->base = P_mmap(fd, msize, (fm == &swapmap));
+	if (fm->base == (char *) NULL) {
+	    /* cannot map: use ordinary file I/O from now on */
+	    fm->size = fm->fsize = 0;
+	    mapped = FALSE;
+	    return (char *) NULL;
+	}
+	fm->size = msize;
+    }
+    return fm->base + offset;
+}
+
+/*
+ * NAME:	swap->iowait()
+ * DESCRIPTION:	wait for background I/O on a buffer to complete
+ */
+static void sw_iowait(iobuf *b)
+{
+    if (!P_aio_wait(&b->req)) {
+	if (b->req.write) {
+	    fatal("cannot write swap file");
+	}
+	b->swap = SW_UNUSED;	/* failed read-ahead */
+    }
+}
+
+/*
+ * NAME:	swap->iosync()
+ * DESCRIPTION:	complete all background I/O, and forget buffered sectors
+ */
+static void sw_iosync()
+{
+    iobuf *b;
+    int i;
+
+    for (b = iobufs, i = SWIOBUFS; i > 0; b++, --i) {
+	sw_iowait(b);
+	b->swap = SW_UNUSED;
+    }
+}
+
+/*
+ * NAME:	swap->iofind()
+ * DESCRIPTION:	find the I/O buffer for a sector in a file
+ */
+static iobuf *sw_iofind(int fd, sector sec)
+{
+    iobuf *b;
+    int i;
+
+    for (b = iobufs, i = SWIOBUFS; i > 0; b++, --i) {
+	if (b->swap == sec && b->req.fd == fd) {
+	    return b;
+	}
+    }
+    return (iobuf *) NULL;
+}
+
+/*
+ * NAME:	swap->iobuf()
+ * DESCRIPTION:	get an I/O buffer for a sector in a file
+ */
+static iobuf *sw_iobuf(int fd, sector sec, bool write)
+{
+    iobuf *b;
+
+    /* reuse the least recently queued buffer */
+    b = &iobufs[ionext];
+    ionext = (ionext + 1) % SWIOBUFS;
+    sw_iowait(b);
+
+    b->swap = sec;
+    b->req.fd = fd;
+    b->req.write = write;
+    b->req.offset = (off_t) (sec + 1L) * sectorsize;
+    b->req.size = sectorsize;
+    return b;
+}
+
+/*
+ * NAME:	swap->ioread()
+ * DESCRIPTION:	read a sector from a file, using a buffered copy if possible
+ */
+static void sw_ioread(int fd, sector sec, char *m, const char *err)
+{
+    iobuf *b;
+    char *p;
+
+    b = sw_iofind(fd, sec);
+    if (b != (iobuf *) NULL) {
+	sw_iowait(b);
+	if (b->swap == sec) {
+	    memcpy(m, b->req.buf, sectorsize);
+	    return;
+	}
+    }
+
+    if (mapped) {
+	p = sw_mapped(fd, (fd == swap) ? &swapmap : &dumpmap,
+		      (off_t) (sec + 1L) * sectorsize, sectorsize);
+	if (p != (char *) NULL) {
+	    memcpy(m, p, sectorsize);
+	    return;
+	}
+    }
+    sw_dsync(fd, (off_t) (sec + 1L) * sectorsize, sectorsize);
+    P_lseek(fd, (off_t) (sec + 1L) * sectorsize, SEEK_SET);
+    if (P_read(fd, m, sectorsize) <= 0) {
+	fatal(err);
+    }
+}
+
+/*
+ * NAME:	swap->iowrite()
+ * DESCRIPTION:	write a sector to the swap file in the background
+ */
+static void sw_iowrite(sector sec, char *m)
+{
+    iobuf *b;
+    char *p;
+
+    b = sw_iofind(swap, sec);
+    if (b != (iobuf *) NULL) {
+	if (mapped) {
+	    sw_iowait(b);	/* must not overwrite the mapped copy */
+	}
+	b->swap = SW_UNUSED;	/* superseded; requests complete in order */
+    }
+    if (mapped) {
+	p = sw_mapped(swap, &swapmap, (off_t) (sec + 1L) * sectorsize,
+		      sectorsize);
+	if (p != (char *) NULL) {
+	    memcpy(p, m, sectorsize);
+	    return;
+	}
+	/* extending the file is left to the I/O thread */
+    }
+    b = sw_iobuf(swap, sec, TRUE);
+    memcpy(b->req.buf, m, sectorsize);
+    P_aio_queue(&b->req);
 }
 
 /*
@@ -102,6 +482,11 @@ void sw_init(char *file, unsigned int total, unsigned int cache, unsigned int se
  */
 void sw_finish()
 {
+    sw_iosync();
+    sw_dsync(-1, 0, 0);
+    P_aio_finish();
+    sw_unmap(&swapmap);
+    sw_unmap(&dumpmap);
     if (swap >= 0) {
 	char buf[STRINGSZ];
 
@@ -111,6 +496,9 @@ void sw_finish()
     if (dump >= 0) {
 	P_close(dump);
     }
+    if (dump2 >= 0) {
+	P_close(dump2);
+    }
 }
 
 /*
@@ -119,6 +507,10 @@ void sw_finish()
  */
 bool sw_write(int fd, void *buffer, size_t size)
 {
+    if (dumping && fd == swap) {
+	sw_dcollect((char *) buffer, size);
+	return TRUE;
+    }
     while (size > SWAPCHUNK) {
 	if (P_write(fd, (char *) buffer, SWAPCHUNK) != SWAPCHUNK) {
 	    return FALSE;
@@ -137,6 +529,7 @@ static void sw_create()
 {
     char buf[STRINGSZ], *p;
 
+    sw_unmap(&swapmap);
     memset(cbuf, '\0', sectorsize);
     p = path_native(buf, swapfile);
     P_unlink(p);
@@ -204,6 +597,100 @@ void sw_wipev(sector *vec, unsigned int size)
     }
 }
 
+/*
+ * NAME:	swap->qdel()
+ * DESCRIPTION:	remove a swap slot from its queue
+ */
+static void sw_qdel(header *h)
+{
+    slotq *q;
+
+    q = &queues[UCHAR(h->queue)];
+    if (h != q->first) {
+	h->prev->next = h->next;
+    } else {
+	q->first = h->next;
+	if (q->first != (header *) NULL) {
+	    q->first->prev = (header *) NULL;
+	}
+    }
+    if (h != q->last) {
+	h->next->prev = h->prev;
+    } else {
+	q->last = h->prev;
+	if (q->last != (header *) NULL) {
+	    q->last->next = (header *) NULL;
+	}
+    }
+    --q->size;
+}
+
+/*
+ * NAME:	swap->qadd()
+ * DESCRIPTION:	put a swap slot at the head of a queue
+ */
+static void sw_qadd(header *h, int queue)
+{
+    slotq *q;
+
+    q = &queues[queue];
+    h->queue = queue;
+    h->prev = (header *) NULL;
+    h->next = q->first;
+    if (q->first != (header *) NULL) {
+	q->first->prev = h;
+    } else {
+	q->last = h;	/* last was NULL too */
+    }
+    q->first = h;
+    q->size++;
+}
+
+/*
+ * NAME:	swap->qlast()
+ * DESCRIPTION:	return the last swap slot in use, NEW queue first
+ */
+static header *sw_qlast()
+{
+    return (queues[Q_NEW].last != (header *) NULL) ?
+	    queues[Q_NEW].last : queues[Q_HOT].last;
+}
+
+/*
+ * NAME:	swap->qprev()
+ * DESCRIPTION:	return the swap slot in use before the given one
+ */
+static header *sw_qprev(header *h)
+{
+    return (h->prev != (header *) NULL || h->queue == Q_HOT) ?
+	    h->prev : queues[Q_HOT].last;
+}
+
+/*
+ * NAME:	swap->ghost()
+ * DESCRIPTION:	remember a sector evicted from the NEW queue
+ */
+static void sw_ghost(sector sec)
+{
+    ghosts[gnext] = sec;
+    gmap[sec] = gnext;
+    if (++gnext == nghosts) {
+	gnext = 0;
+    }
+}
+
+/*
+ * NAME:	swap->isghost()
+ * DESCRIPTION:	check whether a sector was evicted from the NEW queue recently
+ */
+static bool sw_isghost(sector sec)
+{
+    sector g;
+
+    g = gmap[sec];
+    return (g < nghosts && ghosts[g] == sec);
+}
+
 /*
  * NAME:	swap->delv()
  * DESCRIPTION:	delete a vector of swap sectors
@@ -222,24 +709,9 @@ void sw_delv(sector *vec, unsigned int size)
 	i = map[sec];
 	if (i < cachesize && (h=(header *) (mem + i * slotsize))->sec == sec) {
 	    /*
-	     * remove the swap slot from the first-last list
+	     * remove the swap slot from its queue
 	     */
-	    if (h != first) {
-		h->prev->next = h->next;
-	    } else {
-		first = h->next;
-		if (first != (header *) NULL) {
-		    first->prev = (header *) NULL;
-		}
-	    }
-	    if (h != last) {
-		h->next->prev = h->prev;
-	    } else {
-		last = h->prev;
-		if (last != (header *) NULL) {
-		    last->next = (header *) NULL;
-		}
-	    }
+	    sw_qdel(h);
 	    /*
 	     * put the cache slot in the free cache slot list
 	     */
@@ -268,6 +740,7 @@ static header *sw_load(sector sec, bool restore, bool fill)
 {
     header *h;
     sector load, save;
+    int queue;
 
     load = map[sec];
     if (load >= cachesize ||
@@ -275,6 +748,8 @@ static header *sw_load(sector sec, bool restore, bool fill)
 	/*
 	 * the sector is either unused or in the swap file
 	 */
+	info.misses++;
+	queue = (sw_isghost(sec)) ? Q_HOT : Q_NEW;
 	if (lfree != (header *) NULL) {
 	    /*
 	     * get swap slot from the free swap slot list
@@ -283,16 +758,18 @@ static header *sw_load(sector sec, bool restore, bool fill)
 	    lfree = h->next;
 	} else {
 	    /*
-	     * No free slot available, use the last one in the swap slot list
-	     * instead.
+	     * No free slot available, replace the last one in the NEW queue
+	     * if it has grown too large, or the last one in the HOT queue
+	     * otherwise.
 	     */
-	    h = last;
-	    last = h->prev;
-	    if (last != (header *) NULL) {
-		last->next = (header *) NULL;
+	    if (queues[Q_NEW].size > newsize || queues[Q_HOT].size == 0) {
+		h = queues[Q_NEW].last;
+		sw_ghost(h->sec);
 	    } else {
-		first = (header *) NULL;
+		h = queues[Q_HOT].last;
 	    }
+	    sw_qdel(h);
+	    info.evictions++;
 	    save = h->swap;
 	    if (h->dirty) {
 		/*
@@ -318,10 +795,7 @@ static header *sw_load(sector sec, bool restore, bool fill)
 		if (swap < 0) {
 		    sw_create();
 		}
-		P_lseek(swap, (off_t) (save + 1L) * sectorsize, SEEK_SET);
-		if (!sw_write(swap, h + 1, sectorsize)) {
-		    fatal("cannot write swap file");
-		}
+		sw_iowrite(save, (char *) (h + 1));
 	    }
 	    map[h->sec] = save;
 	}
@@ -338,54 +812,139 @@ static header *sw_load(sector sec, bool restore, bool fill)
 		/*
 		 * load the sector from the snapshot
 		 */
-		P_lseek(dump, (off_t) (load + 1L) * sectorsize, SEEK_SET);
-		if (P_read(dump, (char *) (h + 1), sectorsize) <= 0) {
-		    fatal("cannot read snapshot");
-		}
+		sw_ioread(dump, load, (char *) (h + 1), "cannot read snapshot");
 	    } else if (fill) {
 		/*
 		 * load the sector from the swap file
 		 */
-		P_lseek(swap, (off_t) (load + 1L) * sectorsize, SEEK_SET);
-		if (P_read(swap, (char *) (h + 1), sectorsize) <= 0) {
-		    fatal("cannot read swap file");
-		}
+		sw_ioread(swap, load, (char *) (h + 1),
+			  "cannot read swap file");
 	    }
 	} else if (fill) {
 	    /* zero-fill new sector */
 	    memset(h + 1, '\0', sectorsize);
 	}
+	sw_qadd(h, queue);
     } else {
 	/*
-	 * The sector already had a slot. Remove it from the first-last list.
+	 * The sector already had a slot.  Move it to the head of the HOT
+	 * queue if it is in there, but leave the NEW queue in FIFO order.
 	 */
-	if (h != first) {
-	    h->prev->next = h->next;
-	} else {
-	    first = h->next;
+	info.hits++;
+	if (h->queue == Q_HOT && h != queues[Q_HOT].first) {
+	    sw_qdel(h);
+	    sw_qadd(h, Q_HOT);
 	}
-	if (h != last) {
-	    h->next->prev = h->prev;
-	} else {
-	    last = h->prev;
-	    if (last != (header *) NULL) {
-		last->next = (header *) NULL;
-	    }
+    }
+
+    return h;
+}
+
+/*
+ * NAME:	swap->loadv()
+ * DESCRIPTION:	if the first sector of a vector is in a file, load it together
+ *		with the sectors that follow it in the same file, using a
+ *		single vectored read
+ */
+static void sw_loadv(sector *vec, unsigned int size, bool restore)
+{
+    struct iovec iov[SWVECTOR];
+    sector sec, load, start;
+    unsigned int n;
+    int fd;
+
+    fd = (restore) ? dump : swap;
+    if (fd < 0 || mapped) {
+	return;		/* nothing to gain */
+    }
+    if (size > SWVECTOR) {
+	size = SWVECTOR;
+    }
+    if (size > newsize) {
+	size = newsize;		/* slots in the run must not evict each other */
+    }
+
+    /* find a run of consecutive sectors in the file */
+    start = SW_UNUSED;
+    for (n = 0; n < size; n++) {
+	sec = vec[n];
+	load = map[sec];
+	if (load == SW_UNUSED ||
+	    (load < cachesize &&
+	     ((header *) (mem + load * slotsize))->sec == sec) ||
+	    (n != 0 && load != start + n) ||
+	    sw_iofind(fd, load) != (iobuf *) NULL) {
+	    break;
+	}
+	if (n == 0) {
+	    start = load;
 	}
     }
-    /*
-     * put the sector at the head of the first-last list
-     */
-    h->prev = (header *) NULL;
-    h->next = first;
-    if (first != (header *) NULL) {
-	first->prev = h;
-    } else {
-	last = h;	/* last was NULL too */
+    if (n < 2) {
+	return;		/* leave single sectors to sw_load() */
     }
-    first = h;
 
-    return h;
+    /* reserve slots, and fill them all at once */
+    size = n;
+    for (n = 0; n < size; n++) {
+	iov[n].iov_base = sw_load(vec[n], FALSE, FALSE) + 1;
+	iov[n].iov_len = sectorsize;
+    }
+    sw_dsync(fd, (off_t) (start + 1L) * sectorsize, size * sectorsize);
+    if (P_preadv(fd, iov, size, (off_t) (start + 1L) * sectorsize) !=
+							 size * sectorsize) {
+	fatal((restore) ? "cannot read snapshot" : "cannot read swap file");
+    }
+    info.rsaved += size - 1;
+}
+
+/*
+ * NAME:	swap->prefetchv()
+ * DESCRIPTION:	start loading a vector of sectors in the background
+ */
+void sw_prefetchv(sector *vec, unsigned int size, bool restore)
+{
+    sector sec, load;
+    int fd;
+
+    fd = (restore) ? dump : swap;
+    if (fd < 0 || mapped || (restore && restoresecsize != sectorsize)) {
+	return;
+    }
+    if (size > SWPREFETCH) {
+	size = SWPREFETCH;
+    }
+    while (size > 0) {
+	sec = *vec++;
+	load = map[sec];
+	if (load != SW_UNUSED &&
+	    (load >= cachesize ||
+	     ((header *) (mem + load * slotsize))->sec != sec) &&
+	    sw_iofind(fd, load) == (iobuf *) NULL) {
+	    P_aio_queue(&sw_iobuf(fd, load, FALSE)->req);
+	}
+	--size;
+    }
+}
+
+/*
+ * NAME:	swap->inplace()
+ * DESCRIPTION:	return a pointer to a sector in the mapped swap file, or NULL
+ *		if it must be accessed through the cache
+ */
+static char *sw_inplace(sector sec)
+{
+    sector load;
+
+    load = map[sec];
+    if (load == SW_UNUSED ||
+	(load < cachesize &&
+	 ((header *) (mem + load * slotsize))->sec == sec) ||
+	sw_iofind(swap, load) != (iobuf *) NULL) {
+	return (char *) NULL;
+    }
+    return sw_mapped(swap, &swapmap, (off_t) (load + 1L) * sectorsize,
+		     sectorsize);
 }
 
 /*
@@ -394,13 +953,25 @@ static header *sw_load(sector sec, bool restore, bool fill)
  */
 void sw_readv(char *m, sector *vec, Uint size, Uint idx)
 {
-    unsigned int len;
+    unsigned int len, n;
+    char *p;
 
     vec += idx / sectorsize;
     idx %= sectorsize;
+    n = (idx + size + sectorsize - 1) / sectorsize;
     do {
 	len = (size > sectorsize - idx) ? sectorsize - idx : size;
-	memcpy(m, (char *) (sw_load(*vec++, FALSE, TRUE) + 1) + idx, len);
+	if (mapped && (p=sw_inplace(*vec)) != (char *) NULL) {
+	    /* read directly from the file, bypassing the cache */
+	    vec++;
+	} else {
+	    if (n > 1) {
+		sw_loadv(vec, n, FALSE);
+	    }
+	    p = (char *) (sw_load(*vec++, FALSE, TRUE) + 1);
+	}
+	memcpy(m, p + idx, len);
+	--n;
 	idx = 0;
 	m += len;
     } while ((size -= len) > 0);
@@ -434,12 +1005,16 @@ void sw_writev(char *m, sector *vec, Uint size, Uint idx)
 void sw_dreadv(char *m, sector *vec, Uint size, Uint idx)
 {
     header *h;
-    unsigned int len;
+    unsigned int len, n;
 
     vec += idx / sectorsize;
     idx %= sectorsize;
+    n = (idx + size + sectorsize - 1) / sectorsize;
     do {
 	len = (size > sectorsize - idx) ? sectorsize - idx : size;
+	if (n > 1) {
+	    sw_loadv(vec, n--, TRUE);
+	}
 	h = sw_load(*vec++, TRUE, FALSE);
 	h->swap = SW_UNUSED;
 	memcpy(m, (char *) (h + 1) + idx, len);
@@ -455,15 +1030,30 @@ void sw_dreadv(char *m, sector *vec, Uint size, Uint idx)
 void sw_conv(char *m, sector *vec, Uint size, Uint idx)
 {
     unsigned int len;
+    off_t offset;
+    char *p;
 
     vec += idx / restoresecsize;
     idx %= restoresecsize;
     do {
 	len = (size > restoresecsize - idx) ? restoresecsize - idx : size;
 	if (*vec != cached) {
-	    P_lseek(dump, (off_t) (map[*vec] + 1L) * restoresecsize, SEEK_SET);
-	    if (P_read(dump, cbuf, restoresecsize) <= 0) {
-		fatal("cannot read snapshot");
+	    if (restoresecsize == sectorsize) {
+		/* the sector may have been read in the background */
+		sw_ioread(dump, map[*vec], cbuf, "cannot read snapshot");
+	    } else {
+		offset = (off_t) (map[*vec] + 1L) * restoresecsize;
+		p = (mapped) ?
+		     sw_mapped(dump, &dumpmap, offset, restoresecsize) :
+		     (char *) NULL;
+		if (p != (char *) NULL) {
+		    memcpy(cbuf, p, restoresecsize);
+		} else {
+		    P_lseek(dump, offset, SEEK_SET);
+		    if (P_read(dump, cbuf, restoresecsize) <= 0) {
+			fatal("cannot read snapshot");
+		    }
+		}
 	    }
 	    map[cached = *vec] = SW_UNUSED;
 	}
@@ -529,6 +1119,52 @@ sector sw_count()
     return nsectors - nfree;
 }
 
+/*
+ * NAME:	swap->info()
+ * DESCRIPTION:	return swap statistics
+ */
+swapinfo *sw_info()
+{
+    return &info;
+}
+
+/*
+ * NAME:	swap->flushv()
+ * DESCRIPTION:	write consecutive sectors to the swap file at once
+ */
+static void sw_flushv(struct iovec *iov, sector n, sector start)
+{
+    char *p;
+
+    if (mapped) {
+	p = sw_mapped(swap, &swapmap, (off_t) (start + 1L) * sectorsize,
+		      n * sectorsize);
+	if (p != (char *) NULL) {
+	    do {
+		memcpy(p, iov->iov_base, sectorsize);
+		p += sectorsize;
+		iov++;
+	    } while (--n != 0);
+	    return;
+	}
+    }
+    if (dumping) {
+	/* copy the sectors, to be written in the background */
+	doffset = (off_t) (start + 1L) * sectorsize;
+	sw_dnew(n * sectorsize);
+	do {
+	    sw_dcollect((char *) iov->iov_base, sectorsize);
+	    iov++;
+	} while (--n != 0);
+	return;
+    }
+    if (P_pwritev(swap, iov, n, (off_t) (start + 1L) * sectorsize) !=
+							    n * sectorsize) {
+	fatal("cannot write swap file");
+    }
+    info.wsaved += n - 1;
+}
+
 
 struct dump_header {
     Uint secsize;		/* size of swap sector */
@@ -547,16 +1183,22 @@ static char dh_layout[] = "idddd";
 int sw_dump(char *snapshot, bool keep)
 {
     header *h;
-    sector sec;
+    sector sec, start;
     char buffer[STRINGSZ + 4], buf1[STRINGSZ], buf2[STRINGSZ], *p, *q;
     sector n;
+    struct iovec iov[SWVECTOR];
 
+    sw_iosync();
+    sw_dsync(-1, 0, 0);
     if (swap < 0) {
 	sw_create();
     }
+    dumping = TRUE;
 
     /* flush the cache and adjust sector map */
-    for (h = last; h != (header *) NULL; h = h->prev) {
+    n = 0;
+    start = SW_UNUSED;
+    for (h = sw_qlast(); h != (header *) NULL; h = sw_qprev(h)) {
 	sec = h->swap;
 	if (h->dirty) {
 	    /*
@@ -578,13 +1220,23 @@ int sw_dump(char *snapshot, bool keep)
 		}
 		h->swap = sec;
 	    }
-	    P_lseek(swap, (off_t) (sec + 1L) * sectorsize, SEEK_SET);
-	    if (!sw_write(swap, h + 1, sectorsize)) {
-		fatal("cannot write swap file");
+	    if (n != 0 && (sec != start + n || n == SWVECTOR)) {
+		sw_flushv(iov, n, start);
+		n = 0;
 	    }
+	    if (n == 0) {
+		start = sec;
+	    }
+	    iov[n].iov_base = h + 1;
+	    iov[n++].iov_len = sectorsize;
 	}
 	map[h->sec] = sec;
     }
+    if (n != 0) {
+	sw_flushv(iov, n, start);
+    }
+    sw_unmap(&swapmap);
+    sw_unmap(&dumpmap);
 
     if (dump >= 0 && !keep) {
 	P_close(dump);
@@ -613,6 +1265,10 @@ int sw_dump(char *snapshot, bool keep)
 	    if (old < 0 || swap < 0) {
 		fatal("cannot move swap file");
 	    }
+	    /* the flushed sectors must be copied as well */
+	    dumping = FALSE;
+	    sw_dqueue(old);
+	    sw_dsync(-1, 0, 0);
 	    /* copy initial sector */
 	    if (P_read(old, cbuf, sectorsize) <= 0) {
 		fatal("cannot read swap file");
@@ -630,6 +1286,7 @@ int sw_dump(char *snapshot, bool keep)
 		}
 	    }
 	    P_close(old);
+	    dumping = TRUE;
 	} else {
 	    /*
 	     * The rename succeeded; reopen the new snapshot.
@@ -642,13 +1299,13 @@ int sw_dump(char *snapshot, bool keep)
     }
 
     /* write map */
-    P_lseek(swap, (off_t) (ssectors + 1L) * sectorsize, SEEK_SET);
+    doffset = (off_t) (ssectors + 1L) * sectorsize;
     if (!sw_write(swap, map, nsectors * sizeof(sector))) {
 	fatal("cannot write sector map to snapshot");
     }
 
     /* fix the sector map */
-    for (h = last; h != (header *) NULL; h = h->prev) {
+    for (h = sw_qlast(); h != (header *) NULL; h = sw_qprev(h)) {
 	map[h->sec] = ((intptr_t) h - (intptr_t) mem) / slotsize;
 	h->dirty = FALSE;
     }
@@ -668,11 +1325,14 @@ void sw_dump2(char *header, int size, bool incr)
     dump_header dh;
     char save[4];
 
+    sw_iosync();
+    sw_unmap(&swapmap);
+    sw_unmap(&dumpmap);
     memset(cbuf, '\0', sectorsize);
 
     if (!swapping || incr) {
 	/* extend */
-	sectors = P_lseek(swap, 0, SEEK_CUR);
+	sectors = doffset;
 	offset = sectors % sectorsize;
 	sectors /= sectorsize;
 	if (offset != 0) {
@@ -684,7 +1344,7 @@ void sw_dump2(char *header, int size, bool incr)
     }
 
     if (swapping) {
-	P_lseek(swap, 0, SEEK_SET);
+	doffset = 0;
 	prev = 0;
     }
 
@@ -706,13 +1366,17 @@ void sw_dump2(char *header, int size, bool incr)
 	save[1] = sectors >> 16;
 	save[2] = sectors >> 8;
 	save[3] = sectors;
-	P_lseek(swap, prev * sectorsize + size - sizeof(save), SEEK_SET);
+	doffset = prev * sectorsize + size - sizeof(save);
 	if (!sw_write(swap, save, sizeof(save))) {
 	    fatal("cannot write offset");
 	}
 	prev = sectors;
     }
 
+    /* write the snapshot in the background */
+    dumping = FALSE;
+    sw_dqueue(swap);
+
     if (incr) {
 	/* incremental snapshot */
 	if (swapping) {
@@ -766,14 +1430,18 @@ void sw_restore(int fd, unsigned int secsize)
     mfree = dh.mfree;
     nfree = dh.nfree;
 
+    sw_unmap(&dumpmap);
     dump = fd;
 }
 
 /*
  * NAME:	swap->restore2()
- * DESCRIPTION:	restore secondary snapshot
+ * DESCRIPTION:	restore secondary snapshot, or close it when no longer needed
  */
 void sw_restore2(int fd)
 {
+    if (dump2 >= 0) {
+	P_close(dump2);
+    }
     dump2 = fd;
 }
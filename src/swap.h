@@ -17,13 +17,26 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+# ifndef H_SWAP
+# define H_SWAP
+
+struct swapinfo {
+    Uuint hits;			/* swap cache hits */
+    Uuint misses;		/* swap cache misses */
+    Uuint evictions;		/* sectors evicted from swap cache */
+    Uuint rsaved;		/* reads saved by vectored I/O */
+    Uuint wsaved;		/* writes saved by vectored I/O */
+};
+
 extern void	sw_init		(char*, unsigned int, unsigned int,
-				   unsigned int);
+				   unsigned int, bool);
 extern void	sw_finish	();
+extern void	sw_dwait	();
 extern bool	sw_write	(int, void*, size_t);
 extern void	sw_newv		(sector*, unsigned int);
 extern void	sw_wipev	(sector*, unsigned int);
 extern void	sw_delv		(sector*, unsigned int);
+extern void	sw_prefetchv	(sector*, unsigned int, bool);
 extern void	sw_readv	(char*, sector*, Uint, Uint);
 extern void	sw_writev	(char*, sector*, Uint, Uint);
 extern void	sw_dreadv	(char*, sector*, Uint, Uint);
@@ -31,8 +44,11 @@ extern void	sw_conv		(char*, sector*, Uint, Uint);
 extern void	sw_conv2	(char*, sector*, Uint, Uint);
 extern sector	sw_mapsize	(unsigned int);
 extern sector	sw_count	();
+extern swapinfo *sw_info	();
 extern bool	sw_copy		(Uint);
 extern int	sw_dump		(char*, bool);
 extern void	sw_dump2	(char*, int, bool);
 extern void	sw_restore	(int, unsigned int);
 extern void	sw_restore2	(int);
+
+# endif /* H_SWAP */